@@ -8,6 +8,8 @@ CREATE TABLE IF NOT EXISTS conversations (
   last_time DATETIME,
   unread_count INTEGER DEFAULT 0,
   status TEXT DEFAULT 'new',
+  last_message_id INTEGER DEFAULT 0,
+  last_direction TEXT DEFAULT '',
   updated_at DATETIME,
   deleted_at DATETIME,
   created_at DATETIME DEFAULT CURRENT_TIMESTAMP,
@@ -36,6 +38,50 @@ CREATE TABLE IF NOT EXISTS messages (
 CREATE INDEX IF NOT EXISTS idx_messages_conv_id ON messages(conversation_id);
 CREATE INDEX IF NOT EXISTS idx_messages_platform_message_id ON messages(platform_message_id);
 CREATE INDEX IF NOT EXISTS idx_messages_client_message_id ON messages(client_message_id);
+CREATE INDEX IF NOT EXISTS idx_messages_conv_direction ON messages(conversation_id, direction);
+CREATE INDEX IF NOT EXISTS idx_messages_conv_created ON messages(conversation_id, created_at);
+CREATE INDEX IF NOT EXISTS idx_conversations_last_time ON conversations(last_time);
+CREATE INDEX IF NOT EXISTS idx_conversations_last_message ON conversations(last_message_id, last_direction);
+
+-- 会话最后一条未删除消息（按 id）的冗余列由触发器维护，入库/发送/对账各写入路径都不用改；
+-- 客户端刷新会话列表直接读会话行，不再对 messages 做 GROUP BY
+CREATE TRIGGER IF NOT EXISTS trg_messages_last_direction_insert
+AFTER INSERT ON messages
+WHEN NEW.deleted_at IS NULL OR NEW.deleted_at = ''
+BEGIN
+  UPDATE conversations SET last_message_id = NEW.id, last_direction = NEW.direction
+  WHERE id = NEW.conversation_id AND COALESCE(last_message_id, 0) <= NEW.id;
+END;
+
+CREATE TRIGGER IF NOT EXISTS trg_messages_last_direction_update
+AFTER UPDATE OF conversation_id, direction, deleted_at ON messages
+BEGIN
+  UPDATE conversations SET
+    last_message_id = COALESCE((SELECT m.id FROM messages m
+                                WHERE m.conversation_id = conversations.id
+                                  AND (m.deleted_at IS NULL OR m.deleted_at = '')
+                                ORDER BY m.id DESC LIMIT 1), 0),
+    last_direction = COALESCE((SELECT m.direction FROM messages m
+                               WHERE m.conversation_id = conversations.id
+                                 AND (m.deleted_at IS NULL OR m.deleted_at = '')
+                               ORDER BY m.id DESC LIMIT 1), '')
+  WHERE id IN (OLD.conversation_id, NEW.conversation_id);
+END;
+
+CREATE TRIGGER IF NOT EXISTS trg_messages_last_direction_delete
+AFTER DELETE ON messages
+BEGIN
+  UPDATE conversations SET
+    last_message_id = COALESCE((SELECT m.id FROM messages m
+                                WHERE m.conversation_id = conversations.id
+                                  AND (m.deleted_at IS NULL OR m.deleted_at = '')
+                                ORDER BY m.id DESC LIMIT 1), 0),
+    last_direction = COALESCE((SELECT m.direction FROM messages m
+                               WHERE m.conversation_id = conversations.id
+                                 AND (m.deleted_at IS NULL OR m.deleted_at = '')
+                               ORDER BY m.id DESC LIMIT 1), '')
+  WHERE id = OLD.conversation_id AND last_message_id = OLD.id;
+END;
 
 CREATE TABLE IF NOT EXISTS wechat_conversations (
   id INTEGER PRIMARY KEY AUTOINCREMENT,
@@ -104,6 +150,8 @@ CREATE TABLE IF NOT EXISTS wechat_messages (
 
 CREATE INDEX IF NOT EXISTS idx_wechat_messages_conv_id ON wechat_messages(conversation_id);
 CREATE INDEX IF NOT EXISTS idx_wechat_messages_platform_message_id ON wechat_messages(platform_message_id);
+CREATE INDEX IF NOT EXISTS idx_wechat_messages_content_image_path ON wechat_messages(content_image_path);
+CREATE INDEX IF NOT EXISTS idx_wechat_messages_evidence_ref ON wechat_messages(evidence_ref);
 
 CREATE TABLE IF NOT EXISTS qianniu_messages (
   id INTEGER PRIMARY KEY AUTOINCREMENT,
@@ -136,6 +184,8 @@ CREATE TABLE IF NOT EXISTS qianniu_messages (
 
 CREATE INDEX IF NOT EXISTS idx_qianniu_messages_conv_id ON qianniu_messages(conversation_id);
 CREATE INDEX IF NOT EXISTS idx_qianniu_messages_platform_message_id ON qianniu_messages(platform_message_id);
+CREATE INDEX IF NOT EXISTS idx_qianniu_messages_content_image_path ON qianniu_messages(content_image_path);
+CREATE INDEX IF NOT EXISTS idx_qianniu_messages_evidence_ref ON qianniu_messages(evidence_ref);
 
 CREATE TABLE IF NOT EXISTS rpa_events (
   id INTEGER PRIMARY KEY AUTOINCREMENT,
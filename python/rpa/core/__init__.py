@@ -3,124 +3,87 @@ RPA 通用基础设施模块。
 
 提供与平台无关的 Win32 输入模拟、窗口截图、窗口锁、增量去重等能力。
 平台特化代码应放在 platforms/ 子目录下。
+
+下列名字按需从子模块加载：input_sim、screenshot 等在导入时就要 ctypes.WinDLL，
+导入本包本身不能牵出它们，否则 poll_scheduler、uia_locator、frame_diff 这类纯 Python
+模块在非 Windows 环境下也无法导入和测试。纯 Python 模块请直接从子模块导入。
 """
-from .input_sim import (
-    simulate_click,
-    simulate_double_click,
-    simulate_key,
-    simulate_key_combo,
-    simulate_type_unicode,
-    set_clipboard_text,
-    get_clipboard_text,
-    ClipboardGuard,
-    client_to_screen,
-    post_click,
-    post_click_window_at_point,
-    post_key,
-    post_key_combo,
-    post_clear_text,
-    post_type_text,
-    get_window_at_point,
-)
-from .screenshot import (
-    capture_region,
-    capture_window_printwindow,
-    crop_bgra,
-    save_bgra_png,
-    get_window_rect,
-    get_client_area_in_window_bitmap,
-    is_window_valid,
-    is_window_minimized,
-    hwnd_screen_rect_unobstructed,
-    hwnd_capture_subrect_unobstructed,
-    hwnd_screen_root_unobstructed,
-)
-from .win32_window import (
-    find_window,
-    find_all_windows,
-    find_largest_window,
-    find_window_by_title_candidates,
-    get_window_text,
-    get_process_name,
-    enum_windows,
-    screen_to_client,
-    get_foreground_window,
-    is_window_visible,
-    bring_to_foreground,
-    window_client_area_pixels,
-)
-from .window_lock import (
-    PlatformWindowLock,
-    hold_platform_window_lock,
-)
-from .incremental import (
-    IncrementalDetector,
-    content_hash,
-    make_platform_msg_id,
-    MessageLike,
-)
-from .rpa_console_log import (
-    rpa_log,
-    rpa_phase,
-    rpa_heartbeat,
-)
-from .name_stabilizer import NameStabilizer
+from __future__ import annotations
+
+import importlib
+from typing import Any
+
+_EXPORTS: dict[str, tuple[str, ...]] = {
+    "input_sim": (
+        "simulate_click",
+        "simulate_double_click",
+        "simulate_key",
+        "simulate_key_combo",
+        "simulate_type_unicode",
+        "set_clipboard_text",
+        "get_clipboard_text",
+        "ClipboardGuard",
+        "client_to_screen",
+        "post_click",
+        "post_click_window_at_point",
+        "post_key",
+        "post_key_combo",
+        "post_clear_text",
+        "post_type_text",
+        "get_window_at_point",
+    ),
+    "screenshot": (
+        "capture_region",
+        "capture_window_printwindow",
+        "crop_bgra",
+        "save_bgra_png",
+        "get_window_rect",
+        "get_client_area_in_window_bitmap",
+        "is_window_valid",
+        "is_window_minimized",
+        "hwnd_screen_rect_unobstructed",
+        "hwnd_capture_subrect_unobstructed",
+        "hwnd_screen_root_unobstructed",
+    ),
+    "win32_window": (
+        "find_window",
+        "find_all_windows",
+        "find_largest_window",
+        "find_window_by_title_candidates",
+        "get_window_text",
+        "get_process_name",
+        "enum_windows",
+        "screen_to_client",
+        "get_foreground_window",
+        "is_window_visible",
+        "bring_to_foreground",
+        "window_client_area_pixels",
+    ),
+    "window_lock": (
+        "PlatformWindowLock",
+        "hold_platform_window_lock",
+    ),
+    "rpa_console_log": (
+        "rpa_log",
+        "rpa_phase",
+        "rpa_heartbeat",
+    ),
+    "name_stabilizer": ("NameStabilizer",),
+}
+
+_MODULE_BY_NAME = {name: module for module, names in _EXPORTS.items() for name in names}
+
+__all__ = list(_MODULE_BY_NAME)
+
+
+def __getattr__(name: str) -> Any:
+    module = _MODULE_BY_NAME.get(name)
+    if module is None:
+        raise AttributeError(f"module {__name__!r} has no attribute {name!r}")
+    value = getattr(importlib.import_module(f".{module}", __name__), name)
+    globals()[name] = value
+    return value
+
 
-__all__ = [
-    # input_sim
-    "simulate_click",
-    "simulate_double_click",
-    "simulate_key",
-    "simulate_key_combo",
-    "simulate_type_unicode",
-    "set_clipboard_text",
-    "get_clipboard_text",
-    "ClipboardGuard",
-    "client_to_screen",
-    "post_click",
-    "post_click_window_at_point",
-    "post_key",
-    "post_key_combo",
-    "post_clear_text",
-    "post_type_text",
-    "get_window_at_point",
-    # screenshot
-    "capture_region",
-    "capture_window_printwindow",
-    "crop_bgra",
-    "save_bgra_png",
-    "get_window_rect",
-    "get_client_area_in_window_bitmap",
-    "is_window_valid",
-    "is_window_minimized",
-    "hwnd_screen_rect_unobstructed",
-    "hwnd_capture_subrect_unobstructed",
-    "hwnd_screen_root_unobstructed",
-    # win32_window
-    "find_window",
-    "find_all_windows",
-    "find_largest_window",
-    "find_window_by_title_candidates",
-    "get_window_text",
-    "get_process_name",
-    "enum_windows",
-    "screen_to_client",
-    "get_foreground_window",
-    "is_window_visible",
-    "bring_to_foreground",
-    "window_client_area_pixels",
-    # window_lock
-    "PlatformWindowLock",
-    "hold_platform_window_lock",
-    # incremental
-    "IncrementalDetector",
-    "content_hash",
-    "make_platform_msg_id",
-    "MessageLike",
-    # rpa_console_log
-    "rpa_log",
-    "rpa_phase",
-    "rpa_heartbeat",
-    # name_stabilizer
-    "NameStabilizer",
-]
+def __dir__() -> list[str]:
+    return sorted(set(globals()) | set(__all__))
@@ -0,0 +1,180 @@
+"""
+截图帧的裁剪与脏区检测，纯 numpy 实现，不依赖 Win32，可直接用合成的 BGRA 缓冲测试。
+
+``FrameDiffer`` 按调用方给的 key（通常是窗口句柄加截取矩形）记住上一帧的分块哈希：
+帧先按 ``downsample`` 隔点取样，再切成 ``tile_size`` 像素见方的块，每块算一个 64 位哈希。
+与上一帧逐块比较，变化的块合并成矩形（原图像素坐标）报告出来。整帧没有变化时，
+调用方可以跳过 PNG 编码、OCR 和后续解析。
+
+隔点取样意味着只改动了未被采样像素的极小变化（如 1 像素宽的光标）可能漏检；
+``downsample=1`` 时逐像素比较。Alpha 通道不参与比较（PrintWindow 输出的 alpha 不稳定）。
+"""
+from __future__ import annotations
+
+import threading
+from collections import OrderedDict
+from dataclasses import dataclass, field
+from typing import Hashable, Optional
+
+import numpy as np
+
+DEFAULT_TILE_SIZE = 32
+DEFAULT_DOWNSAMPLE = 4
+DEFAULT_MAX_ENTRIES = 64
+
+# 分块哈希的乘数：固定种子生成的奇数，uint64 乘加溢出自然取模
+_HASH_WEIGHTS = np.random.default_rng(0x5EED_F4A3).integers(1, 2**63, size=4096, dtype=np.uint64) | np.uint64(1)
+
+
+def bgra_array(bgra: bytes | bytearray | memoryview, width: int, height: int) -> np.ndarray:
+    """BGRA 缓冲的 (height, width, 4) 只读视图，不复制。"""
+    if width <= 0 or height <= 0:
+        raise ValueError("invalid frame size")
+    buffer = np.frombuffer(bgra, dtype=np.uint8)
+    if buffer.size < width * height * 4:
+        raise ValueError("bgra buffer smaller than width * height * 4")
+    return buffer[: width * height * 4].reshape(height, width, 4)
+
+
+def crop_bgra(bgra: bytes, src_w: int, src_h: int, x: int, y: int, w: int, h: int) -> bytes:
+    if x < 0 or y < 0 or w <= 0 or h <= 0:
+        raise ValueError("invalid crop rect")
+    if x + w > src_w or y + h > src_h:
+        raise ValueError("crop rect out of bounds")
+    if x == 0 and y == 0 and w == src_w and h == src_h:
+        return bytes(bgra)
+    return bgra_array(bgra, src_w, src_h)[y : y + h, x : x + w].tobytes()
+
+
+@dataclass(frozen=True)
+class Region:
+    x: int
+    y: int
+    width: int
+    height: int
+
+
+@dataclass
+class FrameDiff:
+    changed: bool
+    regions: list[Region] = field(default_factory=list)
+    tiles_changed: int = 0
+    tiles_total: int = 0
+    # 该 key 第一次出现或尺寸变化：没有可比较的上一帧，整帧视为变化
+    first_frame: bool = False
+
+
+def tile_hashes(
+    bgra: bytes | bytearray | memoryview,
+    width: int,
+    height: int,
+    tile_size: int = DEFAULT_TILE_SIZE,
+    downsample: int = DEFAULT_DOWNSAMPLE,
+) -> np.ndarray:
+    """
+    返回 (rows, cols) 的 uint64 分块哈希。块在原图中为 tile_size 见方，
+    右、下边缘不足一块的部分补零后单独成块。
+    """
+    if tile_size <= 0 or downsample <= 0 or tile_size % downsample:
+        raise ValueError("tile_size must be a positive multiple of downsample")
+    frame = bgra_array(bgra, width, height)[::downsample, ::downsample, :3]
+    cell = tile_size // downsample
+    rows = -(-height // tile_size)
+    cols = -(-width // tile_size)
+    padded_h = rows * cell
+    padded_w = cols * cell
+    if frame.shape[0] != padded_h or frame.shape[1] != padded_w:
+        padded = np.zeros((padded_h, padded_w, 3), dtype=np.uint8)
+        padded[: frame.shape[0], : frame.shape[1]] = frame
+        frame = padded
+    tiles = frame.reshape(rows, cell, cols, cell * 3).swapaxes(1, 2).reshape(rows, cols, cell * cell * 3)
+    values = tiles.astype(np.uint64)
+    weights = np.resize(_HASH_WEIGHTS, values.shape[-1])
+    return (values * weights).sum(axis=-1, dtype=np.uint64)
+
+
+def merge_tiles(
+    mask: np.ndarray, tile_size: int, width: int, height: int
+) -> list[Region]:
+    """变化块合并为矩形：同一行相邻块连成一段，上下两行横向范围相同的段再纵向合并。"""
+    regions: list[list[int]] = []  # [col_start, col_end, row_start, row_end]
+    open_runs: dict[tuple[int, int], list[int]] = {}
+    for row in range(mask.shape[0]):
+        columns = np.flatnonzero(mask[row])
+        runs: list[tuple[int, int]] = []
+        if columns.size:
+            breaks = np.flatnonzero(np.diff(columns) > 1)
+            starts = np.concatenate(([columns[0]], columns[breaks + 1]))
+            ends = np.concatenate((columns[breaks], [columns[-1]])) + 1
+            runs = list(zip(starts.tolist(), ends.tolist()))
+        next_open: dict[tuple[int, int], list[int]] = {}
+        for run in runs:
+            region = open_runs.get(run)
+            if region is None:
+                region = [run[0], run[1], row, row + 1]
+                regions.append(region)
+            else:
+                region[3] = row + 1
+            next_open[run] = region
+        open_runs = next_open
+
+    result: list[Region] = []
+    for col_start, col_end, row_start, row_end in regions:
+        x = col_start * tile_size
+        y = row_start * tile_size
+        result.append(Region(x, y, min(width, col_end * tile_size) - x, min(height, row_end * tile_size) - y))
+    return result
+
+
+class FrameDiffer:
+    """按 key 记住上一帧的分块哈希，最多保留 max_entries 个 key（最久未用的先丢）。线程安全。"""
+
+    def __init__(
+        self,
+        tile_size: int = DEFAULT_TILE_SIZE,
+        downsample: int = DEFAULT_DOWNSAMPLE,
+        max_entries: int = DEFAULT_MAX_ENTRIES,
+    ) -> None:
+        if tile_size <= 0 or downsample <= 0 or tile_size % downsample:
+            raise ValueError("tile_size must be a positive multiple of downsample")
+        self.tile_size = tile_size
+        self.downsample = downsample
+        self.max_entries = max(1, max_entries)
+        self._frames: OrderedDict[Hashable, tuple[int, int, np.ndarray]] = OrderedDict()
+        self._lock = threading.Lock()
+
+    def diff(self, key: Hashable, bgra: bytes | bytearray | memoryview, width: int, height: int) -> FrameDiff:
+        hashes = tile_hashes(bgra, width, height, self.tile_size, self.downsample)
+        with self._lock:
+            previous = self._frames.pop(key, None)
+            self._frames[key] = (width, height, hashes)
+            while len(self._frames) > self.max_entries:
+                self._frames.popitem(last=False)
+
+        total = int(hashes.size)
+        if previous is None or previous[0] != width or previous[1] != height:
+            return FrameDiff(
+                changed=True,
+                regions=[Region(0, 0, width, height)],
+                tiles_changed=total,
+                tiles_total=total,
+                first_frame=True,
+            )
+        mask = hashes != previous[2]
+        changed = int(np.count_nonzero(mask))
+        if not changed:
+            return FrameDiff(changed=False, tiles_total=total)
+        return FrameDiff(
+            changed=True,
+            regions=merge_tiles(mask, self.tile_size, width, height),
+            tiles_changed=changed,
+            tiles_total=total,
+        )
+
+    def forget(self, key: Optional[Hashable] = None) -> None:
+        """丢掉某个 key 的上一帧（key 为 None 时全部丢掉），下次 diff 视为首帧。"""
+        with self._lock:
+            if key is None:
+                self._frames.clear()
+            else:
+                self._frames.pop(key, None)
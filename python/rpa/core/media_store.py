@@ -0,0 +1,281 @@
+"""
+内容寻址的媒体仓库：同一份字节只落盘一次。
+
+blob 存放在 ``<root>/.blobs/<sha256 前两位>/<sha256><后缀>``。会话目录下的文件
+（``<root>/<content_type>/<msg_id>/<name>``）是指向 blob 的硬链接，消息里的
+``content_image_path`` / ``evidence_ref`` 仍然记录这些路径，UI 与旧数据无需改动。
+文件系统不支持硬链接时（FAT、跨卷）直接返回 blob 路径，由消息引用 blob 本身。
+
+引用计数：blob 的链接数减一就是会话目录中引用它的文件数。消息被删除后，
+``release_media_paths`` 删掉不再被任何消息引用的会话文件；链接数归一、
+且没有消息直接引用的 blob 随之回收。
+
+同一进程内，指向同一仓库目录的所有 ``MediaStore`` 实例共用一把锁（按解析后的根目录），
+证据写入、剪贴板落盘与消息删除后的回收互相串行，回收不会删掉正在被链接的 blob。
+
+``MediaStore.migrate`` 把已有目录中的重复文件（``<hash>.jpg`` / ``<hash>_2.jpg``、
+多个会话目录下的同一视频）改写为指向同一 blob 的硬链接，原地完成，不复制数据。
+"""
+from __future__ import annotations
+
+import argparse
+import hashlib
+import json
+import logging
+import os
+import shutil
+import threading
+from dataclasses import asdict, dataclass, field
+from pathlib import Path
+from typing import Callable, Iterable, Optional
+
+logger = logging.getLogger(__name__)
+
+BLOB_DIR_NAME = ".blobs"
+DEFAULT_MEDIA_ROOT = Path(__file__).resolve().parents[1] / "_media" / "wechat"
+_HASH_CHUNK = 1024 * 1024
+
+_ROOT_LOCKS: dict[str, threading.RLock] = {}
+_ROOT_LOCKS_GUARD = threading.Lock()
+
+
+def _root_lock(root: Path) -> threading.RLock:
+    key = os.path.normcase(str(root.resolve()))
+    with _ROOT_LOCKS_GUARD:
+        lock = _ROOT_LOCKS.get(key)
+        if lock is None:
+            lock = _ROOT_LOCKS[key] = threading.RLock()
+        return lock
+
+
+def file_sha256(path: str | Path) -> str:
+    digest = hashlib.sha256()
+    with open(path, "rb") as handle:
+        for chunk in iter(lambda: handle.read(_HASH_CHUNK), b""):
+            digest.update(chunk)
+    return digest.hexdigest()
+
+
+def find_store_root(path: str | Path) -> Optional[Path]:
+    """向上查找带 ``.blobs`` 的目录；不在任何仓库内的文件（如用户自己选的发送文件）返回 None。"""
+    for parent in Path(path).parents:
+        if (parent / BLOB_DIR_NAME).is_dir():
+            return parent
+    return None
+
+
+def _same_file(a: Path, b: Path) -> bool:
+    try:
+        return os.path.samefile(a, b)
+    except OSError:
+        return False
+
+
+@dataclass
+class MediaMigrationReport:
+    root: str = ""
+    files: int = 0
+    deduplicated: int = 0
+    bytes_reclaimed: int = 0
+    errors: list[str] = field(default_factory=list)
+
+
+class MediaStore:
+    def __init__(self, root_dir: str | Path) -> None:
+        self.root_dir = Path(root_dir)
+        self.blob_dir = self.root_dir / BLOB_DIR_NAME
+        self._lock = _root_lock(self.root_dir)
+
+    def blob_path(self, digest: str, suffix: str = "") -> Path:
+        return self.blob_dir / digest[:2] / f"{digest}{suffix.lower()}"
+
+    def store_file(self, source: str | Path, folder: str | Path, file_name: str) -> Path:
+        """把 source 收进仓库并在 folder 下放一个同内容的文件，返回消息应引用的路径。"""
+        source = Path(source)
+        digest = file_sha256(source)
+        suffix = Path(file_name).suffix or source.suffix
+        with self._lock:
+            ensure = lambda: self._ensure_blob(digest, suffix, lambda tmp: shutil.copyfile(source, tmp))
+            return self._place(ensure, digest, Path(folder), file_name)
+
+    def store_bytes(self, data: bytes, folder: str | Path, file_name: str) -> Path:
+        digest = hashlib.sha256(data).hexdigest()
+        with self._lock:
+            ensure = lambda: self._ensure_blob(digest, Path(file_name).suffix, lambda tmp: tmp.write_bytes(data))
+            return self._place(ensure, digest, Path(folder), file_name)
+
+    def adopt(self, path: str | Path) -> int:
+        """
+        让已有文件指向它的 blob：第一次见到的内容直接把该文件链接为 blob（零拷贝），
+        之后相同内容的文件替换为硬链接。返回因此释放的字节数。
+        """
+        path = Path(path)
+        stat = path.stat()
+        digest = file_sha256(path)
+        with self._lock:
+            blob = self.blob_path(digest, path.suffix)
+            if not blob.exists():
+                blob.parent.mkdir(parents=True, exist_ok=True)
+                os.link(path, blob)
+                return 0
+            if _same_file(blob, path):
+                return 0
+            tmp = path.with_name(f"{path.name}.{os.getpid()}.link")
+            os.link(blob, tmp)
+            os.replace(tmp, path)
+            # 原文件还有别的硬链接时数据并未释放
+            return stat.st_size if stat.st_nlink == 1 else 0
+
+    def migrate(self) -> MediaMigrationReport:
+        report = MediaMigrationReport(root=str(self.root_dir))
+        if not self.root_dir.is_dir():
+            return report
+        files = sorted(
+            path
+            for path in self.root_dir.rglob("*")
+            if path.is_file() and BLOB_DIR_NAME not in path.relative_to(self.root_dir).parts
+        )
+        for path in files:
+            report.files += 1
+            try:
+                reclaimed = self.adopt(path)
+            except OSError as exc:
+                report.errors.append(f"{path}: {type(exc).__name__}")
+                continue
+            if reclaimed > 0:
+                report.deduplicated += 1
+                report.bytes_reclaimed += reclaimed
+        logger.info(
+            "media store migrated root=%s files=%s deduplicated=%s bytes_reclaimed=%s errors=%s",
+            report.root,
+            report.files,
+            report.deduplicated,
+            report.bytes_reclaimed,
+            len(report.errors),
+        )
+        return report
+
+    def release(self, path: str | Path, is_referenced: Callable[[str], bool]) -> bool:
+        """删除一个已无消息引用的仓库文件；对应 blob 也没人引用时一并回收。"""
+        path = Path(path)
+        if not path.is_file():
+            return False
+        if self.blob_dir.resolve() in path.resolve().parents:
+            return self._collect_blob(path, is_referenced)
+
+        # 哈希放在锁外算（视频可能很大），锁内再按 inode 确认 blob
+        digest = file_sha256(path) if path.stat().st_nlink > 1 else ""
+        with self._lock:
+            if not path.is_file():
+                return False
+            blob = self._find_blob(path, digest) if digest else None
+            path.unlink()
+            self._prune_empty_dirs(path.parent)
+            if blob is not None and blob.is_file():
+                self._collect_blob(blob, is_referenced)
+        return True
+
+    def _find_blob(self, path: Path, digest: str) -> Optional[Path]:
+        """path 链接到的 blob。blob 后缀取自入库时的文件名或源文件，未必与 path 相同，按 inode 比对。"""
+        folder = self.blob_dir / digest[:2]
+        if not folder.is_dir():
+            return None
+        for candidate in folder.glob(f"{digest}*"):
+            if _same_file(candidate, path):
+                return candidate
+        return None
+
+    def _collect_blob(self, blob: Path, is_referenced: Callable[[str], bool]) -> bool:
+        with self._lock:
+            if blob.stat().st_nlink > 1 or is_referenced(str(blob.resolve())):
+                return False
+            blob.unlink()
+            self._prune_empty_dirs(blob.parent)
+            return True
+
+    def _ensure_blob(self, digest: str, suffix: str, write: Callable[[Path], object]) -> Path:
+        blob = self.blob_path(digest, suffix)
+        if blob.is_file():
+            return blob
+        blob.parent.mkdir(parents=True, exist_ok=True)
+        tmp = blob.with_name(f"{blob.name}.{os.getpid()}.tmp")
+        try:
+            write(tmp)
+            os.replace(tmp, blob)
+        finally:
+            if tmp.exists():
+                tmp.unlink()
+        return blob
+
+    def _place(self, ensure_blob: Callable[[], Path], digest: str, folder: Path, file_name: str) -> Path:
+        blob = ensure_blob()
+        folder.mkdir(parents=True, exist_ok=True)
+        target = folder / file_name
+        stem = target.stem or "file"
+        suffix = target.suffix
+        index = 2
+        while target.exists():
+            # 同一消息重复抓取同一文件时复用已有文件，不再生成 _2、_3 副本
+            if _same_file(target, blob) or (
+                target.stat().st_size == blob.stat().st_size and file_sha256(target) == digest
+            ):
+                return target.resolve()
+            target = folder / f"{stem}_{index}{suffix}"
+            index += 1
+        for _ in range(2):
+            try:
+                os.link(blob, target)
+                return target.resolve()
+            except OSError as exc:
+                if blob.is_file():
+                    logger.debug(
+                        "media store hardlink unavailable, referencing blob directly target=%s error=%s", target, exc
+                    )
+                    return blob.resolve()
+                # blob 在链接前被回收（别的进程删了消息），重建后再链一次
+                logger.info("media store blob vanished before link, rewriting blob=%s", blob)
+                blob = ensure_blob()
+        raise FileNotFoundError(f"media blob disappeared while placing {target}")
+
+    def _prune_empty_dirs(self, folder: Path) -> None:
+        root = self.root_dir.resolve()
+        folder = folder.resolve()
+        while folder != root and root in folder.parents:
+            try:
+                folder.rmdir()
+            except OSError:
+                return
+            folder = folder.parent
+
+
+def release_media_paths(paths: Iterable[str], is_referenced: Callable[[str], bool]) -> int:
+    """
+    消息删除后调用：paths 是被删消息引用过的文件，is_referenced 查询剩余消息是否仍引用某路径。
+    只处理位于媒体仓库内的文件，返回删除的会话文件数。
+    """
+    released = 0
+    for raw in dict.fromkeys(str(path) for path in paths if path):
+        root = find_store_root(raw)
+        if root is None or is_referenced(raw):
+            continue
+        try:
+            if MediaStore(root).release(raw, is_referenced):
+                released += 1
+        except OSError as exc:
+            logger.warning("media store release failed path=%s error=%s", raw, exc)
+    return released
+
+
+def main() -> int:
+    parser = argparse.ArgumentParser(
+        description="Deduplicate an RPA media directory into a content-addressed blob store."
+    )
+    parser.add_argument("root", type=Path, nargs="?", default=DEFAULT_MEDIA_ROOT)
+    args = parser.parse_args()
+    report = MediaStore(args.root).migrate()
+    print(json.dumps(asdict(report), ensure_ascii=False, indent=2))
+    return 0 if not report.errors else 1
+
+
+if __name__ == "__main__":
+    raise SystemExit(main())
@@ -0,0 +1,178 @@
+"""
+平台无关的自适应轮询调度，供各平台适配器的观察线程使用。
+
+观察线程每轮把看到的可见状态摘要交给调度器，由调度器决定下一轮等多久：
+- 状态有变化（未读会话或未读数变了、拉到了消息）时，间隔回落到 ``min_interval``；
+- 连续没有变化时间隔按 ``backoff`` 倍增长，封顶 ``max_interval``；
+- 还有没处理完的未读会话时保持 ``min_interval``，预算用完则等到时间窗里腾出名额；
+- 出错时等 ``error_interval``，退避进度不变。
+
+打开会话（切换、读消息）是轮询里最重、也最打扰用户的动作，按时间窗限额：
+每 ``budget_window`` 秒最多打开 ``window_budget`` 个会话，选中即计入预算。
+挑选时带未读角标的会话优先，未读数多的优先，同等条件下最久没被打开的优先。
+
+时钟可注入，测试里用假时钟驱动，不必真的 sleep。线程安全。
+"""
+from __future__ import annotations
+
+import threading
+import time
+from collections import deque
+from dataclasses import dataclass
+from typing import Any, Callable, Hashable, Iterable, Optional, TypeVar
+
+T = TypeVar("T")
+
+# 记录「上次打开时间」的会话数上限，超出时丢掉最久的一半
+_MAX_TRACKED_KEYS = 1024
+
+
+@dataclass(frozen=True)
+class PollPolicy:
+    min_interval: float = 0.2
+    max_interval: float = 3.2
+    backoff: float = 2.0
+    error_interval: float = 2.0
+    window_budget: int = 6
+    budget_window: float = 10.0
+
+
+class AdaptivePollScheduler:
+    def __init__(self, policy: Optional[PollPolicy] = None, *, clock: Callable[[], float] = time.monotonic) -> None:
+        self.policy = policy or PollPolicy()
+        if self.policy.min_interval <= 0 or self.policy.max_interval < self.policy.min_interval:
+            raise ValueError("invalid poll interval range")
+        if self.policy.backoff < 1.0:
+            raise ValueError("backoff must be >= 1")
+        self._clock = clock
+        self._lock = threading.Lock()
+        self._interval = self.policy.min_interval
+        self._delay = self.policy.min_interval
+        self._signature: Any = None
+        self._has_signature = False
+        self._last_change_at: Optional[float] = None
+        self._last_poll_at: Optional[float] = None
+        self._polls = 0
+        self._idle_polls = 0
+        self._errors = 0
+        self._pending = 0
+        self._opened: deque[float] = deque()
+        self._last_opened: dict[Hashable, float] = {}
+
+    def record(self, signature: Hashable, *, worked: bool = False, pending: int = 0) -> float:
+        """
+        一轮轮询结束。signature 是本轮可见状态的摘要（如未读会话及未读数），与上一轮不同即视为变化；
+        worked 表示本轮打开了会话或拉到了消息；pending 是还没处理的未读会话数。返回下一轮前应等待的秒数。
+        """
+        now = self._clock()
+        policy = self.policy
+        with self._lock:
+            changed = worked or not self._has_signature or signature != self._signature
+            self._signature = signature
+            self._has_signature = True
+            self._polls += 1
+            self._last_poll_at = now
+            self._pending = max(0, int(pending))
+            if changed:
+                self._last_change_at = now
+                self._idle_polls = 0
+                self._interval = policy.min_interval
+            else:
+                self._idle_polls += 1
+                self._interval = min(policy.max_interval, self._interval * policy.backoff)
+
+            self._delay = self._interval
+            if self._pending:
+                budget_wait = self._budget_wait(now)
+                self._delay = policy.min_interval if budget_wait <= 0 else max(policy.min_interval, budget_wait)
+            return self._delay
+
+    def record_error(self) -> float:
+        with self._lock:
+            self._errors += 1
+            self._last_poll_at = self._clock()
+            self._delay = max(self.policy.error_interval, self._interval)
+            return self._delay
+
+    def select(
+        self,
+        items: Iterable[T],
+        *,
+        key: Callable[[T], Hashable],
+        unread: Callable[[T], int],
+        limit: Optional[int] = None,
+    ) -> list[T]:
+        """按优先级挑出本轮要打开的会话，数量不超过 limit 与本时间窗剩余预算，选中的计入预算。"""
+        now = self._clock()
+        with self._lock:
+            self._expire(now)
+            take = self.policy.window_budget - len(self._opened)
+            if limit is not None:
+                take = min(take, limit)
+            if take <= 0:
+                return []
+            ranked = []
+            for index, item in enumerate(items):
+                count = max(0, int(unread(item) or 0))
+                item_key = key(item)
+                ranked.append((0 if count else 1, -count, self._last_opened.get(item_key, float("-inf")), index, item_key, item))
+            ranked.sort(key=lambda entry: entry[:4])
+            chosen = ranked[:take]
+            for *_, item_key, _item in chosen:
+                self._opened.append(now)
+                self._last_opened[item_key] = now
+            if len(self._last_opened) > _MAX_TRACKED_KEYS:
+                recent = sorted(self._last_opened.items(), key=lambda pair: pair[1])[-_MAX_TRACKED_KEYS // 2 :]
+                self._last_opened = dict(recent)
+            return [entry[-1] for entry in chosen]
+
+    def budget_remaining(self) -> int:
+        with self._lock:
+            self._expire(self._clock())
+            return max(0, self.policy.window_budget - len(self._opened))
+
+    def reset(self) -> None:
+        """重新连接时调用：回到最快节奏，忘掉上一轮状态与预算。"""
+        with self._lock:
+            self._interval = self.policy.min_interval
+            self._delay = self.policy.min_interval
+            self._signature = None
+            self._has_signature = False
+            self._idle_polls = 0
+            self._pending = 0
+            self._opened.clear()
+            self._last_opened.clear()
+
+    def snapshot(self) -> dict[str, Any]:
+        """供 /api/platform/health 展示的轮询状态。"""
+        now = self._clock()
+        policy = self.policy
+        with self._lock:
+            self._expire(now)
+            return {
+                "interval_sec": round(self._delay, 3),
+                "min_interval_sec": policy.min_interval,
+                "max_interval_sec": policy.max_interval,
+                "idle_polls": self._idle_polls,
+                "polls": self._polls,
+                "errors": self._errors,
+                "pending_unread": self._pending,
+                "seconds_since_change": None if self._last_change_at is None else round(now - self._last_change_at, 3),
+                "seconds_since_poll": None if self._last_poll_at is None else round(now - self._last_poll_at, 3),
+                "budget": {
+                    "window_sec": policy.budget_window,
+                    "limit": policy.window_budget,
+                    "used": len(self._opened),
+                },
+            }
+
+    def _expire(self, now: float) -> None:
+        horizon = now - self.policy.budget_window
+        while self._opened and self._opened[0] <= horizon:
+            self._opened.popleft()
+
+    def _budget_wait(self, now: float) -> float:
+        self._expire(now)
+        if len(self._opened) < self.policy.window_budget:
+            return 0.0
+        return self._opened[0] + self.policy.budget_window - now
@@ -6,9 +6,12 @@ from __future__ import annotations
 
 import ctypes
 from ctypes import wintypes
+from dataclasses import dataclass, field
 from pathlib import Path
 from typing import Optional
 
+from .frame_diff import FrameDiffer, Region, crop_bgra
+
 user32 = ctypes.WinDLL("user32", use_last_error=True)
 gdi32 = ctypes.WinDLL("gdi32", use_last_error=True)
 
@@ -228,20 +231,6 @@ def capture_window_printwindow(hwnd: int) -> tuple[bytes, int, int]:
         user32.ReleaseDC(0, hdc_screen)
 
 
-def crop_bgra(bgra: bytes, src_w: int, src_h: int, x: int, y: int, w: int, h: int) -> bytes:
-    if x < 0 or y < 0 or w <= 0 or h <= 0:
-        raise ValueError("invalid crop rect")
-    if x + w > src_w or y + h > src_h:
-        raise ValueError("crop rect out of bounds")
-    row_bytes = src_w * 4
-    out = bytearray(w * h * 4)
-    for row in range(h):
-        src_off = (y + row) * row_bytes + x * 4
-        dst_off = row * w * 4
-        out[dst_off : dst_off + w * 4] = bgra[src_off : src_off + w * 4]
-    return bytes(out)
-
-
 def capture_region_bitblt(hwnd: int, x: int, y: int, w: int, h: int) -> bytes:
     """Screen capture fallback; window must be visible."""
     win_x, win_y, _, _ = get_window_rect(hwnd)
@@ -294,6 +283,37 @@ def capture_region(
         return bgra, w, h, "bitblt"
 
 
+# capture_changed_region 默认使用的进程级比较器，按 (hwnd, 截取矩形) 记住上一帧
+_default_differ = FrameDiffer()
+
+
+@dataclass
+class CapturedFrame:
+    bgra: bytes
+    width: int
+    height: int
+    method: str
+    # 相对本次截取区域左上角的变化矩形；首帧为整块区域
+    regions: list[Region] = field(default_factory=list)
+    first_frame: bool = False
+
+
+def capture_changed_region(
+    hwnd: int, x: int, y: int, w: int, h: int, differ: Optional[FrameDiffer] = None
+) -> Optional[CapturedFrame]:
+    """
+    与 capture_region 相同的截取，再与该窗口同一区域的上一帧比较。
+    画面没有变化时返回 None，调用方应跳过 PNG 编码、OCR 和解析；
+    有变化时返回像素与变化矩形，调用方可以只处理这些区域。
+    """
+    bgra, width, height, method = capture_region(hwnd, x, y, w, h)
+    differ = differ or _default_differ
+    diff = differ.diff((int(hwnd), x, y, w, h), bgra, width, height)
+    if not diff.changed:
+        return None
+    return CapturedFrame(bgra, width, height, method, diff.regions, diff.first_frame)
+
+
 def save_bgra_png(bgra: bytes, width: int, height: int, path: Path) -> None:
     """将 BGRA 像素保存为 PNG（依赖 Pillow）。"""
     from PIL import Image
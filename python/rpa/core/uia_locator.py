@@ -0,0 +1,224 @@
+"""
+UIA 控件定位缓存，与具体平台无关。
+
+按窗口（根控件的 NativeWindowHandle，没有句柄时用 RuntimeId）和定位名记住上次找到的控件：
+RuntimeId、从根控件出发的子节点下标路径，以及 ClassName/AutomationId/ControlType 指纹。
+
+不保存控件引用：UIA 元素是 COM 指针，只在创建它的线程、且该线程的 CoInitialize 未撤销时有效，
+而各平台每次 uia_guard 都会 CoInitialize/CoUninitialize，读取、发送又各在自己的线程上。
+每次都从调用方本次传入的根控件重新解析：
+1. 沿下标路径逐层取子节点（每层一次 GetChildren），指纹一致、矩形非空即可复用；
+   RuntimeId 也一致记为命中，不一致（同位置换了新元素）记为重定位；
+2. 路径走不通或校验不过，才调用方提供的全量搜索，找到后重新记下。
+
+调用方可再传 validate 回调（会话名仍匹配、打分仍为正等），缓存的控件也要通过它才算命中。
+命中、路径重定位、未命中次数由 stats() 给出。
+"""
+from __future__ import annotations
+
+import threading
+from collections import OrderedDict
+from dataclasses import dataclass
+from typing import Any, Callable, Hashable, Optional
+
+DEFAULT_MAX_ENTRIES = 128
+# 回溯下标路径时最多向上走的层数；超过则不缓存，每次全量搜索
+MAX_PATH_DEPTH = 32
+
+_FINGERPRINT_PROPS = ("ClassName", "AutomationId", "ControlTypeName")
+
+
+@dataclass
+class _Entry:
+    fingerprint: tuple[str, ...]
+    runtime_id: Optional[tuple[int, ...]]
+    path: tuple[int, ...]
+
+
+def _prop(control: Any, name: str) -> str:
+    try:
+        value = getattr(control, name, "")
+        return "" if value is None else str(value)
+    except Exception:
+        return ""
+
+
+def _runtime_id(control: Any) -> Optional[tuple[int, ...]]:
+    getter = getattr(control, "GetRuntimeId", None)
+    if getter is None:
+        return None
+    try:
+        value = getter()
+    except Exception:
+        return None
+    return tuple(int(part) for part in value) if value else None
+
+
+def _fingerprint(control: Any) -> tuple[str, ...]:
+    return tuple(_prop(control, name) for name in _FINGERPRINT_PROPS)
+
+
+def _has_area(control: Any) -> bool:
+    try:
+        rect = control.BoundingRectangle
+        return int(rect.right) > int(rect.left) and int(rect.bottom) > int(rect.top)
+    except Exception:
+        return False
+
+
+def _children(control: Any) -> list[Any]:
+    try:
+        return list(control.GetChildren())
+    except Exception:
+        return []
+
+
+def _same_control(left: Any, right: Any) -> bool:
+    if left is right:
+        return True
+    left_id = _runtime_id(left)
+    right_id = _runtime_id(right)
+    if left_id is not None and right_id is not None:
+        return left_id == right_id
+    return False
+
+
+def window_key(root: Any) -> Hashable:
+    hwnd = 0
+    try:
+        hwnd = int(getattr(root, "NativeWindowHandle", 0) or 0)
+    except Exception:
+        hwnd = 0
+    if hwnd:
+        return ("hwnd", hwnd)
+    runtime_id = _runtime_id(root)
+    if runtime_id is not None:
+        return ("rid", runtime_id)
+    return ("obj", id(root))
+
+
+def index_path(root: Any, control: Any, *, max_depth: int = MAX_PATH_DEPTH) -> Optional[tuple[int, ...]]:
+    """control 相对 root 的子节点下标路径；不在 root 之下或无法回溯时返回 None。"""
+    path: list[int] = []
+    current = control
+    for _ in range(max_depth + 1):
+        if _same_control(current, root):
+            path.reverse()
+            return tuple(path)
+        try:
+            parent = current.GetParentControl()
+        except Exception:
+            return None
+        if parent is None:
+            return None
+        index = next((i for i, child in enumerate(_children(parent)) if _same_control(child, current)), -1)
+        if index < 0:
+            return None
+        path.append(index)
+        current = parent
+    return None
+
+
+def follow_path(root: Any, path: tuple[int, ...]) -> Optional[Any]:
+    current = root
+    for index in path:
+        children = _children(current)
+        if index >= len(children):
+            return None
+        current = children[index]
+    return current
+
+
+class UiaLocatorCache:
+    """线程安全；只存 RuntimeId 与下标路径，可跨线程、跨 uia_guard 共享。搜索与校验在锁外进行。"""
+
+    def __init__(self, max_entries: int = DEFAULT_MAX_ENTRIES) -> None:
+        self.max_entries = max(1, max_entries)
+        self._entries: OrderedDict[tuple[Hashable, str], _Entry] = OrderedDict()
+        self._lock = threading.Lock()
+        self._hits = 0
+        self._relocated = 0
+        self._misses = 0
+        self._stale = 0
+
+    def resolve(
+        self,
+        root: Any,
+        name: str,
+        search: Callable[[Any], Optional[Any]],
+        *,
+        validate: Optional[Callable[[Any], bool]] = None,
+    ) -> Optional[Any]:
+        if root is None:
+            return None
+        key = (window_key(root), name)
+        with self._lock:
+            entry = self._entries.get(key)
+            if entry is not None:
+                self._entries.move_to_end(key)
+
+        if entry is not None:
+            control = follow_path(root, entry.path)
+            if control is not None and self._still_valid(control, entry, validate):
+                runtime_id = _runtime_id(control)
+                same_element = entry.runtime_id is None or runtime_id == entry.runtime_id
+                entry.runtime_id = runtime_id
+                with self._lock:
+                    if same_element:
+                        self._hits += 1
+                    else:
+                        self._relocated += 1
+                return control
+
+        control = search(root)
+        path = index_path(root, control) if control is not None else None
+        with self._lock:
+            self._misses += 1
+            if entry is not None:
+                self._stale += 1
+            if path is None:
+                # 没找到，或回溯不出路径（不保存引用就无从复用）
+                self._entries.pop(key, None)
+                return control
+        stored = _Entry(
+            fingerprint=_fingerprint(control),
+            runtime_id=_runtime_id(control),
+            path=path,
+        )
+        with self._lock:
+            self._entries[key] = stored
+            self._entries.move_to_end(key)
+            while len(self._entries) > self.max_entries:
+                self._entries.popitem(last=False)
+        return control
+
+    def invalidate(self, root: Any = None, name: Optional[str] = None) -> None:
+        """丢掉缓存：root 为 None 时不限窗口，name 为 None 时不限定位名。"""
+        scope = window_key(root) if root is not None else None
+        with self._lock:
+            for key in list(self._entries):
+                if (scope is None or key[0] == scope) and (name is None or key[1] == name):
+                    del self._entries[key]
+
+    def stats(self) -> dict[str, Any]:
+        with self._lock:
+            lookups = self._hits + self._relocated + self._misses
+            return {
+                "hits": self._hits,
+                "relocated": self._relocated,
+                "misses": self._misses,
+                "stale": self._stale,
+                "entries": len(self._entries),
+                "hit_rate": round((self._hits + self._relocated) / lookups, 3) if lookups else 0.0,
+            }
+
+    @staticmethod
+    def _still_valid(control: Any, entry: _Entry, validate: Optional[Callable[[Any], bool]]) -> bool:
+        if _fingerprint(control) != entry.fingerprint or not _has_area(control):
+            return False
+        if validate is not None:
+            try:
+                return bool(validate(control))
+            except Exception:
+                return False
+        return True
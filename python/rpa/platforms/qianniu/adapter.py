@@ -7,7 +7,9 @@ from dataclasses import dataclass
 from datetime import datetime, timezone
 from typing import Any, Protocol
 
-from .detector import QianniuDetector
+from rpa.core.poll_scheduler import AdaptivePollScheduler, PollPolicy
+
+from .detector import QianniuDetector, locator_stats
 from .qianniu_logging import get_logger
 from .reader import MessageRecord, MessageReadResult, QianniuReader
 from .sender import QianniuSender
@@ -20,7 +22,10 @@ PLATFORM_QIANNIU = "qianniu"
 DEFAULT_ACCOUNT_ID = "local_qianniu"
 OBSERVER_POLL_INTERVAL_SEC = 1.5
 OBSERVER_AFTER_WORK_SLEEP_SEC = 0.3
+OBSERVER_MAX_POLL_INTERVAL_SEC = 4.8
 OBSERVER_ERROR_SLEEP_SEC = 3.0
+OBSERVER_WINDOW_BUDGET = 6
+OBSERVER_BUDGET_WINDOW_SEC = 10.0
 OBSERVER_MESSAGE_LIMIT = 30
 
 
@@ -104,6 +109,16 @@ class QianniuSidecarAdapter:
         self._observer_thread: threading.Thread | None = None
         self._observer_lock = threading.Lock()
         self._handled_unread_session_keys: set[str] = set()
+        self._last_unread_session_keys: frozenset[str] = frozenset()
+        self._poll_scheduler = AdaptivePollScheduler(
+            PollPolicy(
+                min_interval=OBSERVER_AFTER_WORK_SLEEP_SEC,
+                max_interval=OBSERVER_MAX_POLL_INTERVAL_SEC,
+                error_interval=OBSERVER_ERROR_SLEEP_SEC,
+                window_budget=OBSERVER_WINDOW_BUDGET,
+                budget_window=OBSERVER_BUDGET_WINDOW_SEC,
+            )
+        )
 
     def command(self, payload: dict[str, Any]) -> dict[str, Any]:
         started_at = time.perf_counter()
@@ -176,11 +191,14 @@ class QianniuSidecarAdapter:
             "account_id": self._account_id,
             "connected": self._connected,
             "health": result,
+            "polling": self._poll_scheduler.snapshot(),
+            "locators": locator_stats(),
         }
 
     def _connect(self, params: dict[str, Any], request_id: str) -> dict[str, Any]:
         self._connected = True
         self._handled_unread_session_keys.clear()
+        self._poll_scheduler.reset()
         health = self._probe()
         self._store.append(
             self._health_event(
@@ -221,7 +239,13 @@ class QianniuSidecarAdapter:
                 daemon=True,
             )
             self._observer_thread.start()
-        logger.info("qianniu observer started poll_interval=%.1fs", OBSERVER_POLL_INTERVAL_SEC)
+        logger.info(
+            "qianniu observer started poll_interval=%.1f-%.1fs window_budget=%s/%.0fs",
+            OBSERVER_AFTER_WORK_SLEEP_SEC,
+            OBSERVER_MAX_POLL_INTERVAL_SEC,
+            OBSERVER_WINDOW_BUDGET,
+            OBSERVER_BUDGET_WINDOW_SEC,
+        )
 
     def _stop_observer(self) -> None:
         with self._observer_lock:
@@ -247,13 +271,19 @@ class QianniuSidecarAdapter:
                     uia_guard_wait_ms = _elapsed_ms(uia_guard_started_at)
                     scan_started_at = time.perf_counter()
                     result = self._scan_unread_and_fetch(
-                        {"message_limit": OBSERVER_MESSAGE_LIMIT},
+                        {"message_limit": OBSERVER_MESSAGE_LIMIT, "budgeted": True},
                         request_id,
                     )
                     scan_ms = _elapsed_ms(scan_started_at)
                 had_work = bool(result.get("message_count") or result.get("conversation_count") or result.get("processed_count"))
+                unread_keys = self._last_unread_session_keys
+                delay = self._poll_scheduler.record(
+                    unread_keys,
+                    worked=had_work,
+                    pending=len(unread_keys - self._handled_unread_session_keys),
+                )
                 logger.info(
-                    "qianniu observer timing request_id=%s total_ms=%.1f uia_guard_wait_ms=%.1f scan_ms=%.1f had_work=%s unread=%s conversations=%s messages=%s processed=%s",
+                    "qianniu observer timing request_id=%s total_ms=%.1f uia_guard_wait_ms=%.1f scan_ms=%.1f had_work=%s unread=%s conversations=%s messages=%s processed=%s next_poll_sec=%.2f",
                     request_id,
                     _elapsed_ms(tick_started_at),
                     uia_guard_wait_ms,
@@ -263,8 +293,9 @@ class QianniuSidecarAdapter:
                     result.get("conversation_count"),
                     result.get("message_count"),
                     result.get("processed_count"),
+                    delay,
                 )
-                self._observer_stop.wait(OBSERVER_AFTER_WORK_SLEEP_SEC if had_work else OBSERVER_POLL_INTERVAL_SEC)
+                self._observer_stop.wait(delay)
             except Exception as exc:
                 logger.exception("qianniu observer tick failed: %s", exc)
                 self._store.append(
@@ -275,7 +306,7 @@ class QianniuSidecarAdapter:
                         metadata={"stage": "qianniu_observer", "detail": str(exc)},
                     )
                 )
-                self._observer_stop.wait(OBSERVER_ERROR_SLEEP_SEC)
+                self._observer_stop.wait(self._poll_scheduler.record_error())
 
     def _health_check(self, _params: dict[str, Any], _request_id: str) -> dict[str, Any]:
         health = self._probe()
@@ -369,6 +400,7 @@ class QianniuSidecarAdapter:
         unread_items = [item for item in sessions if item.unread]
         unread_keys = {_session_unread_key(item) for item in unread_items}
         self._handled_unread_session_keys.intersection_update(unread_keys)
+        self._last_unread_session_keys = frozenset(unread_keys)
         logger.info(
             "qianniu scan_unread_timing request_id=%s stage=read_visible_sessions ms=%.1f session_count=%s unread_count=%s limit=%s",
             _request_id,
@@ -392,10 +424,30 @@ class QianniuSidecarAdapter:
                 "processed": [],
             }
 
-        target = next(
-            (item for item in unread_items if _session_unread_key(item) not in self._handled_unread_session_keys),
-            None,
-        )
+        candidates = [item for item in unread_items if _session_unread_key(item) not in self._handled_unread_session_keys]
+        if params.get("budgeted") and candidates:
+            # 观察线程：一轮只开一个会话，并受时间窗预算约束
+            chosen = self._poll_scheduler.select(candidates, key=_session_unread_key, unread=lambda item: int(item.unread), limit=1)
+            if not chosen:
+                logger.info(
+                    "qianniu scan_unread_timing request_id=%s stage=total ms=%.1f session_count=%s unread_count=%s deferred=%s reason=window_budget",
+                    _request_id,
+                    _elapsed_ms(total_started_at),
+                    len(sessions),
+                    len(unread_items),
+                    len(candidates),
+                )
+                return {
+                    "unread_count": len(unread_items),
+                    "conversation_count": 0,
+                    "message_count": 0,
+                    "processed_count": 0,
+                    "deferred_count": len(candidates),
+                    "processed": [],
+                }
+            target = chosen[0]
+        else:
+            target = candidates[0] if candidates else None
         if target is None:
             logger.info(
                 "qianniu scan_unread_timing request_id=%s stage=total ms=%.1f session_count=%s unread_count=%s skipped_handled=%s processed=0 messages=0",
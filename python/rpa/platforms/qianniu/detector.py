@@ -5,6 +5,8 @@ import threading
 import time
 from typing import Any, Callable
 
+from rpa.core.uia_locator import UiaLocatorCache
+
 from .config import AppConfig, load_config
 from .uia import (
     control_from_hwnd,
@@ -54,6 +56,13 @@ class CachedWindow:
 _WINDOW_CACHE_LOCK = threading.Lock()
 _WINDOW_CACHE: dict[str, CachedWindow] = {}
 _WINDOW_CACHE_TTL_SEC = 120.0
+# 会话读取、消息读取、发送各自持有 QianniuDetector，控件定位缓存与窗口缓存一样进程内共享；
+# 两者都只存句柄/RuntimeId/下标路径，不存 COM 引用，跨线程、跨 uia_guard 使用是安全的
+_LOCATORS = UiaLocatorCache()
+
+
+def locator_stats() -> dict[str, Any]:
+    return _LOCATORS.stats()
 
 
 class QianniuDetector:
@@ -156,10 +165,9 @@ class QianniuDetector:
         if self._is_definitive_chat_root(window_control, root_score):
             chat_root = window_control
         else:
-            roots = self.find_chat_root_candidates(window_control)
-            if not roots:
+            chat_root = _LOCATORS.resolve(window_control, "chat_root", self._search_chat_root)
+            if chat_root is None:
                 return None
-            chat_root = roots[0].control
         candidate = WindowCandidate(
             hwnd=window.hwnd,
             pid=window.pid,
@@ -196,6 +204,10 @@ class QianniuDetector:
             if cached and (hwnd is None or cached.hwnd == hwnd):
                 _WINDOW_CACHE.pop(self.q.process_name, None)
 
+    def _search_chat_root(self, window_control: Any) -> Any | None:
+        roots = self.find_chat_root_candidates(window_control)
+        return roots[0].control if roots else None
+
     def get_window_control(self, hwnd: int) -> Any | None:
         return control_from_hwnd(hwnd)
 
@@ -291,6 +303,18 @@ class QianniuDetector:
     ) -> Any | None:
         if not root or not suffix:
             return None
+        return _LOCATORS.resolve(
+            root,
+            f"aid:{suffix}",
+            lambda current: self._search_by_automation_id_suffix(current, suffix, prune_automation_id_keywords),
+        )
+
+    def _search_by_automation_id_suffix(
+        self,
+        root: Any,
+        suffix: str,
+        prune_automation_id_keywords: list[str] | None,
+    ) -> Any | None:
         if not prune_automation_id_keywords:
             for _, control in walk_controls(root, max_depth=self.q.max_tree_depth, max_nodes=self.q.max_tree_nodes):
                 aid = safe_prop(control, "AutomationId")
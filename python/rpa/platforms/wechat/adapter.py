@@ -7,6 +7,8 @@ from dataclasses import asdict, is_dataclass
 from datetime import datetime, timezone
 from typing import Any, Protocol
 
+from rpa.core.poll_scheduler import AdaptivePollScheduler, PollPolicy
+
 from .detector import WechatDetector
 from .media_extractor import WechatMediaExtractor
 from .reader import WechatVisibleMessageReader
@@ -19,7 +21,10 @@ PLATFORM_WECHAT = "wechat"
 DEFAULT_ACCOUNT_ID = "local_wechat"
 OBSERVER_POLL_INTERVAL_SEC = 0.8
 OBSERVER_AFTER_WORK_SLEEP_SEC = 0.2
+OBSERVER_MAX_POLL_INTERVAL_SEC = 3.2
 OBSERVER_ERROR_SLEEP_SEC = 2.0
+OBSERVER_WINDOW_BUDGET = 6
+OBSERVER_BUDGET_WINDOW_SEC = 10.0
 OBSERVER_SESSION_LIMIT = 3
 OBSERVER_MESSAGE_LIMIT = 20
 OBSERVER_SETTLE_MS = 150
@@ -154,6 +159,15 @@ class WechatSidecarAdapter:
         )
         self._debug_writer = DebugArtifactWriter.from_config(config)
         self._media_extractor = WechatMediaExtractor.from_config(config)
+        self._poll_scheduler = AdaptivePollScheduler(
+            PollPolicy(
+                min_interval=OBSERVER_AFTER_WORK_SLEEP_SEC,
+                max_interval=OBSERVER_MAX_POLL_INTERVAL_SEC,
+                error_interval=OBSERVER_ERROR_SLEEP_SEC,
+                window_budget=OBSERVER_WINDOW_BUDGET,
+                budget_window=OBSERVER_BUDGET_WINDOW_SEC,
+            )
+        )
 
     def command(self, payload: dict[str, Any]) -> dict[str, Any]:
         request_id = clean(payload.get("request_id"))
@@ -225,10 +239,13 @@ class WechatSidecarAdapter:
             "account_id": self._account_id,
             "connected": self._connected,
             "health": result,
+            "polling": self._poll_scheduler.snapshot(),
+            "locators": self._detector.locator_stats(),
         }
 
     def _connect(self, params: dict[str, Any], request_id: str) -> dict[str, Any]:
         self._connected = True
+        self._poll_scheduler.reset()
         health = self._probe()
         logger.info(
             "connect request_id=%s healthy=%s reason=%s emit_initial_snapshot=%s",
@@ -277,8 +294,11 @@ class WechatSidecarAdapter:
             )
             self._observer_thread.start()
         logger.info(
-            "wechat observer started poll_interval=%.1fs session_limit=%s message_limit=%s settle_ms=%s",
-            OBSERVER_POLL_INTERVAL_SEC,
+            "wechat observer started poll_interval=%.1f-%.1fs window_budget=%s/%.0fs session_limit=%s message_limit=%s settle_ms=%s",
+            OBSERVER_AFTER_WORK_SLEEP_SEC,
+            OBSERVER_MAX_POLL_INTERVAL_SEC,
+            OBSERVER_WINDOW_BUDGET,
+            OBSERVER_BUDGET_WINDOW_SEC,
             OBSERVER_SESSION_LIMIT,
             OBSERVER_MESSAGE_LIMIT,
             OBSERVER_SETTLE_MS,
@@ -302,12 +322,11 @@ class WechatSidecarAdapter:
                 continue
 
             try:
-                had_work = False
                 with uia_guard("wechat_observer"):
                     self._ensure_not_cooling("wechat_observer")
-                    had_work = self._observer_tick()
+                    delay = self._observer_tick()
                 self._failures.record(True)
-                self._observer_stop.wait(OBSERVER_AFTER_WORK_SLEEP_SEC if had_work else OBSERVER_POLL_INTERVAL_SEC)
+                self._observer_stop.wait(delay)
             except Exception as exc:
                 self._failures.record(False, "wechat_observer")
                 logger.exception("wechat observer tick failed: %s", exc)
@@ -319,14 +338,15 @@ class WechatSidecarAdapter:
                         metadata=self._failure_metadata("wechat_observer", str(exc)),
                     )
                 )
-                self._observer_stop.wait(OBSERVER_ERROR_SLEEP_SEC)
+                self._observer_stop.wait(self._poll_scheduler.record_error())
 
-    def _observer_tick(self) -> bool:
+    def _observer_tick(self) -> float:
+        """轮询一轮，返回下一轮前应等待的秒数。"""
         started_at = time.perf_counter()
         win = self._detector.find_main_window_control()
         if win is None:
             logger.info("wechat_observer_timing stage=find_main_window_control ms=%.1f found=False", (time.perf_counter() - started_at) * 1000.0)
-            return False
+            return self._poll_scheduler.record("window_not_found")
 
         stage_started_at = time.perf_counter()
         session_list = self._detector.get_session_list(win)
@@ -335,6 +355,7 @@ class WechatSidecarAdapter:
         scan = self._detector.scan_unread_sessions_detailed(session_list)
         scan_ms = (time.perf_counter() - stage_started_at) * 1000.0
         unread_count = len(scan.sessions)
+        signature = tuple(sorted((clean(item.name), item.unread_count) for item in scan.sessions))
         logger.info(
             "wechat_observer_timing stage=light_scan total_ms=%.1f session_list_ms=%.1f scan_ms=%.1f source=%s scanned=%s unread=%s",
             (time.perf_counter() - started_at) * 1000.0,
@@ -345,7 +366,7 @@ class WechatSidecarAdapter:
             unread_count,
         )
         if unread_count <= 0:
-            return False
+            return self._poll_scheduler.record(signature)
 
         request_id = f"observer-{int(time.time() * 1000)}"
         result = self._scan_unread_and_fetch(
@@ -354,17 +375,23 @@ class WechatSidecarAdapter:
                 "message_limit": OBSERVER_MESSAGE_LIMIT,
                 "allow_foreground": False,
                 "settle_ms": OBSERVER_SETTLE_MS,
+                "budgeted": True,
             },
             request_id,
         )
+        had_work = bool(result.get("message_count") or result.get("conversation_count") or result.get("processed_count"))
+        pending = max(0, int(result.get("unread_count") or 0) - int(result.get("processed_count") or 0))
+        delay = self._poll_scheduler.record(signature, worked=had_work, pending=pending)
         logger.info(
-            "wechat_observer processed request_id=%s unread=%s processed=%s messages=%s",
+            "wechat_observer processed request_id=%s unread=%s processed=%s messages=%s pending=%s next_poll_sec=%.2f",
             request_id,
             result.get("unread_count"),
             result.get("processed_count"),
             result.get("message_count"),
+            pending,
+            delay,
         )
-        return bool(result.get("message_count") or result.get("conversation_count") or result.get("processed_count"))
+        return delay
 
     def _health_check(self, _params: dict[str, Any], _request_id: str) -> dict[str, Any]:
         health = self._probe()
@@ -661,7 +688,16 @@ class WechatSidecarAdapter:
             scanned=scan.scanned_items,
             unread=len(scan.sessions),
         )
-        selected_sessions = scan.sessions[:session_limit]
+        if params.get("budgeted"):
+            # 观察线程：按未读优先级挑选，并受时间窗预算约束
+            selected_sessions = self._poll_scheduler.select(
+                scan.sessions,
+                key=lambda item: self._detector.extract_session_title(item.name),
+                unread=lambda item: int(getattr(item, "unread_count", 1) or 1),
+                limit=session_limit,
+            )
+        else:
+            selected_sessions = scan.sessions[:session_limit]
         conversations: list[dict[str, Any]] = []
         messages: list[dict[str, Any]] = []
         processed: list[dict[str, Any]] = []
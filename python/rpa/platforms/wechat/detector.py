@@ -6,6 +6,8 @@ import time
 from dataclasses import asdict, dataclass
 from typing import Any
 
+from rpa.core.uia_locator import UiaLocatorCache
+
 from .config import WechatAutomationConfig, load_wechat_config
 from .uia_scoring import (
     find_input_candidates,
@@ -55,6 +57,10 @@ class ChatTitleCandidate:
 class WechatDetector:
     def __init__(self, config: WechatAutomationConfig | None = None) -> None:
         self.config = config or load_wechat_config()
+        self._locators = UiaLocatorCache()
+
+    def locator_stats(self) -> dict[str, Any]:
+        return self._locators.stats()
 
     def find_main_window_control(self) -> Any | None:
         from rpa.platforms.wechat.uia import find_wechat_main_window_uia
@@ -97,11 +103,14 @@ class WechatDetector:
         return data
 
     def get_session_list(self, window_control: Any | None = None) -> Any | None:
-        from rpa.platforms.wechat.uia import find_session_list_control
-
         win = self.get_window_control(window_control)
         if win is None:
             return None
+        return self._locators.resolve(win, "session_list", self._search_session_list)
+
+    def _search_session_list(self, win: Any) -> Any | None:
+        from rpa.platforms.wechat.uia import find_session_list_control
+
         direct = find_session_list_control(win)
         if direct is not None:
             logger.info("get_session_list direct match=True")
@@ -229,19 +238,21 @@ class WechatDetector:
         if not session_list:
             return ""
 
-        for _, control in walk_controls(session_list, max_depth=8, max_nodes=1500):
-            try:
-                pattern = control.GetSelectionItemPattern()
-                if not pattern or not pattern.IsSelected:
-                    continue
-            except Exception:
-                continue
-
-            name = safe_prop(control, "Name").strip()
-            if name:
-                return self.extract_session_title(name)
+        selected = self._locators.resolve(
+            session_list,
+            "selected_session",
+            self._search_selected_session,
+            validate=_is_selected_with_name,
+        )
+        if selected is None:
+            return ""
+        return self.extract_session_title(safe_prop(selected, "Name").strip())
 
-        return ""
+    def _search_selected_session(self, session_list: Any) -> Any | None:
+        for _, control in walk_controls(session_list, max_depth=8, max_nodes=1500):
+            if _is_selected_with_name(control):
+                return control
+        return None
 
     def get_current_chat_name(self, window_control: Any | None = None) -> str:
         win = self.get_window_control(window_control)
@@ -252,9 +263,9 @@ class WechatDetector:
         if selected_title and not self._is_generic_context_name(selected_title, safe_prop(win, "Name")):
             return selected_title
 
-        candidates = self.find_chat_title_candidates(win)
-        if candidates:
-            return candidates[0].name
+        title_control = self._find_chat_title_control(win)
+        if title_control is not None:
+            return normalize_text(safe_prop(title_control, "Name"))
 
         fallback = normalize_text(safe_prop(win, "Name"))
         if fallback and not self._is_generic_context_name(fallback, fallback):
@@ -264,6 +275,29 @@ class WechatDetector:
     def current_chat_name(self, window_control: Any | None = None) -> str:
         return self.get_current_chat_name(window_control)
 
+    def _find_chat_title_control(self, win: Any) -> Any | None:
+        """得分最高的会话标题控件；缓存的控件按当前布局重新打分仍为正才复用，不必再给整棵树打分。"""
+        message_list = self._find_message_list(win)
+        message_rect = safe_rect_tuple(message_list) if message_list else None
+        session_list = self.get_session_list(win)
+        session_rect = safe_rect_tuple(session_list) if session_list else None
+        window_name = normalize_text(safe_prop(win, "Name"))
+
+        def still_title(control: Any) -> bool:
+            score, _reason = self._score_chat_title_candidate(
+                control=control,
+                message_rect=message_rect,
+                session_rect=session_rect,
+                window_name=window_name,
+            )
+            return score > 0
+
+        def search(root: Any) -> Any | None:
+            candidates = self.find_chat_title_candidates(root)
+            return candidates[0].control if candidates else None
+
+        return self._locators.resolve(win, "chat_title", search, validate=still_title)
+
     def find_chat_title_candidates(self, window_control: Any | None = None) -> list[ChatTitleCandidate]:
         win = self.get_window_control(window_control)
         if not win:
@@ -311,26 +345,24 @@ class WechatDetector:
         target = normalize_text(contact_name)
         if not target:
             return None
+        if not exact:
+            # 模糊匹配不缓存：空名字、包含目标的长名字（张三 → 张三丰）都能通过校验，
+            # 复用上次的控件可能点错人，每次按当前列表重新排序取最优
+            return self._search_session_control(session_list, target, exact)
+        # 会话列表会复用单元格：缓存的控件名字仍精确匹配才算数
+        return self._locators.resolve(
+            session_list,
+            f"session:{int(exact)}:{target}",
+            lambda root: self._search_session_control(root, target, exact),
+            validate=lambda control: _session_match_rank(control, target, exact) is not None,
+        )
 
+    def _search_session_control(self, session_list: Any, target: str, exact: bool) -> Any | None:
         scored: list[tuple[tuple[int, int, int, int], Any]] = []
         for _depth, control in walk_controls(session_list, max_depth=8, max_nodes=1600):
-            name = normalize_text(safe_prop(control, "Name"))
-            automation_id = normalize_text(safe_prop(control, "AutomationId"))
-            class_name = safe_prop(control, "ClassName")
-            display_name = _extract_session_display_name(name, automation_id)
-            expected_aid = "session_item_" + target
-            if exact:
-                matched = display_name == target or automation_id == expected_aid
-            else:
-                matched = target in display_name or display_name in target or expected_aid in automation_id or target in automation_id
-            if not matched:
-                continue
-            rect = safe_rect_tuple(control)
-            top = rect[1] if rect is not None else 0
-            exact_name = 0 if display_name == target else 1
-            exact_aid = 0 if automation_id == expected_aid else 1
-            class_rank = 0 if class_name == "mmui::ChatSessionCell" else 1
-            scored.append(((class_rank, exact_aid, exact_name, top), control))
+            rank = _session_match_rank(control, target, exact)
+            if rank is not None:
+                scored.append((rank, control))
 
         if not scored:
             return None
@@ -505,7 +537,7 @@ class WechatDetector:
         win = self.get_window_control(window_control)
         if not win:
             return None
-        return find_chat_message_list_control(win)
+        return self._locators.resolve(win, "message_list", find_chat_message_list_control)
 
     def _find_chat_input(self, window_control: Any | None = None) -> Any | None:
         from rpa.platforms.wechat.uia import find_chat_input
@@ -513,7 +545,7 @@ class WechatDetector:
         win = self.get_window_control(window_control)
         if not win:
             return None
-        return find_chat_input(win)
+        return self._locators.resolve(win, "chat_input", find_chat_input)
 
     def _find_send_button(self, window_control: Any | None = None) -> Any | None:
         from rpa.platforms.wechat.uia import find_send_button
@@ -521,7 +553,7 @@ class WechatDetector:
         win = self.get_window_control(window_control)
         if not win:
             return None
-        return find_send_button(win)
+        return self._locators.resolve(win, "send_button", find_send_button)
 
     def _candidate_report(self, candidates: list[Any]) -> list[dict[str, Any]]:
         report: list[dict[str, Any]] = []
@@ -734,6 +766,36 @@ def _extract_session_display_name(raw_name: str, automation_id: str) -> str:
     return extract_session_title(raw_name)
 
 
+def _session_match_rank(control: Any, target: str, exact: bool) -> tuple[int, int, int, int] | None:
+    name = normalize_text(safe_prop(control, "Name"))
+    automation_id = normalize_text(safe_prop(control, "AutomationId"))
+    class_name = safe_prop(control, "ClassName")
+    display_name = _extract_session_display_name(name, automation_id)
+    expected_aid = "session_item_" + target
+    if exact:
+        matched = display_name == target or automation_id == expected_aid
+    else:
+        matched = target in display_name or display_name in target or expected_aid in automation_id or target in automation_id
+    if not matched:
+        return None
+    rect = safe_rect_tuple(control)
+    top = rect[1] if rect is not None else 0
+    exact_name = 0 if display_name == target else 1
+    exact_aid = 0 if automation_id == expected_aid else 1
+    class_rank = 0 if class_name == "mmui::ChatSessionCell" else 1
+    return class_rank, exact_aid, exact_name, top
+
+
+def _is_selected_with_name(control: Any) -> bool:
+    try:
+        pattern = control.GetSelectionItemPattern()
+        if not pattern or not pattern.IsSelected:
+            return False
+    except Exception:
+        return False
+    return bool(safe_prop(control, "Name").strip())
+
+
 def _safe_rect_left(control: Any) -> int:
     try:
         return int(control.BoundingRectangle.left)
@@ -1,12 +1,13 @@
 from __future__ import annotations
 
 import ctypes
-import shutil
+import io
 import time
 from dataclasses import dataclass, field
 from pathlib import Path
 from typing import Iterable
 
+from ...core.media_store import MediaStore
 from .wechat_logging import get_logger
 
 
@@ -174,20 +175,19 @@ def copy_clipboard_files_to_artifacts(
     if not safe_message_id:
         return ClipboardFileResult(status="failed", error="platform_msg_id_unavailable")
 
+    store = MediaStore(root_dir)
     artifact_dir = Path(root_dir) / content_type / safe_message_id
     copied: list[str] = []
     source_values: list[str] = []
     try:
-        artifact_dir.mkdir(parents=True, exist_ok=True)
         for index, source in enumerate(sources, start=1):
             source = Path(source)
             source_values.append(str(source))
             if not source.is_file():
                 logger.debug("wechat clipboard file source unavailable: %s", source)
                 continue
-            target = _unique_target_path(artifact_dir, source.name or f"file_{index}")
-            shutil.copy2(source, target)
-            copied.append(str(target.resolve()))
+            target = store.store_file(source, artifact_dir, source.name or f"file_{index}")
+            copied.append(str(target))
     except Exception as exc:
         return ClipboardFileResult(
             status="failed",
@@ -228,29 +228,16 @@ def copy_clipboard_bitmap_to_artifact(
         if not isinstance(data, Image.Image):
             return ClipboardFileResult(status="failed", method="clipboard_bitmap", error=type(data).__name__)
 
-        artifact_dir = Path(root_dir) / content_type
-        artifact_dir.mkdir(parents=True, exist_ok=True)
-        target = _unique_target_path(artifact_dir, f"{safe_message_id}.png")
-        data.save(target, "PNG")
-        return ClipboardFileResult(status="copied", method="clipboard_bitmap", artifact_paths=[str(target.resolve())])
+        buffer = io.BytesIO()
+        data.save(buffer, "PNG")
+        target = MediaStore(root_dir).store_bytes(
+            buffer.getvalue(), Path(root_dir) / content_type, f"{safe_message_id}.png"
+        )
+        return ClipboardFileResult(status="copied", method="clipboard_bitmap", artifact_paths=[str(target)])
     except Exception as exc:
         return ClipboardFileResult(status="failed", method="clipboard_bitmap", error=type(exc).__name__)
 
 
-def _unique_target_path(folder: Path, file_name: str) -> Path:
-    target = folder / file_name
-    if not target.exists():
-        return target
-    stem = target.stem or "file"
-    suffix = target.suffix
-    index = 2
-    while True:
-        candidate = folder / f"{stem}_{index}{suffix}"
-        if not candidate.exists():
-            return candidate
-        index += 1
-
-
 def _read_clipboard_file_paths_win32() -> list[Path]:
     try:
         user32 = ctypes.WinDLL("user32", use_last_error=True)
@@ -1,10 +1,12 @@
 from __future__ import annotations
 
+import io
 import threading
 from dataclasses import dataclass
 from pathlib import Path
 from typing import Any
 
+from ...core.media_store import MediaStore
 from .screenshot import capture_bubble, trim_media_evidence
 from .wechat_logging import get_logger
 
@@ -24,6 +26,7 @@ class MediaEvidenceWriter:
     def __init__(self, enabled: bool = True, root_dir: str | Path = "python/rpa/_media/wechat") -> None:
         self.enabled = enabled
         self.root_dir = Path(root_dir)
+        self._store = MediaStore(self.root_dir)
         self._lock = threading.Lock()
 
     @classmethod
@@ -55,9 +58,9 @@ class MediaEvidenceWriter:
                 if image is None:
                     return MediaEvidenceResult(status="failed", error="bubble_capture_failed")
                 image = trim_media_evidence(image)
-                path.parent.mkdir(parents=True, exist_ok=True)
-                image.save(path, "PNG")
-                resolved_path = str(path.resolve())
+                buffer = io.BytesIO()
+                image.save(buffer, "PNG")
+                resolved_path = str(self._store.store_bytes(buffer.getvalue(), path.parent, path.name))
                 logger.info(
                     "wechat media evidence saved content_type=%s platform_msg_id=%s path=%s",
                     content_type,
@@ -11,6 +11,7 @@ import comtypes
 from PIL import Image, ImageDraw
 
 from .screenshot import capture_bubble
+from rpa.core.frame_diff import FrameDiffer
 from rpa.core.screenshot import capture_window_printwindow
 from .wechat_logging import get_logger
 
@@ -63,9 +64,18 @@ class SnapshotPaths:
 
 
 class DebugArtifactWriter:
+    """
+    失败现场截图。同一窗口连续失败时画面往往没变：与上次落盘的整窗截图比较分块哈希，
+    没有变化就不再编码 PNG，window 直接指向上次的 window.png。
+    """
+
     def __init__(self, enabled: bool = False, root_dir: str | Path = "python/rpa/_debug/wechat") -> None:
         self.enabled = enabled
         self.root_dir = Path(root_dir)
+        self._frames = FrameDiffer()
+        self._last_window_png: dict[int, Path] = {}
+        self.window_pngs_saved = 0
+        self.window_pngs_reused = 0
 
     @classmethod
     def from_config(cls, config: object) -> "DebugArtifactWriter":
@@ -95,14 +105,28 @@ class DebugArtifactWriter:
         bubble_path = None
         compare_path = None
 
-        window_image = self._capture_window_png(hwnd)
-        if window_image is not None:
-            window_path = folder / "window.png"
-            self._save_image(window_image, window_path, f"window: {window_title}")
-
-        if bubble_control is not None and window_image is not None:
+        window_image = None
+        frame = self._capture_window_frame(hwnd)
+        if frame is not None:
+            bgra, width, height = frame
+            unchanged = not self._frames.diff(hwnd, bgra, width, height).changed
+            previous = self._last_window_png.get(hwnd)
+            if unchanged and previous is not None and previous.exists():
+                window_path = previous
+                self.window_pngs_reused += 1
+                logger.info("wechat debug snapshot unchanged, reusing %s (%s)", previous, label)
+            else:
+                window_image = _bgra_to_image(bgra, width, height)
+                window_path = folder / "window.png"
+                self._save_image(window_image, window_path, f"window: {window_title}")
+                self._last_window_png[hwnd] = window_path
+                self.window_pngs_saved += 1
+
+        if bubble_control is not None and frame is not None:
             bubble_image = self._capture_bubble_png(bubble_control, hwnd)
             if bubble_image is not None:
+                if window_image is None:
+                    window_image = _bgra_to_image(*frame)
                 bubble_path = folder / "bubble.png"
                 self._save_image(bubble_image, bubble_path, f"bubble: {chat_title}")
                 compare_path = folder / "compare.png"
@@ -114,10 +138,9 @@ class DebugArtifactWriter:
 
         return SnapshotPaths(window=window_path, bubble=bubble_path, compare=compare_path)
 
-    def _capture_window_png(self, hwnd: int) -> Image.Image | None:
+    def _capture_window_frame(self, hwnd: int) -> tuple[bytes, int, int] | None:
         try:
-            bgra, width, height = capture_window_printwindow(hwnd)
-            return Image.frombuffer("RGBA", (width, height), bgra, "raw", "BGRA", 0, 1).convert("RGB")
+            return capture_window_printwindow(hwnd)
         except Exception as exc:
             logger.debug("failed to capture window snapshot: %s", exc)
             return None
@@ -165,6 +188,10 @@ class DebugArtifactWriter:
         return canvas
 
 
+def _bgra_to_image(bgra: bytes, width: int, height: int) -> Image.Image:
+    return Image.frombuffer("RGBA", (width, height), bgra, "raw", "BGRA", 0, 1).convert("RGB")
+
+
 def _slugify(value: str) -> str:
     text = "_".join(str(value or "snapshot").split())
     text = "".join(ch if ch.isalnum() or ch in "_-." else "_" for ch in text)
@@ -185,3 +212,4 @@ def uia_guard(_label: str = "wechat") -> Iterator[None]:
             yield
     finally:
         comtypes.CoUninitialize()
+
@@ -1,6 +1,7 @@
 from __future__ import annotations
 
 import logging
+import sqlite3
 from pathlib import Path
 
 from rpa.db.connection import open_db
@@ -11,6 +12,36 @@ from .cache_snapshot import resolved_snapshot_db_path
 PROJECT_ROOT = Path(__file__).resolve().parents[2]
 APP_DATA_SCHEMA_PATH = PROJECT_ROOT / "database" / "app_data_schema.sql"
 
+# 后来加到 conversations 上的冗余列；旧库要先补列，schema 脚本里的索引和触发器才能建
+_CONVERSATION_LAST_MESSAGE_COLUMNS = (
+    ("last_message_id", "INTEGER DEFAULT 0"),
+    ("last_direction", "TEXT DEFAULT ''"),
+)
+
+_BACKFILL_LAST_MESSAGE_SQL = """
+UPDATE conversations SET
+  last_message_id = COALESCE((SELECT m.id FROM messages m
+                              WHERE m.conversation_id = conversations.id
+                                AND (m.deleted_at IS NULL OR m.deleted_at = '')
+                              ORDER BY m.id DESC LIMIT 1), 0),
+  last_direction = COALESCE((SELECT m.direction FROM messages m
+                             WHERE m.conversation_id = conversations.id
+                               AND (m.deleted_at IS NULL OR m.deleted_at = '')
+                             ORDER BY m.id DESC LIMIT 1), '')
+"""
+
+
+def _add_missing_conversation_columns(conn: sqlite3.Connection) -> bool:
+    columns = {row[1] for row in conn.execute("PRAGMA table_info(conversations)")}
+    if not columns:
+        return False
+    added = False
+    for name, ddl in _CONVERSATION_LAST_MESSAGE_COLUMNS:
+        if name not in columns:
+            conn.execute(f"ALTER TABLE conversations ADD COLUMN {name} {ddl}")
+            added = True
+    return added
+
 
 def ensure_app_database_schema(db_path: Path | None = None) -> Path:
     path = db_path or resolved_snapshot_db_path()
@@ -20,7 +51,11 @@ def ensure_app_database_schema(db_path: Path | None = None) -> Path:
 
     conn = open_db(path)
     try:
+        needs_backfill = _add_missing_conversation_columns(conn)
         conn.executescript(APP_DATA_SCHEMA_PATH.read_text(encoding="utf-8"))
+        # 触发器只维护之后的写入，补列时一次性回填已有会话
+        if needs_backfill:
+            conn.execute(_BACKFILL_LAST_MESSAGE_SQL)
         conn.commit()
     finally:
         conn.close()
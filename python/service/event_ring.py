@@ -0,0 +1,157 @@
+"""
+内存事件环：按字节限额保留最近的平台事件，按 seq 二分查找。
+
+事件按 seq 递增追加，同时记入全量索引与所属平台的索引；总字节数（事件 JSON 的 UTF-8 长度）
+超出 max_bytes 时从最旧的开始淘汰。``evicted_through`` 之前的事件已不在环里，读取方应转去
+持久事件日志补齐；没进持久日志的事件被淘汰时记下 seq，``lost_between`` 据此判断补齐后是否有缺口。
+
+不加锁，由持有者（RpaEventStore）在自己的锁内调用。
+"""
+from __future__ import annotations
+
+import bisect
+import json
+from collections import deque
+from typing import Any
+
+DEFAULT_MAX_BYTES = 8 * 1024 * 1024
+# 头部出队累计到这么多条、且超过一半时才整体裁掉列表前段
+_COMPACT_THRESHOLD = 1024
+# 每个索引最多记多少个已淘汰且未落库的 seq，更早的只保留上界
+_LOST_SEQ_LIMIT = 4096
+
+
+def event_size(event: dict[str, Any]) -> int:
+    return len(json.dumps(event, ensure_ascii=False, default=str).encode("utf-8"))
+
+
+class _SeqIndex:
+    """seq 递增的事件序列；出队只移动 head，查找在 [head, len) 上二分。"""
+
+    __slots__ = ("seqs", "events", "head")
+
+    def __init__(self) -> None:
+        self.seqs: list[int] = []
+        self.events: list[Any] = []
+        self.head = 0
+
+    def __len__(self) -> int:
+        return len(self.seqs) - self.head
+
+    def append(self, seq: int, event: dict[str, Any]) -> None:
+        self.seqs.append(seq)
+        self.events.append(event)
+
+    def first_seq(self) -> int | None:
+        return self.seqs[self.head] if self.head < len(self.seqs) else None
+
+    def popleft(self) -> tuple[int, dict[str, Any]]:
+        seq = self.seqs[self.head]
+        event = self.events[self.head]
+        self.events[self.head] = None
+        self.head += 1
+        if self.head >= _COMPACT_THRESHOLD and self.head * 2 >= len(self.seqs):
+            del self.seqs[: self.head]
+            del self.events[: self.head]
+            self.head = 0
+        return seq, event
+
+    def after(self, since: int, limit: int) -> list[dict[str, Any]]:
+        start = bisect.bisect_right(self.seqs, since, self.head)
+        return self.events[start : start + limit]
+
+
+class _LostSeqs:
+    """已淘汰且不在持久日志里的 seq；超出条数上限后只记 floor，floor 之前的区间一律按有缺口处理。"""
+
+    __slots__ = ("seqs", "floor")
+
+    def __init__(self) -> None:
+        self.seqs: list[int] = []
+        self.floor = 0
+
+    def add(self, seq: int) -> None:
+        self.seqs.append(seq)
+        excess = len(self.seqs) - _LOST_SEQ_LIMIT
+        if excess > 0:
+            self.floor = self.seqs[excess - 1]
+            del self.seqs[:excess]
+
+    def any_between(self, after: int, through: int) -> bool:
+        if through <= after:
+            return False
+        if after < self.floor:
+            return True
+        start = bisect.bisect_right(self.seqs, after)
+        return start < len(self.seqs) and self.seqs[start] <= through
+
+
+class EventRing:
+    def __init__(self, max_bytes: int = DEFAULT_MAX_BYTES, *, start_after: int = 0) -> None:
+        self.max_bytes = max(1, int(max_bytes))
+        self._all = _SeqIndex()
+        self._sizes: deque[int] = deque()
+        self._platforms: deque[str] = deque()
+        self._durable: deque[bool] = deque()
+        self._by_platform: dict[str, _SeqIndex] = {}
+        self._lost = _LostSeqs()
+        self._lost_by_platform: dict[str, _LostSeqs] = {}
+        self._bytes = 0
+        # seq <= evicted_through 的事件不在环里（已淘汰，或属于启动前的上一个进程）
+        self.evicted_through = start_after
+        self.latest_seq = start_after
+
+    def append(self, seq: int, platform: str, event: dict[str, Any], durable: bool = True) -> None:
+        """``durable`` 为 False 表示事件不在持久日志里，淘汰后无法补齐。"""
+        if seq <= self.latest_seq:
+            raise ValueError("event seq must increase")
+        size = event_size(event)
+        self._all.append(seq, event)
+        self._sizes.append(size)
+        self._platforms.append(platform)
+        self._durable.append(durable)
+        if platform:
+            self._by_platform.setdefault(platform, _SeqIndex()).append(seq, event)
+        self._bytes += size
+        self.latest_seq = seq
+        # 至少留下最新一条，单条超过限额也能被读到
+        while self._bytes > self.max_bytes and len(self._all) > 1:
+            self._evict()
+
+    def after(self, since: int, platform: str = "", limit: int = 50) -> list[dict[str, Any]]:
+        """seq > since 的事件（platform 为空时不限平台），最多 limit 条。"""
+        index = self._by_platform.get(platform) if platform else self._all
+        if index is None or limit <= 0:
+            return []
+        return index.after(since, limit)
+
+    def lost_between(self, after: int, through: int, platform: str = "") -> bool:
+        """(after, through] 内是否有已淘汰、持久日志也读不到的事件（platform 为空时不限平台）。"""
+        lost = self._lost_by_platform.get(platform) if platform else self._lost
+        return lost is not None and lost.any_between(after, through)
+
+    def stats(self) -> dict[str, Any]:
+        return {
+            "events": len(self._all),
+            "bytes": self._bytes,
+            "max_bytes": self.max_bytes,
+            "oldest_seq": self._all.first_seq(),
+            "latest_seq": self.latest_seq,
+            "evicted_through": self.evicted_through,
+            "platforms": {name: len(index) for name, index in self._by_platform.items()},
+        }
+
+    def _evict(self) -> None:
+        seq, _event = self._all.popleft()
+        self._bytes -= self._sizes.popleft()
+        platform = self._platforms.popleft()
+        if not self._durable.popleft():
+            self._lost.add(seq)
+            if platform:
+                self._lost_by_platform.setdefault(platform, _LostSeqs()).add(seq)
+        index = self._by_platform.get(platform) if platform else None
+        if index is not None and index.first_seq() == seq:
+            index.popleft()
+            if not len(index):
+                del self._by_platform[platform]
+        self.evicted_through = seq
@@ -15,11 +15,15 @@ from urllib.parse import urlparse
 
 from rpa.platforms.qianniu.adapter import PLATFORM_QIANNIU, QianniuSidecarAdapter
 from rpa.platforms.wechat.adapter import PLATFORM_WECHAT, WechatSidecarAdapter, clean, payload_status
+from . import tracing
 from .app_database import ensure_app_database_schema
-from .truth_store import PythonServiceTruthStore
+from .event_ring import DEFAULT_MAX_BYTES as DEFAULT_EVENT_RING_BYTES, EventRing
+from .truth_store import EVENT_LOG_TYPES, PythonServiceTruthStore
 
 
 MUTATION_OBSERVATION_QUIET_SECONDS = 3.0
+EVENT_PAGE_LIMIT = 200
+EVENT_ID_READ_ATTEMPTS = 3
 
 
 def normalize_platform(value: Any) -> str:
@@ -27,16 +31,54 @@ def normalize_platform(value: Any) -> str:
 
 
 class RpaEventStore:
-    def __init__(self, max_events: int = 500, truth_store: PythonServiceTruthStore | None = None) -> None:
+    """
+    平台事件的内存窗口加持久日志。
+
+    事件 seq 从持久事件日志已用过的最大 id 之后接着编，落库的事件以 seq 作行 id，
+    因此内存窗口与持久日志共用一套游标。内存里按字节限额保留最近的事件；
+    list_after 的游标落在窗口之前时先从持久日志补齐，再接上内存窗口，调用方看到的是一条连续的流。
+    持久日志只收会话/消息/发送结果事件，健康状态等事件一旦移出窗口就不再可读，
+    补齐的区间里有这类事件时响应带 ``truncated``。
+    """
+
+    def __init__(
+        self,
+        max_bytes: int = DEFAULT_EVENT_RING_BYTES,
+        truth_store: PythonServiceTruthStore | None = None,
+    ) -> None:
         self._lock = threading.Lock()
-        self._next_seq = 1
-        self._events: deque[tuple[int, dict[str, Any]]] = deque(maxlen=max_events)
         self._listeners: list["_EventPushClient"] = []
         self._listeners_lock = threading.Lock()
         self._truth_store = truth_store
         self._last_observed_at_by_platform: dict[str, float] = {}
+        start_after = 0
+        if truth_store is not None:
+            start_after = self._read_latest_event_id(truth_store)
+        self._next_seq = start_after + 1
+        self._ring = EventRing(max_bytes, start_after=start_after)
+
+    @staticmethod
+    def _read_latest_event_id(truth_store: PythonServiceTruthStore) -> int:
+        # 读不到就不能启动：序号从 1 重新编会和持久日志里的行 id 撞车
+        for attempt in range(1, EVENT_ID_READ_ATTEMPTS + 1):
+            try:
+                return truth_store.latest_event_id()
+            except Exception:
+                if attempt == EVENT_ID_READ_ATTEMPTS:
+                    raise
+                logging.warning(
+                    "failed to read latest rpa event id from Python service truth db attempt=%s", attempt,
+                    exc_info=True,
+                )
+                time.sleep(0.2 * attempt)
+        return 0
 
     def append(self, event: dict[str, Any]) -> int:
+        trace_id = clean(event.get("client_message_id") or event.get("event_id"))
+        with tracing.span("rpa_event_store.append", "store", trace_id, event_type=clean(event.get("event_type"))):
+            return self._append(event, trace_id)
+
+    def _append(self, event: dict[str, Any], trace_id: str) -> int:
         total_started_at = time.perf_counter()
         persist_ms = 0.0
         with self._lock:
@@ -51,9 +93,9 @@ class RpaEventStore:
                 self._last_observed_at_by_platform[platform_name] = time.monotonic()
             if self._truth_store is not None:
                 try:
-                    persist_started_at = time.perf_counter()
-                    accepted = self._truth_store.persist_event(stored)
-                    persist_ms = (time.perf_counter() - persist_started_at) * 1000.0
+                    with tracing.span("rpa_event_store.persist", "store", trace_id) as persist_span:
+                        accepted = self._truth_store.persist_event(stored)
+                    persist_ms = persist_span.elapsed_ms
                     if accepted is False:
                         logging.info(
                             "rpa_event_store filtered event_id=%s platform=%s event_type=%s seq=%s persist_ms=%.1f",
@@ -68,10 +110,13 @@ class RpaEventStore:
                 except Exception:
                     stored["truth_persisted"] = False
                     logging.exception("failed to persist rpa event to Python service truth db")
-            self._events.append((seq, stored))
-        broadcast_started_at = time.perf_counter()
-        self._broadcast(stored)
-        broadcast_ms = (time.perf_counter() - broadcast_started_at) * 1000.0
+            durable = (
+                stored.get("truth_persisted") is True and event_type in EVENT_LOG_TYPES and bool(platform_name)
+            )
+            self._ring.append(seq, platform_name, stored, durable=durable)
+        with tracing.span("rpa_event_store.broadcast", "store", trace_id) as broadcast_span:
+            self._broadcast(stored)
+        broadcast_ms = broadcast_span.elapsed_ms
         logging.info(
             "rpa_event_store timing event_id=%s platform=%s event_type=%s seq=%s total_ms=%.1f persist_ms=%.1f broadcast_ms=%.1f truth_persisted=%s",
             stored.get("event_id", ""),
@@ -100,27 +145,55 @@ class RpaEventStore:
             since = int(cursor or 0)
         except (TypeError, ValueError):
             since = 0
-        limit = max(1, min(int(limit or 50), 200))
+        limit = max(1, min(int(limit or 50), EVENT_PAGE_LIMIT))
         platform = normalize_platform(platform)
-        with self._lock:
-            selected: list[dict[str, Any]] = []
-            last_cursor = since
-            for seq, event in self._events:
-                if seq <= since:
-                    continue
-                if platform and normalize_platform(event.get("platform")) != platform:
-                    continue
-                selected.append(dict(event))
-                last_cursor = seq
-                if len(selected) >= limit:
+        selected: list[dict[str, Any]] = []
+        position = since
+        while True:
+            with self._lock:
+                floor = self._ring.evicted_through
+                latest = self._ring.latest_seq
+                if position >= floor or self._truth_store is None:
+                    if self._truth_store is None:
+                        truncated = position < floor
+                    else:
+                        truncated = self._ring.lost_between(since, floor, platform)
+                    wanted = limit - len(selected)
+                    recent = [dict(event) for event in self._ring.after(position, platform, wanted)]
                     break
-            latest = self._events[-1][0] if self._events else since
-        return {
+            # 游标落在内存窗口之前：先从持久日志补 (position, floor]，读库不占用事件锁
+            durable = self._truth_store.read_event_log(platform, position, floor, limit - len(selected))
+            selected.extend(durable)
+            if len(selected) >= limit:
+                cursor = int(selected[-1]["cursor"])
+                with self._lock:
+                    truncated = self._ring.lost_between(since, cursor, platform)
+                response = {
+                    "status": "success",
+                    "cursor": str(cursor),
+                    "latest_cursor": str(latest),
+                    "events": selected,
+                }
+                if truncated:
+                    response["truncated"] = True
+                return response
+            position = floor
+
+        selected.extend(recent)
+        if len(recent) < wanted:
+            # 窗口里已没有更多匹配的事件，游标直接推进到最新，下次不必重扫
+            cursor = max(latest, position)
+        else:
+            cursor = int(selected[-1]["seq"])
+        response: dict[str, Any] = {
             "status": "success",
-            "cursor": str(last_cursor if selected else since),
+            "cursor": str(cursor),
             "latest_cursor": str(latest),
             "events": selected,
         }
+        if truncated:
+            response["truncated"] = True
+        return response
 
     def seconds_since_observed_event(self, platform: str) -> float | None:
         normalized = normalize_platform(platform)
@@ -484,13 +557,6 @@ class RpaBridge:
             normalized_payload = dict(payload)
             normalized_payload["platform"] = platform
             if command == "send_message":
-                self._truth_store.persist_outbound_command(normalized_payload)
-                threading.Thread(
-                    target=self._run_async_send_message,
-                    args=(platform, adapter, normalized_payload),
-                    name=f"{platform}-send-message",
-                    daemon=True,
-                ).start()
                 params = normalized_payload.get("parameters")
                 if not isinstance(params, dict):
                     params = {}
@@ -501,6 +567,14 @@ class RpaBridge:
                     or params.get("task_id")
                     or normalized_payload.get("request_id")
                 )
+                with tracing.span("rpa_bridge.persist_outbound_command", "bridge", client_message_id):
+                    self._truth_store.persist_outbound_command(normalized_payload)
+                threading.Thread(
+                    target=self._run_async_send_message,
+                    args=(platform, adapter, normalized_payload),
+                    name=f"{platform}-send-message",
+                    daemon=True,
+                ).start()
                 return payload_status(
                     "success",
                     clean(normalized_payload.get("request_id")),
@@ -600,16 +674,27 @@ class RpaBridge:
         return None
 
     def _run_async_send_message(self, platform: str, adapter: Any, payload: dict[str, Any]) -> None:
-        with self._command_lock:
+        params = payload.get("parameters")
+        trace_id = clean(
+            payload.get("client_message_id")
+            or (params.get("client_message_id") if isinstance(params, dict) else "")
+            or payload.get("request_id")
+        )
+        with tracing.span("rpa_bridge.send_message.wait_lock", "bridge", trace_id):
+            self._command_lock.acquire()
+        try:
             request_id = clean(payload.get("request_id"))
             try:
-                response = adapter.command(payload)
+                with tracing.span("rpa_bridge.send_message.adapter", "bridge", trace_id, platform=platform):
+                    response = adapter.command(payload)
             except Exception as exc:
                 logging.exception("Async send_message raised request_id=%s platform=%s", request_id, platform)
                 self._emit_send_failed(payload, str(exc))
                 return
             if response.get("status") != "success":
                 self._emit_send_failed(payload, clean(response.get("error")) or "send_message_failed")
+        finally:
+            self._command_lock.release()
 
     def _emit_send_failed(self, payload: dict[str, Any], reason: str) -> None:
         params = payload.get("parameters")
@@ -15,6 +15,7 @@ import time
 from .ai_suggestion import build_ai_suggestion_response
 from .cache_snapshot import build_cache_snapshot, build_conversation_list, build_conversation_messages
 from . import rpa_bridge
+from . import tracing
 
 
 SERVICE_VERSION = "0.1.0"
@@ -148,6 +149,10 @@ class AiServiceHandler(BaseHTTPRequestHandler):
                 )
             )
             return
+        if path == "/api/debug/trace":
+            correlation_id = query.get("correlation_id", [""])[0]
+            self._send_json(tracing.export_chrome_trace(correlation_id))
+            return
         self._send_json({"status": "error", "error": "not_found"}, status_code=404)
 
     def do_POST(self) -> None:
@@ -0,0 +1,116 @@
+"""
+服务内热路径追踪：``span`` 上下文管理器把耗时写入有界环形缓冲，
+``/api/debug/trace`` 按 Chrome trace 事件格式导出，可与客户端导出的文件合并查看。
+
+写入只做一次 ``deque.append``（GIL 下原子，不加锁），缓冲写满后覆盖最旧的记录。
+时间戳为基于 Unix 纪元的微秒，与客户端 Tracing::nowUs() 同一基准。
+关联 ID 沿用 client_message_id / event_id。
+"""
+from __future__ import annotations
+
+import os
+import threading
+import time
+from collections import deque
+from typing import Any, Deque, Dict, List, Tuple
+
+MAX_EVENTS = 16384
+
+# (name, category, start_us, duration_us, thread_id, correlation_id, args)
+_Event = Tuple[str, str, int, int, int, str, Dict[str, Any]]
+
+_events: Deque[_Event] = deque(maxlen=MAX_EVENTS)
+_enabled = not os.environ.get("YY_TRACE_DISABLED")
+_epoch_base_ns = time.time_ns() - time.perf_counter_ns()
+
+
+def set_enabled(enabled: bool) -> None:
+    global _enabled
+    _enabled = bool(enabled)
+
+
+def is_enabled() -> bool:
+    return _enabled
+
+
+def now_us() -> int:
+    return (_epoch_base_ns + time.perf_counter_ns()) // 1000
+
+
+def clear() -> None:
+    _events.clear()
+
+
+class span:
+    """
+    用法::
+
+        with tracing.span("rpa_event_store.persist", "store", event_id) as s:
+            ...
+        logging.info("persist_ms=%.1f", s.elapsed_ms)
+    """
+
+    __slots__ = ("name", "category", "correlation_id", "args", "_start_ns", "_duration_ns")
+
+    def __init__(self, name: str, category: str = "service", correlation_id: str = "", **args: Any) -> None:
+        self.name = name
+        self.category = category
+        self.correlation_id = correlation_id
+        self.args = args
+        self._start_ns = 0
+        self._duration_ns: int | None = None
+
+    def __enter__(self) -> "span":
+        self._start_ns = time.perf_counter_ns()
+        return self
+
+    def __exit__(self, exc_type, exc, tb) -> None:
+        self._duration_ns = time.perf_counter_ns() - self._start_ns
+        if exc_type is not None:
+            self.args["error"] = exc_type.__name__
+        if _enabled:
+            _events.append(
+                (
+                    self.name,
+                    self.category,
+                    (_epoch_base_ns + self._start_ns) // 1000,
+                    self._duration_ns // 1000,
+                    threading.get_ident(),
+                    self.correlation_id or "",
+                    self.args,
+                )
+            )
+
+    @property
+    def elapsed_ms(self) -> float:
+        duration_ns = self._duration_ns
+        if duration_ns is None:
+            duration_ns = time.perf_counter_ns() - self._start_ns
+        return duration_ns / 1_000_000.0
+
+
+def export_chrome_trace(correlation_id: str = "") -> Dict[str, Any]:
+    """Chrome trace 事件列表；``correlation_id`` 非空时只导出该 ID 的事件。"""
+    pid = os.getpid()
+    trace_events: List[Dict[str, Any]] = [
+        {"name": "process_name", "ph": "M", "pid": pid, "args": {"name": "python-ai-service"}}
+    ]
+    for name, category, start_us, duration_us, tid, corr, args in sorted(list(_events), key=lambda e: e[2]):
+        if correlation_id and corr != correlation_id:
+            continue
+        event_args = dict(args)
+        if corr:
+            event_args["correlation_id"] = corr
+        trace_events.append(
+            {
+                "name": name,
+                "cat": category,
+                "ph": "X",
+                "ts": start_us,
+                "dur": duration_us,
+                "pid": pid,
+                "tid": tid,
+                "args": event_args,
+            }
+        )
+    return {"status": "success", "traceEvents": trace_events, "displayTimeUnit": "ms"}
@@ -7,6 +7,7 @@ from datetime import datetime, timedelta, timezone
 from pathlib import Path
 from typing import Any
 
+from rpa.core.media_store import release_media_paths
 from rpa.db.connection import open_db
 
 from .cache_snapshot import resolved_snapshot_db_path
@@ -168,11 +169,16 @@ def _longest_tail_overlap(history: list[str], current: list[str]) -> int:
     return 0
 
 
+# persist_event 只落库并写入持久事件日志的事件类型，其他类型直接放行
+EVENT_LOG_TYPES = frozenset({"conversation_observed", "message_observed", "message_sent", "send_failed"})
+
+
 class PythonServiceTruthStore:
     """Persist platform events into the Python service truth database."""
 
     def __init__(self, db_path: Path | None = None) -> None:
         self._db_path = db_path
+        self._schema_ready: set[str] = set()
 
     def ensure_schema(self) -> Path:
         path = self._db_path or resolved_snapshot_db_path()
@@ -186,7 +192,7 @@ class PythonServiceTruthStore:
 
     def persist_event(self, event: dict[str, Any]) -> bool:
         event_type = _clean(event.get("event_type"))
-        if event_type not in {"conversation_observed", "message_observed", "message_sent", "send_failed"}:
+        if event_type not in EVENT_LOG_TYPES:
             return True
 
         path = self._db_path or resolved_snapshot_db_path()
@@ -279,34 +285,95 @@ class PythonServiceTruthStore:
             since = 0
         safe_limit = max(1, min(int(limit or 50), 200))
         normalized_platform = _clean(platform).lower()
-        path = self._db_path or resolved_snapshot_db_path()
 
-        conn = open_db(path)
+        conn = self._open_read()
         try:
-            self._ensure_schema(conn)
-            clauses = ["id > ?"]
-            params: list[Any] = [since]
-            if normalized_platform:
-                clauses.append("platform = ?")
-                params.append(normalized_platform)
-            params.append(safe_limit)
-            rows = conn.execute(
-                f"""
-                SELECT id, event_type, platform, account_id, conversation_key,
-                       occurred_at, payload_json, raw_event_json
-                FROM rpa_events
-                WHERE {" AND ".join(clauses)}
-                ORDER BY id ASC
-                LIMIT ?
-                """,
-                params,
-            ).fetchall()
+            events = self._read_event_log(conn, normalized_platform, since, None, safe_limit)
             latest_row = conn.execute("SELECT COALESCE(MAX(id), 0) FROM rpa_events").fetchone()
         finally:
             conn.close()
 
+        last_cursor = int(events[-1]["cursor"]) if events else since
+        latest = int(latest_row[0]) if latest_row and latest_row[0] is not None else since
+        return {
+            "status": "success",
+            "source_role": "python_service_truth_replay",
+            "platform": normalized_platform,
+            "cursor": str(last_cursor),
+            "latest_cursor": str(latest),
+            "event_count": len(events),
+            "events": events,
+        }
+
+    def read_event_log(self, platform: str, after_id: int, through_id: int | None, limit: int) -> list[dict[str, Any]]:
+        """持久事件日志中 id 落在 (after_id, through_id] 的事件，按 id 升序，最多 limit 条。"""
+        conn = self._open_read()
+        try:
+            return self._read_event_log(conn, _clean(platform).lower(), after_id, through_id, max(1, int(limit)))
+        finally:
+            conn.close()
+
+    def latest_event_id(self) -> int:
+        """持久事件日志用过的最大 id（含已删除的行），内存事件序号从它之后接着编。"""
+        conn = self._open_read()
+        try:
+            row = conn.execute(
+                """
+                SELECT MAX(
+                    COALESCE((SELECT MAX(id) FROM rpa_events), 0),
+                    COALESCE((SELECT seq FROM sqlite_sequence WHERE name = 'rpa_events'), 0)
+                )
+                """
+            ).fetchone()
+        finally:
+            conn.close()
+        return int(row[0] or 0) if row else 0
+
+    def _open_read(self) -> sqlite3.Connection:
+        path = self._db_path or resolved_snapshot_db_path()
+        conn = open_db(path)
+        # 建表脚本每个实例每个库只跑一次，追赶读取不必每页都执行一遍迁移
+        key = str(path)
+        if key not in self._schema_ready:
+            try:
+                self._ensure_schema(conn)
+                conn.commit()
+            except Exception:
+                conn.close()
+                raise
+            self._schema_ready.add(key)
+        return conn
+
+    def _read_event_log(
+        self,
+        conn: sqlite3.Connection,
+        platform: str,
+        after_id: int,
+        through_id: int | None,
+        limit: int,
+    ) -> list[dict[str, Any]]:
+        clauses = ["id > ?"]
+        params: list[Any] = [after_id]
+        if through_id is not None:
+            clauses.append("id <= ?")
+            params.append(through_id)
+        if platform:
+            clauses.append("platform = ?")
+            params.append(platform)
+        params.append(limit)
+        rows = conn.execute(
+            f"""
+            SELECT id, event_type, platform, account_id, conversation_key,
+                   occurred_at, payload_json, raw_event_json
+            FROM rpa_events
+            WHERE {" AND ".join(clauses)}
+            ORDER BY id ASC
+            LIMIT ?
+            """,
+            params,
+        ).fetchall()
+
         events: list[dict[str, Any]] = []
-        last_cursor = since
         for row in rows:
             event_id = int(row[0])
             raw_event = _json_loads(row[7])
@@ -324,18 +391,7 @@ class PythonServiceTruthStore:
             event["replayed"] = True
             event["source_role"] = "python_service_truth_replay"
             events.append(event)
-            last_cursor = event_id
-
-        latest = int(latest_row[0]) if latest_row and latest_row[0] is not None else since
-        return {
-            "status": "success",
-            "source_role": "python_service_truth_replay",
-            "platform": normalized_platform,
-            "cursor": str(last_cursor if events else since),
-            "latest_cursor": str(latest),
-            "event_count": len(events),
-            "events": events,
-        }
+        return events
 
     def filter_observed_message_events(
         self,
@@ -813,6 +869,11 @@ class PythonServiceTruthStore:
             "INSERT OR IGNORE INTO wechat_messages (message_id, conversation_id, platform_message_id, source_type, confidence, verification_status, original_timestamp, content_image_path, evidence_ref, raw_payload_json) SELECT m.id, m.conversation_id, m.platform_message_id, m.source_type, m.confidence, m.verification_status, m.original_timestamp, m.content_image_path, m.content_image_path, '{}' FROM messages m JOIN conversations c ON c.id = m.conversation_id WHERE c.platform = 'wechat'",
             "INSERT OR IGNORE INTO qianniu_messages (message_id, conversation_id, platform_message_id, source_type, confidence, verification_status, original_timestamp, content_image_path, evidence_ref, raw_payload_json) SELECT m.id, m.conversation_id, m.platform_message_id, m.source_type, m.confidence, m.verification_status, m.original_timestamp, m.content_image_path, m.content_image_path, '{}' FROM messages m JOIN conversations c ON c.id = m.conversation_id WHERE c.platform = 'qianniu'",
             "CREATE INDEX IF NOT EXISTS idx_qianniu_messages_platform_message_id ON qianniu_messages(platform_message_id)",
+            # 删除会话释放媒体时按路径反查引用，两列各建索引免得每个文件一次全表扫描
+            "CREATE INDEX IF NOT EXISTS idx_wechat_messages_content_image_path ON wechat_messages(content_image_path)",
+            "CREATE INDEX IF NOT EXISTS idx_wechat_messages_evidence_ref ON wechat_messages(evidence_ref)",
+            "CREATE INDEX IF NOT EXISTS idx_qianniu_messages_content_image_path ON qianniu_messages(content_image_path)",
+            "CREATE INDEX IF NOT EXISTS idx_qianniu_messages_evidence_ref ON qianniu_messages(evidence_ref)",
             "ALTER TABLE conversations DROP COLUMN source_type",
             "ALTER TABLE conversations DROP COLUMN confidence",
             "ALTER TABLE conversations DROP COLUMN cache_scope",
@@ -844,24 +905,36 @@ class PythonServiceTruthStore:
         payload = event.get("payload")
         if not isinstance(payload, dict):
             payload = {}
-        conn.execute(
-            """
+        # 带内存事件序号时以它作行 id，/api/platform/events 与 replay 共用同一套游标
+        seq = event.get("seq")
+        row_id = seq if isinstance(seq, int) and seq > 0 else None
+        event_id = _clean(event.get("event_id"))
+        values = (
+            event_id,
+            event_type,
+            platform,
+            _clean(event.get("account_id")),
+            _clean(event.get("conversation_key")),
+            _sqlite_time(event.get("occurred_at")),
+            _json(payload),
+            _json(event),
+        )
+        insert_sql = """
             INSERT OR IGNORE INTO rpa_events
-            (event_id, event_type, platform, account_id, conversation_key,
+            (id, event_id, event_type, platform, account_id, conversation_key,
              occurred_at, payload_json, raw_event_json, source_role)
-            VALUES (?, ?, ?, ?, ?, NULLIF(?, ''), ?, ?, 'python_service_truth')
-            """,
-            (
-                _clean(event.get("event_id")),
-                event_type,
-                platform,
-                _clean(event.get("account_id")),
-                _clean(event.get("conversation_key")),
-                _sqlite_time(event.get("occurred_at")),
-                _json(payload),
-                _json(event),
-            ),
+            VALUES (?, ?, ?, ?, ?, ?, NULLIF(?, ''), ?, ?, 'python_service_truth')
+        """
+        cursor = conn.execute(insert_sql, (row_id, *values))
+        if cursor.rowcount or row_id is None:
+            return
+        if event_id and conn.execute("SELECT 1 FROM rpa_events WHERE event_id = ?", (event_id,)).fetchone():
+            return
+        # 行 id 已被占用（序号与持久日志不同步）：改用自增 id 落库，游标对不上也不能丢事件
+        logging.warning(
+            "rpa event id %s already used, appending event_id=%s with a new id", row_id, event_id
         )
+        conn.execute(insert_sql, (None, *values))
 
     def _apply_conversation_mutation(
         self,
@@ -920,7 +993,9 @@ class PythonServiceTruthStore:
                 (normalized_platform, normalized_key),
             ).fetchone()
             conversation_id = int(row[0]) if row else 0
+            media_paths: list[str] = []
             if conversation_id > 0:
+                media_paths = self._conversation_media_paths(conn, conversation_id)
                 self._delete_conversation_message_children(conn, conversation_id)
                 conn.execute("DELETE FROM messages WHERE conversation_id = ?", (conversation_id,))
                 if mutation_type == "delete_conversation":
@@ -962,6 +1037,8 @@ class PythonServiceTruthStore:
             }
             self._append_event_log(conn, event)
             conn.commit()
+            # 提交后再删文件：事务回滚时媒体仍在
+            released_media = self._release_media_paths(conn, media_paths)
         finally:
             conn.close()
 
@@ -970,10 +1047,50 @@ class PythonServiceTruthStore:
             "platform": normalized_platform,
             "conversation_key": normalized_key,
             "mutation_type": mutation_type,
+            "released_media": released_media,
             "mutation_id": mutation_id,
             "event": event,
         }
 
+    def _conversation_media_paths(self, conn: sqlite3.Connection, conversation_id: int) -> list[str]:
+        paths: list[str] = []
+        for table_name in ("wechat_messages", "qianniu_messages"):
+            rows = conn.execute(
+                f"""
+                SELECT content_image_path, evidence_ref FROM {table_name}
+                WHERE conversation_id = ?
+                   OR message_id IN (
+                        SELECT id FROM messages WHERE conversation_id = ?
+                   )
+                """,
+                (conversation_id, conversation_id),
+            ).fetchall()
+            for image_path, evidence_ref in rows:
+                paths.extend(path for path in (_clean(image_path), _clean(evidence_ref)) if path)
+        return list(dict.fromkeys(paths))
+
+    def _media_path_referenced(self, conn: sqlite3.Connection, path: str) -> bool:
+        for table_name in ("wechat_messages", "qianniu_messages"):
+            row = conn.execute(
+                f"SELECT 1 FROM {table_name} WHERE content_image_path = ? OR evidence_ref = ? LIMIT 1",
+                (path, path),
+            ).fetchone()
+            if row is not None:
+                return True
+        return False
+
+    def _release_media_paths(self, conn: sqlite3.Connection, paths: list[str]) -> int:
+        if not paths:
+            return 0
+        try:
+            released = release_media_paths(paths, lambda path: self._media_path_referenced(conn, path))
+        except Exception as exc:
+            logging.warning("truth_store media release failed: %s", exc)
+            return 0
+        if released:
+            logging.info("truth_store released media files count=%s", released)
+        return released
+
     def _delete_conversation_message_children(self, conn: sqlite3.Connection, conversation_id: int) -> None:
         if conversation_id <= 0:
             return
@@ -83,6 +83,9 @@ void ConversationManager::initialize(MessageRouter* router)
         emit messageSendFailed(convId, reason);
     });
 
+    connect(m_router, &MessageRouter::sendDelegated, this, &ConversationManager::sendDelegated);
+    connect(m_router, &MessageRouter::delegatedSendFinished, this, &ConversationManager::delegatedSendFinished);
+
     connect(m_router, &MessageRouter::messageStatusChanged, this,
             [this](int convId, int msgId, Models::MessageStatus status, const QString& reason) {
         qDebug() << "[ConversationManager] message status changed convId=" << convId
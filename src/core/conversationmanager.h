@@ -51,6 +51,8 @@ signals:
     void messageStatusChanged(int conversationId, int messageId, Models::MessageStatus newStatus, const QString& errorReason);
     void unifiedMessageReceived(int conversationId, const Models::Message& message);
     void unifiedConversationUpdated(const Models::Conversation& conversation);
+    void sendDelegated(int conversationId, const QString& clientMessageId);
+    void delegatedSendFinished(int conversationId, const QString& clientMessageId);
 
 private:
     explicit ConversationManager(QObject* parent = nullptr);
@@ -1,10 +1,13 @@
 ﻿#include "messagerouter.h"
 #include "../data/conversationdao.h"
 #include "../data/messagedao.h"
+#include "../data/messagesendeventdao.h"
 #include "../data/qianniuconversationdao.h"
 #include "../data/wechatmessagedao.h"
 #include "../services/platforms/iplatformadapter.h"
+#include "../utils/metrics.h"
 #include "../utils/runtimemode.h"
+#include "../utils/tracing.h"
 #include "types.h"
 #include <QElapsedTimer>
 #include <QFileInfo>
@@ -196,8 +199,13 @@ void MessageRouter::sendMessage(int conversationId,
         }
     }
 
-    QElapsedTimer totalTimer;
-    totalTimer.start();
+    static Metrics::Counter* const sendTotal = Metrics::counter(
+        QStringLiteral("router_send_total"), {}, QStringLiteral("经路由发出的消息数"));
+    static Metrics::Histogram* const sendLatency = Metrics::histogram(
+        QStringLiteral("router_send_us"), {}, QStringLiteral("路由发送（入库 + 交给适配器）耗时"));
+    sendTotal->increment();
+    Metrics::ScopedTimer sendTimer(sendLatency);
+    Tracing::Span totalSpan("router.send", "router");
     ConversationDao convDao;
     auto conv = convDao.findById(conversationId);
     if (!conv) {
@@ -219,20 +227,22 @@ void MessageRouter::sendMessage(int conversationId,
         : clientMessageId;
     const Models::MessageContentType outgoingContentType = contentTypeForPart(part);
     const QString outgoingContent = contentForPart(part);
+    totalSpan.setCorrelationId(normalizedClientMessageId);
 
     if (RuntimeMode::ownsBusinessDatabase()) {
-        QElapsedTimer adapterTimer;
-        adapterTimer.start();
+        Tracing::Span adapterSpan("router.send.adapter", "router", normalizedClientMessageId);
         a->sendMessagePart(conv->platformConversationId, part, normalizedClientMessageId);
+        adapterSpan.end();
         qInfo() << "[MessageRouter] send delegated to Python service"
                 << "conversationId=" << conversationId
                 << "platform=" << conv->platform
                 << "platformConversationId=" << conv->platformConversationId
                 << "clientMessageId=" << normalizedClientMessageId
-                << "adapterElapsedMs=" << adapterTimer.elapsed()
-                << "totalElapsedMs=" << totalTimer.elapsed()
+                << "adapterElapsedMs=" << adapterSpan.elapsedMs()
+                << "totalElapsedMs=" << totalSpan.elapsedMs()
                 << "contentType=" << Models::toString(outgoingContentType)
                 << "content=" << outgoingContent.left(30);
+        emit sendDelegated(conversationId, normalizedClientMessageId);
         return;
     }
 
@@ -254,17 +264,16 @@ void MessageRouter::sendMessage(int conversationId,
     pendingMessage.metadata.insert(QStringLiteral("mime_type"), part.mimeType);
     pendingMessage.metadata.insert(QStringLiteral("size_bytes"), double(part.sizeBytes));
     pendingMessage.clientMessageId = normalizedClientMessageId;
-    QElapsedTimer cacheTimer;
-    cacheTimer.start();
+    Tracing::Span stageSpan("router.send.create_pending", "router", normalizedClientMessageId);
     int msgId = msgDao.createOutboundCacheMessage(pendingMessage);
-    const qint64 createPendingElapsedMs = cacheTimer.elapsed();
+    const qint64 createPendingElapsedMs = stageSpan.end();
 
     if (msgId <= 0) {
         qWarning() << "[MessageRouter] send timing"
                    << "conversationId=" << conversationId
                    << "clientMessageId=" << normalizedClientMessageId
                    << "stage=create_pending"
-                   << "elapsedMs=" << totalTimer.elapsed()
+                   << "elapsedMs=" << totalSpan.elapsedMs()
                    << "createPendingElapsedMs=" << createPendingElapsedMs;
         emit messageSendFailed(conversationId, QStringLiteral("message store failed"));
         return;
@@ -293,12 +302,11 @@ void MessageRouter::sendMessage(int conversationId,
         }
     }
 
-    cacheTimer.restart();
+    stageSpan.restart("router.send.update_conversation");
     convDao.updateLastMessage(conversationId, pendingMessage.content, now);
-    const qint64 updateConversationElapsedMs = cacheTimer.elapsed();
+    const qint64 updateConversationElapsedMs = stageSpan.end();
 
-    QElapsedTimer emitTimer;
-    emitTimer.start();
+    stageSpan.restart("router.send.emit_pending");
     const auto persisted = msgDao.findById(msgId);
     if (persisted) {
         emit unifiedMessageReceived(conversationId, LegacyModelCompat::toUnifiedMessage(*persisted));
@@ -309,12 +317,13 @@ void MessageRouter::sendMessage(int conversationId,
         emit unifiedConversationUpdated(LegacyModelCompat::toUnifiedConversation(*updatedConv));
         emit conversationUpdated(*updatedConv);
     }
-    const qint64 emitPendingElapsedMs = emitTimer.elapsed();
+    const qint64 emitPendingElapsedMs = stageSpan.end();
 
-    QElapsedTimer adapterTimer;
-    adapterTimer.start();
+    MessageSendEventDao().append(msgId, conversationId, QStringLiteral("send_attempt"), conv->platform);
+
+    stageSpan.restart("router.send.adapter");
     a->sendMessagePart(conv->platformConversationId, part, normalizedClientMessageId);
-    const qint64 adapterElapsedMs = adapterTimer.elapsed();
+    const qint64 adapterElapsedMs = stageSpan.end();
 
     qInfo() << "[MessageRouter] send timing"
             << "conversationId=" << conversationId
@@ -325,7 +334,7 @@ void MessageRouter::sendMessage(int conversationId,
             << "updateConversationElapsedMs=" << updateConversationElapsedMs
             << "emitPendingElapsedMs=" << emitPendingElapsedMs
             << "adapterElapsedMs=" << adapterElapsedMs
-            << "totalElapsedMs=" << totalTimer.elapsed()
+            << "totalElapsedMs=" << totalSpan.elapsedMs()
             << "contentType=" << Models::toString(pendingMessage.contentType)
             << "content=" << pendingMessage.content.left(30);
 }
@@ -458,18 +467,29 @@ void MessageRouter::onIncomingMessage(const PlatformMessage& msg)
         return;
     }
 
-    QElapsedTimer totalTimer;
-    totalTimer.start();
+    // 适配器事件带 _event_id，与 Python 侧 RpaEventStore 的追踪记录对应
+    const QString traceId = msg.metadata.value(QStringLiteral("_event_id")).toString().isEmpty()
+        ? msg.platformMsgId
+        : msg.metadata.value(QStringLiteral("_event_id")).toString();
+    static Metrics::Counter* const incomingTotal = Metrics::counter(
+        QStringLiteral("router_incoming_messages_total"), {}, QStringLiteral("进入路由的平台消息数"));
+    static Metrics::Counter* const duplicateTotal = Metrics::counter(
+        QStringLiteral("router_incoming_duplicates_total"), {}, QStringLiteral("按 platformMsgId 去重丢弃的消息数"));
+    static Metrics::Histogram* const incomingLatency = Metrics::histogram(
+        QStringLiteral("router_incoming_us"), {}, QStringLiteral("单条入站消息的路由处理耗时（含入库与界面信号）"));
+    incomingTotal->increment();
+    Metrics::ScopedTimer incomingTimer(incomingLatency);
+    Tracing::Span totalSpan("router.incoming", "router", traceId);
     MessageDao msgDao;
     if (!msg.platformMsgId.isEmpty() && msgDao.existsByPlatformMsgId(msg.platformMsgId)) {
+        duplicateTotal->increment();
         qDebug() << "[MessageRouter] duplicate message skipped" << msg.platformMsgId;
         return;
     }
 
-    QElapsedTimer stageTimer;
-    stageTimer.start();
+    Tracing::Span stageSpan("router.incoming.ensure_conversation", "router", traceId);
     int convId = ensureConversation(msg);
-    const qint64 ensureConversationElapsedMs = stageTimer.elapsed();
+    const qint64 ensureConversationElapsedMs = stageSpan.end();
     if (convId <= 0) return;
 
     QDateTime now = msg.createdAt.isValid() ? msg.createdAt : QDateTime::currentDateTime();
@@ -490,9 +510,9 @@ void MessageRouter::onIncomingMessage(const PlatformMessage& msg)
             << "unifiedDirection=" << Models::toString(unifiedMessage.direction)
             << "platformMsgId=" << msg.platformMsgId
             << "content=" << msg.content.left(30);
-    stageTimer.restart();
+    stageSpan.restart("router.incoming.create_message");
     int msgId = msgDao.createObservedCacheMessage(unifiedMessage);
-    const qint64 createMessageElapsedMs = stageTimer.elapsed();
+    const qint64 createMessageElapsedMs = stageSpan.end();
 
     ConversationDao convDao;
     if (msg.platform == QLatin1String("wechat")) {
@@ -512,19 +532,19 @@ void MessageRouter::onIncomingMessage(const PlatformMessage& msg)
             msg.customerName,
             msg.metadata);
     }
-    stageTimer.restart();
+    stageSpan.restart("router.incoming.update_conversation");
     const bool historySync = isHistorySyncMessage(msg);
     if (!historySync)
         convDao.updateLastMessage(convId, msg.content, now);
     if (!historySync && msg.direction == QLatin1String("in"))
         convDao.incrementUnread(convId);
-    const qint64 updateConversationElapsedMs = stageTimer.elapsed();
+    const qint64 updateConversationElapsedMs = stageSpan.end();
 
     if (msgId > 0) {
         unifiedMessage.id = msgId;
-        stageTimer.restart();
+        stageSpan.restart("router.incoming.emit_unified");
         emit unifiedMessageReceived(convId, unifiedMessage);
-        const qint64 emitUnifiedElapsedMs = stageTimer.elapsed();
+        const qint64 emitUnifiedElapsedMs = stageSpan.end();
 
         if (msg.platform == QLatin1String("wechat")) {
             WechatMessageDao wechatDao;
@@ -573,6 +593,7 @@ void MessageRouter::onIncomingMessage(const PlatformMessage& msg)
             rec.observedAt = now;
             rec.cacheScope = QStringLiteral("local_cache");
             rec.cacheOrigin = QStringLiteral("platform_observed_cache");
+            MessageAtoms::compact(rec);
         }
         qInfo() << "[MessageRouter] message record emitted"
                 << "conversationId=" << convId
@@ -585,7 +606,7 @@ void MessageRouter::onIncomingMessage(const PlatformMessage& msg)
                 << "createMessageElapsedMs=" << createMessageElapsedMs
                 << "updateConversationElapsedMs=" << updateConversationElapsedMs
                 << "emitUnifiedElapsedMs=" << emitUnifiedElapsedMs
-                << "totalElapsedMs=" << totalTimer.elapsed()
+                << "totalElapsedMs=" << totalSpan.elapsedMs()
                 << "content=" << rec.content.left(30);
         emit messageReceived(convId, rec);
     }
@@ -602,8 +623,7 @@ void MessageRouter::onIncomingMessage(const PlatformMessage& msg)
 
 void MessageRouter::onMessageSent(const QString& conversationId, const QString& text, const QString& clientMessageId)
 {
-    QElapsedTimer totalTimer;
-    totalTimer.start();
+    Tracing::Span totalSpan("router.send_confirm", "router", clientMessageId);
     const auto* sentAdapter = qobject_cast<IPlatformAdapter*>(sender());
     if (!sentAdapter)
         return;
@@ -618,23 +638,23 @@ void MessageRouter::onMessageSent(const QString& conversationId, const QString&
                 << "platform=" << sentAdapter->platformName()
                 << "conv=" << conversationId
                 << "clientMessageId=" << clientMessageId
-                << "elapsedMs=" << totalTimer.elapsed();
+                << "elapsedMs=" << totalSpan.elapsedMs();
+        emit delegatedSendFinished(conv->id, clientMessageId);
         return;
     }
 
     MessageDao msgDao;
-    QElapsedTimer stageTimer;
-    stageTimer.start();
+    Tracing::Span stageSpan("router.send_confirm.find_pending", "router", clientMessageId);
     std::optional<MessageRecord> pending = msgDao.latestOutboundCacheByClientMessageId(conv->id, clientMessageId);
     if (!pending)
         pending = msgDao.latestPendingOutboundCache(conv->id, text);
-    const qint64 findPendingElapsedMs = stageTimer.elapsed();
+    const qint64 findPendingElapsedMs = stageSpan.end();
     if (!pending) {
         qWarning() << "[MessageRouter] no pending outbound found platform="
                    << sentAdapter->platformName() << "conv=" << conversationId
                    << "clientMessageId=" << clientMessageId
                    << "findPendingElapsedMs=" << findPendingElapsedMs
-                   << "totalElapsedMs=" << totalTimer.elapsed();
+                   << "totalElapsedMs=" << totalSpan.elapsedMs();
         return;
     }
     if (pending->syncStatus == 11) {
@@ -645,9 +665,9 @@ void MessageRouter::onMessageSent(const QString& conversationId, const QString&
                 << "clientMessageId=" << clientMessageId;
         return;
     }
-    stageTimer.restart();
+    stageSpan.restart("router.send_confirm.update_state");
     if (msgDao.updateOutboundCacheDeliveryState(pending->id, 11)) {
-        const qint64 updateStateElapsedMs = stageTimer.elapsed();
+        const qint64 updateStateElapsedMs = stageSpan.end();
         qInfo() << "[MessageRouter] send confirm timing"
                 << "platform=" << sentAdapter->platformName()
                 << "convId=" << conv->id
@@ -655,7 +675,8 @@ void MessageRouter::onMessageSent(const QString& conversationId, const QString&
                 << "clientMessageId=" << clientMessageId
                 << "findPendingElapsedMs=" << findPendingElapsedMs
                 << "updateStateElapsedMs=" << updateStateElapsedMs
-                << "totalElapsedMs=" << totalTimer.elapsed();
+                << "totalElapsedMs=" << totalSpan.elapsedMs();
+        MessageSendEventDao().append(pending->id, conv->id, QStringLiteral("success"));
         emit messageStatusChanged(conv->id, pending->id, Models::MessageStatus::Sent, QString());
         const auto updatedConv = convDao.findById(conv->id);
         if (updatedConv) {
@@ -667,8 +688,7 @@ void MessageRouter::onMessageSent(const QString& conversationId, const QString&
 
 void MessageRouter::onSendFailed(const QString& conversationId, const QString& reason, const QString& clientMessageId)
 {
-    QElapsedTimer totalTimer;
-    totalTimer.start();
+    Tracing::Span totalSpan("router.send_failed", "router", clientMessageId);
     ConversationDao dao;
     const auto* failedAdapter = qobject_cast<IPlatformAdapter*>(sender());
     const QString platformName = failedAdapter ? failedAdapter->platformName() : QString();
@@ -681,6 +701,7 @@ void MessageRouter::onSendFailed(const QString& conversationId, const QString& r
             pending = msgDao.latestPendingOutboundCache(conv->id);
         if (pending) {
             msgDao.updateOutboundCacheDeliveryState(pending->id, 12, reason);
+            MessageSendEventDao().append(pending->id, conv->id, QStringLiteral("failed"), reason);
             emit messageStatusChanged(conv->id, pending->id, Models::MessageStatus::Failed, reason);
         }
         const auto updatedConv = dao.findById(conv->id);
@@ -688,12 +709,14 @@ void MessageRouter::onSendFailed(const QString& conversationId, const QString& r
             emit unifiedConversationUpdated(LegacyModelCompat::toUnifiedConversation(*updatedConv));
             emit conversationUpdated(*updatedConv);
         }
+    } else if (conv) {
+        emit delegatedSendFinished(conv->id, clientMessageId);
     }
 
     qWarning() << "[MessageRouter] send failed platform=" << platformName
                << "conv=" << conversationId
                << "clientMessageId=" << clientMessageId
-               << "elapsedMs=" << totalTimer.elapsed()
+               << "elapsedMs=" << totalSpan.elapsedMs()
                << "reason=" << reason;
     emit messageSendFailed(conv ? conv->id : 0, reason);
 }
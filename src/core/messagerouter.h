@@ -39,6 +39,11 @@ signals:
 
     void messageStatusChanged(int conversationId, int messageId, Models::MessageStatus newStatus, const QString& errorReason);
 
+    // 业务库归 Python 服务时发送只转交给适配器，时间线行由服务写入；
+    // 界面据这两个信号判断是否还有在途发送，决定是否轮询发送时间线
+    void sendDelegated(int conversationId, const QString& clientMessageId);
+    void delegatedSendFinished(int conversationId, const QString& clientMessageId);
+
 private slots:
     void onConversationObserved(const ConversationInfo& conv);
     void onConversationMessagesCleared(const QString& conversationId);
@@ -1,7 +1,50 @@
 #include "types.h"
 
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSet>
+
 namespace {
 
+constexpr int kMaxDynamicAtoms = 512;
+
+template <typename Enum>
+void insertEnumAtoms(QSet<QString>& atoms, Enum last)
+{
+    for (int i = 0; i <= static_cast<int>(last); ++i)
+        atoms.insert(Models::toString(static_cast<Enum>(i)));
+}
+
+const QSet<QString>& builtinAtoms()
+{
+    static const QSet<QString> atoms = [] {
+        QSet<QString> out;
+        insertEnumAtoms(out, Models::MessageContentType::Unknown);
+        insertEnumAtoms(out, Models::MessageStatus::Recalled);
+        insertEnumAtoms(out, Models::SourceType::Experimental);
+        insertEnumAtoms(out, Models::VerificationStatus::Conflict);
+        for (const QString& value : {
+                 QStringLiteral("in"),
+                 QStringLiteral("out"),
+                 QStringLiteral("system"),
+                 QStringLiteral("customer"),
+                 QStringLiteral("agent"),
+                 QStringLiteral("local_cache"),
+                 QStringLiteral("service_db"),
+                 QStringLiteral("legacy_runtime"),
+                 QStringLiteral("python_service_db"),
+                 QStringLiteral("platform_observed_cache"),
+                 QStringLiteral("manual_outbound_cache"),
+                 QStringLiteral("experimental_cache"),
+                 QStringLiteral("server_snapshot_cache"),
+             }) {
+            out.insert(value);
+        }
+        return out;
+    }();
+    return atoms;
+}
+
 Models::SourceType sourceTypeOrDefault(const QString& value, const QString& platform)
 {
     if (!value.trimmed().isEmpty())
@@ -64,7 +107,9 @@ Models::Message toUnifiedMessage(const MessageRecord& value)
     out.observedAt = value.observedAt.isValid() ? value.observedAt : value.createdAt;
     out.platformDisplayedAt = value.createdAt;
     out.evidenceRef = value.contentImagePath;
-    out.metadata.insert(QStringLiteral("clientMessageId"), value.clientMessageId);
+    // clientMessageId 已有独立字段；为空时不再为每条消息分配一个 QJsonObject
+    if (!value.clientMessageId.isEmpty())
+        out.metadata.insert(QStringLiteral("clientMessageId"), value.clientMessageId);
     return out;
 }
 
@@ -88,3 +133,40 @@ Models::ConversationEvent toMessageObservedEvent(const PlatformMessage& value)
 }
 
 } // namespace LegacyModelCompat
+
+namespace MessageAtoms {
+
+QString intern(const QString& value)
+{
+    if (value.isEmpty())
+        return QString();
+    const QSet<QString>& builtin = builtinAtoms();
+    const auto it = builtin.constFind(value);
+    if (it != builtin.cend())
+        return *it;
+
+    static QMutex mutex;
+    static QSet<QString> dynamicAtoms;
+    QMutexLocker locker(&mutex);
+    const auto dyn = dynamicAtoms.constFind(value);
+    if (dyn != dynamicAtoms.cend())
+        return *dyn;
+    if (dynamicAtoms.size() >= kMaxDynamicAtoms)
+        return value;
+    dynamicAtoms.insert(value);
+    return value;
+}
+
+void compact(MessageRecord& record)
+{
+    record.direction = intern(record.direction);
+    record.sender = intern(record.sender);
+    record.status = intern(record.status);
+    record.sourceType = intern(record.sourceType);
+    record.verificationStatus = intern(record.verificationStatus);
+    record.contentType = intern(record.contentType);
+    record.cacheScope = intern(record.cacheScope);
+    record.cacheOrigin = intern(record.cacheOrigin);
+}
+
+} // namespace MessageAtoms
@@ -43,25 +43,33 @@ struct ConversationInfo {
     QDateTime updatedAt;
     QString cacheScope = QStringLiteral("local_cache");
     QString cacheOrigin = QStringLiteral("legacy_runtime");
+    /** 会话行上冗余的最后一条消息方向（触发器维护，无消息为空）；库里没有该列时 lastDirectionKnown 为 false。 */
+    QString lastDirection;
+    bool lastDirectionKnown = false;
 };
 
+/**
+ * 本地缓存消息。direction/sender/status/sourceType/verificationStatus/contentType/
+ * cacheScope/cacheOrigin 取值有限，在 DB 与 JSON 边界经 MessageAtoms::compact() 换成
+ * 共享实例，不再为每条消息单独分配；int 字段集中放在开头以免结构体内填充。
+ */
 struct MessageRecord {
     int id = 0;
     int conversationId = 0;
+    int syncStatus = 1;      // 1=normal, 10=pending_send, 11=sent_ok, 12=sent_failed
+    int confidence = 100;
     QString direction; // "in" or "out"
     QString content;
     QString sender; // "customer", "agent", "system"
     QString senderName; // OCR 识别的发送者名称（如千牛店铺:昵称；微信通常为空）
     QDateTime createdAt;
     QString platformMsgId;
-    int syncStatus = 1;      // 1=normal, 10=pending_send, 11=sent_ok, 12=sent_failed
     QString errorReason;
     QString originalTimestamp; // 对方消息在聚合侧的展示时间（来源依平台：入库时刻或 OCR）
     QString contentImagePath;  // 千牛等：聊天区截图本地路径；空表示纯文本
     QString clientMessageId;   // C++ 发起发送命令时生成的本地消息关联 ID
     QString status = QStringLiteral("observed");
     QString sourceType = QStringLiteral("mock");
-    int confidence = 100;
     QString verificationStatus = QStringLiteral("unverified");
     QString contentType = QStringLiteral("text");
     QDateTime observedAt;
@@ -103,6 +111,17 @@ Models::ConversationEvent toMessageObservedEvent(const PlatformMessage& value);
 
 } // namespace LegacyModelCompat
 
+namespace MessageAtoms {
+
+/**
+ * 枚举型字符串字段的驻留表：已知取值（Models::toString 全部枚举值与缓存来源常量）
+ * 返回静态字面量，不占堆；其他取值进入有上限的共享池，超出上限时原样返回。
+ */
+QString intern(const QString& value);
+void compact(MessageRecord& record);
+
+} // namespace MessageAtoms
+
 Q_DECLARE_METATYPE(PlatformMessage)
 Q_DECLARE_METATYPE(ConversationInfo)
 Q_DECLARE_METATYPE(MessageRecord)
@@ -1,11 +1,14 @@
 #include "airequesteventdao.h"
 #include "database.h"
+#include "dataeventbus.h"
 
 #include <QDebug>
 #include <QSqlError>
 #include <QSqlQuery>
 #include <QVariant>
 
+#include <algorithm>
+
 namespace {
 
 bool updateEventStatus(qint64 eventId,
@@ -82,6 +85,83 @@ bool AiRequestEventDao::cancelEvent(qint64 eventId, int durationMs)
     return updateEventStatus(eventId, QStringLiteral("canceled"), durationMs, 0, 0, QStringLiteral("canceled"));
 }
 
+bool AiRequestEventDao::recordEstimatedPromptTokens(qint64 eventId, int estimatedPromptTokens)
+{
+    if (eventId <= 0)
+        return false;
+
+    QSqlQuery q(Database::getInstance().connection());
+    q.prepare(QStringLiteral(
+        "UPDATE ai_request_events SET estimated_prompt_tokens = :estimated WHERE id = :id"));
+    q.bindValue(QStringLiteral(":estimated"), qMax(0, estimatedPromptTokens));
+    q.bindValue(QStringLiteral(":id"), eventId);
+    if (!q.exec()) {
+        qWarning() << "AiRequestEventDao::recordEstimatedPromptTokens failed:" << q.lastError().text();
+        return false;
+    }
+    return true;
+}
+
+bool AiRequestEventDao::recordServingModel(qint64 eventId, const QString& sessionModelKey, const QString& model)
+{
+    if (eventId <= 0 || sessionModelKey.isEmpty())
+        return false;
+
+    QSqlQuery q(Database::getInstance().connection());
+    q.prepare(QStringLiteral(
+        "UPDATE ai_request_events SET session_model_key = :sessionModelKey, model = :model WHERE id = :id"));
+    q.bindValue(QStringLiteral(":sessionModelKey"), sessionModelKey);
+    q.bindValue(QStringLiteral(":model"), model);
+    q.bindValue(QStringLiteral(":id"), eventId);
+    if (!q.exec()) {
+        qWarning() << "AiRequestEventDao::recordServingModel failed:" << q.lastError().text();
+        return false;
+    }
+    return true;
+}
+
+bool AiRequestEventDao::recordHedgeLoser(qint64 eventId, const QString& sessionModelKey, int censoredFirstTokenMs)
+{
+    if (eventId <= 0 || sessionModelKey.isEmpty() || censoredFirstTokenMs <= 0)
+        return false;
+
+    QSqlQuery q(Database::getInstance().connection());
+    q.prepare(QStringLiteral(
+        "UPDATE ai_request_events SET hedge_loser_session_model_key = :sessionModelKey, "
+        "  hedge_loser_first_token_ms = :censoredMs WHERE id = :id"));
+    q.bindValue(QStringLiteral(":sessionModelKey"), sessionModelKey);
+    q.bindValue(QStringLiteral(":censoredMs"), censoredFirstTokenMs);
+    q.bindValue(QStringLiteral(":id"), eventId);
+    if (!q.exec()) {
+        qWarning() << "AiRequestEventDao::recordHedgeLoser failed:" << q.lastError().text();
+        return false;
+    }
+    return true;
+}
+
+bool AiRequestEventDao::recordTokenUsage(qint64 eventId,
+                                         int promptTokens,
+                                         int cachedPromptTokens,
+                                         int completionTokens)
+{
+    if (eventId <= 0)
+        return false;
+
+    QSqlQuery q(Database::getInstance().connection());
+    q.prepare(QStringLiteral(
+        "UPDATE ai_request_events SET prompt_tokens = :prompt, cached_prompt_tokens = :cached, "
+        "completion_tokens = :completion WHERE id = :id"));
+    q.bindValue(QStringLiteral(":prompt"), qMax(0, promptTokens));
+    q.bindValue(QStringLiteral(":cached"), qBound(0, cachedPromptTokens, qMax(0, promptTokens)));
+    q.bindValue(QStringLiteral(":completion"), qMax(0, completionTokens));
+    q.bindValue(QStringLiteral(":id"), eventId);
+    if (!q.exec()) {
+        qWarning() << "AiRequestEventDao::recordTokenUsage failed:" << q.lastError().text();
+        return false;
+    }
+    return true;
+}
+
 bool AiRequestEventDao::appendStage(qint64 requestEventId,
                                     int conversationId,
                                     const QString& stage,
@@ -103,6 +183,15 @@ bool AiRequestEventDao::appendStage(qint64 requestEventId,
         qWarning() << "AiRequestEventDao::appendStage failed:" << q.lastError().text();
         return false;
     }
+
+    AiRequestStageEventRecord r;
+    r.id = q.lastInsertId().toLongLong();
+    r.requestEventId = requestEventId;
+    r.conversationId = conversationId;
+    r.stage = stage;
+    r.detail = detail.left(500);
+    r.createdAt = QDateTime::currentDateTime();
+    emit DataEventBus::instance().aiStageEventAppended(r);
     return true;
 }
 
@@ -177,6 +266,47 @@ AiRequestEventMetrics AiRequestEventDao::aggregateMetrics(const QString& session
     return metrics;
 }
 
+int AiRequestEventDao::firstTokenPercentileMs(const QString& sessionModelKey,
+                                              int percentile,
+                                              int sampleLimit,
+                                              int* sampleCountOut) const
+{
+    if (sampleCountOut)
+        *sampleCountOut = 0;
+    if (sessionModelKey.trimmed().isEmpty() || sampleLimit <= 0)
+        return 0;
+
+    QSqlQuery q(Database::getInstance().connection());
+    q.prepare(QStringLiteral(
+        "SELECT ms FROM ("
+        "  SELECT id, first_token_ms AS ms FROM ai_request_events "
+        "  WHERE session_model_key = :sessionModelKey AND status = 'completed' AND first_token_ms > 0 "
+        "  UNION ALL "
+        "  SELECT id, hedge_loser_first_token_ms AS ms FROM ai_request_events "
+        "  WHERE hedge_loser_session_model_key = :loserModelKey AND hedge_loser_first_token_ms > 0"
+        ") ORDER BY id DESC LIMIT :limit"));
+    q.bindValue(QStringLiteral(":sessionModelKey"), sessionModelKey);
+    q.bindValue(QStringLiteral(":loserModelKey"), sessionModelKey);
+    q.bindValue(QStringLiteral(":limit"), sampleLimit);
+    if (!q.exec()) {
+        qWarning() << "AiRequestEventDao::firstTokenPercentileMs failed:" << q.lastError().text();
+        return 0;
+    }
+
+    QVector<int> samples;
+    while (q.next())
+        samples.push_back(q.value(0).toInt());
+    if (sampleCountOut)
+        *sampleCountOut = samples.size();
+    if (samples.isEmpty())
+        return 0;
+
+    std::sort(samples.begin(), samples.end());
+    const int p = qBound(1, percentile, 100);
+    const int rank = qMax(1, (p * int(samples.size()) + 99) / 100);
+    return samples.at(qMin(rank, int(samples.size())) - 1);
+}
+
 qint64 AiRequestEventDao::globalStageMaxId() const
 {
     QSqlQuery q(Database::getInstance().connection());
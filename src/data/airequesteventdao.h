@@ -37,12 +37,32 @@ public:
     bool completeEvent(qint64 eventId, int durationMs, int firstTokenMs, int outputChars);
     bool failEvent(qint64 eventId, int durationMs, const QString& errorReason);
     bool cancelEvent(qint64 eventId, int durationMs);
+    /** 本地估算的 prompt tokens（发送前写入，便于与服务端回报对照）。 */
+    bool recordEstimatedPromptTokens(qint64 eventId, int estimatedPromptTokens);
+    /** 对冲由备用模型胜出时，把事件改记到实际出结果的模型，按模型统计的指标与首字分位才准确。 */
+    bool recordServingModel(qint64 eventId, const QString& sessionModelKey, const QString& model);
+    /**
+     * 对冲落败一路被中止时已等待 censoredFirstTokenMs 仍无首字：按截尾样本记给该模型，
+     * 否则慢的一路总是输、从不留下样本，首字分位会被胜者拉低。
+     */
+    bool recordHedgeLoser(qint64 eventId, const QString& sessionModelKey, int censoredFirstTokenMs);
+    /** 服务端 usage；cachedPromptTokens 为前缀缓存命中部分。 */
+    bool recordTokenUsage(qint64 eventId, int promptTokens, int cachedPromptTokens, int completionTokens);
     bool appendStage(qint64 requestEventId,
                      int conversationId,
                      const QString& stage,
                      const QString& detail = QString());
 
     AiRequestEventMetrics aggregateMetrics(const QString& sessionModelKey) const;
+    /**
+     * 最近 sampleLimit 条样本 first_token_ms 的 percentile 分位（nearest-rank）。样本包括该模型
+     * 已完成的请求，以及它在对冲中落败时的截尾等待时长（按已等待时长计，是真实值的下界）。
+     * 无样本返回 0；sampleCountOut 返回实际参与计算的样本数。
+     */
+    int firstTokenPercentileMs(const QString& sessionModelKey,
+                               int percentile,
+                               int sampleLimit = 200,
+                               int* sampleCountOut = nullptr) const;
     qint64 globalStageMaxId() const;
     QVector<AiRequestStageEventRecord> listStagesSince(int conversationId,
                                                        qint64 afterId,
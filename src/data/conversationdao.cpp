@@ -2,6 +2,7 @@
 #include "wechatmessagedao.h"
 #include "qianniuconversationdao.h"
 #include "database.h"
+#include "../utils/metrics.h"
 #include <QDebug>
 #include <QJsonObject>
 #include <QSet>
@@ -166,6 +167,9 @@ static ConversationInfo recordFromQuery(QSqlQuery& q)
     c.cacheOrigin = rowString(q, QStringLiteral("cache_origin"));
     if (c.cacheOrigin.isEmpty())
         c.cacheOrigin = QStringLiteral("python_service_db");
+    c.lastDirectionKnown = q.record().indexOf(QStringLiteral("last_direction")) >= 0;
+    if (c.lastDirectionKnown)
+        c.lastDirection = rowString(q, QStringLiteral("last_direction")).trimmed().toLower();
     return c;
 }
 
@@ -286,9 +290,8 @@ int ConversationDao::upsertSnapshotCacheConversation(const QJsonObject& conversa
     if (!existing)
         existing = findLegacyShortConversation(platform, platformConversationId);
 
-    QSqlQuery q(Database::getInstance().connection());
-    if (existing) {
-        q.prepare(QStringLiteral(
+    CachedQuery stmt = Database::getInstance().prepareCached(existing
+        ? QStringLiteral(
             "UPDATE conversations SET "
             "platform_conversation_id = :pcid, "
                 "account_id = :account, "
@@ -302,11 +305,8 @@ int ConversationDao::upsertSnapshotCacheConversation(const QJsonObject& conversa
             "created_at = COALESCE(NULLIF(:created_at, ''), created_at), "
             "updated_at = COALESCE(NULLIF(:updated_at, ''), datetime('now','localtime')), "
             "deleted_at = NULLIF(:deleted_at, '') "
-            "WHERE id = :id"));
-        q.bindValue(QStringLiteral(":id"), existing->id);
-        q.bindValue(QStringLiteral(":pcid"), platformConversationId);
-    } else {
-        q.prepare(QStringLiteral(
+            "WHERE id = :id")
+        : QStringLiteral(
             "INSERT INTO conversations (platform, platform_conversation_id, account_id, customer_name, "
             "last_message, unread_count, status, cache_scope, cache_origin, "
             "last_time, created_at, updated_at, deleted_at) "
@@ -316,9 +316,12 @@ int ConversationDao::upsertSnapshotCacheConversation(const QJsonObject& conversa
             "COALESCE(NULLIF(:created_at, ''), datetime('now','localtime')), "
             "COALESCE(NULLIF(:updated_at, ''), datetime('now','localtime')), "
             "NULLIF(:deleted_at, ''))"));
+    QSqlQuery& q = stmt.query();
+    if (existing)
+        q.bindValue(QStringLiteral(":id"), existing->id);
+    else
         q.bindValue(QStringLiteral(":platform"), platform);
-        q.bindValue(QStringLiteral(":pcid"), platformConversationId);
-    }
+    q.bindValue(QStringLiteral(":pcid"), platformConversationId);
     q.bindValue(QStringLiteral(":account"), accountId.isEmpty() ? platform : accountId);
     q.bindValue(QStringLiteral(":name"), customerName.isEmpty() ? platformConversationId : customerName);
     q.bindValue(QStringLiteral(":last_message"), lastMessage);
@@ -404,8 +407,11 @@ int ConversationDao::deleteMissingSnapshotCacheConversations(
 
 std::optional<ConversationInfo> ConversationDao::findById(int id)
 {
-    QSqlQuery q(Database::getInstance().connection());
-    q.prepare("SELECT * FROM conversations WHERE id = :id");
+    static Metrics::Histogram* const latency = Metrics::dbStatementLatency("ConversationDao::findById");
+    Metrics::ScopedTimer timer(latency);
+    CachedQuery stmt = Database::getInstance().prepareCached(QStringLiteral(
+        "SELECT * FROM conversations WHERE id = :id"));
+    QSqlQuery& q = stmt.query();
     q.bindValue(":id", id);
     if (!q.exec() || !q.next())
         return std::nullopt;
@@ -414,8 +420,9 @@ std::optional<ConversationInfo> ConversationDao::findById(int id)
 
 std::optional<ConversationInfo> ConversationDao::findByPlatformId(const QString& platform, const QString& platformConvId)
 {
-    QSqlQuery q(Database::getInstance().connection());
-    q.prepare("SELECT * FROM conversations WHERE platform = :p AND platform_conversation_id = :pcid");
+    CachedQuery stmt = Database::getInstance().prepareCached(QStringLiteral(
+        "SELECT * FROM conversations WHERE platform = :p AND platform_conversation_id = :pcid"));
+    QSqlQuery& q = stmt.query();
     q.bindValue(":p", platform);
     q.bindValue(":pcid", platformConvId);
     if (!q.exec())
@@ -442,13 +449,13 @@ QVector<ConversationInfo> ConversationDao::listByStatus(const QString& status, i
 
 QVector<ConversationInfo> ConversationDao::listAll(int limit, int offset)
 {
-    QSqlQuery q(Database::getInstance().connection());
     const QString deletedFilter = tableHasColumn(QStringLiteral("conversations"), QStringLiteral("deleted_at"))
         ? QStringLiteral("WHERE deleted_at IS NULL OR deleted_at = ''")
         : QString();
-    q.prepare(QStringLiteral(
+    CachedQuery stmt = Database::getInstance().prepareCached(QStringLiteral(
         "SELECT * FROM conversations %1 "
         "ORDER BY last_time DESC, id DESC LIMIT :lim OFFSET :off").arg(deletedFilter));
+    QSqlQuery& q = stmt.query();
     q.bindValue(":lim", limit);
     q.bindValue(":off", offset);
     q.exec();
@@ -479,9 +486,12 @@ bool ConversationDao::updateDisplayName(int id, const QString& customerName)
 
 bool ConversationDao::updateLastMessage(int id, const QString& lastMessage, const QDateTime& lastTime)
 {
-    QSqlQuery q(Database::getInstance().connection());
-    q.prepare("UPDATE conversations SET last_message = :msg, last_time = :t, "
-              "updated_at = datetime('now','localtime') WHERE id = :id");
+    static Metrics::Histogram* const latency = Metrics::dbStatementLatency("ConversationDao::updateLastMessage");
+    Metrics::ScopedTimer timer(latency);
+    CachedQuery stmt = Database::getInstance().prepareCached(QStringLiteral(
+        "UPDATE conversations SET last_message = :msg, last_time = :t, "
+        "updated_at = datetime('now','localtime') WHERE id = :id"));
+    QSqlQuery& q = stmt.query();
     q.bindValue(":msg", lastMessage);
     q.bindValue(":t", lastTime);
     q.bindValue(":id", id);
@@ -494,17 +504,21 @@ bool ConversationDao::updateLastMessage(int id, const QString& lastMessage, cons
 
 bool ConversationDao::incrementUnread(int id)
 {
-    QSqlQuery q(Database::getInstance().connection());
-    q.prepare("UPDATE conversations SET unread_count = unread_count + 1, "
-              "updated_at = datetime('now','localtime') WHERE id = :id");
+    static Metrics::Histogram* const latency = Metrics::dbStatementLatency("ConversationDao::incrementUnread");
+    Metrics::ScopedTimer timer(latency);
+    CachedQuery stmt = Database::getInstance().prepareCached(QStringLiteral(
+        "UPDATE conversations SET unread_count = unread_count + 1, "
+        "updated_at = datetime('now','localtime') WHERE id = :id"));
+    QSqlQuery& q = stmt.query();
     q.bindValue(":id", id);
     return q.exec();
 }
 
 bool ConversationDao::clearUnread(int id)
 {
-    QSqlQuery q(Database::getInstance().connection());
-    q.prepare("UPDATE conversations SET unread_count = 0, updated_at = datetime('now','localtime') WHERE id = :id");
+    CachedQuery stmt = Database::getInstance().prepareCached(QStringLiteral(
+        "UPDATE conversations SET unread_count = 0, updated_at = datetime('now','localtime') WHERE id = :id"));
+    QSqlQuery& q = stmt.query();
     q.bindValue(":id", id);
     return q.exec();
 }
@@ -14,7 +14,8 @@ std::optional<CustomerProfileRecord> CustomerProfileDao::findByConversationId(in
 
     QSqlQuery q(Database::getInstance().connection());
     q.prepare(QStringLiteral(
-        "SELECT conversation_id, profile_json, source_model_key, source_request_event_id, updated_at "
+        "SELECT conversation_id, profile_json, source_model_key, source_request_event_id, updated_at, "
+        "       last_message_id "
         "FROM conversation_customer_profiles WHERE conversation_id = :conversationId"));
     q.bindValue(QStringLiteral(":conversationId"), conversationId);
     if (!q.exec()) {
@@ -32,13 +33,15 @@ std::optional<CustomerProfileRecord> CustomerProfileDao::findByConversationId(in
     record.sourceModelKey = q.value(2).toString();
     record.sourceRequestEventId = q.value(3).toLongLong();
     record.updatedAt = q.value(4).toDateTime();
+    record.lastMessageId = q.value(5).toLongLong();
     return record;
 }
 
 bool CustomerProfileDao::upsert(int conversationId,
                                 const QJsonObject& profile,
                                 const QString& sourceModelKey,
-                                qint64 sourceRequestEventId)
+                                qint64 sourceRequestEventId,
+                                qint64 lastMessageId)
 {
     if (conversationId <= 0 || profile.isEmpty())
         return false;
@@ -47,13 +50,15 @@ bool CustomerProfileDao::upsert(int conversationId,
     QSqlQuery q(Database::getInstance().connection());
     q.prepare(QStringLiteral(
         "INSERT INTO conversation_customer_profiles "
-        "(conversation_id, profile_json, source_model_key, source_request_event_id, created_at, updated_at) "
-        "VALUES (:conversationId, :profileJson, :sourceModelKey, :sourceRequestEventId, "
+        "(conversation_id, profile_json, source_model_key, source_request_event_id, last_message_id, "
+        " created_at, updated_at) "
+        "VALUES (:conversationId, :profileJson, :sourceModelKey, :sourceRequestEventId, :lastMessageId, "
         "        datetime('now','localtime'), datetime('now','localtime')) "
         "ON CONFLICT(conversation_id) DO UPDATE SET "
         "  profile_json = excluded.profile_json, "
         "  source_model_key = excluded.source_model_key, "
         "  source_request_event_id = excluded.source_request_event_id, "
+        "  last_message_id = MAX(last_message_id, excluded.last_message_id), "
         "  updated_at = datetime('now','localtime')"));
     q.bindValue(QStringLiteral(":conversationId"), conversationId);
     q.bindValue(QStringLiteral(":profileJson"), json);
@@ -62,6 +67,7 @@ bool CustomerProfileDao::upsert(int conversationId,
         q.bindValue(QStringLiteral(":sourceRequestEventId"), sourceRequestEventId);
     else
         q.bindValue(QStringLiteral(":sourceRequestEventId"), QVariant());
+    q.bindValue(QStringLiteral(":lastMessageId"), qMax<qint64>(0, lastMessageId));
     if (!q.exec()) {
         qWarning() << "CustomerProfileDao::upsert failed:" << q.lastError().text();
         return false;
@@ -69,6 +75,25 @@ bool CustomerProfileDao::upsert(int conversationId,
     return true;
 }
 
+bool CustomerProfileDao::advanceLastMessageId(int conversationId, qint64 lastMessageId)
+{
+    if (conversationId <= 0 || lastMessageId <= 0)
+        return false;
+
+    QSqlQuery q(Database::getInstance().connection());
+    q.prepare(QStringLiteral(
+        "UPDATE conversation_customer_profiles "
+        "SET last_message_id = MAX(last_message_id, :lastMessageId) "
+        "WHERE conversation_id = :conversationId"));
+    q.bindValue(QStringLiteral(":lastMessageId"), lastMessageId);
+    q.bindValue(QStringLiteral(":conversationId"), conversationId);
+    if (!q.exec()) {
+        qWarning() << "CustomerProfileDao::advanceLastMessageId failed:" << q.lastError().text();
+        return false;
+    }
+    return q.numRowsAffected() > 0;
+}
+
 bool CustomerProfileDao::remove(int conversationId)
 {
     if (conversationId <= 0)
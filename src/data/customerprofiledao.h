@@ -11,6 +11,8 @@ struct CustomerProfileRecord {
     QJsonObject profile;
     QString sourceModelKey;
     qint64 sourceRequestEventId = 0;
+    /** 本次画像已覆盖到的最后一条消息 id（高水位），之后的消息才需要增量合并。 */
+    qint64 lastMessageId = 0;
     QDateTime updatedAt;
 };
 
@@ -23,7 +25,10 @@ public:
     bool upsert(int conversationId,
                 const QJsonObject& profile,
                 const QString& sourceModelKey,
-                qint64 sourceRequestEventId);
+                qint64 sourceRequestEventId,
+                qint64 lastMessageId);
+    /** 只推进高水位（不变更画像内容），用于新增消息里没有可整理内容的情况。 */
+    bool advanceLastMessageId(int conversationId, qint64 lastMessageId);
     bool remove(int conversationId);
 };
 
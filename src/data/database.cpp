@@ -9,6 +9,7 @@
 #include <QStandardPaths>
 #include <QDebug>
 #include <QStringList>
+#include <utility>
 
 namespace {
 
@@ -110,6 +111,7 @@ bool Database::open(const QString& path)
         }
     }
 
+    clearStatementCache();
     QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE");
     db.setDatabaseName(m_path);
 
@@ -142,6 +144,8 @@ bool Database::open(const QString& path)
 
 void Database::close()
 {
+    // 缓存的语句持有连接，必须先于 removeDatabase 释放
+    clearStatementCache();
     const QString connectionName = QSqlDatabase::defaultConnection;
     if (QSqlDatabase::contains(connectionName)) {
         {
@@ -165,6 +169,56 @@ QSqlDatabase Database::connection() const
     return QSqlDatabase::database();
 }
 
+CachedQuery::~CachedQuery()
+{
+    QSqlQuery& q = query();
+    // 重置底层 sqlite3_stmt，避免未读完的 SELECT 一直占着读事务
+    q.finish();
+    if (m_slot)
+        m_slot->inUse = false;
+}
+
+CachedQuery Database::prepareCached(const QString& sql)
+{
+    const auto it = m_statements.constFind(sql);
+    if (it != m_statements.constEnd() && !it.value()->inUse) {
+        const std::shared_ptr<CachedQuery::Slot>& slot = it.value();
+        QSqlQuery& q = slot->query;
+        // 清掉上一次的绑定值，漏绑的占位符按 NULL 处理而不是沿用旧值
+        const int bound = q.boundValues().size();
+        for (int i = 0; i < bound; ++i)
+            q.bindValue(i, QVariant());
+        slot->inUse = true;
+        return CachedQuery(slot);
+    }
+
+    ++m_statementPrepareCount;
+    if (it != m_statements.constEnd() || m_statements.size() >= kMaxCachedStatements) {
+        QSqlQuery q(connection());
+        q.prepare(sql);
+        return CachedQuery(std::move(q));
+    }
+
+    auto slot = std::make_shared<CachedQuery::Slot>(connection());
+    if (!slot->query.prepare(sql)) {
+        // 准备失败不入缓存，错误留在 lastError() 里由调用方在 exec() 失败时报告
+        return CachedQuery(std::move(slot->query));
+    }
+    slot->inUse = true;
+    m_statements.insert(sql, slot);
+    return CachedQuery(slot);
+}
+
+void Database::clearStatementCache()
+{
+    for (const auto& slot : std::as_const(m_statements)) {
+        if (slot->inUse)
+            qWarning() << "[Database] 关闭连接时仍有预编译语句在使用中";
+        slot->query.finish();
+    }
+    m_statements.clear();
+}
+
 bool Database::runClientPrivateMigrations()
 {
     QSqlQuery q(connection());
@@ -210,6 +264,10 @@ bool Database::runClientPrivateMigrations()
         "  duration_ms INTEGER DEFAULT 0,"
         "  first_token_ms INTEGER DEFAULT 0,"
         "  output_chars INTEGER DEFAULT 0,"
+        "  estimated_prompt_tokens INTEGER DEFAULT 0,"
+        "  prompt_tokens INTEGER DEFAULT 0,"
+        "  cached_prompt_tokens INTEGER DEFAULT 0,"
+        "  completion_tokens INTEGER DEFAULT 0,"
         "  error_reason TEXT DEFAULT '',"
         "  created_at DATETIME DEFAULT CURRENT_TIMESTAMP,"
         "  FOREIGN KEY(conversation_id) REFERENCES conversations(id) ON DELETE SET NULL,"
@@ -237,12 +295,33 @@ bool Database::runClientPrivateMigrations()
         "  profile_json TEXT NOT NULL DEFAULT '{}',"
         "  source_model_key TEXT DEFAULT '',"
         "  source_request_event_id INTEGER,"
+        "  last_message_id INTEGER DEFAULT 0,"
         "  created_at DATETIME DEFAULT CURRENT_TIMESTAMP,"
         "  updated_at DATETIME DEFAULT CURRENT_TIMESTAMP,"
         "  FOREIGN KEY(conversation_id) REFERENCES conversations(id) ON DELETE CASCADE,"
         "  FOREIGN KEY(source_request_event_id) REFERENCES ai_request_events(id) ON DELETE SET NULL"
         ")",
 
+        "CREATE TABLE IF NOT EXISTS outbound_send_queue ("
+        "  id INTEGER PRIMARY KEY AUTOINCREMENT,"
+        "  platform TEXT NOT NULL,"
+        "  account_id TEXT NOT NULL DEFAULT '',"
+        "  conversation_key TEXT NOT NULL,"
+        "  client_message_id TEXT NOT NULL UNIQUE,"
+        "  part_type TEXT NOT NULL DEFAULT 'text',"
+        "  text TEXT DEFAULT '',"
+        "  local_path TEXT DEFAULT '',"
+        "  file_name TEXT DEFAULT '',"
+        "  mime_type TEXT DEFAULT '',"
+        "  size_bytes INTEGER DEFAULT 0,"
+        "  state TEXT NOT NULL DEFAULT 'queued',"
+        "  attempts INTEGER DEFAULT 0,"
+        "  enqueued_at DATETIME DEFAULT CURRENT_TIMESTAMP,"
+        "  dispatched_at DATETIME"
+        ")",
+        "CREATE INDEX IF NOT EXISTS idx_outbound_send_queue_account "
+        "  ON outbound_send_queue(platform, account_id, id)",
+
         "CREATE TABLE IF NOT EXISTS ai_assistant_sessions ("
         "  id INTEGER PRIMARY KEY AUTOINCREMENT,"
         "  user_id INTEGER NOT NULL,"
@@ -269,6 +348,15 @@ bool Database::runClientPrivateMigrations()
         "ALTER TABLE users ADD COLUMN display_name TEXT DEFAULT ''",
         "ALTER TABLE users ADD COLUMN bio TEXT DEFAULT ''",
         "ALTER TABLE users ADD COLUMN avatar_path TEXT DEFAULT ''",
+        "ALTER TABLE ai_request_events ADD COLUMN estimated_prompt_tokens INTEGER DEFAULT 0",
+        "ALTER TABLE ai_request_events ADD COLUMN prompt_tokens INTEGER DEFAULT 0",
+        "ALTER TABLE ai_request_events ADD COLUMN cached_prompt_tokens INTEGER DEFAULT 0",
+        "ALTER TABLE ai_request_events ADD COLUMN completion_tokens INTEGER DEFAULT 0",
+        "ALTER TABLE conversation_customer_profiles ADD COLUMN last_message_id INTEGER DEFAULT 0",
+        "ALTER TABLE ai_request_events ADD COLUMN hedge_loser_session_model_key TEXT DEFAULT ''",
+        "ALTER TABLE ai_request_events ADD COLUMN hedge_loser_first_token_ms INTEGER DEFAULT 0",
+        "CREATE INDEX IF NOT EXISTS idx_ai_request_events_hedge_loser "
+        "ON ai_request_events(hedge_loser_session_model_key, id)",
     };
 
     for (const char* sql : requiredMigrations) {
@@ -314,6 +402,8 @@ bool Database::runMigrations()
         "  status TEXT DEFAULT 'new',"
         "  cache_scope TEXT NOT NULL DEFAULT 'local_cache',"
         "  cache_origin TEXT NOT NULL DEFAULT 'legacy_runtime',"
+        "  last_message_id INTEGER DEFAULT 0,"
+        "  last_direction TEXT DEFAULT '',"
         "  updated_at DATETIME,"
         "  deleted_at DATETIME,"
         "  created_at DATETIME DEFAULT CURRENT_TIMESTAMP,"
@@ -356,6 +446,10 @@ bool Database::runMigrations()
 
         "CREATE INDEX IF NOT EXISTS idx_messages_conv_id ON messages(conversation_id)",
         "CREATE INDEX IF NOT EXISTS idx_conversations_status ON conversations(status)",
+        // 热点查询的复合索引：按方向取最近一条、按时间分页、会话列表按最后消息时间排序
+        "CREATE INDEX IF NOT EXISTS idx_messages_conv_direction ON messages(conversation_id, direction)",
+        "CREATE INDEX IF NOT EXISTS idx_messages_conv_created ON messages(conversation_id, created_at)",
+        "CREATE INDEX IF NOT EXISTS idx_conversations_last_time ON conversations(last_time)",
 
         "CREATE TABLE IF NOT EXISTS message_send_events ("
         "  id INTEGER PRIMARY KEY AUTOINCREMENT,"
@@ -383,6 +477,10 @@ bool Database::runMigrations()
         "  duration_ms INTEGER DEFAULT 0,"
         "  first_token_ms INTEGER DEFAULT 0,"
         "  output_chars INTEGER DEFAULT 0,"
+        "  estimated_prompt_tokens INTEGER DEFAULT 0,"
+        "  prompt_tokens INTEGER DEFAULT 0,"
+        "  cached_prompt_tokens INTEGER DEFAULT 0,"
+        "  completion_tokens INTEGER DEFAULT 0,"
         "  error_reason TEXT DEFAULT '',"
         "  created_at DATETIME DEFAULT CURRENT_TIMESTAMP,"
         "  FOREIGN KEY(conversation_id) REFERENCES conversations(id) ON DELETE SET NULL,"
@@ -409,12 +507,33 @@ bool Database::runMigrations()
         "  profile_json TEXT NOT NULL DEFAULT '{}',"
         "  source_model_key TEXT DEFAULT '',"
         "  source_request_event_id INTEGER,"
+        "  last_message_id INTEGER DEFAULT 0,"
         "  created_at DATETIME DEFAULT CURRENT_TIMESTAMP,"
         "  updated_at DATETIME DEFAULT CURRENT_TIMESTAMP,"
         "  FOREIGN KEY(conversation_id) REFERENCES conversations(id) ON DELETE CASCADE,"
         "  FOREIGN KEY(source_request_event_id) REFERENCES ai_request_events(id) ON DELETE SET NULL"
         ")",
 
+        "CREATE TABLE IF NOT EXISTS outbound_send_queue ("
+        "  id INTEGER PRIMARY KEY AUTOINCREMENT,"
+        "  platform TEXT NOT NULL,"
+        "  account_id TEXT NOT NULL DEFAULT '',"
+        "  conversation_key TEXT NOT NULL,"
+        "  client_message_id TEXT NOT NULL UNIQUE,"
+        "  part_type TEXT NOT NULL DEFAULT 'text',"
+        "  text TEXT DEFAULT '',"
+        "  local_path TEXT DEFAULT '',"
+        "  file_name TEXT DEFAULT '',"
+        "  mime_type TEXT DEFAULT '',"
+        "  size_bytes INTEGER DEFAULT 0,"
+        "  state TEXT NOT NULL DEFAULT 'queued',"
+        "  attempts INTEGER DEFAULT 0,"
+        "  enqueued_at DATETIME DEFAULT CURRENT_TIMESTAMP,"
+        "  dispatched_at DATETIME"
+        ")",
+        "CREATE INDEX IF NOT EXISTS idx_outbound_send_queue_account "
+        "  ON outbound_send_queue(platform, account_id, id)",
+
         "CREATE TABLE IF NOT EXISTS wechat_conversations ("
         "  id INTEGER PRIMARY KEY AUTOINCREMENT,"
         "  conversation_id INTEGER NOT NULL UNIQUE,"
@@ -559,6 +678,43 @@ bool Database::runMigrations()
         "CREATE INDEX IF NOT EXISTS idx_messages_client_message_id ON messages(client_message_id)",
         "ALTER TABLE messages ADD COLUMN cache_scope TEXT NOT NULL DEFAULT 'local_cache'",
         "ALTER TABLE messages ADD COLUMN cache_origin TEXT NOT NULL DEFAULT 'legacy_runtime'",
+        // 部分索引依赖 cache_origin，旧库要等上面的 ALTER 补齐列后才能建
+        "CREATE INDEX IF NOT EXISTS idx_messages_snapshot_cache ON messages(conversation_id) WHERE cache_origin = 'server_snapshot_cache'",
+        // 会话最后一条消息的 id/方向冗余到 conversations，由下面的触发器维护；
+        // 列表刷新按会话行读取，不再每次对 messages 做 GROUP BY
+        "ALTER TABLE conversations ADD COLUMN last_message_id INTEGER DEFAULT 0",
+        "ALTER TABLE conversations ADD COLUMN last_direction TEXT DEFAULT ''",
+        "CREATE INDEX IF NOT EXISTS idx_conversations_last_message ON conversations(last_message_id, last_direction)",
+        // 回填旧库：只处理还没有 last_message_id 的会话，已回填或无消息的会话每次启动只走一次索引查找
+        "UPDATE conversations SET "
+        "  last_message_id = COALESCE((SELECT MAX(m.id) FROM messages m WHERE m.conversation_id = conversations.id), 0),"
+        "  last_direction = COALESCE((SELECT m.direction FROM messages m WHERE m.conversation_id = conversations.id "
+        "                             ORDER BY m.id DESC LIMIT 1), '') "
+        "WHERE COALESCE(last_message_id, 0) = 0",
+        "CREATE TRIGGER IF NOT EXISTS trg_messages_last_direction_insert AFTER INSERT ON messages BEGIN "
+        "  UPDATE conversations SET last_message_id = NEW.id, last_direction = NEW.direction "
+        "  WHERE id = NEW.conversation_id AND COALESCE(last_message_id, 0) <= NEW.id; "
+        "END",
+        // 会话键归一化会把消息挪到规范会话下，两边都要重算
+        "CREATE TRIGGER IF NOT EXISTS trg_messages_last_direction_update "
+        "AFTER UPDATE OF conversation_id, direction ON messages BEGIN "
+        "  UPDATE conversations SET last_message_id = NEW.id, last_direction = NEW.direction "
+        "  WHERE id = NEW.conversation_id AND COALESCE(last_message_id, 0) <= NEW.id; "
+        "  UPDATE conversations SET "
+        "    last_message_id = COALESCE((SELECT MAX(m.id) FROM messages m WHERE m.conversation_id = OLD.conversation_id), 0),"
+        "    last_direction = COALESCE((SELECT m.direction FROM messages m WHERE m.conversation_id = OLD.conversation_id "
+        "                               ORDER BY m.id DESC LIMIT 1), '') "
+        "  WHERE id = OLD.conversation_id AND OLD.conversation_id <> NEW.conversation_id "
+        "    AND last_message_id = OLD.id; "
+        "END",
+        // 只有删掉的正好是最后一条时才重算（快照对账删除多为中间的旧消息）
+        "CREATE TRIGGER IF NOT EXISTS trg_messages_last_direction_delete AFTER DELETE ON messages BEGIN "
+        "  UPDATE conversations SET "
+        "    last_message_id = COALESCE((SELECT MAX(m.id) FROM messages m WHERE m.conversation_id = OLD.conversation_id), 0),"
+        "    last_direction = COALESCE((SELECT m.direction FROM messages m WHERE m.conversation_id = OLD.conversation_id "
+        "                               ORDER BY m.id DESC LIMIT 1), '') "
+        "  WHERE id = OLD.conversation_id AND last_message_id = OLD.id; "
+        "END",
         "ALTER TABLE wechat_conversations ADD COLUMN session_control_hash TEXT DEFAULT ''",
         "ALTER TABLE wechat_conversations ADD COLUMN last_unread_badge INTEGER DEFAULT 0",
         "ALTER TABLE wechat_conversations ADD COLUMN last_observed_at DATETIME",
@@ -605,6 +761,11 @@ bool Database::runMigrations()
         "INSERT OR IGNORE INTO wechat_messages (message_id, conversation_id, platform_message_id, source_type, confidence, verification_status, original_timestamp, content_image_path, evidence_ref, raw_payload_json) SELECT m.id, m.conversation_id, m.platform_message_id, m.source_type, m.confidence, m.verification_status, m.original_timestamp, m.content_image_path, m.content_image_path, '{}' FROM messages m JOIN conversations c ON c.id = m.conversation_id WHERE c.platform = 'wechat'",
         "INSERT OR IGNORE INTO qianniu_messages (message_id, conversation_id, platform_message_id, source_type, confidence, verification_status, original_timestamp, content_image_path, evidence_ref, raw_payload_json) SELECT m.id, m.conversation_id, m.platform_message_id, m.source_type, m.confidence, m.verification_status, m.original_timestamp, m.content_image_path, m.content_image_path, '{}' FROM messages m JOIN conversations c ON c.id = m.conversation_id WHERE c.platform = 'qianniu'",
         "CREATE INDEX IF NOT EXISTS idx_qianniu_messages_platform_message_id ON qianniu_messages(platform_message_id)",
+        // 删除会话释放媒体时按路径反查引用（Python 服务 truth_store），两列各建索引
+        "CREATE INDEX IF NOT EXISTS idx_wechat_messages_content_image_path ON wechat_messages(content_image_path)",
+        "CREATE INDEX IF NOT EXISTS idx_wechat_messages_evidence_ref ON wechat_messages(evidence_ref)",
+        "CREATE INDEX IF NOT EXISTS idx_qianniu_messages_content_image_path ON qianniu_messages(content_image_path)",
+        "CREATE INDEX IF NOT EXISTS idx_qianniu_messages_evidence_ref ON qianniu_messages(evidence_ref)",
         "ALTER TABLE messages DROP COLUMN platform_msg_id",
         "ALTER TABLE messages DROP COLUMN sync_status",
         "ALTER TABLE messages DROP COLUMN original_timestamp",
@@ -614,6 +775,15 @@ bool Database::runMigrations()
         "ALTER TABLE messages DROP COLUMN verification_status",
         "ALTER TABLE messages DROP COLUMN observed_at",
         "DROP TABLE IF EXISTS rpa_inbox_messages",
+        "ALTER TABLE ai_request_events ADD COLUMN estimated_prompt_tokens INTEGER DEFAULT 0",
+        "ALTER TABLE ai_request_events ADD COLUMN prompt_tokens INTEGER DEFAULT 0",
+        "ALTER TABLE ai_request_events ADD COLUMN cached_prompt_tokens INTEGER DEFAULT 0",
+        "ALTER TABLE ai_request_events ADD COLUMN completion_tokens INTEGER DEFAULT 0",
+        "ALTER TABLE conversation_customer_profiles ADD COLUMN last_message_id INTEGER DEFAULT 0",
+        "ALTER TABLE ai_request_events ADD COLUMN hedge_loser_session_model_key TEXT DEFAULT ''",
+        "ALTER TABLE ai_request_events ADD COLUMN hedge_loser_first_token_ms INTEGER DEFAULT 0",
+        "CREATE INDEX IF NOT EXISTS idx_ai_request_events_hedge_loser "
+        "ON ai_request_events(hedge_loser_session_model_key, id)",
     };
 
     for (const char* sql : requiredMigrations) {
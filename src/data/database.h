@@ -1,16 +1,56 @@
 #ifndef DATABASE_H
 #define DATABASE_H
 
+#include <QHash>
 #include <QSqlDatabase>
+#include <QSqlQuery>
 #include <QString>
+#include <QStringList>
+#include <memory>
+#include <optional>
+
+/**
+ * 从预编译语句缓存借出的查询，析构时 finish() 并归还。
+ *
+ * 借出时已清空上次绑定的参数，调用方必须重新绑定全部占位符；
+ * 同一条 SQL 正被外层借用（嵌套调用）或缓存已满时退化为一次性语句。
+ */
+class CachedQuery {
+public:
+    ~CachedQuery();
+    CachedQuery(const CachedQuery&) = delete;
+    CachedQuery& operator=(const CachedQuery&) = delete;
+
+    QSqlQuery& query() { return m_slot ? m_slot->query : *m_oneShot; }
+
+private:
+    friend class Database;
+    struct Slot {
+        explicit Slot(const QSqlDatabase& db) : query(db) {}
+        QSqlQuery query;
+        bool inUse = false;
+    };
+
+    explicit CachedQuery(std::shared_ptr<Slot> slot) : m_slot(std::move(slot)) {}
+    explicit CachedQuery(QSqlQuery&& oneShot) : m_oneShot(std::move(oneShot)) {}
+
+    std::shared_ptr<Slot> m_slot;
+    std::optional<QSqlQuery> m_oneShot;
+};
 
 class Database {
 private:
     Database() = default;
     ~Database() = default;
+    void clearStatementCache();
+
     QString m_path;
     bool m_unifiedAppDataMode = false;
+    QHash<QString, std::shared_ptr<CachedQuery::Slot>> m_statements;
+    int m_statementPrepareCount = 0;
 public:
+    static constexpr int kMaxCachedStatements = 128;
+
     static Database& getInstance() {
         static Database db;
         return db;
@@ -19,6 +59,16 @@ public:
     void close();
     bool isOpen() const;
     QSqlDatabase connection() const;
+    /**
+     * 按 SQL 文本复用默认连接上的预编译语句；只用于 SQL 文本固定的热点语句，
+     * 拼接了 IN (...) 等可变部分的语句仍应直接 prepare。
+     */
+    CachedQuery prepareCached(const QString& sql);
+    int cachedStatementCount() const { return m_statements.size(); }
+    /** 当前缓存中的 SQL 文本，供查询计划回归测试逐条 EXPLAIN。 */
+    QStringList cachedStatementSql() const { return m_statements.keys(); }
+    /** prepareCached 实际调用 prepare() 的次数（含一次性语句），用于确认缓存命中。 */
+    int statementPrepareCount() const { return m_statementPrepareCount; }
     bool runMigrations();
     bool runClientPrivateMigrations();
     bool normalizePlatformConversationKeys();
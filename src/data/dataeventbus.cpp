@@ -0,0 +1,7 @@
+#include "dataeventbus.h"
+
+DataEventBus& DataEventBus::instance()
+{
+    static DataEventBus bus;
+    return bus;
+}
@@ -0,0 +1,36 @@
+#ifndef DATAEVENTBUS_H
+#define DATAEVENTBUS_H
+
+#include "airequesteventdao.h"
+#include "messagesendeventdao.h"
+
+#include <QMetaType>
+#include <QObject>
+
+/**
+ * 事件表写入通知。
+ *
+ * DAO 在本进程写入一行事件后在这里发出带完整记录的信号，界面据此直接追加，
+ * 不必轮询事件表。其他进程（Python 侧边车）写入的行不会经过这里，订阅方需要
+ * 按 id 是否连续判断漏掉的行，再用 listSince 补齐。
+ *
+ * 信号可能在任意线程发出，跨线程连接按排队方式投递。
+ */
+class DataEventBus : public QObject
+{
+    Q_OBJECT
+public:
+    static DataEventBus& instance();
+
+signals:
+    void messageSendEventAppended(const MessageSendEventRecord& event);
+    void aiStageEventAppended(const AiRequestStageEventRecord& event);
+
+private:
+    DataEventBus() = default;
+};
+
+Q_DECLARE_METATYPE(MessageSendEventRecord)
+Q_DECLARE_METATYPE(AiRequestStageEventRecord)
+
+#endif // DATAEVENTBUS_H
@@ -1,7 +1,9 @@
 #include "messagedao.h"
 #include "database.h"
+#include "../utils/metrics.h"
 #include "qianniuconversationdao.h"
 #include "wechatmessagedao.h"
+#include <algorithm>
 #include <QDebug>
 #include <QJsonObject>
 #include <QSet>
@@ -116,22 +118,21 @@ int existingSnapshotMessageId(int conversationId,
     if (conversationId <= 0)
         return 0;
 
-    QSqlQuery q(Database::getInstance().connection());
-    if (!platformMsgId.isEmpty()) {
-        q.prepare(QStringLiteral(
-            "SELECT id FROM messages WHERE conversation_id = :cid "
-            "AND platform_message_id = :pmid ORDER BY id DESC LIMIT 1"));
-        q.bindValue(QStringLiteral(":cid"), conversationId);
+    if (platformMsgId.isEmpty() && clientMessageId.isEmpty())
+        return 0;
+
+    const bool byPlatformId = !platformMsgId.isEmpty();
+    CachedQuery stmt = Database::getInstance().prepareCached(byPlatformId
+        ? QStringLiteral("SELECT id FROM messages WHERE conversation_id = :cid "
+                         "AND platform_message_id = :pmid ORDER BY id DESC LIMIT 1")
+        : QStringLiteral("SELECT id FROM messages WHERE conversation_id = :cid "
+                         "AND client_message_id = :cmid ORDER BY id DESC LIMIT 1"));
+    QSqlQuery& q = stmt.query();
+    q.bindValue(QStringLiteral(":cid"), conversationId);
+    if (byPlatformId)
         q.bindValue(QStringLiteral(":pmid"), platformMsgId);
-    } else if (!clientMessageId.isEmpty()) {
-        q.prepare(QStringLiteral(
-            "SELECT id FROM messages WHERE conversation_id = :cid "
-            "AND client_message_id = :cmid ORDER BY id DESC LIMIT 1"));
-        q.bindValue(QStringLiteral(":cid"), conversationId);
+    else
         q.bindValue(QStringLiteral(":cmid"), clientMessageId);
-    } else {
-        return 0;
-    }
 
     if (!q.exec() || !q.next())
         return 0;
@@ -171,6 +172,19 @@ bool tableExists(const QString& tableName)
     return q.exec() && q.next();
 }
 
+bool tableHasColumn(const QString& tableName, const QString& columnName)
+{
+    QSqlQuery q(Database::getInstance().connection());
+    q.prepare(QStringLiteral("PRAGMA table_info(%1)").arg(tableName));
+    if (!q.exec())
+        return false;
+    while (q.next()) {
+        if (q.value(1).toString() == columnName)
+            return true;
+    }
+    return false;
+}
+
 } // namespace
 
 static MessageRecord messageRecordFromQuery(QSqlQuery& q)
@@ -212,6 +226,7 @@ static MessageRecord messageRecordFromQuery(QSqlQuery& q)
     m.cacheOrigin = rowString(q, QStringLiteral("cache_origin"));
     if (m.cacheOrigin.isEmpty())
         m.cacheOrigin = QStringLiteral("legacy_runtime");
+    MessageAtoms::compact(m);
     return m;
 }
 
@@ -265,14 +280,17 @@ int MessageDao::create(int conversationId, const QString& direction,
 
 int MessageDao::create(const Models::Message& message)
 {
-    QSqlQuery q(Database::getInstance().connection());
-    q.prepare("INSERT INTO messages (conversation_id, platform_message_id, client_message_id, "
-              "direction, sender, sender_name, content_type, content, status, error_reason, "
-              "message_time, cache_scope, cache_origin, created_at, updated_at) "
-              "VALUES (:cid, :pmid, :cmid, :dir, :sender, :sname, :ctype, :content, :status, "
-              ":reason, :message_time, :cache_scope, :cache_origin, "
-              "COALESCE(:message_time, datetime('now','localtime')), "
-              "COALESCE(:message_time, datetime('now','localtime')))");
+    static Metrics::Histogram* const latency = Metrics::dbStatementLatency("MessageDao::create");
+    Metrics::ScopedTimer timer(latency);
+    CachedQuery stmt = Database::getInstance().prepareCached(QStringLiteral(
+        "INSERT INTO messages (conversation_id, platform_message_id, client_message_id, "
+        "direction, sender, sender_name, content_type, content, status, error_reason, "
+        "message_time, cache_scope, cache_origin, created_at, updated_at) "
+        "VALUES (:cid, :pmid, :cmid, :dir, :sender, :sname, :ctype, :content, :status, "
+        ":reason, :message_time, :cache_scope, :cache_origin, "
+        "COALESCE(:message_time, datetime('now','localtime')), "
+        "COALESCE(:message_time, datetime('now','localtime')))"));
+    QSqlQuery& q = stmt.query();
     const QString legacyDirection = Models::legacyDirectionFromMessageDirection(message.direction);
     const QString clientMessageId = message.clientMessageId.isEmpty()
         ? message.metadata.value(QStringLiteral("client_message_id")).toString()
@@ -329,6 +347,8 @@ int MessageDao::createOutboundCacheMessage(const Models::Message& message)
 
 int MessageDao::upsertSnapshotCacheMessage(int conversationId, const QJsonObject& message)
 {
+    static Metrics::Histogram* const latency = Metrics::dbStatementLatency("MessageDao::upsertSnapshotCacheMessage");
+    Metrics::ScopedTimer timer(latency);
     if (conversationId <= 0)
         return -1;
 
@@ -363,9 +383,9 @@ int MessageDao::upsertSnapshotCacheMessage(int conversationId, const QJsonObject
     const QString createdAt = jsonString(message, QStringLiteral("created_at"));
     const QString updatedAt = jsonString(message, QStringLiteral("updated_at"));
 
-    QSqlQuery q(Database::getInstance().connection());
-    if (existingId > 0) {
-        q.prepare(QStringLiteral(
+    // UPDATE 与 INSERT 各自缓存一条预编译语句，快照批量同步时不再逐行 prepare
+    CachedQuery stmt = Database::getInstance().prepareCached(existingId > 0
+        ? QStringLiteral(
             "UPDATE messages SET "
             "direction = :direction, "
             "content = :content, "
@@ -380,10 +400,8 @@ int MessageDao::upsertSnapshotCacheMessage(int conversationId, const QJsonObject
             "cache_scope = 'local_cache', "
             "cache_origin = 'server_snapshot_cache', "
             "updated_at = COALESCE(NULLIF(:updated_at, ''), datetime('now','localtime')) "
-            "WHERE id = :id"));
-        q.bindValue(QStringLiteral(":id"), existingId);
-    } else {
-        q.prepare(QStringLiteral(
+            "WHERE id = :id")
+        : QStringLiteral(
             "INSERT INTO messages (conversation_id, platform_message_id, client_message_id, "
             "direction, sender, sender_name, content_type, content, status, error_reason, "
             "message_time, cache_scope, cache_origin, created_at, updated_at) "
@@ -393,6 +411,10 @@ int MessageDao::upsertSnapshotCacheMessage(int conversationId, const QJsonObject
             "'local_cache', 'server_snapshot_cache', "
             "COALESCE(NULLIF(:created_at, ''), datetime('now','localtime')), "
             "COALESCE(NULLIF(:updated_at, ''), COALESCE(NULLIF(:created_at, ''), datetime('now','localtime'))))"));
+    QSqlQuery& q = stmt.query();
+    if (existingId > 0) {
+        q.bindValue(QStringLiteral(":id"), existingId);
+    } else {
         q.bindValue(QStringLiteral(":cid"), conversationId);
         q.bindValue(QStringLiteral(":created_at"), createdAt);
     }
@@ -416,23 +438,17 @@ int MessageDao::upsertSnapshotCacheMessage(int conversationId, const QJsonObject
     return existingId > 0 ? existingId : q.lastInsertId().toInt();
 }
 
-int MessageDao::deleteMissingSnapshotCacheMessages(
-    int conversationId,
-    const QSet<QString>& keepPlatformMessageIds,
-    const QSet<QString>& keepClientMessageIds)
+QString MessageDao::deleteMissingSnapshotCacheMessagesSql(int keepPlatformCount, int keepClientCount)
 {
-    if (conversationId <= 0)
-        return 0;
-
     QString keepPredicate;
-    if (!keepPlatformMessageIds.isEmpty())
+    if (keepPlatformCount > 0)
         keepPredicate += QStringLiteral("platform_message_id IN (%1)")
-                             .arg(placeholders(QStringLiteral("pmid"), keepPlatformMessageIds.size()));
-    if (!keepClientMessageIds.isEmpty()) {
+                             .arg(placeholders(QStringLiteral("pmid"), keepPlatformCount));
+    if (keepClientCount > 0) {
         if (!keepPredicate.isEmpty())
             keepPredicate += QStringLiteral(" OR ");
         keepPredicate += QStringLiteral("client_message_id IN (%1)")
-                             .arg(placeholders(QStringLiteral("cmid"), keepClientMessageIds.size()));
+                             .arg(placeholders(QStringLiteral("cmid"), keepClientCount));
     }
 
     QString sql = QStringLiteral(
@@ -440,9 +456,20 @@ int MessageDao::deleteMissingSnapshotCacheMessages(
         "AND cache_origin = 'server_snapshot_cache'");
     if (!keepPredicate.isEmpty())
         sql += QStringLiteral(" AND NOT (%1)").arg(keepPredicate);
+    return sql;
+}
+
+int MessageDao::deleteMissingSnapshotCacheMessages(
+    int conversationId,
+    const QSet<QString>& keepPlatformMessageIds,
+    const QSet<QString>& keepClientMessageIds)
+{
+    if (conversationId <= 0)
+        return 0;
 
     QSqlQuery q(Database::getInstance().connection());
-    q.prepare(sql);
+    q.prepare(deleteMissingSnapshotCacheMessagesSql(int(keepPlatformMessageIds.size()),
+                                                    int(keepClientMessageIds.size())));
     q.bindValue(QStringLiteral(":cid"), conversationId);
     int i = 0;
     for (const QString& id : keepPlatformMessageIds) {
@@ -464,11 +491,14 @@ int MessageDao::deleteMissingSnapshotCacheMessages(
 
 std::optional<MessageRecord> MessageDao::findById(int messageId) const
 {
+    static Metrics::Histogram* const latency = Metrics::dbStatementLatency("MessageDao::findById");
+    Metrics::ScopedTimer timer(latency);
     if (messageId <= 0)
         return std::nullopt;
 
-    QSqlQuery q(Database::getInstance().connection());
-    q.prepare(messageSelectProjection() + QStringLiteral("WHERE m.id = :id"));
+    static const QString sql = messageSelectProjection() + QStringLiteral("WHERE m.id = :id");
+    CachedQuery stmt = Database::getInstance().prepareCached(sql);
+    QSqlQuery& q = stmt.query();
     q.bindValue(QStringLiteral(":id"), messageId);
     if (!q.exec()) {
         qWarning() << "MessageDao::findById 失败:" << q.lastError().text();
@@ -485,11 +515,12 @@ std::optional<MessageRecord> MessageDao::latestPendingOutboundByClientMessageId(
     if (conversationId <= 0 || clientMessageId.isEmpty())
         return std::nullopt;
 
-    QSqlQuery q(Database::getInstance().connection());
-    q.prepare(QStringLiteral(
+    static const QString sql = QStringLiteral(
         "%1WHERE m.conversation_id = :cid "
         "AND m.direction = 'out' AND m.status = 'pending' AND m.client_message_id = :cmid "
-        "ORDER BY m.id DESC LIMIT 1").arg(messageSelectProjection()));
+        "ORDER BY m.id DESC LIMIT 1").arg(messageSelectProjection());
+    CachedQuery stmt = Database::getInstance().prepareCached(sql);
+    QSqlQuery& q = stmt.query();
     q.bindValue(QStringLiteral(":cid"), conversationId);
     q.bindValue(QStringLiteral(":cmid"), clientMessageId);
     if (!q.exec()) {
@@ -507,11 +538,12 @@ std::optional<MessageRecord> MessageDao::latestOutboundByClientMessageId(int con
     if (conversationId <= 0 || clientMessageId.isEmpty())
         return std::nullopt;
 
-    QSqlQuery q(Database::getInstance().connection());
-    q.prepare(QStringLiteral(
+    static const QString sql = QStringLiteral(
         "%1WHERE m.conversation_id = :cid "
         "AND m.direction = 'out' AND m.client_message_id = :cmid "
-        "ORDER BY m.id DESC LIMIT 1").arg(messageSelectProjection()));
+        "ORDER BY m.id DESC LIMIT 1").arg(messageSelectProjection());
+    CachedQuery stmt = Database::getInstance().prepareCached(sql);
+    QSqlQuery& q = stmt.query();
     q.bindValue(QStringLiteral(":cid"), conversationId);
     q.bindValue(QStringLiteral(":cmid"), clientMessageId);
     if (!q.exec()) {
@@ -545,14 +577,99 @@ QVector<MessageRecord> MessageDao::listCachedMessages(int conversationId, int li
     return listByConversation(conversationId, limit, offset);
 }
 
+QVector<MessageRecord> MessageDao::listRecentCachedMessages(int conversationId, int limit) const
+{
+    static Metrics::Histogram* const latency = Metrics::dbStatementLatency("MessageDao::listRecentCachedMessages");
+    Metrics::ScopedTimer timer(latency);
+    QVector<MessageRecord> result;
+    if (conversationId <= 0 || limit <= 0)
+        return result;
+
+    static const QString sql = messageSelectProjection()
+        + QStringLiteral("WHERE m.conversation_id = :cid "
+                         "ORDER BY m.created_at DESC, m.id DESC LIMIT :lim");
+    CachedQuery stmt = Database::getInstance().prepareCached(sql);
+    QSqlQuery& q = stmt.query();
+    q.bindValue(QStringLiteral(":cid"), conversationId);
+    q.bindValue(QStringLiteral(":lim"), limit);
+    if (!q.exec()) {
+        qWarning() << "MessageDao::listRecentCachedMessages 失败:" << q.lastError().text();
+        return result;
+    }
+    while (q.next())
+        result.append(messageRecordFromQuery(q));
+    std::reverse(result.begin(), result.end());
+    return result;
+}
+
+int MessageDao::countCachedMessages(int conversationId) const
+{
+    if (conversationId <= 0)
+        return 0;
+
+    CachedQuery stmt = Database::getInstance().prepareCached(
+        QStringLiteral("SELECT COUNT(*) FROM messages WHERE conversation_id = :cid"));
+    QSqlQuery& q = stmt.query();
+    q.bindValue(QStringLiteral(":cid"), conversationId);
+    if (!q.exec() || !q.next()) {
+        qWarning() << "MessageDao::countCachedMessages 失败:" << q.lastError().text();
+        return 0;
+    }
+    return q.value(0).toInt();
+}
+
+QVector<MessageRecord> MessageDao::listCachedMessagesAfter(int conversationId,
+                                                           qint64 afterMessageId,
+                                                           int limit) const
+{
+    QVector<MessageRecord> result;
+    if (conversationId <= 0 || limit <= 0)
+        return result;
+
+    static const QString sql = messageSelectProjection()
+        + QStringLiteral("WHERE m.conversation_id = :cid AND m.id > :afterId "
+                         "ORDER BY m.id ASC LIMIT :lim");
+    CachedQuery stmt = Database::getInstance().prepareCached(sql);
+    QSqlQuery& q = stmt.query();
+    q.bindValue(QStringLiteral(":cid"), conversationId);
+    q.bindValue(QStringLiteral(":afterId"), qMax<qint64>(0, afterMessageId));
+    q.bindValue(QStringLiteral(":lim"), limit);
+    if (!q.exec()) {
+        qWarning() << "MessageDao::listCachedMessagesAfter 失败:" << q.lastError().text();
+        return result;
+    }
+    while (q.next())
+        result.append(messageRecordFromQuery(q));
+    return result;
+}
+
+int MessageDao::countCachedInboundAfter(int conversationId, qint64 afterMessageId) const
+{
+    if (conversationId <= 0)
+        return 0;
+
+    CachedQuery stmt = Database::getInstance().prepareCached(QStringLiteral(
+        "SELECT COUNT(*) FROM messages "
+        "WHERE conversation_id = :cid AND direction = 'in' AND id > :afterId"));
+    QSqlQuery& q = stmt.query();
+    q.bindValue(QStringLiteral(":cid"), conversationId);
+    q.bindValue(QStringLiteral(":afterId"), qMax<qint64>(0, afterMessageId));
+    if (!q.exec() || !q.next()) {
+        qWarning() << "MessageDao::countCachedInboundAfter 失败:" << q.lastError().text();
+        return 0;
+    }
+    return q.value(0).toInt();
+}
+
 std::optional<MessageRecord> MessageDao::lastMessageForConversation(int conversationId) const
 {
     if (conversationId <= 0)
         return std::nullopt;
 
-    QSqlQuery q(Database::getInstance().connection());
-    q.prepare(messageSelectProjection()
-              + QStringLiteral("WHERE m.conversation_id = :cid ORDER BY m.id DESC LIMIT 1"));
+    static const QString sql = messageSelectProjection()
+        + QStringLiteral("WHERE m.conversation_id = :cid ORDER BY m.id DESC LIMIT 1");
+    CachedQuery stmt = Database::getInstance().prepareCached(sql);
+    QSqlQuery& q = stmt.query();
     q.bindValue(QStringLiteral(":cid"), conversationId);
     if (!q.exec()) {
         qWarning() << "MessageDao::lastMessageForConversation 失败:" << q.lastError().text();
@@ -623,12 +740,12 @@ bool MessageDao::updateDeliveryState(int messageId,
     if (messageId <= 0)
         return false;
 
-    QSqlQuery q(Database::getInstance().connection());
-    q.prepare(QStringLiteral(
+    CachedQuery stmt = Database::getInstance().prepareCached(QStringLiteral(
         "UPDATE messages SET status = :status, error_reason = :reason, "
         "platform_message_id = COALESCE(NULLIF(:pmid, ''), platform_message_id), "
         "updated_at = datetime('now','localtime') "
         "WHERE id = :id"));
+    QSqlQuery& q = stmt.query();
     q.bindValue(QStringLiteral(":status"), statusFromSyncStatus(syncStatus));
     q.bindValue(QStringLiteral(":reason"), errorReason);
     q.bindValue(QStringLiteral(":pmid"), platformMsgId);
@@ -653,8 +770,7 @@ std::optional<LatestInboundSnapshot> MessageDao::latestInboundSnapshot(int conve
     if (conversationId <= 0)
         return std::nullopt;
 
-    QSqlQuery q(Database::getInstance().connection());
-    q.prepare(QStringLiteral(
+    CachedQuery stmt = Database::getInstance().prepareCached(QStringLiteral(
         "SELECT m.content, coalesce(wm.evidence_ref, qm.evidence_ref, '') "
         "FROM messages m "
         "LEFT JOIN wechat_messages wm ON wm.message_id = m.id "
@@ -663,6 +779,7 @@ std::optional<LatestInboundSnapshot> MessageDao::latestInboundSnapshot(int conve
         "(length(trim(coalesce(m.content, ''))) > 0 "
         " OR length(trim(coalesce(wm.evidence_ref, qm.evidence_ref, ''))) > 0) "
         "ORDER BY m.id DESC LIMIT 1"));
+    QSqlQuery& q = stmt.query();
     q.bindValue(QStringLiteral(":cid"), conversationId);
     if (!q.exec()) {
         qWarning() << "MessageDao::latestInboundSnapshot failed:" << q.lastError().text();
@@ -702,10 +819,14 @@ QHash<int, QString> MessageDao::lastDirectionsByConversation() const
     if (!tableExists(QStringLiteral("messages")))
         return out;
 
-    QSqlQuery q(Database::getInstance().connection());
-    q.prepare(QStringLiteral(
-        "SELECT conversation_id, direction FROM messages WHERE id IN "
-        "(SELECT MAX(id) FROM messages GROUP BY conversation_id)"));
+    // conversations.last_direction 由 messages 上的触发器维护（客户端缓存库见 runMigrations，
+    // 统一库见 database/app_data_schema.sql），直接读会话行；尚未升级的旧库仍按消息表聚合
+    const bool denormalized = tableHasColumn(QStringLiteral("conversations"), QStringLiteral("last_message_id"));
+    CachedQuery stmt = Database::getInstance().prepareCached(denormalized
+        ? QStringLiteral("SELECT id, last_direction FROM conversations WHERE last_message_id > 0")
+        : QStringLiteral("SELECT conversation_id, direction FROM messages WHERE id IN "
+                         "(SELECT MAX(id) FROM messages GROUP BY conversation_id)"));
+    QSqlQuery& q = stmt.query();
     if (!q.exec()) {
         qWarning() << "MessageDao::lastDirectionsByConversation 失败:" << q.lastError().text();
         return out;
@@ -720,12 +841,30 @@ QHash<int, QString> MessageDao::lastCachedDirectionsByConversation() const
     return lastDirectionsByConversation();
 }
 
+QHash<int, QString> MessageDao::lastCachedDirectionsByConversation(
+    const QVector<ConversationInfo>& conversations) const
+{
+    if (conversations.isEmpty() || !conversations.first().lastDirectionKnown)
+        return lastDirectionsByConversation();
+
+    QHash<int, QString> out;
+    out.reserve(conversations.size());
+    for (const ConversationInfo& conv : conversations) {
+        if (!conv.lastDirection.isEmpty())
+            out.insert(conv.id, conv.lastDirection);
+    }
+    return out;
+}
+
 bool MessageDao::existsByPlatformMsgId(const QString& platformMsgId)
 {
+    static Metrics::Histogram* const latency = Metrics::dbStatementLatency("MessageDao::existsByPlatformMsgId");
+    Metrics::ScopedTimer timer(latency);
     if (platformMsgId.isEmpty())
         return false;
-    QSqlQuery q(Database::getInstance().connection());
-    q.prepare("SELECT 1 FROM messages WHERE platform_message_id = :pmid LIMIT 1");
+    CachedQuery stmt = Database::getInstance().prepareCached(
+        QStringLiteral("SELECT 1 FROM messages WHERE platform_message_id = :pmid LIMIT 1"));
+    QSqlQuery& q = stmt.query();
     q.bindValue(":pmid", platformMsgId);
     return q.exec() && q.next();
 }
@@ -32,10 +32,20 @@ public:
     int deleteMissingSnapshotCacheMessages(int conversationId,
                                            const QSet<QString>& keepPlatformMessageIds,
                                            const QSet<QString>& keepClientMessageIds);
+    /** 上面删除所用的语句（保留列表为可变长 IN，不进预编译缓存）；占位符 :cid、:pmidN、:cmidN。 */
+    static QString deleteMissingSnapshotCacheMessagesSql(int keepPlatformCount, int keepClientCount);
     std::optional<MessageRecord> findById(int messageId) const;
     QVector<MessageRecord> listByConversation(int conversationId, int limit = 200, int offset = 0);
     /** 读取客户端本地消息缓存；用于 UI 恢复/展示，不代表服务端真相源。 */
     QVector<MessageRecord> listCachedMessages(int conversationId, int limit = 200, int offset = 0);
+    /** 本地缓存中最新的 limit 条消息，按时间正序返回；用于 AI 上下文组装。 */
+    QVector<MessageRecord> listRecentCachedMessages(int conversationId, int limit) const;
+    /** 本地缓存中该会话的消息总数。 */
+    int countCachedMessages(int conversationId) const;
+    /** `messages.id` 大于 afterMessageId 的缓存消息，按 id 正序，最多 limit 条；用于增量整理客户信息。 */
+    QVector<MessageRecord> listCachedMessagesAfter(int conversationId, qint64 afterMessageId, int limit) const;
+    /** `messages.id` 大于 afterMessageId 的入站消息条数。 */
+    int countCachedInboundAfter(int conversationId, qint64 afterMessageId) const;
     /** 按 `messages.id` 最大的一条（当前会话时间线上的最后一条），无消息则 `nullopt`。 */
     std::optional<MessageRecord> lastMessageForConversation(int conversationId) const;
     /** 读取客户端本地缓存中的最后一条消息；用于 UI/应用服务判断，不代表服务端真相源。 */
@@ -69,10 +79,15 @@ public:
     /** 最后一条入站：文本与/或聊天区截图路径（用于聚合 AI 多模态）。 */
     std::optional<LatestInboundSnapshot> latestInboundSnapshot(int conversationId) const;
     std::optional<LatestInboundSnapshot> latestCachedInboundSnapshot(int conversationId) const;
-    /** 各会话当前最后一条消息的 direction（按 messages.id 最大）；无消息则无键。 */
+    /**
+     * 各会话当前最后一条消息的 direction（按 messages.id 最大）；无消息则无键。
+     * 有 conversations.last_direction 列（触发器维护）时读会话行，不扫 messages。
+     */
     QHash<int, QString> lastDirectionsByConversation() const;
     /** 各会话本地缓存最后一条消息的 direction；用于会话列表恢复/分栏。 */
     QHash<int, QString> lastCachedDirectionsByConversation() const;
+    /** 同上，但会话行已带 last_direction 时直接取用，列表刷新不再单独查一次库。 */
+    QHash<int, QString> lastCachedDirectionsByConversation(const QVector<ConversationInfo>& conversations) const;
     bool existsByPlatformMsgId(const QString& platformMsgId);
     /** 删除该会话全部消息和 message_send_events（事务内执行）。 */
     bool clearAllForConversation(int conversationId);
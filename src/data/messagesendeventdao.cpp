@@ -1,9 +1,38 @@
 #include "messagesendeventdao.h"
 #include "database.h"
+#include "dataeventbus.h"
 #include <QDebug>
 #include <QSqlError>
 #include <QSqlQuery>
 
+qint64 MessageSendEventDao::append(int messageId, int conversationId, const QString& phase, const QString& detail)
+{
+    if (messageId <= 0 || conversationId <= 0 || phase.trimmed().isEmpty())
+        return 0;
+
+    MessageSendEventRecord r;
+    r.messageId = messageId;
+    r.conversationId = conversationId;
+    r.phase = phase.left(64);
+    r.detail = detail.left(500);
+    r.createdAt = QDateTime::currentDateTime();
+
+    QSqlQuery q(Database::getInstance().connection());
+    q.prepare(QStringLiteral("INSERT INTO message_send_events (message_id, conversation_id, phase, detail) "
+                             "VALUES (:mid, :cid, :phase, :detail)"));
+    q.bindValue(QStringLiteral(":mid"), r.messageId);
+    q.bindValue(QStringLiteral(":cid"), r.conversationId);
+    q.bindValue(QStringLiteral(":phase"), r.phase);
+    q.bindValue(QStringLiteral(":detail"), r.detail);
+    if (!q.exec()) {
+        qWarning() << "MessageSendEventDao::append failed:" << q.lastError().text();
+        return 0;
+    }
+    r.id = q.lastInsertId().toLongLong();
+    emit DataEventBus::instance().messageSendEventAppended(r);
+    return r.id;
+}
+
 qint64 MessageSendEventDao::globalMaxId() const
 {
     QSqlQuery q(Database::getInstance().connection());
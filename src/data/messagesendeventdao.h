@@ -19,6 +19,9 @@ class MessageSendEventDao
 public:
     MessageSendEventDao() = default;
 
+    /** Append one send phase row and publish it on DataEventBus; returns the new id or 0. */
+    qint64 append(int messageId, int conversationId, const QString& phase, const QString& detail = QString());
+
     /** Max event id in table (for UI baseline after open session / clear). */
     qint64 globalMaxId() const;
 
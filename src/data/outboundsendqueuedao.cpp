@@ -0,0 +1,139 @@
+#include "outboundsendqueuedao.h"
+#include "database.h"
+
+#include <QDebug>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QVariant>
+
+namespace {
+
+QString partTypeToString(OutgoingPartType type)
+{
+    switch (type) {
+    case OutgoingPartType::Image: return QStringLiteral("image");
+    case OutgoingPartType::Video: return QStringLiteral("video");
+    case OutgoingPartType::File: return QStringLiteral("file");
+    case OutgoingPartType::Text:
+    default: return QStringLiteral("text");
+    }
+}
+
+OutgoingPartType partTypeFromString(const QString& value)
+{
+    if (value == QLatin1String("image"))
+        return OutgoingPartType::Image;
+    if (value == QLatin1String("video"))
+        return OutgoingPartType::Video;
+    if (value == QLatin1String("file"))
+        return OutgoingPartType::File;
+    return OutgoingPartType::Text;
+}
+
+} // namespace
+
+qint64 OutboundSendQueueDao::enqueue(const OutboundSendRecord& record, bool* existedOut)
+{
+    if (existedOut)
+        *existedOut = false;
+    if (record.platform.isEmpty() || record.clientMessageId.isEmpty())
+        return 0;
+
+    QSqlQuery q(Database::getInstance().connection());
+    q.prepare(QStringLiteral(
+        "INSERT INTO outbound_send_queue "
+        "(platform, account_id, conversation_key, client_message_id, part_type, text, local_path, "
+        " file_name, mime_type, size_bytes, state, attempts, enqueued_at) "
+        "VALUES (:platform, :accountId, :conversationKey, :clientMessageId, :partType, :text, :localPath, "
+        "        :fileName, :mimeType, :sizeBytes, 'queued', 0, :enqueuedAt) "
+        "ON CONFLICT(client_message_id) DO NOTHING"));
+    q.bindValue(QStringLiteral(":platform"), record.platform);
+    q.bindValue(QStringLiteral(":accountId"), record.accountId);
+    q.bindValue(QStringLiteral(":conversationKey"), record.conversationKey);
+    q.bindValue(QStringLiteral(":clientMessageId"), record.clientMessageId);
+    q.bindValue(QStringLiteral(":partType"), partTypeToString(record.part.type));
+    q.bindValue(QStringLiteral(":text"), record.part.text);
+    q.bindValue(QStringLiteral(":localPath"), record.part.localPath);
+    q.bindValue(QStringLiteral(":fileName"), record.part.fileName);
+    q.bindValue(QStringLiteral(":mimeType"), record.part.mimeType);
+    q.bindValue(QStringLiteral(":sizeBytes"), record.part.sizeBytes);
+    q.bindValue(QStringLiteral(":enqueuedAt"),
+                (record.enqueuedAt.isValid() ? record.enqueuedAt : QDateTime::currentDateTime())
+                    .toString(Qt::ISODateWithMs));
+    if (!q.exec()) {
+        qWarning() << "OutboundSendQueueDao::enqueue failed:" << q.lastError().text();
+        return 0;
+    }
+    if (q.numRowsAffected() == 0) {
+        // 重复入队（例如上层重试）：原命令可能已在途，覆盖会把 in_flight 改回 queued 而重发
+        if (existedOut)
+            *existedOut = true;
+        return 0;
+    }
+    return q.lastInsertId().toLongLong();
+}
+
+bool OutboundSendQueueDao::markInFlight(const QString& clientMessageId)
+{
+    QSqlQuery q(Database::getInstance().connection());
+    q.prepare(QStringLiteral(
+        "UPDATE outbound_send_queue SET state = 'in_flight', attempts = attempts + 1, "
+        "  dispatched_at = datetime('now','localtime') "
+        "WHERE client_message_id = :clientMessageId"));
+    q.bindValue(QStringLiteral(":clientMessageId"), clientMessageId);
+    if (!q.exec()) {
+        qWarning() << "OutboundSendQueueDao::markInFlight failed:" << q.lastError().text();
+        return false;
+    }
+    return q.numRowsAffected() > 0;
+}
+
+bool OutboundSendQueueDao::remove(const QString& clientMessageId)
+{
+    QSqlQuery q(Database::getInstance().connection());
+    q.prepare(QStringLiteral("DELETE FROM outbound_send_queue WHERE client_message_id = :clientMessageId"));
+    q.bindValue(QStringLiteral(":clientMessageId"), clientMessageId);
+    if (!q.exec()) {
+        qWarning() << "OutboundSendQueueDao::remove failed:" << q.lastError().text();
+        return false;
+    }
+    return q.numRowsAffected() > 0;
+}
+
+QVector<OutboundSendRecord> OutboundSendQueueDao::listPending(const QString& platform,
+                                                             const QString& accountId) const
+{
+    QVector<OutboundSendRecord> out;
+    QSqlQuery q(Database::getInstance().connection());
+    q.prepare(QStringLiteral(
+        "SELECT id, platform, account_id, conversation_key, client_message_id, part_type, text, "
+        "       local_path, file_name, mime_type, size_bytes, state, attempts, enqueued_at "
+        "FROM outbound_send_queue "
+        "WHERE platform = :platform AND account_id = :accountId "
+        "ORDER BY id ASC"));
+    q.bindValue(QStringLiteral(":platform"), platform);
+    q.bindValue(QStringLiteral(":accountId"), accountId);
+    if (!q.exec()) {
+        qWarning() << "OutboundSendQueueDao::listPending failed:" << q.lastError().text();
+        return out;
+    }
+    while (q.next()) {
+        OutboundSendRecord r;
+        r.id = q.value(0).toLongLong();
+        r.platform = q.value(1).toString();
+        r.accountId = q.value(2).toString();
+        r.conversationKey = q.value(3).toString();
+        r.clientMessageId = q.value(4).toString();
+        r.part.type = partTypeFromString(q.value(5).toString());
+        r.part.text = q.value(6).toString();
+        r.part.localPath = q.value(7).toString();
+        r.part.fileName = q.value(8).toString();
+        r.part.mimeType = q.value(9).toString();
+        r.part.sizeBytes = q.value(10).toLongLong();
+        r.state = q.value(11).toString();
+        r.attempts = q.value(12).toInt();
+        r.enqueuedAt = QDateTime::fromString(q.value(13).toString(), Qt::ISODateWithMs);
+        out.append(r);
+    }
+    return out;
+}
@@ -0,0 +1,38 @@
+#ifndef OUTBOUNDSENDQUEUEDAO_H
+#define OUTBOUNDSENDQUEUEDAO_H
+
+#include "../core/types.h"
+#include <QDateTime>
+#include <QString>
+#include <QVector>
+
+/** 平台出站发送队列中的一条待发命令；以 client_message_id 与 sidecar 回执关联。 */
+struct OutboundSendRecord {
+    qint64 id = 0;
+    QString platform;
+    QString accountId;
+    QString conversationKey;
+    QString clientMessageId;
+    OutgoingMessagePart part;
+    QString state = QStringLiteral("queued"); // "queued" / "in_flight"
+    int attempts = 0;
+    QDateTime enqueuedAt;
+};
+
+class OutboundSendQueueDao
+{
+public:
+    OutboundSendQueueDao() = default;
+
+    /**
+     * 插入一条命令并返回行 id。同 client_message_id 已在队列中时保持原行不动（不重置状态与
+     * 尝试次数），返回 0 并置 *existedOut = true。
+     */
+    qint64 enqueue(const OutboundSendRecord& record, bool* existedOut = nullptr);
+    bool markInFlight(const QString& clientMessageId);
+    bool remove(const QString& clientMessageId);
+    /** 某平台账号下尚未完成的命令，按入队顺序返回（重启后恢复用）。 */
+    QVector<OutboundSendRecord> listPending(const QString& platform, const QString& accountId) const;
+};
+
+#endif // OUTBOUNDSENDQUEUEDAO_H
@@ -35,8 +35,7 @@ bool QianniuConversationDao::upsertConversation(int conversationId,
     if (conversationId <= 0)
         return false;
 
-    QSqlQuery q(Database::getInstance().connection());
-    q.prepare(QStringLiteral(
+    CachedQuery stmt = Database::getInstance().prepareCached(QStringLiteral(
         "INSERT INTO qianniu_conversations ("
         "conversation_id, qianniu_account_id, qianniu_conversation_key, display_name, "
         "last_unread_badge, last_observed_at, last_health_status, raw_payload_json"
@@ -52,6 +51,7 @@ bool QianniuConversationDao::upsertConversation(int conversationId,
         "last_health_status = excluded.last_health_status, "
         "raw_payload_json = excluded.raw_payload_json, "
         "updated_at = datetime('now','localtime')"));
+    QSqlQuery& q = stmt.query();
     q.bindValue(QStringLiteral(":cid"), conversationId);
     q.bindValue(QStringLiteral(":account"),
                 accountId.isEmpty() ? payload.value(QStringLiteral("_event_account_id")).toString() : accountId);
@@ -82,8 +82,7 @@ bool QianniuConversationDao::createMessageExtension(int messageId,
         return false;
 
     const QJsonObject meta = payload.value(QStringLiteral("metadata")).toObject();
-    QSqlQuery q(Database::getInstance().connection());
-    q.prepare(QStringLiteral(
+    CachedQuery stmt = Database::getInstance().prepareCached(QStringLiteral(
         "INSERT INTO qianniu_messages ("
         "message_id, conversation_id, qianniu_account_id, qianniu_conversation_key, "
         "qianniu_display_name, platform_message_id, direction, sender_role, raw_sender, "
@@ -118,6 +117,7 @@ bool QianniuConversationDao::createMessageExtension(int messageId,
         "message_list_rect = excluded.message_list_rect, "
         "evidence_ref = excluded.evidence_ref, "
         "raw_payload_json = excluded.raw_payload_json"));
+    QSqlQuery& q = stmt.query();
     q.bindValue(QStringLiteral(":mid"), messageId);
     q.bindValue(QStringLiteral(":cid"), conversationId);
     q.bindValue(QStringLiteral(":account"),
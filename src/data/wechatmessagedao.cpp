@@ -34,8 +34,7 @@ bool WechatMessageDao::upsertConversation(int conversationId,
         return false;
 
     const QJsonObject meta = payloadMetadata(payload);
-    QSqlQuery q(Database::getInstance().connection());
-    q.prepare(QStringLiteral(
+    CachedQuery stmt = Database::getInstance().prepareCached(QStringLiteral(
         "INSERT INTO wechat_conversations ("
         "conversation_id, wechat_account_id, wechat_conversation_key, display_name, "
         "session_control_hash, last_unread_badge, last_observed_at, last_health_status, raw_payload_json"
@@ -51,6 +50,7 @@ bool WechatMessageDao::upsertConversation(int conversationId,
         "last_observed_at = excluded.last_observed_at, "
         "last_health_status = excluded.last_health_status, "
         "raw_payload_json = excluded.raw_payload_json"));
+    QSqlQuery& q = stmt.query();
     q.bindValue(QStringLiteral(":cid"), conversationId);
     const QString effectiveAccount = accountId.isEmpty()
         ? payload.value(QStringLiteral("_event_account_id")).toString()
@@ -85,8 +85,7 @@ bool WechatMessageDao::createMessageExtension(int messageId,
         return false;
 
     const QJsonObject meta = payloadMetadata(payload);
-    QSqlQuery q(Database::getInstance().connection());
-    q.prepare(QStringLiteral(
+    CachedQuery stmt = Database::getInstance().prepareCached(QStringLiteral(
         "INSERT INTO wechat_messages ("
         "message_id, conversation_id, wechat_account_id, wechat_conversation_key, "
         "wechat_display_name, platform_message_id, direction, sender_role, source_type, confidence, "
@@ -120,6 +119,7 @@ bool WechatMessageDao::createMessageExtension(int messageId,
         "observation_method = excluded.observation_method, "
         "evidence_ref = excluded.evidence_ref, "
         "raw_payload_json = excluded.raw_payload_json"));
+    QSqlQuery& q = stmt.query();
     q.bindValue(QStringLiteral(":mid"), messageId);
     q.bindValue(QStringLiteral(":cid"), conversationId);
     const QString effectiveAccount = accountId.isEmpty()
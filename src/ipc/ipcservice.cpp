@@ -1,5 +1,6 @@
 #include "ipcservice.h"
 #include "../utils/appsettings.h"
+#include "../utils/metrics.h"
 #include <QEventLoop>
 #include <QJsonArray>
 #include <QJsonDocument>
@@ -124,6 +125,17 @@ QString IpcService::eventWebSocketUrl() const
     return QStringLiteral("ws://127.0.0.1:%1").arg(m_eventPort);
 }
 
+namespace {
+
+Metrics::Counter* httpErrors()
+{
+    static Metrics::Counter* const counter = Metrics::counter(
+        QStringLiteral("ipc_http_errors_total"), {}, QStringLiteral("Python 服务 HTTP 请求失败或超时次数"));
+    return counter;
+}
+
+} // namespace
+
 PlatformCommandResponse IpcService::sendPlatformCommandViaWebSocket(const PlatformCommandRequest& request, int timeoutMs)
 {
     PlatformCommandResponse response;
@@ -187,15 +199,25 @@ PlatformCommandResponse IpcService::sendPlatformCommandViaWebSocket(const Platfo
             << "command=" << request.commandType
             << "taskId=" << request.taskId
             << "clientMessageId=" << request.parameters.value(QStringLiteral("client_message_id")).toString();
+    static Metrics::Histogram* const commandRtt = Metrics::histogram(
+        QStringLiteral("ipc_command_rtt_us"), {}, QStringLiteral("平台命令 WebSocket 往返耗时（微秒）"));
+    QElapsedTimer rttTimer;
+    rttTimer.start();
     m_commandSocket->sendTextMessage(QString::fromUtf8(QJsonDocument(payload).toJson(QJsonDocument::Compact)));
 
     QTimer::singleShot(timeoutMs, &responseLoop, &QEventLoop::quit);
     responseLoop.exec();
+    commandRtt->record(rttTimer.nsecsElapsed() / 1000);
     QObject::disconnect(messageConn);
     QObject::disconnect(errorConn);
     QObject::disconnect(disconnectedConn);
 
     if (rawResponse.isEmpty()) {
+        if (socketError.isEmpty()) {
+            static Metrics::Counter* const timeouts = Metrics::counter(
+                QStringLiteral("ipc_command_timeouts_total"), {}, QStringLiteral("平台命令 WebSocket 等待回复超时次数"));
+            timeouts->increment();
+        }
         response.status = socketError.isEmpty() ? ResponseStatus::Timeout : ResponseStatus::Error;
         response.errorMessage = socketError.isEmpty() ? QStringLiteral("request_timeout") : socketError;
         return response;
@@ -323,6 +345,9 @@ void IpcService::stopCommandWebSocketClient()
 
 void IpcService::handleEventSocketPayload(const QJsonObject& payload)
 {
+    static Metrics::Counter* const received = Metrics::counter(
+        QStringLiteral("ipc_events_received_total"), {}, QStringLiteral("事件 WebSocket 收到的推送条数"));
+    received->increment();
     QElapsedTimer timer;
     timer.start();
     const QString type = payload.value(QStringLiteral("type")).toString();
@@ -599,6 +624,27 @@ QJsonObject IpcService::fetchConversationMessages(const QString& platform,
     return response;
 }
 
+QJsonObject IpcService::fetchServiceTrace(const QString& correlationId,
+                                          int timeoutMs,
+                                          ResponseStatus* statusOut,
+                                          QString* errorOut)
+{
+    QUrl url(m_endpoint + QStringLiteral("/api/debug/trace"));
+    if (!correlationId.trimmed().isEmpty()) {
+        QUrlQuery query;
+        query.addQueryItem(QStringLiteral("correlation_id"), correlationId.trimmed());
+        url.setQuery(query);
+    }
+
+    QJsonObject response = performJsonGet(url, timeoutMs, statusOut, errorOut);
+    qInfo() << "[IpcService] service trace fetched"
+            << "correlationId=" << correlationId
+            << "status=" << (statusOut ? Ipc::toString(*statusOut) : QStringLiteral("unknown"))
+            << "events=" << response.value(QStringLiteral("traceEvents")).toArray().size()
+            << "error=" << (errorOut ? *errorOut : QString());
+    return response;
+}
+
 QJsonObject IpcService::fetchPlatformReplay(const QString& platform,
                                             const QString& cursor,
                                             int limit,
@@ -848,6 +894,10 @@ QJsonObject IpcService::performJsonGet(const QUrl& url, int timeoutMs,
                                        QString* errorOut)
 {
     QNetworkRequest request(url);
+    static Metrics::Histogram* const rtt = Metrics::histogram(
+        QStringLiteral("ipc_http_rtt_us"), {{QStringLiteral("method"), QStringLiteral("GET")}},
+        QStringLiteral("Python 服务 HTTP 请求往返耗时（微秒）"));
+    Metrics::ScopedTimer timer(rtt);
     request.setTransferTimeout(timeoutMs);
     QNetworkReply* reply = m_network->get(request);
 
@@ -859,6 +909,7 @@ QJsonObject IpcService::performJsonGet(const QUrl& url, int timeoutMs,
     QJsonObject obj;
     if (!reply->isFinished()) {
         reply->abort();
+        httpErrors()->increment();
         if (statusOut) *statusOut = ResponseStatus::Timeout;
         if (errorOut) *errorOut = QStringLiteral("request_timeout");
         reply->deleteLater();
@@ -866,6 +917,7 @@ QJsonObject IpcService::performJsonGet(const QUrl& url, int timeoutMs,
     }
 
     if (reply->error() != QNetworkReply::NoError) {
+        httpErrors()->increment();
         if (statusOut) *statusOut = ResponseStatus::Error;
         if (errorOut) *errorOut = reply->errorString();
         reply->deleteLater();
@@ -895,6 +947,10 @@ QJsonObject IpcService::performJsonPost(const QUrl& url,
 {
     QNetworkRequest request(url);
     request.setHeader(QNetworkRequest::ContentTypeHeader, QStringLiteral("application/json"));
+    static Metrics::Histogram* const rtt = Metrics::histogram(
+        QStringLiteral("ipc_http_rtt_us"), {{QStringLiteral("method"), QStringLiteral("POST")}},
+        QStringLiteral("Python 服务 HTTP 请求往返耗时（微秒）"));
+    Metrics::ScopedTimer timer(rtt);
     request.setTransferTimeout(timeoutMs);
     QNetworkReply* reply = m_network->post(request, QJsonDocument(payload).toJson(QJsonDocument::Compact));
 
@@ -906,6 +962,7 @@ QJsonObject IpcService::performJsonPost(const QUrl& url,
     QJsonObject obj;
     if (!reply->isFinished()) {
         reply->abort();
+        httpErrors()->increment();
         if (statusOut) *statusOut = ResponseStatus::Timeout;
         if (errorOut) *errorOut = QStringLiteral("request_timeout");
         reply->deleteLater();
@@ -913,6 +970,7 @@ QJsonObject IpcService::performJsonPost(const QUrl& url,
     }
 
     if (reply->error() != QNetworkReply::NoError) {
+        httpErrors()->increment();
         if (statusOut) *statusOut = ResponseStatus::Error;
         if (errorOut) *errorOut = reply->errorString();
         reply->deleteLater();
@@ -59,6 +59,11 @@ public:
                                           int timeoutMs = 5000,
                                           ResponseStatus* statusOut = nullptr,
                                           QString* errorOut = nullptr);
+    /** Python 服务的追踪事件（Chrome trace 格式，见 /api/debug/trace）。 */
+    QJsonObject fetchServiceTrace(const QString& correlationId = QString(),
+                                  int timeoutMs = 5000,
+                                  ResponseStatus* statusOut = nullptr,
+                                  QString* errorOut = nullptr);
     QJsonObject fetchPlatformReplay(const QString& platform = QString(),
                                     const QString& cursor = QString(),
                                     int limit = 100,
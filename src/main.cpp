@@ -7,6 +7,8 @@
 #include "utils/appsettings.h"
 #include "utils/applystyle.h"
 #include "utils/logger.h"
+#include "utils/metrics.h"
+#include "utils/processmemory.h"
 #include "utils/scrollbehavior.h"
 #include "utils/swordcursor.h"
 #include <QApplication>
@@ -33,6 +35,19 @@ int main(int argc, char* argv[])
 
     Logger::init();
 
+    Metrics::Registry::instance().addCollector([] {
+        static Metrics::Gauge* const resident = Metrics::gauge(
+            QStringLiteral("process_resident_bytes"), {}, QStringLiteral("进程常驻内存（字节）"));
+        static Metrics::Gauge* const logDropped = Metrics::gauge(
+            QStringLiteral("logger_dropped_total"), {}, QStringLiteral("日志队列已满丢弃的条数"));
+        static Metrics::Gauge* const logRateLimited = Metrics::gauge(
+            QStringLiteral("logger_rate_limited_total"), {}, QStringLiteral("日志按前缀限流丢弃的条数"));
+        resident->set(static_cast<double>(ProcessMemory::residentBytes()));
+        logDropped->set(static_cast<double>(Logger::droppedCount()));
+        logRateLimited->set(static_cast<double>(Logger::rateLimitedCount()));
+    });
+    Metrics::startEventLoopLagProbe(&a);
+
     if (!Database::getInstance().open()) {
         QMessageBox::critical(nullptr, "错误", "数据库初始化失败，无法启动应用。");
         return 1;
@@ -0,0 +1,207 @@
+#include "aicontextassembler.h"
+
+#include "aiprovidercatalog.h"
+#include "airequestassembler.h"
+#include "../../utils/appsettings.h"
+
+#include <QSettings>
+#include <QStringList>
+#include <QVector>
+
+#include <algorithm>
+
+namespace {
+
+constexpr int kTurnOverheadTokens = 4;
+constexpr int kImageTokenEstimate = 800;
+constexpr int kDigestLineChars = 60;
+constexpr int kDigestHeaderTokens = 32;
+
+bool isCjkLike(char32_t cp)
+{
+    // CJK 统一表意、假名、韩文、全角标点等：主流分词器基本 1 字 ≈ 1 token
+    return (cp >= 0x2E80 && cp <= 0x9FFF) || (cp >= 0xAC00 && cp <= 0xD7AF)
+        || (cp >= 0xF900 && cp <= 0xFAFF) || (cp >= 0xFF00 && cp <= 0xFFEF)
+        || (cp >= 0x20000 && cp <= 0x2FFFF);
+}
+
+QString digestSpeakerLabel(const QString& role)
+{
+    if (role == QLatin1String("assistant"))
+        return QStringLiteral("客服");
+    if (role == QLatin1String("system"))
+        return QStringLiteral("系统");
+    return QStringLiteral("客户");
+}
+
+QString digestLineForTurn(const AiConversationTurn& turn)
+{
+    QString text = plainTextForAiTurnWithoutFileMarker(turn).simplified();
+    if (text.isEmpty()) {
+        for (const AiMessagePart& part : turn.parts) {
+            if (part.kind == AiMessagePartKind::ImageFile) {
+                text = QStringLiteral("[图片]");
+                break;
+            }
+        }
+    }
+    if (text.isEmpty())
+        return {};
+    if (text.size() > kDigestLineChars)
+        text = text.left(kDigestLineChars) + QStringLiteral("…");
+    return QStringLiteral("%1：%2").arg(digestSpeakerLabel(turn.role), text);
+}
+
+} // namespace
+
+int estimateAiTokens(const QString& text)
+{
+    int cjk = 0;
+    int other = 0;
+    for (const char32_t cp : text.toUcs4()) {
+        if (QChar::isSpace(cp))
+            continue;
+        if (isCjkLike(cp))
+            ++cjk;
+        else
+            ++other;
+    }
+    return cjk + (other + 3) / 4;
+}
+
+int estimateAiTurnTokens(const AiConversationTurn& turn)
+{
+    int tokens = kTurnOverheadTokens;
+    for (const AiMessagePart& part : turn.parts) {
+        switch (part.kind) {
+        case AiMessagePartKind::Text:
+            tokens += estimateAiTokens(part.text);
+            break;
+        case AiMessagePartKind::ImageFile:
+            tokens += kImageTokenEstimate;
+            break;
+        case AiMessagePartKind::LocalFile:
+            // 文件内容由方舟 Files API 单独计费，这里只计文件名提示
+            tokens += estimateAiTokens(part.displayName);
+            break;
+        }
+    }
+    return tokens;
+}
+
+AiContextBudget aiContextBudgetFor(const QString& sessionModelKey)
+{
+    AiContextBudget budget;
+    const AiPresetDefinition def = aiPresetDefinition(sessionModelKey);
+    if (def.contextTokenBudget > 0)
+        budget.maxPromptTokens = def.contextTokenBudget;
+
+    QSettings settings = AppSettings::create();
+    settings.beginGroup(aiPresetSettingsGroup(sessionModelKey));
+    const int overrideBudget = settings.value(QStringLiteral("contextTokenBudget"), 0).toInt();
+    settings.endGroup();
+    if (overrideBudget > 0)
+        budget.maxPromptTokens = overrideBudget;
+    return budget;
+}
+
+AiContextAssembly assembleAiContext(const QString& systemPrompt,
+                                    const QList<AiContextHistoryTurn>& history,
+                                    const QList<AiConversationTurn>& tail,
+                                    const AiContextBudget& budget)
+{
+    AiContextAssembly out;
+    out.systemPrompt = systemPrompt;
+
+    int fixedTokens = estimateAiTokens(systemPrompt) + kTurnOverheadTokens;
+    for (const AiConversationTurn& turn : tail)
+        fixedTokens += estimateAiTurnTokens(turn);
+
+    const int n = int(history.size());
+    QVector<int> costs(n);
+    for (int i = 0; i < n; ++i)
+        costs[i] = estimateAiTurnTokens(history.at(i).turn);
+
+    // 从最新一条往前累加，找能放进 available 的最小起点
+    const auto minimalStart = [&](int available) {
+        int used = 0;
+        int start = n;
+        for (int i = n - 1; i >= 0; --i) {
+            if (used + costs.at(i) > available)
+                break;
+            used += costs.at(i);
+            start = i;
+        }
+        return start;
+    };
+
+    const int available = qMax(0, budget.maxPromptTokens - fixedTokens);
+    int start = minimalStart(available);
+    if (start > 0)
+        start = minimalStart(qMax(0, available - budget.digestTokens));
+
+    // 起点对齐到 anchorStride 的整数倍序号：窗口只在跨过对齐点时才整体后移，
+    // 其余请求的 system + 历史前缀逐字节不变。读取窗口本身已截断时同样需要对齐。
+    const bool windowTruncated = start > 0 || (n > 0 && history.first().ordinal > 0);
+    if (windowTruncated && budget.anchorStride > 1 && start < n) {
+        const qint64 stride = budget.anchorStride;
+        const qint64 anchor = (history.at(start).ordinal + stride - 1) / stride * stride;
+        while (start < n && history.at(start).ordinal < anchor)
+            ++start;
+    }
+    if (start >= n && n > 0)
+        start = n - 1; // 至少保留最近一条
+
+    int digestTokensUsed = 0;
+    if (start > 0 && budget.digestTokens > 0) {
+        QStringList lines;
+        int lineBudget = budget.digestTokens - kTurnOverheadTokens - kDigestHeaderTokens;
+        for (int i = start - 1; i >= 0; --i) {
+            const QString line = digestLineForTurn(history.at(i).turn);
+            if (line.isEmpty())
+                continue;
+            const int cost = estimateAiTokens(line) + 1;
+            if (cost > lineBudget)
+                break;
+            lineBudget -= cost;
+            lines.append(line);
+        }
+        if (!lines.isEmpty()) {
+            std::reverse(lines.begin(), lines.end());
+            // 省略条数取首条保留消息的会话内序号：它随对齐点才变化；
+            // start 只是读取窗口内的下标，窗口满后每来一条新消息都会变，摘要头随之失去前缀缓存
+            const QString digest = QStringLiteral("【较早聊天摘要：已省略 %1 条，以下为其中最近 %2 条的要点】\n%3")
+                                       .arg(history.at(start).ordinal)
+                                       .arg(lines.size())
+                                       .arg(lines.join(QLatin1Char('\n')));
+            out.systemPrompt = systemPrompt.isEmpty() ? digest : systemPrompt + QStringLiteral("\n\n") + digest;
+            digestTokensUsed = estimateAiTokens(digest);
+            out.stats.digestedTurns = lines.size();
+        }
+    }
+
+    int keptTokens = 0;
+    for (int i = start; i < n; ++i) {
+        out.turns.append(history.at(i).turn);
+        keptTokens += costs.at(i);
+    }
+
+    out.stats.keptTurns = n - start;
+    out.stats.droppedTurns = start;
+    out.stats.estimatedPromptTokens = fixedTokens + digestTokensUsed + keptTokens;
+    return out;
+}
+
+AiContextAssembly assembleAiContextOldestFirst(const QString& systemPrompt,
+                                               const QList<AiContextHistoryTurn>& history,
+                                               const QList<AiConversationTurn>& tail,
+                                               const AiContextBudget& budget)
+{
+    QList<AiContextHistoryTurn> kept = history;
+    AiContextAssembly context = assembleAiContext(systemPrompt, kept, tail, budget);
+    while (context.stats.droppedTurns > 0) {
+        kept = kept.mid(0, qMax(1, int(kept.size()) - context.stats.droppedTurns));
+        context = assembleAiContext(systemPrompt, kept, tail, budget);
+    }
+    return context;
+}
@@ -0,0 +1,60 @@
+#ifndef AICONTEXTASSEMBLER_H
+#define AICONTEXTASSEMBLER_H
+
+#include "aitypes.h"
+
+#include <QList>
+
+/**
+ * 上下文 token 预算。maxPromptTokens 覆盖 system + 历史 + 本轮输入；
+ * 历史起点按 anchorStride 对齐到会话内序号，使相邻请求共享同一前缀，便于服务端前缀缓存命中。
+ */
+struct AiContextBudget {
+    int maxPromptTokens = 4000;
+    int digestTokens = 300;
+    int anchorStride = 8;
+};
+
+/** 参与组装的一条历史；ordinal 为该消息在会话时间线中的稳定序号。 */
+struct AiContextHistoryTurn {
+    AiConversationTurn turn;
+    qint64 ordinal = 0;
+};
+
+struct AiContextStats {
+    int estimatedPromptTokens = 0;
+    int keptTurns = 0;
+    int droppedTurns = 0;
+    int digestedTurns = 0;
+};
+
+struct AiContextAssembly {
+    /**
+     * 传入的 system 提示，其后接较早消息摘要（如有）。摘要放在开头的 system 里而不是历史中间：
+     * 部分服务只认第一条 system，且它只在对齐点移动时才变化，不影响前缀缓存。
+     */
+    QString systemPrompt;
+    /** 保留的历史，不含本轮输入。 */
+    QList<AiConversationTurn> turns;
+    AiContextStats stats;
+};
+
+/** 本地估算：CJK 字符按 1 token，其余非空白字符约 4 个 1 token；不依赖具体分词器。 */
+int estimateAiTokens(const QString& text);
+int estimateAiTurnTokens(const AiConversationTurn& turn);
+/** 预设默认预算，可由 ai/presets/<slug>/contextTokenBudget 覆盖。 */
+AiContextBudget aiContextBudgetFor(const QString& sessionModelKey);
+AiContextAssembly assembleAiContext(const QString& systemPrompt,
+                                    const QList<AiContextHistoryTurn>& history,
+                                    const QList<AiConversationTurn>& tail,
+                                    const AiContextBudget& budget);
+/**
+ * 按高水位增量处理时用：放不下时从最新一端舍弃，只发能完整放进预算的最早一段，不生成摘要。
+ * 结果的 keptTurns 即 history 开头已完整发出的条数（至少 1 条）。
+ */
+AiContextAssembly assembleAiContextOldestFirst(const QString& systemPrompt,
+                                               const QList<AiContextHistoryTurn>& history,
+                                               const QList<AiConversationTurn>& tail,
+                                               const AiContextBudget& budget);
+
+#endif // AICONTEXTASSEMBLER_H
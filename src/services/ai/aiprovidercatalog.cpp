@@ -18,7 +18,9 @@ AiPresetDefinition buildDeepSeekDefinition()
     def.assistantAvatarResource
         = QStringLiteral(":/aggregate_reception_icons/deepseek_logo_icon.svg");
     def.available = true;
+    def.contextTokenBudget = 6000;
     def.capabilities.supportsStreamingChat = true;
+    def.capabilities.supportsStreamUsage = true;
     return def;
 }
 
@@ -33,10 +35,12 @@ AiPresetDefinition buildDoubaoDefinition()
     def.assistantAvatarResource
         = QStringLiteral(":/aggregate_reception_icons/doubao_logo_icon.svg");
     def.available = true;
+    def.contextTokenBudget = 6000;
     def.capabilities.supportsStreamingChat = true;
     def.capabilities.supportsVisionDataUrl = true;
     def.capabilities.supportsFileAttachment = true;
     def.capabilities.supportsArkResponses = true;
+    def.capabilities.supportsStreamUsage = true;
     return def;
 }
 
@@ -163,3 +167,37 @@ void migrateLegacyAiSettingsToPreset(const QString& sessionModelKey)
         settings.setValue(QStringLiteral("apiKey"), legacyKey);
     settings.endGroup();
 }
+
+AiHedgePolicy loadAiHedgePolicy()
+{
+    AiHedgePolicy policy;
+    QSettings settings = AppSettings::create();
+    settings.beginGroup(QStringLiteral("aggregateAi/hedge"));
+    policy.enabled = settings.value(QStringLiteral("enabled"), policy.enabled).toBool();
+    policy.backupSessionModelKey = settings.value(QStringLiteral("backupSessionModelKey")).toString().trimmed();
+    policy.firstTokenPercentile = qBound(
+        1, settings.value(QStringLiteral("firstTokenPercentile"), policy.firstTokenPercentile).toInt(), 99);
+    policy.minSamples = qMax(1, settings.value(QStringLiteral("minSamples"), policy.minSamples).toInt());
+    policy.fallbackHedgeDelayMs = qMax(
+        0, settings.value(QStringLiteral("fallbackHedgeDelayMs"), policy.fallbackHedgeDelayMs).toInt());
+    policy.minHedgeDelayMs = qMax(0, settings.value(QStringLiteral("minHedgeDelayMs"), policy.minHedgeDelayMs).toInt());
+    policy.maxHedgeDelayMs = qMax(
+        policy.minHedgeDelayMs,
+        settings.value(QStringLiteral("maxHedgeDelayMs"), policy.maxHedgeDelayMs).toInt());
+    settings.endGroup();
+    return policy;
+}
+
+void saveAiHedgePolicy(const AiHedgePolicy& policy)
+{
+    QSettings settings = AppSettings::create();
+    settings.beginGroup(QStringLiteral("aggregateAi/hedge"));
+    settings.setValue(QStringLiteral("enabled"), policy.enabled);
+    settings.setValue(QStringLiteral("backupSessionModelKey"), policy.backupSessionModelKey.trimmed());
+    settings.setValue(QStringLiteral("firstTokenPercentile"), policy.firstTokenPercentile);
+    settings.setValue(QStringLiteral("minSamples"), policy.minSamples);
+    settings.setValue(QStringLiteral("fallbackHedgeDelayMs"), policy.fallbackHedgeDelayMs);
+    settings.setValue(QStringLiteral("minHedgeDelayMs"), policy.minHedgeDelayMs);
+    settings.setValue(QStringLiteral("maxHedgeDelayMs"), policy.maxHedgeDelayMs);
+    settings.endGroup();
+}
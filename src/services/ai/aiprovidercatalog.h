@@ -14,6 +14,8 @@ struct AiPresetDefinition {
     QString assistantDisplayName;
     QString assistantAvatarResource;
     bool available = false;
+    /** 单次请求 prompt 的 token 预算（0 表示用默认值），见 aiContextBudgetFor。 */
+    int contextTokenBudget = 0;
     AiProviderCapabilities capabilities;
 };
 
@@ -22,6 +24,20 @@ struct AiConfigLoadOptions {
     bool allowGeneralFallback = false;
 };
 
+/**
+ * 聚合 AI 对冲策略：主模型首字超过历史首字耗时的 firstTokenPercentile 分位时，
+ * 向 backupSessionModelKey 并发一路备用请求。样本不足时使用 fallbackHedgeDelayMs。
+ */
+struct AiHedgePolicy {
+    bool enabled = false;
+    QString backupSessionModelKey;
+    int firstTokenPercentile = 90;
+    int minSamples = 8;
+    int fallbackHedgeDelayMs = 4000;
+    int minHedgeDelayMs = 800;
+    int maxHedgeDelayMs = 15000;
+};
+
 QList<AiPresetDefinition> aiPresetDefinitions();
 AiPresetDefinition aiPresetDefinition(const QString& sessionModelKey);
 QString aiPresetSettingsGroup(const QString& sessionModelKey);
@@ -30,5 +46,7 @@ AiProviderConfig loadAiProviderConfig(const QString& sessionModelKey,
                                      const AiConfigLoadOptions& options = {});
 void saveAiProviderConfig(const AiProviderConfig& config);
 void migrateLegacyAiSettingsToPreset(const QString& sessionModelKey);
+AiHedgePolicy loadAiHedgePolicy();
+void saveAiHedgePolicy(const AiHedgePolicy& policy);
 
 #endif // AIPROVIDERCATALOG_H
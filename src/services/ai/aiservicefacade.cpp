@@ -3,8 +3,11 @@
 #include "airequestassembler.h"
 #include "aiprovidercatalog.h"
 #include "aistreamingsession.h"
+#include "../../utils/metrics.h"
 
+#include <QElapsedTimer>
 #include <QNetworkAccessManager>
+#include <memory>
 
 AiServiceFacade::AiServiceFacade(QNetworkAccessManager* nam, QObject* parent)
     : QObject(parent)
@@ -15,6 +18,13 @@ AiServiceFacade::AiServiceFacade(QNetworkAccessManager* nam, QObject* parent)
 IAiStreamingSession* AiServiceFacade::createSession(const AiProviderConfig& config,
                                                     const AiRequest& request,
                                                     QObject* parent) const
+{
+    return instrument(buildSession(config, request, parent));
+}
+
+IAiStreamingSession* AiServiceFacade::buildSession(const AiProviderConfig& config,
+                                                   const AiRequest& request,
+                                                   QObject* parent) const
 {
     const QString presetLabel = aiPresetLabel(config.sessionModelKey);
     if (!m_nam)
@@ -47,3 +57,62 @@ IAiStreamingSession* AiServiceFacade::createSession(const AiProviderConfig& conf
 
     return new OpenAiChatSession(m_nam, config, request, parent);
 }
+
+IAiStreamingSession* AiServiceFacade::createHedgedSession(const AiProviderConfig& primaryConfig,
+                                                          const AiProviderConfig& backupConfig,
+                                                          const AiRequest& request,
+                                                          int hedgeDelayMs,
+                                                          QObject* parent) const
+{
+    IAiStreamingSession* primary = buildSession(primaryConfig, request, nullptr);
+    if (qobject_cast<ImmediateFailAiSession*>(primary)
+        || backupConfig.sessionModelKey == primaryConfig.sessionModelKey) {
+        primary->setParent(parent);
+        return instrument(primary);
+    }
+
+    IAiStreamingSession* backup = buildSession(backupConfig, request, nullptr);
+    if (qobject_cast<ImmediateFailAiSession*>(backup)) {
+        delete backup;
+        primary->setParent(parent);
+        return instrument(primary);
+    }
+
+    return instrument(new HedgedAiSession(primary,
+                                          backup,
+                                          hedgeDelayMs,
+                                          aiPresetLabel(primaryConfig.sessionModelKey),
+                                          aiPresetLabel(backupConfig.sessionModelKey),
+                                          parent));
+}
+
+IAiStreamingSession* AiServiceFacade::instrument(IAiStreamingSession* session) const
+{
+    static Metrics::Histogram* const firstToken = Metrics::histogram(
+        QStringLiteral("ai_first_token_us"), {}, QStringLiteral("AI 会话创建到首个增量的耗时（微秒）"));
+    static Metrics::Histogram* const completion = Metrics::histogram(
+        QStringLiteral("ai_completion_us"), {}, QStringLiteral("AI 会话创建到完成的耗时（微秒）"));
+    static Metrics::Counter* const completed = Metrics::counter(
+        QStringLiteral("ai_sessions_completed_total"), {}, QStringLiteral("成功完成的 AI 会话数"));
+    static Metrics::Counter* const failed = Metrics::counter(
+        QStringLiteral("ai_sessions_failed_total"), {}, QStringLiteral("失败的 AI 会话数"));
+
+    // 调用方拿到会话后立即 start()，以创建时刻为起点
+    auto clock = std::make_shared<QElapsedTimer>();
+    clock->start();
+    auto firstDelta = std::make_shared<bool>(true);
+    connect(session, &IAiStreamingSession::delta, session, [clock, firstDelta](const QString&) {
+        if (!*firstDelta)
+            return;
+        *firstDelta = false;
+        firstToken->record(clock->nsecsElapsed() / 1000);
+    });
+    connect(session, &IAiStreamingSession::completed, session, [clock]() {
+        completion->record(clock->nsecsElapsed() / 1000);
+        completed->increment();
+    });
+    connect(session, &IAiStreamingSession::failed, session, [](const QString&) {
+        failed->increment();
+    });
+    return session;
+}
@@ -17,8 +17,23 @@ public:
     IAiStreamingSession* createSession(const AiProviderConfig& config,
                                        const AiRequest& request,
                                        QObject* parent = nullptr) const;
+    /**
+     * 创建对冲会话：主配置先发，hedgeDelayMs 内无首字或首字前失败时再发备用配置。
+     * 备用配置无法承接该请求（能力不符、配置不完整）时退化为普通主会话。
+     */
+    IAiStreamingSession* createHedgedSession(const AiProviderConfig& primaryConfig,
+                                             const AiProviderConfig& backupConfig,
+                                             const AiRequest& request,
+                                             int hedgeDelayMs,
+                                             QObject* parent = nullptr) const;
 
 private:
+    IAiStreamingSession* buildSession(const AiProviderConfig& config,
+                                      const AiRequest& request,
+                                      QObject* parent) const;
+    /** 挂上首字耗时、完成耗时与成功/失败计数；对冲会话只统计外层。 */
+    IAiStreamingSession* instrument(IAiStreamingSession* session) const;
+
     QNetworkAccessManager* m_nam = nullptr;
 };
 
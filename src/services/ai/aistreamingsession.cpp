@@ -36,6 +36,16 @@ OpenAiChatSession::OpenAiChatSession(QNetworkAccessManager* nam,
     , m_request(request)
 {
     connect(m_client, &OpenAiCompatClient::streamDelta, this, &IAiStreamingSession::delta);
+    connect(m_client,
+            &OpenAiCompatClient::usageReported,
+            this,
+            [this](int promptTokens, int cachedPromptTokens, int completionTokens) {
+                AiTokenUsage usage;
+                usage.promptTokens = promptTokens;
+                usage.cachedPromptTokens = cachedPromptTokens;
+                usage.completionTokens = completionTokens;
+                emit usageReported(usage);
+            });
     connect(m_client, &OpenAiCompatClient::completed, this, &IAiStreamingSession::completed);
     connect(m_client, &OpenAiCompatClient::failed, this, &IAiStreamingSession::failed);
 }
@@ -53,12 +63,20 @@ void OpenAiChatSession::start()
         emit failed(err);
         return;
     }
+    QJsonObject extraRootFields = m_request.extraRootFields;
+    if (m_request.stream && m_config.capabilities.supportsStreamUsage
+        && !extraRootFields.contains(QStringLiteral("stream_options"))) {
+        // 让流式最后一包带上 usage，用于核对前缀缓存命中与实际 prompt 体积
+        QJsonObject streamOptions;
+        streamOptions[QStringLiteral("include_usage")] = true;
+        extraRootFields[QStringLiteral("stream_options")] = streamOptions;
+    }
     m_client->requestChatCompletion(OpenAiCompatClient::buildCompletionsUrl(m_config.baseUrl),
                                     m_config.apiKey,
                                     m_config.model,
                                     messages,
                                     m_request.stream,
-                                    m_request.extraRootFields);
+                                    extraRootFields);
 }
 
 void OpenAiChatSession::abort()
@@ -108,3 +126,220 @@ void ArkFileSession::abort()
     if (m_service)
         m_service->abort();
 }
+
+HedgedAiSession::HedgedAiSession(IAiStreamingSession* primary,
+                                 IAiStreamingSession* backup,
+                                 int hedgeDelayMs,
+                                 const QString& primaryLabel,
+                                 const QString& backupLabel,
+                                 QObject* parent)
+    : IAiStreamingSession(parent)
+    , m_primary(primary)
+    , m_backup(backup)
+    , m_hedgeTimer(new QTimer(this))
+    , m_hedgeDelayMs(qMax(0, hedgeDelayMs))
+    , m_primaryLabel(primaryLabel)
+    , m_backupLabel(backupLabel)
+{
+    m_hedgeTimer->setSingleShot(true);
+    connect(m_hedgeTimer, &QTimer::timeout, this, [this]() {
+        if (m_done || m_winner != Leg::None || m_backupStarted)
+            return;
+        launchBackup(QStringLiteral("hedge_fired"),
+                     QStringLiteral("%1 超过 %2 ms 未返回首字，并发请求 %3")
+                         .arg(m_primaryLabel)
+                         .arg(m_hedgeDelayMs)
+                         .arg(m_backupLabel));
+    });
+
+    const auto wire = [this](IAiStreamingSession* session, Leg leg) {
+        if (!session)
+            return;
+        session->setParent(this);
+        connect(session, &IAiStreamingSession::delta, this, [this, leg](const QString& text) {
+            onLegDelta(leg, text);
+        });
+        connect(session, &IAiStreamingSession::completed, this, [this, leg]() { onLegCompleted(leg); });
+        connect(session, &IAiStreamingSession::usageReported, this, [this, leg](const AiTokenUsage& usage) {
+            // 只记胜者（或唯一在跑的一路）的用量，被中止的一路不计入本次请求
+            if (!m_done && (m_winner == leg || (m_winner == Leg::None && !m_backupStarted)))
+                emit usageReported(usage);
+        });
+        connect(session, &IAiStreamingSession::failed, this, [this, leg](const QString& reason) {
+            onLegFailed(leg, reason);
+        });
+    };
+    wire(m_primary, Leg::Primary);
+    wire(m_backup, Leg::Backup);
+}
+
+HedgedAiSession::~HedgedAiSession()
+{
+    abort();
+}
+
+void HedgedAiSession::start()
+{
+    if (m_started || !m_primary)
+        return;
+    m_started = true;
+    m_clock.start();
+    if (m_backup) {
+        emit stageReported(QStringLiteral("hedge_armed"),
+                           QStringLiteral("%1 ms 内无首字则启用 %2").arg(m_hedgeDelayMs).arg(m_backupLabel));
+        m_hedgeTimer->start(m_hedgeDelayMs);
+    }
+    m_primary->start();
+}
+
+void HedgedAiSession::abort()
+{
+    m_done = true;
+    if (m_hedgeTimer)
+        m_hedgeTimer->stop();
+    if (m_primary)
+        m_primary->abort();
+    if (m_backup)
+        m_backup->abort();
+}
+
+IAiStreamingSession* HedgedAiSession::legSession(Leg leg) const
+{
+    switch (leg) {
+    case Leg::Primary:
+        return m_primary;
+    case Leg::Backup:
+        return m_backup;
+    case Leg::None:
+        break;
+    }
+    return nullptr;
+}
+
+QString HedgedAiSession::legLabel(Leg leg) const
+{
+    return leg == Leg::Backup ? m_backupLabel : m_primaryLabel;
+}
+
+bool HedgedAiSession::legRunning(Leg leg) const
+{
+    if (leg == Leg::Primary)
+        return m_started && !m_primaryFinished;
+    if (leg == Leg::Backup)
+        return m_backupStarted && !m_backupFinished;
+    return false;
+}
+
+void HedgedAiSession::launchBackup(const QString& stage, const QString& detail)
+{
+    if (!m_backup || m_backupStarted)
+        return;
+    m_backupStarted = true;
+    m_backupStartedAtMs = int(m_clock.elapsed());
+    m_hedgeTimer->stop();
+    emit stageReported(stage, detail);
+    m_backup->start();
+}
+
+void HedgedAiSession::onLegDelta(Leg leg, const QString& text)
+{
+    if (m_done)
+        return;
+    if (m_winner == Leg::None) {
+        m_winner = leg;
+        m_hedgeTimer->stop();
+        const Leg loser = leg == Leg::Primary ? Leg::Backup : Leg::Primary;
+        int loserElapsedMs = 0;
+        if (legRunning(loser)) {
+            // 落败一路被中止前已等待的时长：它的首字耗时至少这么长
+            const int elapsedMs = int(m_clock.elapsed());
+            loserElapsedMs = qMax(1, loser == Leg::Primary ? elapsedMs : elapsedMs - m_backupStartedAtMs);
+            IAiStreamingSession* loserSession = legSession(loser);
+            loserSession->disconnect(this);
+            loserSession->abort();
+            if (loser == Leg::Primary)
+                m_primaryFinished = true;
+            else
+                m_backupFinished = true;
+        }
+        if (m_backupStarted) {
+            emit stageReported(QStringLiteral("hedge_won"),
+                               QStringLiteral("%1 先返回首字，已中止另一路").arg(legLabel(leg)));
+            emit hedgeResolved(leg == Leg::Backup, leg == Leg::Backup ? m_backupStartedAtMs : 0,
+                               loserElapsedMs);
+        }
+    }
+    if (leg == m_winner)
+        emit delta(text);
+}
+
+void HedgedAiSession::onLegCompleted(Leg leg)
+{
+    if (m_done)
+        return;
+    if (leg == Leg::Primary)
+        m_primaryFinished = true;
+    else
+        m_backupFinished = true;
+
+    if (m_winner == leg) {
+        finish();
+        emit completed();
+        return;
+    }
+    if (m_winner != Leg::None)
+        return;
+
+    // 未产出正文就结束：另一路仍在跑则继续等待，否则交给调用方按空结果处理。
+    const Leg other = leg == Leg::Primary ? Leg::Backup : Leg::Primary;
+    if (legRunning(other))
+        return;
+    finish();
+    emit completed();
+}
+
+void HedgedAiSession::onLegFailed(Leg leg, const QString& reason)
+{
+    if (m_done)
+        return;
+    if (leg == Leg::Primary) {
+        m_primaryFinished = true;
+        m_primaryFailure = reason;
+    } else {
+        m_backupFinished = true;
+        m_backupFailure = reason;
+    }
+
+    if (m_winner == leg) {
+        finish();
+        emit failed(reason);
+        return;
+    }
+    if (m_winner != Leg::None)
+        return;
+
+    if (leg == Leg::Primary && m_backup && !m_backupStarted) {
+        launchBackup(QStringLiteral("hedge_failover"),
+                     QStringLiteral("%1 失败（%2），切换到 %3")
+                         .arg(m_primaryLabel, reason.left(80), m_backupLabel));
+        return;
+    }
+
+    const Leg other = leg == Leg::Primary ? Leg::Backup : Leg::Primary;
+    if (legRunning(other))
+        return;
+
+    finish();
+    if (m_backupStarted) {
+        emit failed(QStringLiteral("%1：%2；%3：%4")
+                        .arg(m_primaryLabel, m_primaryFailure, m_backupLabel, m_backupFailure));
+    } else {
+        emit failed(reason);
+    }
+}
+
+void HedgedAiSession::finish()
+{
+    m_done = true;
+    m_hedgeTimer->stop();
+}
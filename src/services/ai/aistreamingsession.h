@@ -3,9 +3,11 @@
 
 #include "aitypes.h"
 
+#include <QElapsedTimer>
 #include <QObject>
 
 class QNetworkAccessManager;
+class QTimer;
 class OpenAiCompatClient;
 class VolcengineArkFileChatService;
 
@@ -23,6 +25,17 @@ signals:
     void delta(const QString& text);
     void completed();
     void failed(const QString& reason);
+    /** 会话内部的调度决策（如对冲、故障切换），由调用方写入 ai_request_stage_events。 */
+    void stageReported(const QString& stage, const QString& detail);
+    /** 服务端回报的 token 用量（不支持的会话不会发出）。 */
+    void usageReported(const AiTokenUsage& usage);
+    /**
+     * 仅对冲会话发出：备用一路已启动后某一路先产出正文，在转发首个 delta 之前发出。
+     * winnerStartedAfterMs 为胜出一路相对 start() 的启动时刻，调用方据此按胜者自身计首字耗时。
+     * loserElapsedMs 为落败一路从启动到被中止已等待的时长（它已先结束时为 0），
+     * 其首字耗时至少是这么长，调用方按截尾样本记给落败的模型。
+     */
+    void hedgeResolved(bool backupWon, int winnerStartedAfterMs, int loserElapsedMs);
 };
 
 class ImmediateFailAiSession : public IAiStreamingSession
@@ -77,4 +90,58 @@ private:
     AiRequest m_request;
 };
 
+/**
+ * 对冲请求：先启动主会话，若在 hedgeDelayMs 内没有首字（或主会话在首字前失败），
+ * 再启动备用会话。先产出正文的一路胜出，另一路立即 abort；只转发胜者的 delta。
+ * 主/备会话由本对象接管（reparent 到自身）。
+ */
+class HedgedAiSession : public IAiStreamingSession
+{
+    Q_OBJECT
+public:
+    HedgedAiSession(IAiStreamingSession* primary,
+                    IAiStreamingSession* backup,
+                    int hedgeDelayMs,
+                    const QString& primaryLabel,
+                    const QString& backupLabel,
+                    QObject* parent = nullptr);
+    ~HedgedAiSession() override;
+
+    void start() override;
+    void abort() override;
+
+private:
+    enum class Leg {
+        None,
+        Primary,
+        Backup,
+    };
+
+    IAiStreamingSession* legSession(Leg leg) const;
+    QString legLabel(Leg leg) const;
+    bool legRunning(Leg leg) const;
+    void launchBackup(const QString& stage, const QString& detail);
+    void onLegDelta(Leg leg, const QString& text);
+    void onLegCompleted(Leg leg);
+    void onLegFailed(Leg leg, const QString& reason);
+    void finish();
+
+    IAiStreamingSession* m_primary = nullptr;
+    IAiStreamingSession* m_backup = nullptr;
+    QTimer* m_hedgeTimer = nullptr;
+    int m_hedgeDelayMs = 0;
+    QString m_primaryLabel;
+    QString m_backupLabel;
+    QElapsedTimer m_clock;
+    int m_backupStartedAtMs = 0;
+    Leg m_winner = Leg::None;
+    bool m_started = false;
+    bool m_backupStarted = false;
+    bool m_primaryFinished = false;
+    bool m_backupFinished = false;
+    bool m_done = false;
+    QString m_primaryFailure;
+    QString m_backupFailure;
+};
+
 #endif // AISTREAMINGSESSION_H
@@ -3,6 +3,7 @@
 
 #include <QJsonObject>
 #include <QList>
+#include <QMetaType>
 #include <QString>
 
 enum class AiMessagePartKind {
@@ -16,6 +17,8 @@ struct AiProviderCapabilities {
     bool supportsVisionDataUrl = false;
     bool supportsFileAttachment = false;
     bool supportsArkResponses = false;
+    /** 流式请求可带 stream_options.include_usage（最后一包回报 usage）；并非所有兼容服务都接受。 */
+    bool supportsStreamUsage = false;
 };
 
 struct AiProviderConfig {
@@ -52,6 +55,15 @@ struct AiRequest {
     bool stream = true;
 };
 
+/** 服务端回报的 token 用量；cachedPromptTokens 为命中前缀缓存的 prompt 部分。 */
+struct AiTokenUsage {
+    int promptTokens = 0;
+    int cachedPromptTokens = 0;
+    int completionTokens = 0;
+
+    bool isValid() const { return promptTokens > 0 || completionTokens > 0; }
+};
+
 struct AiArkFileRequestData {
     QString localFilePath;
     QString userText;
@@ -92,4 +104,6 @@ inline AiConversationTurn makeAiTextTurn(const QString& role, const QString& tex
     return turn;
 }
 
+Q_DECLARE_METATYPE(AiTokenUsage)
+
 #endif // AITYPES_H
@@ -3,6 +3,7 @@
 #include <QJsonArray>
 #include <QJsonDocument>
 #include <QJsonObject>
+#include <QJsonValue>
 #include <QNetworkAccessManager>
 #include <QNetworkReply>
 #include <QNetworkRequest>
@@ -100,14 +101,19 @@ void OpenAiCompatClient::requestChatCompletion(const QString& completionsUrl,
     for (auto it = extraRootFields.constBegin(); it != extraRootFields.constEnd(); ++it)
         root[it.key()] = it.value();
 
-    const QJsonDocument doc(root);
-    const QByteArray body = doc.toJson(QJsonDocument::Compact);
-
     QNetworkRequest req(u);
     req.setHeader(QNetworkRequest::ContentTypeHeader, QStringLiteral("application/json"));
     req.setRawHeader("Authorization", QByteArrayLiteral("Bearer ") + apiKey.toUtf8());
 
-    m_reply = m_nam->post(req, body);
+    m_pendingRequest = req;
+    m_pendingRoot = root;
+    postPendingRequest();
+}
+
+void OpenAiCompatClient::postPendingRequest()
+{
+    const QByteArray body = QJsonDocument(m_pendingRoot).toJson(QJsonDocument::Compact);
+    m_reply = m_nam->post(m_pendingRequest, body);
     if (!m_reply) {
         emit failed(QStringLiteral("无法发起网络请求"));
         return;
@@ -117,6 +123,15 @@ void OpenAiCompatClient::requestChatCompletion(const QString& completionsUrl,
     connect(m_reply, &QNetworkReply::finished, this, &OpenAiCompatClient::onReplyFinished);
 }
 
+bool OpenAiCompatClient::dropStreamOptionsAfterRejection(int httpCode)
+{
+    if (httpCode != 400 || !m_pendingRoot.contains(QStringLiteral("stream_options")))
+        return false;
+    m_pendingRoot.remove(QStringLiteral("stream_options"));
+    m_sseBuffer.clear();
+    return true;
+}
+
 void OpenAiCompatClient::onReadyRead()
 {
     if (!m_reply || !m_streamMode)
@@ -168,6 +183,7 @@ bool OpenAiCompatClient::handleSseLine(const QByteArray& line)
         return true;
 
     const QJsonObject obj = jd.object();
+    reportUsage(obj);
     const QJsonArray choices = obj.value(QStringLiteral("choices")).toArray();
     if (choices.isEmpty())
         return true;
@@ -185,6 +201,26 @@ bool OpenAiCompatClient::handleSseLine(const QByteArray& line)
     return true;
 }
 
+void OpenAiCompatClient::reportUsage(const QJsonObject& root)
+{
+    const QJsonValue usageValue = root.value(QStringLiteral("usage"));
+    if (!usageValue.isObject())
+        return;
+    const QJsonObject usage = usageValue.toObject();
+    const int promptTokens = usage.value(QStringLiteral("prompt_tokens")).toInt();
+    const int completionTokens = usage.value(QStringLiteral("completion_tokens")).toInt();
+    int cachedTokens = usage.value(QStringLiteral("prompt_cache_hit_tokens")).toInt();
+    if (cachedTokens <= 0) {
+        cachedTokens = usage.value(QStringLiteral("prompt_tokens_details"))
+                           .toObject()
+                           .value(QStringLiteral("cached_tokens"))
+                           .toInt();
+    }
+    if (promptTokens <= 0 && completionTokens <= 0)
+        return;
+    emit usageReported(promptTokens, qMax(0, cachedTokens), completionTokens);
+}
+
 void OpenAiCompatClient::onReplyFinished()
 {
     if (!m_reply)
@@ -200,6 +236,13 @@ void OpenAiCompatClient::onReplyFinished()
 
     const auto done = [reply]() { reply->deleteLater(); };
 
+    // 有的兼容服务不认识 stream_options，整个请求直接 400：去掉后重发一次
+    if (dropStreamOptionsAfterRejection(code)) {
+        done();
+        postPendingRequest();
+        return;
+    }
+
     if (reply->error() != QNetworkReply::NoError) {
         if (reply->error() == QNetworkReply::OperationCanceledError) {
             done();
@@ -240,6 +283,7 @@ void OpenAiCompatClient::onReplyFinished()
         return;
     }
     const QJsonObject root = jd.object();
+    reportUsage(root);
     const QJsonArray choices = root.value(QStringLiteral("choices")).toArray();
     if (choices.isEmpty()) {
         emit completed();
@@ -4,6 +4,7 @@
 #include <QByteArray>
 #include <QJsonArray>
 #include <QJsonObject>
+#include <QNetworkRequest>
 #include <QObject>
 #include <QString>
 
@@ -18,6 +19,7 @@ class OpenAiCompatClient : public QObject
 {
     Q_OBJECT
     friend class TestOpenAiCompatClient;
+    friend class BenchHotPaths;
 public:
     explicit OpenAiCompatClient(QNetworkAccessManager* nam, QObject* parent = nullptr);
     ~OpenAiCompatClient() override;
@@ -28,6 +30,8 @@ public:
      * POST JSON to completions URL; emits streamDelta / completed / failed on main thread.
      * 对火山方舟域名会自动附加 thinking=disabled（关闭豆包 Seed 等模型的思考链，除非 extraRootFields 覆盖）。
      * extraRootFields 会与根对象合并（后者覆盖同名键），可用于 max_tokens 等。
+     * stream_options 只由调用方按服务能力放进 extraRootFields；带了它却被服务以 HTTP 400 拒绝时，
+     * 去掉后自动重发一次。收到 usage 后发出 usageReported。
      */
     void requestChatCompletion(const QString& completionsUrl,
                                const QString& apiKey,
@@ -40,6 +44,8 @@ public:
 
 signals:
     void streamDelta(const QString& delta);
+    /** cachedPromptTokens：DeepSeek 的 prompt_cache_hit_tokens 或 prompt_tokens_details.cached_tokens。 */
+    void usageReported(int promptTokens, int cachedPromptTokens, int completionTokens);
     void completed();
     void failed(const QString& reason);
 
@@ -48,11 +54,17 @@ private slots:
     void onReplyFinished();
 
 private:
+    void postPendingRequest();
+    /** HTTP 400 且请求带了 stream_options：去掉它以便重发，返回是否需要重发。 */
+    bool dropStreamOptionsAfterRejection(int httpCode);
     void processSseBuffer();
     bool handleSseLine(const QByteArray& line);
+    void reportUsage(const QJsonObject& root);
 
     QNetworkAccessManager* m_nam = nullptr;
     QNetworkReply* m_reply = nullptr;
+    QNetworkRequest m_pendingRequest;
+    QJsonObject m_pendingRoot;
     QByteArray m_sseBuffer;
     bool m_streamMode = false;
 };
@@ -1,15 +1,20 @@
 #include "aichatappservice.h"
 
+#include "../../data/airequesteventdao.h"
+#include "../../data/customerprofiledao.h"
 #include "../../data/messagedao.h"
+#include "../ai/airequestassembler.h"
 #include "../ai/aiservicefacade.h"
 #include "../ai/aistreamingsession.h"
 
 #include <QFileInfo>
+#include <QJsonDocument>
 #include <QNetworkAccessManager>
 
 namespace {
 
-constexpr int kAggregateRecentHistoryLimit = 12;
+// 只决定从本地缓存读多少条候选历史；实际保留多少由 token 预算决定
+constexpr int kAggregateContextFetchLimit = 120;
 constexpr int kAggregateMessageTextLimit = 1600;
 
 QString boundedText(QString text, int maxChars = kAggregateMessageTextLimit)
@@ -29,17 +34,29 @@ QString roleForAggregateMessage(const MessageRecord& msg)
     return QStringLiteral("user");
 }
 
-QList<AiConversationTurn> buildAggregateHistoryTurns(const QVector<MessageRecord>& messages)
+QList<AiContextHistoryTurn> historyTurnsFromMessages(const QVector<MessageRecord>& messages, qint64 firstOrdinal)
 {
-    QList<AiConversationTurn> turns;
-    const int start = qMax(0, messages.size() - kAggregateRecentHistoryLimit);
-    for (int i = start; i < messages.size(); ++i) {
+    QList<AiContextHistoryTurn> history;
+    for (int i = 0; i < messages.size(); ++i) {
         const QString text = boundedText(messages.at(i).content);
         if (text.isEmpty())
             continue;
-        turns.append(makeAiTextTurn(roleForAggregateMessage(messages.at(i)), text));
+        AiContextHistoryTurn entry;
+        entry.turn = makeAiTextTurn(roleForAggregateMessage(messages.at(i)), text);
+        entry.ordinal = firstOrdinal + i;
+        history.append(entry);
     }
-    return turns;
+    return history;
+}
+
+QList<AiContextHistoryTurn> loadAggregateHistory(const MessageDao& dao, int conversationId)
+{
+    const QVector<MessageRecord> messages =
+        dao.listRecentCachedMessages(conversationId, kAggregateContextFetchLimit);
+    // 序号按会话内消息总数倒推，新消息到来时已有消息的序号不变，历史起点才能稳定对齐
+    const qint64 firstOrdinal =
+        qMax<qint64>(0, dao.countCachedMessages(conversationId) - messages.size());
+    return historyTurnsFromMessages(messages, firstOrdinal);
 }
 
 QString aggregateAiMvpSystemPrompt()
@@ -149,9 +166,6 @@ AggregateAiBuiltRequest AiChatAppService::buildAggregateReplyRequest(int convers
         return built;
     }
 
-    built.request.systemPrompt = aggregateAiMvpSystemPrompt();
-    built.request.turns = buildAggregateHistoryTurns(dao.listCachedMessages(conversationId, 40));
-
     AiConversationTurn userTurn;
     userTurn.role = QStringLiteral("user");
     if (hasUsableImage)
@@ -163,7 +177,17 @@ AggregateAiBuiltRequest AiChatAppService::buildAggregateReplyRequest(int convers
                            ? QStringLiteral("（无 OCR 文本，请根据截图理解客户意图）")
                            : textInbound)
             : QStringLiteral("请结合上面的最近聊天记录和下方客户最新入站内容，生成本条客服回复。\n\n【客户最新入站】\n%1").arg(textInbound)));
+
+    built.request.systemPrompt = aggregateAiMvpSystemPrompt();
+    const AiContextAssembly context = assembleAiContext(built.request.systemPrompt,
+                                                        loadAggregateHistory(dao, conversationId),
+                                                        {userTurn},
+                                                        aiContextBudgetFor(sessionModelKey));
+    built.request.systemPrompt = context.systemPrompt;
+    built.request.turns = context.turns;
     built.request.turns.append(userTurn);
+    built.context = context.stats;
+    built.hedge = planHedge(built.config, built.request);
     return built;
 }
 
@@ -174,6 +198,54 @@ IAiStreamingSession* AiChatAppService::createSession(const AiProviderConfig& con
     return m_facade->createSession(config, request, parent);
 }
 
+IAiStreamingSession* AiChatAppService::createSession(const AggregateAiBuiltRequest& built, QObject* parent) const
+{
+    if (!built.hedge.enabled)
+        return m_facade->createSession(built.config, built.request, parent);
+    return m_facade->createHedgedSession(built.config,
+                                         built.hedge.backupConfig,
+                                         built.request,
+                                         built.hedge.hedgeDelayMs,
+                                         parent);
+}
+
+AggregateAiHedgePlan AiChatAppService::planHedge(const AiProviderConfig& primaryConfig,
+                                                 const AiRequest& request) const
+{
+    AggregateAiHedgePlan plan;
+    const AiHedgePolicy policy = loadAiHedgePolicy();
+    if (!policy.enabled || policy.backupSessionModelKey.isEmpty()
+        || policy.backupSessionModelKey == primaryConfig.sessionModelKey) {
+        return plan;
+    }
+    // 文件附件只走方舟 Responses 单路，不做对冲。
+    if (aiRequestContainsLocalFile(request))
+        return plan;
+
+    AiConfigLoadOptions loadOptions;
+    loadOptions.allowAggregateFallback = true;
+    loadOptions.allowGeneralFallback = true;
+    const AiProviderConfig backup =
+        resolveProviderConfig(policy.backupSessionModelKey, QString(), QString(), QString(), loadOptions);
+    if (!backup.isValidForChat() || !backup.capabilities.supportsStreamingChat)
+        return plan;
+    if (aiRequestContainsImage(request) && !backup.capabilities.supportsVisionDataUrl)
+        return plan;
+
+    int samples = 0;
+    const int percentileMs = AiRequestEventDao().firstTokenPercentileMs(
+        primaryConfig.sessionModelKey, policy.firstTokenPercentile, 200, &samples);
+    const int delayMs = samples >= policy.minSamples && percentileMs > 0
+        ? percentileMs
+        : policy.fallbackHedgeDelayMs;
+
+    plan.enabled = true;
+    plan.backupConfig = backup;
+    plan.sampleCount = samples;
+    plan.hedgeDelayMs = qBound(policy.minHedgeDelayMs, delayMs, policy.maxHedgeDelayMs);
+    return plan;
+}
+
 AggregateAiBuiltRequest AiChatAppService::buildAggregateCustomerProfileRequest(int conversationId,
                                                                                const QString& sessionModelKey) const
 {
@@ -196,18 +268,74 @@ AggregateAiBuiltRequest AiChatAppService::buildAggregateCustomerProfileRequest(i
     }
 
     MessageDao dao;
-    const QVector<MessageRecord> messages = dao.listCachedMessages(conversationId, 40);
-    const QList<AiConversationTurn> turns = buildAggregateHistoryTurns(messages);
-    if (turns.isEmpty()) {
+    const auto lastMessage = dao.lastCachedMessageForConversation(conversationId);
+    built.coveredMessageId = lastMessage ? lastMessage->id : 0;
+    built.request.systemPrompt = aggregateCustomerProfileSystemPrompt();
+    const AiContextBudget budget = aiContextBudgetFor(sessionModelKey);
+
+    // 已有画像且记录了高水位：只把之后的新消息连同旧画像发给模型合并，成本随新增消息增长
+    const auto existing = CustomerProfileDao().findByConversationId(conversationId);
+    if (existing && !existing->profile.isEmpty() && existing->lastMessageId > 0) {
+        if (built.coveredMessageId <= existing->lastMessageId) {
+            built.failure = AggregateAiBuildFailure::ProfileUpToDate;
+            built.failureDetail = QStringLiteral("暂无新的聊天记录");
+            return built;
+        }
+        const QVector<MessageRecord> fresh =
+            dao.listCachedMessagesAfter(conversationId, existing->lastMessageId, kAggregateContextFetchLimit + 1);
+        // ordinal 即 fresh 内下标，用于把实际发出的最后一条映射回消息 id
+        const QList<AiContextHistoryTurn> freshHistory = historyTurnsFromMessages(fresh, 0);
+        // 新消息全是图片等无文字内容：没有可合并的内容，直接推进高水位，不请求模型
+        if (!fresh.isEmpty() && freshHistory.isEmpty()) {
+            CustomerProfileDao().advanceLastMessageId(conversationId, fresh.last().id);
+            built.failure = AggregateAiBuildFailure::ProfileUpToDate;
+            built.failureDetail = QStringLiteral("新消息中没有文字内容");
+            return built;
+        }
+        // 新消息超过读取上限时退回全量整理
+        if (fresh.size() <= kAggregateContextFetchLimit && !freshHistory.isEmpty()) {
+            const AiConversationTurn priorTurn = makeAiTextTurn(
+                QStringLiteral("user"),
+                QStringLiteral("【已有客户信息】\n%1")
+                    .arg(QString::fromUtf8(QJsonDocument(existing->profile).toJson(QJsonDocument::Compact))));
+            const AiConversationTurn instruction = makeAiTextTurn(
+                QStringLiteral("user"),
+                QStringLiteral("以上是已有客户信息及其之后新增的聊天记录。请在已有信息基础上合并更新："
+                               "仍然有效的内容保留，按新消息修正或补充，已解决或过时的诉求删除。只输出完整的指定 JSON。"));
+            // 高水位之前的消息不会再发给模型：预算放不下时只发最早的一段并只覆盖到那里，
+            // 不能让被折叠或丢弃的较早新消息随最新一条一起被记为已整理；余下的留给下一次增量
+            const AiContextAssembly context = assembleAiContextOldestFirst(
+                built.request.systemPrompt, freshHistory, {priorTurn, instruction}, budget);
+            const int sentTurns = context.stats.keptTurns;
+            built.request.systemPrompt = context.systemPrompt;
+            built.request.turns.append(priorTurn);
+            built.request.turns.append(context.turns);
+            built.request.turns.append(instruction);
+            built.context = context.stats;
+            built.coveredMessageId = sentTurns >= freshHistory.size()
+                ? fresh.last().id
+                : fresh.at(int(freshHistory.at(sentTurns - 1).ordinal)).id;
+            built.incrementalProfile = true;
+            built.hedge = planHedge(built.config, built.request);
+            return built;
+        }
+    }
+
+    const QList<AiContextHistoryTurn> history = loadAggregateHistory(dao, conversationId);
+    if (history.isEmpty()) {
         built.failure = AggregateAiBuildFailure::EmptyInbound;
         built.failureDetail = QStringLiteral("暂无可整理的聊天记录");
         return built;
     }
 
-    built.request.systemPrompt = aggregateCustomerProfileSystemPrompt();
-    built.request.turns = turns;
-    built.request.turns.append(makeAiTextTurn(
+    const AiConversationTurn instruction = makeAiTextTurn(
         QStringLiteral("user"),
-        QStringLiteral("请根据上面的最近聊天记录，整理这位客户的信息。只输出指定 JSON。")));
+        QStringLiteral("请根据上面的最近聊天记录，整理这位客户的信息。只输出指定 JSON。"));
+    const AiContextAssembly context = assembleAiContext(built.request.systemPrompt, history, {instruction}, budget);
+    built.request.systemPrompt = context.systemPrompt;
+    built.request.turns = context.turns;
+    built.request.turns.append(instruction);
+    built.context = context.stats;
+    built.hedge = planHedge(built.config, built.request);
     return built;
 }
@@ -1,6 +1,7 @@
 #ifndef AICHATAPPSERVICE_H
 #define AICHATAPPSERVICE_H
 
+#include "../ai/aicontextassembler.h"
 #include "../ai/aiprovidercatalog.h"
 #include "../ai/aitypes.h"
 #include <QObject>
@@ -17,6 +18,15 @@ enum class AggregateAiBuildFailure {
     MissingInboundImage,
     EmptyInbound,
     VisionUnsupported,
+    ProfileUpToDate,
+};
+
+/** 对冲计划：enabled 时由 createSession(built) 创建主/备双路会话。 */
+struct AggregateAiHedgePlan {
+    bool enabled = false;
+    AiProviderConfig backupConfig;
+    int hedgeDelayMs = 0;
+    int sampleCount = 0;
 };
 
 struct AggregateAiBuiltRequest {
@@ -24,6 +34,12 @@ struct AggregateAiBuiltRequest {
     QString failureDetail;
     AiProviderConfig config;
     AiRequest request;
+    AggregateAiHedgePlan hedge;
+    /** 上下文组装统计（估算 prompt tokens、保留/省略的历史条数）。 */
+    AiContextStats context;
+    /** 客户信息整理：本次请求覆盖到的最后一条消息 id（写回画像高水位），以及是否为增量合并。 */
+    qint64 coveredMessageId = 0;
+    bool incrementalProfile = false;
 
     bool ok() const { return failure == AggregateAiBuildFailure::None; }
 };
@@ -46,8 +62,12 @@ public:
     IAiStreamingSession* createSession(const AiProviderConfig& config,
                                        const AiRequest& request,
                                        QObject* parent) const;
+    /** 按 built.hedge 决定创建普通会话或对冲会话。 */
+    IAiStreamingSession* createSession(const AggregateAiBuiltRequest& built, QObject* parent) const;
 
 private:
+    AggregateAiHedgePlan planHedge(const AiProviderConfig& primaryConfig, const AiRequest& request) const;
+
     QNetworkAccessManager* m_network = nullptr;
     AiServiceFacade* m_facade = nullptr;
 };
@@ -3,6 +3,7 @@
 #include "../../ipc/ipcservice.h"
 #include "../../ipc/ipctypes.h"
 #include "../../utils/appsettings.h"
+#include "../../utils/metrics.h"
 
 #include <QCoreApplication>
 #include <QDateTime>
@@ -145,6 +146,7 @@ void PythonServiceController::startService()
     m_startupPollsRemaining = 16;
     appendHumanLog(QStringLiteral("正在启动 Python 服务（debug 模式），请稍等。"));
     setState(State::Starting);
+    m_startupTimer.start();
     m_process->start(pythonExe.isEmpty() ? QStringLiteral("python") : pythonExe, args);
 }
 
@@ -223,6 +225,9 @@ void PythonServiceController::onProcessFinished(int exitCode, QProcess::ExitStat
         Ipc::IpcService::instance().markServiceUnavailable();
     } else {
         appendHumanLog(QStringLiteral("Python 服务意外退出，请查看上方提示或确认依赖是否完整。"));
+        static Metrics::Counter* const unexpectedExits = Metrics::counter(
+            QStringLiteral("python_service_unexpected_exits_total"), {}, QStringLiteral("Python 服务意外退出次数"));
+        unexpectedExits->increment();
         setState(State::Failed);
         QTimer::singleShot(0, this, []() {
             Ipc::IpcService::instance().connectToConfiguredService();
@@ -269,6 +274,9 @@ void PythonServiceController::pollStartupHealth()
     Ipc::HealthCheckResponse health = Ipc::IpcService::instance().checkHealth();
     if (health.status == Ipc::ResponseStatus::Success && health.healthy) {
         m_startupPollTimer->stop();
+        static Metrics::Histogram* const startup = Metrics::histogram(
+            QStringLiteral("python_service_startup_us"), {}, QStringLiteral("启动 Python 服务到健康检查通过的耗时（微秒）"));
+        startup->record(m_startupTimer.nsecsElapsed() / 1000);
         finishAsConnected(State::Running, QStringLiteral("Python 服务已就绪，可以开始平台监听。"));
         QTimer::singleShot(0, this, []() {
             Ipc::IpcService::instance().connectToConfiguredService();
@@ -289,6 +297,10 @@ void PythonServiceController::setState(State state)
     if (m_state == state)
         return;
     m_state = state;
+    static Metrics::Gauge* const stateGauge = Metrics::gauge(
+        QStringLiteral("python_service_state"), {},
+        QStringLiteral("Python 服务状态：0 已停止 1 启动中 2 运行中 3 外部运行 4 停止中 5 失败"));
+    stateGauge->set(static_cast<int>(m_state));
     emit stateChanged(m_state);
 }
 
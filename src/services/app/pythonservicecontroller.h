@@ -1,6 +1,7 @@
 #ifndef PYTHONSERVICECONTROLLER_H
 #define PYTHONSERVICECONTROLLER_H
 
+#include <QElapsedTimer>
 #include <QObject>
 #include <QProcess>
 #include <QStringList>
@@ -59,6 +60,7 @@ private:
 
     QProcess* m_process = nullptr;
     QTimer* m_startupPollTimer = nullptr;
+    QElapsedTimer m_startupTimer;
     State m_state = State::Stopped;
     QStringList m_humanLogs;
     int m_startupPollsRemaining = 0;
@@ -0,0 +1,158 @@
+#include "simloadrunner.h"
+#include "../../core/messagerouter.h"
+#include "../../data/conversationdao.h"
+#include "../../data/messagedao.h"
+#include "../../utils/processmemory.h"
+#include <QDebug>
+#include <QEventLoop>
+#include <QTimer>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+constexpr int kRssSampleIntervalMs = 100;
+
+double percentileMs(const QVector<qint64>& sortedNs, double q)
+{
+    if (sortedNs.isEmpty())
+        return 0.0;
+    const int rank = int(std::ceil(q * sortedNs.size())) - 1;
+    return sortedNs.at(qBound(0, rank, int(sortedNs.size()) - 1)) / 1e6;
+}
+} // namespace
+
+QJsonObject SimLoadReport::toJson() const
+{
+    QJsonObject obj;
+    obj.insert(QStringLiteral("generated"), load.generated);
+    obj.insert(QStringLiteral("duplicates_injected"), load.duplicates);
+    obj.insert(QStringLiteral("reordered_injected"), load.reordered);
+    obj.insert(QStringLiteral("images"), load.images);
+    obj.insert(QStringLiteral("delivered"), delivered);
+    obj.insert(QStringLiteral("elapsed_ms"), elapsedMs);
+    obj.insert(QStringLiteral("messages_per_second"), messagesPerSecond);
+    obj.insert(QStringLiteral("capacity_per_second"), capacityPerSecond);
+    obj.insert(QStringLiteral("latency_p50_ms"), p50Ms);
+    obj.insert(QStringLiteral("latency_p99_ms"), p99Ms);
+    obj.insert(QStringLiteral("latency_max_ms"), maxMs);
+    obj.insert(QStringLiteral("rss_start_bytes"), rssStartBytes);
+    obj.insert(QStringLiteral("rss_peak_bytes"), rssPeakBytes);
+    obj.insert(QStringLiteral("rss_end_bytes"), rssEndBytes);
+    obj.insert(QStringLiteral("timed_out"), timedOut);
+    return obj;
+}
+
+SimLoadRunner::SimLoadRunner(MessageRouter* router, SimPlatformAdapter* adapter, QObject* parent)
+    : QObject(parent)
+    , m_router(router)
+    , m_adapter(adapter)
+{
+    m_rssTimer = new QTimer(this);
+    m_rssTimer->setInterval(kRssSampleIntervalMs);
+    connect(m_rssTimer, &QTimer::timeout, this, &SimLoadRunner::sampleRss);
+    if (m_router)
+        connect(m_router, &MessageRouter::messageReceived, this, &SimLoadRunner::onMessageReceived);
+}
+
+SimLoadReport SimLoadRunner::run(const SimLoadProfile& profile, int timeoutMs)
+{
+    SimLoadReport report;
+    if (!m_router || !m_adapter) {
+        qWarning() << "[SimLoadRunner] router or adapter is null";
+        return report;
+    }
+
+    m_messageModel.clear();
+    m_delivered = 0;
+    m_lastDeliveredNs = 0;
+    m_latenciesNs.clear();
+    m_latenciesNs.reserve(qMax(0, profile.totalMessages));
+    report.rssStartBytes = ProcessMemory::residentBytes();
+    m_rssPeakBytes = report.rssStartBytes;
+
+    QEventLoop loop;
+    const auto finished = connect(m_adapter, &SimPlatformAdapter::loadFinished, &loop, &QEventLoop::quit);
+    QTimer timeout;
+    timeout.setSingleShot(true);
+    connect(&timeout, &QTimer::timeout, &loop, [&]() {
+        report.timedOut = true;
+        m_adapter->stopLoad();
+        loop.quit();
+    });
+
+    m_running = true;
+    m_rssTimer->start();
+    if (timeoutMs > 0)
+        timeout.start(timeoutMs);
+    m_adapter->startLoad(profile);
+    if (m_adapter->isLoadRunning())
+        loop.exec();
+    m_rssTimer->stop();
+    m_running = false;
+    disconnect(finished);
+
+    sampleRss();
+    report.load = m_adapter->loadStats();
+    report.delivered = m_delivered;
+    report.elapsedMs = m_lastDeliveredNs / 1000000;
+    report.rssPeakBytes = m_rssPeakBytes;
+    report.rssEndBytes = ProcessMemory::residentBytes();
+    if (m_lastDeliveredNs > 0)
+        report.messagesPerSecond = m_delivered * 1e9 / double(m_lastDeliveredNs);
+    if (report.load.ingestBusyNs > 0)
+        report.capacityPerSecond = m_delivered * 1e9 / double(report.load.ingestBusyNs);
+
+    std::sort(m_latenciesNs.begin(), m_latenciesNs.end());
+    report.p50Ms = percentileMs(m_latenciesNs, 0.50);
+    report.p99Ms = percentileMs(m_latenciesNs, 0.99);
+    report.maxMs = m_latenciesNs.isEmpty() ? 0.0 : m_latenciesNs.last() / 1e6;
+
+    qInfo() << "[SimLoadRunner] 压测完成"
+            << "delivered=" << report.delivered
+            << "generated=" << report.load.generated
+            << "msgPerSec=" << report.messagesPerSecond
+            << "capacityPerSec=" << report.capacityPerSecond
+            << "p50Ms=" << report.p50Ms
+            << "p99Ms=" << report.p99Ms
+            << "rssPeakBytes=" << report.rssPeakBytes
+            << "timedOut=" << report.timedOut;
+    return report;
+}
+
+void SimLoadRunner::onMessageReceived(int conversationId, const MessageRecord& record)
+{
+    if (!m_running)
+        return;
+
+    // 与聚合聊天页一致：未选中会话时打开第一条消息所在会话，之后只追加当前会话
+    if (m_messageModel.conversationId() <= 0) {
+        MessageDao msgDao;
+        m_messageModel.setConversationMessages(conversationId, msgDao.listCachedMessages(conversationId));
+    } else if (conversationId == m_messageModel.conversationId()) {
+        m_messageModel.appendMessage(record);
+    }
+    refreshConversationList();
+
+    const qint64 emittedAtNs = m_adapter->takeEmittedAtNs(record.platformMsgId);
+    const qint64 nowNs = m_adapter->loadClockNs();
+    if (emittedAtNs >= 0)
+        m_latenciesNs.append(nowNs - emittedAtNs);
+    m_lastDeliveredNs = nowNs;
+    ++m_delivered;
+}
+
+void SimLoadRunner::refreshConversationList()
+{
+    ConversationDao convDao;
+    MessageDao msgDao;
+    const QVector<ConversationInfo> conversations = convDao.listCachedConversations();
+    m_conversationModel.setSourceConversations(conversations,
+                                               msgDao.lastCachedDirectionsByConversation(conversations));
+}
+
+void SimLoadRunner::sampleRss()
+{
+    const qint64 rss = ProcessMemory::residentBytes();
+    if (rss > m_rssPeakBytes)
+        m_rssPeakBytes = rss;
+}
@@ -0,0 +1,65 @@
+#ifndef SIMLOADRUNNER_H
+#define SIMLOADRUNNER_H
+
+#include "../platforms/simplatformadapter.h"
+#include "../../ui/conversationlistmodel.h"
+#include "../../ui/messagelistmodel.h"
+#include <QJsonObject>
+#include <QObject>
+#include <QVector>
+
+class MessageRouter;
+class QTimer;
+
+struct SimLoadReport {
+    SimLoadStats load;
+    int delivered = 0;              // 进入列表模型的消息数（重复注入应被路由丢弃）
+    qint64 elapsedMs = 0;
+    double messagesPerSecond = 0.0; // 实际吞吐：delivered / elapsed
+    double capacityPerSecond = 0.0; // 处理能力：delivered / 路由+入库+模型的累计耗时
+    double p50Ms = 0.0;             // 平台发出 -> 模型更新完成
+    double p99Ms = 0.0;
+    double maxMs = 0.0;
+    qint64 rssStartBytes = -1;
+    qint64 rssPeakBytes = -1;
+    qint64 rssEndBytes = -1;
+    bool timedOut = false;
+
+    QJsonObject toJson() const;
+};
+
+/**
+ * 无界面压测：SimPlatformAdapter 产生负载，经真实 MessageRouter、DAO 入库，
+ * 再按聚合聊天页的方式更新 MessageListModel / ConversationListModel。
+ * 调用方负责打开数据库、注册适配器，并在需要时开启本地缓存入库模式。
+ */
+class SimLoadRunner : public QObject
+{
+    Q_OBJECT
+public:
+    SimLoadRunner(MessageRouter* router, SimPlatformAdapter* adapter, QObject* parent = nullptr);
+
+    /** 运行一轮压测；内部跑本地事件循环，直到负载发完或超时。 */
+    SimLoadReport run(const SimLoadProfile& profile, int timeoutMs = 120000);
+
+    MessageListModel* messageModel() { return &m_messageModel; }
+    ConversationListModel* conversationModel() { return &m_conversationModel; }
+
+private:
+    void onMessageReceived(int conversationId, const MessageRecord& record);
+    void refreshConversationList();
+    void sampleRss();
+
+    MessageRouter* m_router = nullptr;
+    SimPlatformAdapter* m_adapter = nullptr;
+    MessageListModel m_messageModel;
+    ConversationListModel m_conversationModel;
+    QTimer* m_rssTimer = nullptr;
+    bool m_running = false;
+    int m_delivered = 0;
+    qint64 m_lastDeliveredNs = 0;
+    qint64 m_rssPeakBytes = -1;
+    QVector<qint64> m_latenciesNs;
+};
+
+#endif // SIMLOADRUNNER_H
@@ -0,0 +1,206 @@
+#include "outboundsendqueue.h"
+#include "../../utils/metrics.h"
+#include <QDateTime>
+#include <QDebug>
+#include <QTimer>
+#include <QUuid>
+
+OutboundSendQueue::OutboundSendQueue(const QString& platform,
+                                     const QString& accountId,
+                                     Dispatcher dispatcher,
+                                     int maxInFlight,
+                                     QObject* parent)
+    : QObject(parent)
+    , m_platform(platform)
+    , m_accountId(accountId)
+    , m_dispatcher(std::move(dispatcher))
+    , m_maxInFlight(qMax(1, maxInFlight))
+{
+    const Metrics::Labels labels{{QStringLiteral("platform"), m_platform}};
+    m_depthGauge = Metrics::gauge(QStringLiteral("outbound_send_queue_depth"), labels,
+                                  QStringLiteral("出站发送队列中等待派发的命令数"));
+    m_inFlightGauge = Metrics::gauge(QStringLiteral("outbound_send_queue_in_flight"), labels,
+                                     QStringLiteral("已派发、等待回执的命令数"));
+    m_oldestAgeGauge = Metrics::gauge(QStringLiteral("outbound_send_queue_oldest_age_ms"), labels,
+                                      QStringLiteral("队列中最早命令已等待的毫秒数"));
+}
+
+QString OutboundSendQueue::enqueue(const QString& conversationKey,
+                                   const OutgoingMessagePart& part,
+                                   const QString& clientMessageId)
+{
+    OutboundSendRecord record;
+    record.platform = m_platform;
+    record.accountId = m_accountId;
+    record.conversationKey = conversationKey;
+    record.clientMessageId = clientMessageId.isEmpty()
+        ? QUuid::createUuid().toString(QUuid::WithoutBraces)
+        : clientMessageId;
+    record.part = part;
+    record.enqueuedAt = QDateTime::currentDateTime();
+    bool existed = false;
+    record.id = m_dao.enqueue(record, &existed);
+    if (existed) {
+        // 同一命令已在队列或在途中（未恢复的会由 restorePending 接上），不再排第二份
+        qInfo() << "[OutboundSendQueue] duplicate enqueue ignored"
+                << "platform=" << m_platform
+                << "conversation=" << conversationKey
+                << "clientMessageId=" << record.clientMessageId;
+        return record.clientMessageId;
+    }
+    m_pending.append(record);
+    qInfo() << "[OutboundSendQueue] enqueued"
+            << "platform=" << m_platform
+            << "conversation=" << conversationKey
+            << "clientMessageId=" << record.clientMessageId
+            << "depth=" << m_pending.size()
+            << "inFlight=" << m_inFlight.size();
+    publishMetrics();
+    schedulePump();
+    return record.clientMessageId;
+}
+
+void OutboundSendQueue::restorePending()
+{
+    if (m_restored)
+        return;
+    m_restored = true;
+
+    const QVector<OutboundSendRecord> stored = m_dao.listPending(m_platform, m_accountId);
+    int resumed = 0;
+    for (const OutboundSendRecord& record : stored) {
+        if (m_inFlight.contains(record.clientMessageId))
+            continue;
+        bool alreadyQueued = false;
+        for (const OutboundSendRecord& pending : m_pending) {
+            if (pending.clientMessageId == record.clientMessageId) {
+                alreadyQueued = true;
+                break;
+            }
+        }
+        if (alreadyQueued)
+            continue;
+        if (record.state == QLatin1String("in_flight")) {
+            // 已交给 sidecar 但没收到回执：重发可能造成重复消息，交由用户确认后重试
+            m_dao.remove(record.clientMessageId);
+            emit sendAbandoned(record.conversationKey, QStringLiteral("send_interrupted"), record.clientMessageId);
+            continue;
+        }
+        m_pending.append(record);
+        ++resumed;
+    }
+    if (resumed > 0) {
+        qInfo() << "[OutboundSendQueue] restored pending sends"
+                << "platform=" << m_platform
+                << "count=" << resumed;
+        publishMetrics();
+        schedulePump();
+    }
+}
+
+bool OutboundSendQueue::complete(const QString& clientMessageId)
+{
+    if (clientMessageId.isEmpty() || !m_inFlight.contains(clientMessageId))
+        return false;
+    finish(clientMessageId);
+    schedulePump();
+    return true;
+}
+
+qint64 OutboundSendQueue::oldestAgeMs() const
+{
+    QDateTime oldest;
+    for (const OutboundSendRecord& record : m_pending) {
+        if (!oldest.isValid() || record.enqueuedAt < oldest)
+            oldest = record.enqueuedAt;
+    }
+    for (const OutboundSendRecord& record : m_inFlight) {
+        if (!oldest.isValid() || record.enqueuedAt < oldest)
+            oldest = record.enqueuedAt;
+    }
+    return oldest.isValid() ? qMax<qint64>(0, oldest.msecsTo(QDateTime::currentDateTime())) : 0;
+}
+
+void OutboundSendQueue::schedulePump()
+{
+    if (m_pumpScheduled)
+        return;
+    m_pumpScheduled = true;
+    QTimer::singleShot(0, this, [this]() {
+        m_pumpScheduled = false;
+        pump();
+    });
+}
+
+int OutboundSendQueue::nextDispatchableIndex() const
+{
+    // 同一会话只看最早的一条；前面有同会话命令未完成时整条会话暂停
+    QSet<QString> blocked = m_busyConversations;
+    for (int i = 0; i < m_pending.size(); ++i) {
+        const QString& key = m_pending.at(i).conversationKey;
+        if (!blocked.contains(key))
+            return i;
+        blocked.insert(key);
+    }
+    return -1;
+}
+
+void OutboundSendQueue::pump()
+{
+    // 派发过程中 IPC 会跑嵌套事件循环，期间新的入队/回执只安排下一轮
+    if (m_dispatching)
+        return;
+    m_dispatching = true;
+    while (m_inFlight.size() < m_maxInFlight) {
+        const int index = nextDispatchableIndex();
+        if (index < 0)
+            break;
+        OutboundSendRecord record = m_pending.takeAt(index);
+        record.state = QStringLiteral("in_flight");
+        ++record.attempts;
+        m_inFlight.insert(record.clientMessageId, record);
+        m_busyConversations.insert(record.conversationKey);
+        m_dao.markInFlight(record.clientMessageId);
+
+        const qint64 queuedMs = record.enqueuedAt.isValid()
+            ? record.enqueuedAt.msecsTo(QDateTime::currentDateTime())
+            : 0;
+        qInfo() << "[OutboundSendQueue] dispatch"
+                << "platform=" << m_platform
+                << "conversation=" << record.conversationKey
+                << "clientMessageId=" << record.clientMessageId
+                << "queuedMs=" << queuedMs
+                << "depth=" << m_pending.size()
+                << "inFlight=" << m_inFlight.size();
+        publishMetrics();
+
+        const OutboundDispatchResult result = m_dispatcher
+            ? m_dispatcher(record)
+            : OutboundDispatchResult::Failed;
+        if (result != OutboundDispatchResult::AwaitingConfirm)
+            finish(record.clientMessageId);
+    }
+    m_dispatching = false;
+    if (m_inFlight.size() < m_maxInFlight && nextDispatchableIndex() >= 0)
+        schedulePump();
+}
+
+void OutboundSendQueue::finish(const QString& clientMessageId)
+{
+    const auto it = m_inFlight.find(clientMessageId);
+    if (it == m_inFlight.end())
+        return;
+    m_busyConversations.remove(it->conversationKey);
+    m_inFlight.erase(it);
+    m_dao.remove(clientMessageId);
+    publishMetrics();
+}
+
+void OutboundSendQueue::publishMetrics()
+{
+    const qint64 oldestAge = oldestAgeMs();
+    m_depthGauge->set(m_pending.size());
+    m_inFlightGauge->set(m_inFlight.size());
+    m_oldestAgeGauge->set(static_cast<double>(oldestAge));
+    emit metricsChanged(m_pending.size(), m_inFlight.size(), oldestAge);
+}
@@ -0,0 +1,85 @@
+#ifndef OUTBOUNDSENDQUEUE_H
+#define OUTBOUNDSENDQUEUE_H
+
+#include "../../data/outboundsendqueuedao.h"
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QSet>
+#include <functional>
+
+namespace Metrics {
+class Gauge;
+}
+
+enum class OutboundDispatchResult {
+    Completed,       // sidecar 同步返回已发出（或已按旧逻辑安排 messageSent）
+    AwaitingConfirm, // sidecar 已受理，等待 message_sent / send_failed 事件或超时
+    Failed,          // 命令失败，适配器已发出 sendFailed
+};
+
+/**
+ * 单个平台账号的出站发送队列。
+ *
+ * - 同一会话严格 FIFO：前一条未完成（含等待回执）时后一条不派发；
+ * - 不同会话可并行，最多 maxInFlight 条处于等待回执状态；
+ * - 入队即写入 outbound_send_queue，重启后未派发的命令继续发送，
+ *   重启前已派发但未确认的命令无法判断是否已发出，按 send_interrupted 失败处理；
+ * - 完成或失败后立即派发下一条，不再轮询等待。
+ */
+class OutboundSendQueue : public QObject
+{
+    Q_OBJECT
+public:
+    using Dispatcher = std::function<OutboundDispatchResult(const OutboundSendRecord&)>;
+
+    static constexpr int kDefaultMaxInFlight = 3;
+
+    OutboundSendQueue(const QString& platform,
+                      const QString& accountId,
+                      Dispatcher dispatcher,
+                      int maxInFlight = kDefaultMaxInFlight,
+                      QObject* parent = nullptr);
+
+    /** 入队并返回 client_message_id（为空时生成）。 */
+    QString enqueue(const QString& conversationKey,
+                    const OutgoingMessagePart& part,
+                    const QString& clientMessageId = QString());
+    /** 从客户端库恢复上次退出时未完成的命令；只执行一次。 */
+    void restorePending();
+    /** 收到回执（成功或失败）或确认超时；返回该命令此前是否仍在等待。 */
+    bool complete(const QString& clientMessageId);
+
+    int depth() const { return m_pending.size(); }
+    int inFlightCount() const { return m_inFlight.size(); }
+    qint64 oldestAgeMs() const;
+
+signals:
+    /** 命令在派发前被放弃（如重启中断），适配器据此发出 sendFailed。 */
+    void sendAbandoned(const QString& conversationKey, const QString& reason, const QString& clientMessageId);
+    void metricsChanged(int depth, int inFlight, qint64 oldestAgeMs);
+
+private:
+    void schedulePump();
+    void pump();
+    int nextDispatchableIndex() const;
+    void finish(const QString& clientMessageId);
+    void publishMetrics();
+
+    QString m_platform;
+    QString m_accountId;
+    Dispatcher m_dispatcher;
+    int m_maxInFlight = kDefaultMaxInFlight;
+    OutboundSendQueueDao m_dao;
+    QList<OutboundSendRecord> m_pending;
+    QHash<QString, OutboundSendRecord> m_inFlight;
+    QSet<QString> m_busyConversations;
+    bool m_dispatching = false;
+    bool m_pumpScheduled = false;
+    bool m_restored = false;
+    Metrics::Gauge* m_depthGauge = nullptr;
+    Metrics::Gauge* m_inFlightGauge = nullptr;
+    Metrics::Gauge* m_oldestAgeGauge = nullptr;
+};
+
+#endif // OUTBOUNDSENDQUEUE_H
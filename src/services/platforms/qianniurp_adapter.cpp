@@ -1,11 +1,11 @@
 #include "qianniurp_adapter.h"
 #include "../../ipc/ipcservice.h"
+#include "../../utils/tracing.h"
 #include <QDateTime>
 #include <QDebug>
 #include <QElapsedTimer>
 #include <QStringList>
 #include <QTimer>
-#include <QUuid>
 
 namespace {
 const QString kQianniuSidecarPlatform = QStringLiteral("qianniu");
@@ -90,6 +90,11 @@ QString outgoingContent(const OutgoingMessagePart& part)
 QianniuRPAAdapter::QianniuRPAAdapter(QObject* parent)
     : IPlatformAdapter(parent)
 {
+    m_sendQueue = new OutboundSendQueue(
+        platformName(), accountId(),
+        [this](const OutboundSendRecord& record) { return dispatchSend(record); },
+        OutboundSendQueue::kDefaultMaxInFlight, this);
+    connect(m_sendQueue, &OutboundSendQueue::sendAbandoned, this, &IPlatformAdapter::sendFailed);
     connect(&Ipc::IpcService::instance(), &Ipc::IpcService::platformEventReceived,
             this, &QianniuRPAAdapter::handleRpaEvent);
     connect(&Ipc::IpcService::instance(), &Ipc::IpcService::platformEventBridgeStateChanged,
@@ -142,6 +147,7 @@ void QianniuRPAAdapter::startListening()
 
     if (!m_connected)
         connectPlatform();
+    m_sendQueue->restorePending();
     qInfo() << "[QianniuRPAAdapter] startListening with WebSocket command/event bridge"
             << "elapsedMs=" << timer.elapsed();
 }
@@ -170,25 +176,21 @@ void QianniuRPAAdapter::sendMessagePart(const QString& conversationId,
                                         const OutgoingMessagePart& part,
                                         const QString& clientMessageId)
 {
+    m_sendQueue->enqueue(conversationId, part, clientMessageId);
+}
+
+OutboundDispatchResult QianniuRPAAdapter::dispatchSend(const OutboundSendRecord& record)
+{
+    const QString& conversationId = record.conversationKey;
+    const OutgoingMessagePart& part = record.part;
     const QString content = outgoingContent(part);
-    QElapsedTimer totalTimer;
-    totalTimer.start();
-    if (m_commandInFlight) {
-        qInfo() << "[QianniuRPAAdapter] sendMessage delayed: command already in flight";
-        QTimer::singleShot(200, this, [this, conversationId, part, clientMessageId]() {
-            sendMessagePart(conversationId, part, clientMessageId);
-        });
-        return;
-    }
+    Tracing::Span totalSpan("qianniu.dispatch_send", "adapter", record.clientMessageId);
 
-    m_commandInFlight = true;
     Ipc::PlatformCommandRequest request;
     request.commandType = QStringLiteral("send_message");
     request.platform = kQianniuSidecarPlatform;
     request.accountId = accountId();
-    request.taskId = clientMessageId.isEmpty()
-        ? QUuid::createUuid().toString(QUuid::WithoutBraces)
-        : clientMessageId;
+    request.taskId = record.clientMessageId;
     request.parameters.insert(QStringLiteral("client_message_id"), request.taskId);
     request.parameters.insert(QStringLiteral("conversation_key"), conversationId);
     request.parameters.insert(QStringLiteral("display_name"), displayNameFromConversationKey(conversationId));
@@ -200,14 +202,13 @@ void QianniuRPAAdapter::sendMessagePart(const QString& conversationId,
     request.parameters.insert(QStringLiteral("size_bytes"), double(part.sizeBytes));
     request.parameters.insert(QStringLiteral("confirm_token"), QStringLiteral("manual_confirmed_by_agent"));
 
-    QElapsedTimer commandTimer;
-    commandTimer.start();
+    Tracing::Span commandSpan("qianniu.send_command", "ipc", request.taskId);
     const auto response = Ipc::IpcService::instance().sendPlatformCommandViaWebSocket(request, 4000);
-    const qint64 commandElapsedMs = commandTimer.elapsed();
-    m_commandInFlight = false;
+    const qint64 commandElapsedMs = commandSpan.end();
     auto scheduleConfirmTimeout = [this, conversationId, clientMessageId = request.taskId]() {
         QTimer::singleShot(30000, this, [this, conversationId, clientMessageId]() {
-            emit sendFailed(conversationId, QStringLiteral("send_confirm_timeout"), clientMessageId);
+            if (m_sendQueue->complete(clientMessageId))
+                emit sendFailed(conversationId, QStringLiteral("send_confirm_timeout"), clientMessageId);
         });
     };
     if (response.status == Ipc::ResponseStatus::Success) {
@@ -218,20 +219,20 @@ void QianniuRPAAdapter::sendMessagePart(const QString& conversationId,
                 << "conversation=" << conversationId
                 << "clientMessageId=" << request.taskId
                 << "commandElapsedMs=" << commandElapsedMs
-                << "totalElapsedMs=" << totalTimer.elapsed()
+                << "totalElapsedMs=" << totalSpan.elapsedMs()
                 << "accepted=" << accepted
                 << "method=" << result.value(QStringLiteral("method")).toString()
                 << "sent=" << sent;
         if (accepted && !sent) {
             scheduleConfirmTimeout();
-            return;
+            return OutboundDispatchResult::AwaitingConfirm;
         }
         if (!m_eventSocketConnected) {
             QTimer::singleShot(300, this, [this, conversationId, content, clientMessageId = request.taskId]() {
                 emit messageSent(conversationId, content, clientMessageId);
             });
         }
-        return;
+        return OutboundDispatchResult::Completed;
     }
 
     if (response.status == Ipc::ResponseStatus::Timeout
@@ -240,25 +241,25 @@ void QianniuRPAAdapter::sendMessagePart(const QString& conversationId,
                    << "conversation=" << conversationId
                    << "clientMessageId=" << request.taskId
                    << "commandElapsedMs=" << commandElapsedMs
-                   << "totalElapsedMs=" << totalTimer.elapsed();
+                   << "totalElapsedMs=" << totalSpan.elapsedMs();
         scheduleConfirmTimeout();
-        return;
+        return OutboundDispatchResult::AwaitingConfirm;
     }
 
     qWarning() << "[QianniuRPAAdapter] sendMessage failed:"
                << response.errorMessage
                << "commandElapsedMs=" << commandElapsedMs
-               << "totalElapsedMs=" << totalTimer.elapsed();
+               << "totalElapsedMs=" << totalSpan.elapsedMs();
     emit sendFailed(conversationId, response.errorMessage.isEmpty()
                                     ? QStringLiteral("qianniu_sidecar_command_failed")
                                     : response.errorMessage,
                     request.taskId);
+    return OutboundDispatchResult::Failed;
 }
 
 void QianniuRPAAdapter::handleRpaEvent(const QJsonObject& event)
 {
-    QElapsedTimer timer;
-    timer.start();
+    Tracing::Span eventSpan("qianniu.handle_event", "adapter");
     if (event.value(QStringLiteral("platform")).toString().trimmed().toLower() != kQianniuSidecarPlatform)
         return;
 
@@ -282,6 +283,7 @@ void QianniuRPAAdapter::handleRpaEvent(const QJsonObject& event)
         payloadObject.value(QStringLiteral("client_message_id")).toString(
             event.value(QStringLiteral("task_id")).toString(
                 payloadObject.value(QStringLiteral("task_id")).toString())));
+    eventSpan.setCorrelationId(!clientMessageId.isEmpty() ? clientMessageId : eventId);
     qInfo() << "[QianniuRPAAdapter] realtime event received"
             << "type=" << type
             << "eventId=" << eventId
@@ -294,22 +296,21 @@ void QianniuRPAAdapter::handleRpaEvent(const QJsonObject& event)
         qInfo() << "[QianniuRPAAdapter] event timing"
                 << "type=" << type
                 << "eventId=" << eventId
-                << "elapsedMs=" << timer.elapsed();
+                << "elapsedMs=" << eventSpan.elapsedMs();
         return;
     }
 
     if (type == QLatin1String("message_observed")) {
-        QElapsedTimer convertTimer;
-        convertTimer.start();
+        Tracing::Span convertSpan("qianniu.convert_event", "adapter", eventId);
         const PlatformMessage msg = platformMessageFromEvent(event);
-        const qint64 convertElapsedMs = convertTimer.elapsed();
+        const qint64 convertElapsedMs = convertSpan.end();
         if (!msg.platformConversationId.isEmpty() && !msg.content.isEmpty())
             emit incomingMessage(msg);
         qInfo() << "[QianniuRPAAdapter] event timing"
                 << "type=" << type
                 << "eventId=" << eventId
                 << "convertElapsedMs=" << convertElapsedMs
-                << "elapsedMs=" << timer.elapsed()
+                << "elapsedMs=" << eventSpan.elapsedMs()
                 << "emitted=" << (!msg.platformConversationId.isEmpty() && !msg.content.isEmpty());
         return;
     }
@@ -321,7 +322,7 @@ void QianniuRPAAdapter::handleRpaEvent(const QJsonObject& event)
         qInfo() << "[QianniuRPAAdapter] conversation cleared event"
                 << "conversation=" << conversation
                 << "eventId=" << eventId
-                << "elapsedMs=" << timer.elapsed();
+                << "elapsedMs=" << eventSpan.elapsedMs();
         return;
     }
 
@@ -332,11 +333,12 @@ void QianniuRPAAdapter::handleRpaEvent(const QJsonObject& event)
         qInfo() << "[QianniuRPAAdapter] conversation deleted event"
                 << "conversation=" << conversation
                 << "eventId=" << eventId
-                << "elapsedMs=" << timer.elapsed();
+                << "elapsedMs=" << eventSpan.elapsedMs();
         return;
     }
 
     if (type == QLatin1String("message_sent")) {
+        m_sendQueue->complete(clientMessageId);
         const QString conversation = normalizeConversationKey(event.value(QStringLiteral("conversation_key")).toString());
         if (!conversation.isEmpty()) {
             qInfo() << "[QianniuRPAAdapter] message_sent event"
@@ -347,11 +349,12 @@ void QianniuRPAAdapter::handleRpaEvent(const QJsonObject& event)
         qInfo() << "[QianniuRPAAdapter] event timing"
                 << "type=" << type
                 << "eventId=" << eventId
-                << "elapsedMs=" << timer.elapsed();
+                << "elapsedMs=" << eventSpan.elapsedMs();
         return;
     }
 
     if (type == QLatin1String("send_failed")) {
+        m_sendQueue->complete(clientMessageId);
         const QString conversation = normalizeConversationKey(event.value(QStringLiteral("conversation_key")).toString());
         QString reason = payloadObject.value(QStringLiteral("error_message")).toString();
         if (reason.isEmpty())
@@ -370,7 +373,7 @@ void QianniuRPAAdapter::handleRpaEvent(const QJsonObject& event)
         qInfo() << "[QianniuRPAAdapter] event timing"
                 << "type=" << type
                 << "eventId=" << eventId
-                << "elapsedMs=" << timer.elapsed();
+                << "elapsedMs=" << eventSpan.elapsedMs();
         return;
     }
 
@@ -383,7 +386,7 @@ void QianniuRPAAdapter::handleRpaEvent(const QJsonObject& event)
         qInfo() << "[QianniuRPAAdapter] event timing"
                 << "type=" << type
                 << "eventId=" << eventId
-                << "elapsedMs=" << timer.elapsed();
+                << "elapsedMs=" << eventSpan.elapsedMs();
         return;
     }
 
@@ -460,6 +463,7 @@ PlatformMessage QianniuRPAAdapter::platformMessageFromEvent(const QJsonObject& e
     msg.contentType = payload.value(QStringLiteral("content_type")).toString(QStringLiteral("text"));
     msg.metadata = payload;
     msg.metadata.insert(QStringLiteral("_event_account_id"), event.value(QStringLiteral("account_id")).toString());
+    msg.metadata.insert(QStringLiteral("_event_id"), event.value(QStringLiteral("event_id")).toString());
     msg.metadata.insert(QStringLiteral("_event_conversation_key"), conversationKey);
     msg.metadata.insert(QStringLiteral("raw_direction"), rawDirection);
     msg.metadata.insert(QStringLiteral("raw_sender_role"), rawSenderRole);
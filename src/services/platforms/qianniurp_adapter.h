@@ -2,6 +2,7 @@
 #define QIANNIURP_ADAPTER_H
 
 #include "iplatformadapter.h"
+#include "outboundsendqueue.h"
 #include <QJsonObject>
 #include <QSet>
 
@@ -29,10 +30,11 @@ private:
     QString normalizeConversationKey(const QString& conversationKey) const;
     void handleRpaEvent(const QJsonObject& event);
     void emitConversationObserved(const QJsonObject& event);
+    OutboundDispatchResult dispatchSend(const OutboundSendRecord& record);
 
     bool m_connected = false;
     QString m_eventCursor = QStringLiteral("0");
-    bool m_commandInFlight = false;
+    OutboundSendQueue* m_sendQueue = nullptr;
     bool m_eventSocketConnected = false;
     QSet<QString> m_seenSeqs;
 };
@@ -2,9 +2,18 @@
 #include <QDateTime>
 #include <QDebug>
 #include <QRandomGenerator>
+#include <QTimer>
 #include <QUuid>
+#include <cmath>
 #include <iterator>
 
+namespace {
+// 单轮事件循环最多发出的压测消息数，避免落后时一次性积压把事件循环饿死
+constexpr int kMaxLoadMessagesPerTick = 64;
+// 重复注入从最近这么多条里挑选
+constexpr int kRecentLoadMessages = 64;
+} // namespace
+
 SimPlatformAdapter::SimPlatformAdapter(QObject* parent)
     : IPlatformAdapter(parent)
 {
@@ -119,3 +128,208 @@ void SimPlatformAdapter::simulateRandomPlatformIncomingMessage()
     const QString message = QString::fromUtf8(scenario.message);
     simulateIncomingMessage(buyerName, message);
 }
+
+void SimPlatformAdapter::startLoad(const SimLoadProfile& profile)
+{
+    if (m_loadRunning)
+        stopLoad();
+
+    m_loadProfile = profile;
+    m_loadProfile.conversations = qMax(1, profile.conversations);
+    m_loadProfile.burstSize = qMax(1, profile.burstSize);
+    m_loadStats = SimLoadStats();
+    m_loadRandom.seed(profile.seed);
+    // platformMsgId 带上本轮标识，同一个库里重复跑不会被当成旧消息去重
+    m_loadRunId = QUuid::createUuid().toString(QUuid::Id128).left(8);
+    m_heldBack.reset();
+    m_heldBackConversation = -1;
+    m_recentLoadMessages.clear();
+    m_emittedAtNs.clear();
+    m_loadBaseTime = QDateTime::currentDateTime();
+    m_loadClock.start();
+    m_burstRemaining = m_loadProfile.burstSize - 1;
+    m_nextArrivalNs = m_loadProfile.arrival == SimLoadProfile::Arrival::Poisson ? nextArrivalOffsetNs() : 0;
+    m_loadRunning = true;
+
+    if (!m_loadTimer) {
+        m_loadTimer = new QTimer(this);
+        m_loadTimer->setSingleShot(true);
+        m_loadTimer->setTimerType(Qt::PreciseTimer);
+        connect(m_loadTimer, &QTimer::timeout, this, &SimPlatformAdapter::onLoadTick);
+    }
+
+    qInfo() << "[SimPlatform] 开始压测"
+            << "conversations=" << m_loadProfile.conversations
+            << "totalMessages=" << m_loadProfile.totalMessages
+            << "rate=" << m_loadProfile.messagesPerSecond
+            << "arrival=" << (m_loadProfile.arrival == SimLoadProfile::Arrival::Burst ? "burst" : "poisson")
+            << "imageRatio=" << m_loadProfile.imageRatio
+            << "duplicateRatio=" << m_loadProfile.duplicateRatio
+            << "outOfOrderRatio=" << m_loadProfile.outOfOrderRatio
+            << "seed=" << m_loadProfile.seed;
+    scheduleNextLoadTick();
+}
+
+void SimPlatformAdapter::stopLoad()
+{
+    if (!m_loadRunning)
+        return;
+    // 被压住的乱序消息也要发出，保证实际发出的不重复消息与 generated 一致
+    if (m_heldBack) {
+        const PlatformMessage held = *m_heldBack;
+        m_heldBack.reset();
+        emitLoadMessage(held);
+    }
+    finishLoad();
+}
+
+qint64 SimPlatformAdapter::loadClockNs() const
+{
+    return m_loadClock.isValid() ? m_loadClock.nsecsElapsed() : 0;
+}
+
+qint64 SimPlatformAdapter::takeEmittedAtNs(const QString& platformMsgId)
+{
+    const auto it = m_emittedAtNs.find(platformMsgId);
+    if (it == m_emittedAtNs.end())
+        return -1;
+    const qint64 emittedAt = it.value();
+    m_emittedAtNs.erase(it);
+    return emittedAt;
+}
+
+void SimPlatformAdapter::scheduleNextLoadTick()
+{
+    if (!m_loadRunning || !m_loadTimer)
+        return;
+    const qint64 waitNs = m_nextArrivalNs - m_loadClock.nsecsElapsed();
+    m_loadTimer->start(waitNs > 0 ? int(waitNs / 1000000) : 0);
+}
+
+qint64 SimPlatformAdapter::nextArrivalOffsetNs()
+{
+    const double rate = m_loadProfile.messagesPerSecond;
+    if (rate <= 0.0)
+        return 0;
+    if (m_loadProfile.arrival == SimLoadProfile::Arrival::Burst) {
+        if (m_burstRemaining > 0) {
+            --m_burstRemaining;
+            return 0;
+        }
+        m_burstRemaining = m_loadProfile.burstSize - 1;
+        return qint64(m_loadProfile.burstSize / rate * 1e9);
+    }
+    // 指数分布间隔 => 泊松到达；generateDouble() 取值 [0, 1)
+    const double u = m_loadRandom.generateDouble();
+    return qint64(-std::log(1.0 - u) / rate * 1e9);
+}
+
+void SimPlatformAdapter::onLoadTick()
+{
+    const qint64 now = m_loadClock.nsecsElapsed();
+    int emitted = 0;
+    while (m_loadRunning && m_nextArrivalNs <= now && emitted < kMaxLoadMessagesPerTick) {
+        emitDueLoadMessage();
+        m_nextArrivalNs += nextArrivalOffsetNs();
+        ++emitted;
+    }
+    scheduleNextLoadTick();
+}
+
+PlatformMessage SimPlatformAdapter::makeLoadMessage(int conversationIndex)
+{
+    const int seq = m_loadStats.generated + 1;
+    PlatformMessage msg;
+    msg.platform = platformName();
+    msg.platformConversationId = QStringLiteral("sim_load_%1").arg(conversationIndex + 1);
+    msg.customerName = QStringLiteral("压测买家%1").arg(conversationIndex + 1);
+    msg.direction = QStringLiteral("in");
+    msg.sender = QStringLiteral("customer");
+    msg.createdAt = m_loadBaseTime.addMSecs(m_loadClock.elapsed());
+    msg.platformMsgId = QStringLiteral("sim-load-%1-%2").arg(m_loadRunId).arg(seq);
+    msg.sourceType = QStringLiteral("mock");
+    msg.confidence = 100;
+    msg.verificationStatus = QStringLiteral("manual_verified");
+    if (m_loadRandom.generateDouble() < m_loadProfile.imageRatio) {
+        msg.content = QStringLiteral("[图片]");
+        msg.contentType = QStringLiteral("image");
+        msg.contentImagePath = m_loadProfile.imagePath.isEmpty()
+            ? QStringLiteral("sim/load_image_%1.png").arg(seq)
+            : m_loadProfile.imagePath;
+        ++m_loadStats.images;
+    } else {
+        const int idx = int(m_loadRandom.bounded(quint32(m_sampleMessages.size())));
+        msg.content = QStringLiteral("%1 #%2").arg(m_sampleMessages.at(idx)).arg(seq);
+        msg.contentType = QStringLiteral("text");
+    }
+    return msg;
+}
+
+void SimPlatformAdapter::emitLoadMessage(const PlatformMessage& msg)
+{
+    m_emittedAtNs.insert(msg.platformMsgId, m_loadClock.nsecsElapsed());
+    m_recentLoadMessages.append(msg);
+    if (m_recentLoadMessages.size() > kRecentLoadMessages)
+        m_recentLoadMessages.removeFirst();
+    const qint64 startNs = m_loadClock.nsecsElapsed();
+    emit incomingMessage(msg);
+    m_loadStats.ingestBusyNs += m_loadClock.nsecsElapsed() - startNs;
+}
+
+void SimPlatformAdapter::emitDueLoadMessage()
+{
+    const int total = m_loadProfile.totalMessages;
+    if (total > 0 && m_loadStats.generated >= total) {
+        stopLoad();
+        return;
+    }
+
+    // 重复注入：原样再发一条最近的消息，不占用 totalMessages 配额
+    if (!m_recentLoadMessages.isEmpty() && m_loadRandom.generateDouble() < m_loadProfile.duplicateRatio) {
+        const int idx = int(m_loadRandom.bounded(quint32(m_recentLoadMessages.size())));
+        const PlatformMessage duplicate = m_recentLoadMessages.at(idx);
+        ++m_loadStats.duplicates;
+        const qint64 startNs = m_loadClock.nsecsElapsed();
+        emit incomingMessage(duplicate);
+        m_loadStats.ingestBusyNs += m_loadClock.nsecsElapsed() - startNs;
+    }
+
+    // 有被压住的消息时，下一条必须落在同一会话，才构成会话内乱序
+    const int conversationIndex = m_heldBack
+        ? m_heldBackConversation
+        : int(m_loadRandom.bounded(quint32(m_loadProfile.conversations)));
+    const PlatformMessage msg = makeLoadMessage(conversationIndex);
+    ++m_loadStats.generated;
+    const bool hasNext = total <= 0 || m_loadStats.generated < total;
+
+    if (m_heldBack) {
+        const PlatformMessage held = *m_heldBack;
+        m_heldBack.reset();
+        emitLoadMessage(msg);
+        emitLoadMessage(held);
+    } else if (hasNext && m_loadRandom.generateDouble() < m_loadProfile.outOfOrderRatio) {
+        m_heldBack = msg;
+        m_heldBackConversation = conversationIndex;
+        ++m_loadStats.reordered;
+    } else {
+        emitLoadMessage(msg);
+    }
+
+    if (!hasNext)
+        stopLoad();
+}
+
+void SimPlatformAdapter::finishLoad()
+{
+    m_loadRunning = false;
+    if (m_loadTimer)
+        m_loadTimer->stop();
+    m_loadStats.elapsedMs = m_loadClock.elapsed();
+    qInfo() << "[SimPlatform] 压测结束"
+            << "generated=" << m_loadStats.generated
+            << "duplicates=" << m_loadStats.duplicates
+            << "reordered=" << m_loadStats.reordered
+            << "images=" << m_loadStats.images
+            << "elapsedMs=" << m_loadStats.elapsedMs;
+    emit loadFinished(m_loadStats);
+}
@@ -2,7 +2,48 @@
 #define SIMPLATFORMADAPTER_H
 
 #include "iplatformadapter.h"
+#include <QElapsedTimer>
+#include <QHash>
+#include <QRandomGenerator>
 #include <QStringList>
+#include <QVector>
+#include <optional>
+
+class QTimer;
+
+/**
+ * 压测负载配置。
+ *
+ * - Poisson：按指数分布间隔逐条到达，平均速率为 messagesPerSecond；
+ * - Burst：每 burstSize / messagesPerSecond 秒集中到达 burstSize 条；
+ * - messagesPerSecond <= 0 时不限速，每轮事件循环尽快发出一批。
+ *
+ * 重复注入会用相同 platformMsgId 再发一次最近的消息（应被路由去重）；
+ * 乱序注入会把一条消息压到同会话下一条之后发出，createdAt 保持更早。
+ */
+struct SimLoadProfile {
+    enum class Arrival { Poisson, Burst };
+
+    int conversations = 20;
+    int totalMessages = 1000; // 不含重复注入；<= 0 表示直到 stopLoad()
+    double messagesPerSecond = 200.0;
+    Arrival arrival = Arrival::Poisson;
+    int burstSize = 20;
+    double imageRatio = 0.1;
+    double duplicateRatio = 0.05;
+    double outOfOrderRatio = 0.05;
+    quint32 seed = 1;
+    QString imagePath; // 图片消息的 contentImagePath；为空时使用占位路径
+};
+
+struct SimLoadStats {
+    int generated = 0;  // 不重复的消息条数
+    int duplicates = 0; // 额外注入的重复条数
+    int reordered = 0;
+    int images = 0;
+    qint64 elapsedMs = 0;
+    qint64 ingestBusyNs = 0; // 同步处理 incomingMessage（路由、入库、界面模型）的累计耗时
+};
 
 class SimPlatformAdapter : public IPlatformAdapter
 {
@@ -21,11 +62,46 @@ public:
     void simulateIncomingMessage(const QString& buyerName, const QString& text);
     void simulateRandomPlatformIncomingMessage();
 
+    void startLoad(const SimLoadProfile& profile);
+    void stopLoad();
+    bool isLoadRunning() const { return m_loadRunning; }
+    SimLoadStats loadStats() const { return m_loadStats; }
+    /** 压测时钟（纳秒），与 takeEmittedAtNs() 同一基准。 */
+    qint64 loadClockNs() const;
+    /** 取出并移除某条压测消息首次发出的时刻；未知返回 -1。 */
+    qint64 takeEmittedAtNs(const QString& platformMsgId);
+
+signals:
+    void loadFinished(const SimLoadStats& stats);
+
 private:
+    void onLoadTick();
+    void scheduleNextLoadTick();
+    qint64 nextArrivalOffsetNs();
+    PlatformMessage makeLoadMessage(int conversationIndex);
+    void emitLoadMessage(const PlatformMessage& msg);
+    void emitDueLoadMessage();
+    void finishLoad();
+
     bool m_connected = false;
     int m_nextBuyerId = 1;
     QStringList m_sampleMessages;
     QStringList m_sampleNames;
+
+    SimLoadProfile m_loadProfile;
+    SimLoadStats m_loadStats;
+    bool m_loadRunning = false;
+    QTimer* m_loadTimer = nullptr;
+    QElapsedTimer m_loadClock;
+    QRandomGenerator m_loadRandom;
+    QString m_loadRunId;
+    qint64 m_nextArrivalNs = 0;
+    int m_burstRemaining = 0;
+    QDateTime m_loadBaseTime;
+    std::optional<PlatformMessage> m_heldBack;
+    int m_heldBackConversation = -1;
+    QVector<PlatformMessage> m_recentLoadMessages;
+    QHash<QString, qint64> m_emittedAtNs;
 };
 
 #endif // SIMPLATFORMADAPTER_H
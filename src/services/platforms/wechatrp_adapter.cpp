@@ -1,11 +1,11 @@
 #include "wechatrp_adapter.h"
 #include "../../ipc/ipcservice.h"
+#include "../../utils/tracing.h"
 #include <QDebug>
 #include <QMetaObject>
 #include <QDateTime>
 #include <QStringList>
 #include <QTimer>
-#include <QUuid>
 
 namespace {
 QString normalizedDirection(const QString& direction, const QString& senderRole, const QJsonObject& payload)
@@ -76,6 +76,11 @@ QString outgoingContent(const OutgoingMessagePart& part)
 WechatRPAAdapter::WechatRPAAdapter(QObject* parent)
     : IPlatformAdapter(parent)
 {
+    m_sendQueue = new OutboundSendQueue(
+        platformName(), accountId(),
+        [this](const OutboundSendRecord& record) { return dispatchSend(record); },
+        OutboundSendQueue::kDefaultMaxInFlight, this);
+    connect(m_sendQueue, &OutboundSendQueue::sendAbandoned, this, &IPlatformAdapter::sendFailed);
     connect(&Ipc::IpcService::instance(), &Ipc::IpcService::platformEventReceived,
             this, &WechatRPAAdapter::handleRpaEvent);
     connect(&Ipc::IpcService::instance(), &Ipc::IpcService::platformEventBridgeStateChanged,
@@ -122,6 +127,7 @@ void WechatRPAAdapter::startListening()
     }
     if (!m_connected)
         connectPlatform();
+    m_sendQueue->restorePending();
     qInfo() << "[WechatRPAAdapter] startListening with WebSocket command/event bridge";
 }
 
@@ -149,23 +155,21 @@ void WechatRPAAdapter::sendMessagePart(const QString& conversationId,
                                        const OutgoingMessagePart& part,
                                        const QString& clientMessageId)
 {
+    m_sendQueue->enqueue(conversationId, part, clientMessageId);
+}
+
+OutboundDispatchResult WechatRPAAdapter::dispatchSend(const OutboundSendRecord& record)
+{
+    const QString& conversationId = record.conversationKey;
+    const OutgoingMessagePart& part = record.part;
     const QString content = outgoingContent(part);
-    if (m_commandInFlight) {
-        qInfo() << "[WechatRPAAdapter] sendMessage delayed: command already in flight";
-        QTimer::singleShot(200, this, [this, conversationId, part, clientMessageId]() {
-            sendMessagePart(conversationId, part, clientMessageId);
-        });
-        return;
-    }
+    Tracing::Span totalSpan("wechat.dispatch_send", "adapter", record.clientMessageId);
 
-    m_commandInFlight = true;
     Ipc::PlatformCommandRequest request;
     request.commandType = QStringLiteral("send_message");
     request.platform = platformName();
     request.accountId = accountId();
-    request.taskId = clientMessageId.isEmpty()
-        ? QUuid::createUuid().toString(QUuid::WithoutBraces)
-        : clientMessageId;
+    request.taskId = record.clientMessageId;
     const QString displayName = displayNameFromConversationKey(conversationId);
     request.parameters.insert(QStringLiteral("client_message_id"), request.taskId);
     request.parameters.insert(QStringLiteral("conversation_key"), conversationId);
@@ -182,11 +186,13 @@ void WechatRPAAdapter::sendMessagePart(const QString& conversationId,
     request.parameters.insert(QStringLiteral("strict_background"), false);
     request.parameters.insert(QStringLiteral("confirm_token"), QStringLiteral("manual_confirmed_by_agent"));
 
+    Tracing::Span commandSpan("wechat.send_command", "ipc", request.taskId);
     const auto response = Ipc::IpcService::instance().sendPlatformCommandViaWebSocket(request, 4000);
-    m_commandInFlight = false;
+    const qint64 commandElapsedMs = commandSpan.end();
     auto scheduleConfirmTimeout = [this, conversationId, clientMessageId = request.taskId]() {
         QTimer::singleShot(30000, this, [this, conversationId, clientMessageId]() {
-            emit sendFailed(conversationId, QStringLiteral("send_confirm_timeout"), clientMessageId);
+            if (m_sendQueue->complete(clientMessageId))
+                emit sendFailed(conversationId, QStringLiteral("send_confirm_timeout"), clientMessageId);
         });
     };
     if (response.status == Ipc::ResponseStatus::Success) {
@@ -196,6 +202,8 @@ void WechatRPAAdapter::sendMessagePart(const QString& conversationId,
         qInfo() << "[WechatRPAAdapter] sendMessage result"
                 << "conversation=" << conversationId
                 << "clientMessageId=" << request.taskId
+                << "commandElapsedMs=" << commandElapsedMs
+                << "totalElapsedMs=" << totalSpan.elapsedMs()
                 << "accepted=" << accepted
                 << "draftMethod=" << result.value(QStringLiteral("draft_method")).toString()
                 << "strictBackgroundWriteSuccess=" << result.value(QStringLiteral("strict_background_write_success")).toBool()
@@ -207,12 +215,12 @@ void WechatRPAAdapter::sendMessagePart(const QString& conversationId,
                 << "sent=" << sent;
         if (accepted && !sent) {
             scheduleConfirmTimeout();
-            return;
+            return OutboundDispatchResult::AwaitingConfirm;
         }
         QTimer::singleShot(800, this, [this, conversationId, content, clientMessageId = request.taskId]() {
             emit messageSent(conversationId, content, clientMessageId);
         });
-        return;
+        return OutboundDispatchResult::Completed;
     }
 
     if (response.status == Ipc::ResponseStatus::Timeout
@@ -222,7 +230,7 @@ void WechatRPAAdapter::sendMessagePart(const QString& conversationId,
                    << "clientMessageId=" << request.taskId
                    << "contentType=" << outgoingContentType(part);
         scheduleConfirmTimeout();
-        return;
+        return OutboundDispatchResult::AwaitingConfirm;
     }
 
     qWarning() << "[WechatRPAAdapter] sendMessage failed:" << response.errorMessage;
@@ -230,10 +238,12 @@ void WechatRPAAdapter::sendMessagePart(const QString& conversationId,
                                     ? QStringLiteral("wechat_rpa_command_failed")
                                     : response.errorMessage,
                     request.taskId);
+    return OutboundDispatchResult::Failed;
 }
 
 void WechatRPAAdapter::handleRpaEvent(const QJsonObject& event)
 {
+    Tracing::Span eventSpan("wechat.handle_event", "adapter");
     if (event.value(QStringLiteral("platform")).toString().trimmed().toLower() != platformName())
         return;
 
@@ -257,6 +267,7 @@ void WechatRPAAdapter::handleRpaEvent(const QJsonObject& event)
         payloadObject.value(QStringLiteral("client_message_id")).toString(
             event.value(QStringLiteral("task_id")).toString(
                 payloadObject.value(QStringLiteral("task_id")).toString())));
+    eventSpan.setCorrelationId(!clientMessageId.isEmpty() ? clientMessageId : eventId);
     qInfo() << "[WechatRPAAdapter] realtime event received"
             << "type=" << type
             << "eventId=" << eventId
@@ -297,6 +308,7 @@ void WechatRPAAdapter::handleRpaEvent(const QJsonObject& event)
     }
 
     if (type == QLatin1String("message_sent")) {
+        m_sendQueue->complete(clientMessageId);
         const QString conversation = normalizeConversationKey(event.value(QStringLiteral("conversation_key")).toString());
         const QString text = payloadObject.value(QStringLiteral("content")).toString();
         if (!conversation.isEmpty()) {
@@ -309,6 +321,7 @@ void WechatRPAAdapter::handleRpaEvent(const QJsonObject& event)
     }
 
     if (type == QLatin1String("send_failed")) {
+        m_sendQueue->complete(clientMessageId);
         const QString conversation = normalizeConversationKey(event.value(QStringLiteral("conversation_key")).toString());
         const QString reason = payloadObject.value(QStringLiteral("error_message")).toString();
         if (!conversation.isEmpty()) {
@@ -400,6 +413,7 @@ PlatformMessage WechatRPAAdapter::platformMessageFromEvent(const QJsonObject& ev
     msg.contentType = payload.value(QStringLiteral("content_type")).toString(QStringLiteral("text"));
     msg.metadata = payload;
     msg.metadata.insert(QStringLiteral("_event_account_id"), event.value(QStringLiteral("account_id")).toString());
+    msg.metadata.insert(QStringLiteral("_event_id"), event.value(QStringLiteral("event_id")).toString());
     msg.metadata.insert(QStringLiteral("_event_conversation_key"), conversationKey);
     msg.metadata.insert(QStringLiteral("raw_direction"), rawDirection);
     msg.metadata.insert(QStringLiteral("raw_sender_role"), rawSenderRole);
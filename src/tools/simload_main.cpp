@@ -0,0 +1,108 @@
+// 无界面压测入口：模拟平台 -> MessageRouter -> DAO -> 列表模型，不依赖 Windows RPA 环境。
+//
+//   yy-ai-customer-service-simload --conversations 50 --messages 20000 --rate 500 --arrival burst --json
+#include "core/messagerouter.h"
+#include "data/database.h"
+#include "services/app/simloadrunner.h"
+#include "services/platforms/simplatformadapter.h"
+#include "utils/runtimemode.h"
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QJsonDocument>
+#include <QLoggingCategory>
+#include <QTemporaryDir>
+#include <QTextStream>
+
+int main(int argc, char* argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName(QStringLiteral("yy-ai-customer-service-simload"));
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QStringLiteral("模拟平台压测：测量路由、数据层与列表模型的吞吐、延迟和内存"));
+    parser.addHelpOption();
+    const QCommandLineOption conversationsOpt(QStringLiteral("conversations"), QStringLiteral("会话数"), QStringLiteral("n"), QStringLiteral("20"));
+    const QCommandLineOption messagesOpt(QStringLiteral("messages"), QStringLiteral("不重复消息总数"), QStringLiteral("n"), QStringLiteral("2000"));
+    const QCommandLineOption rateOpt(QStringLiteral("rate"), QStringLiteral("平均每秒消息数，<=0 不限速"), QStringLiteral("r"), QStringLiteral("0"));
+    const QCommandLineOption arrivalOpt(QStringLiteral("arrival"), QStringLiteral("到达模式：poisson 或 burst"), QStringLiteral("mode"), QStringLiteral("poisson"));
+    const QCommandLineOption burstOpt(QStringLiteral("burst-size"), QStringLiteral("burst 模式每批条数"), QStringLiteral("n"), QStringLiteral("20"));
+    const QCommandLineOption imageOpt(QStringLiteral("image-ratio"), QStringLiteral("图片消息比例"), QStringLiteral("x"), QStringLiteral("0.1"));
+    const QCommandLineOption duplicateOpt(QStringLiteral("duplicate-ratio"), QStringLiteral("重复注入比例"), QStringLiteral("x"), QStringLiteral("0.05"));
+    const QCommandLineOption reorderOpt(QStringLiteral("out-of-order-ratio"), QStringLiteral("会话内乱序比例"), QStringLiteral("x"), QStringLiteral("0.05"));
+    const QCommandLineOption seedOpt(QStringLiteral("seed"), QStringLiteral("随机种子"), QStringLiteral("n"), QStringLiteral("1"));
+    const QCommandLineOption databaseOpt(QStringLiteral("database"), QStringLiteral("数据库文件；默认使用临时目录"), QStringLiteral("path"));
+    const QCommandLineOption timeoutOpt(QStringLiteral("timeout-ms"), QStringLiteral("超时毫秒"), QStringLiteral("ms"), QStringLiteral("600000"));
+    const QCommandLineOption jsonOpt(QStringLiteral("json"), QStringLiteral("以 JSON 输出结果"));
+    const QCommandLineOption verboseOpt(QStringLiteral("verbose"), QStringLiteral("保留路由/DAO 的 info 日志"));
+    parser.addOptions({conversationsOpt, messagesOpt, rateOpt, arrivalOpt, burstOpt, imageOpt, duplicateOpt,
+                       reorderOpt, seedOpt, databaseOpt, timeoutOpt, jsonOpt, verboseOpt});
+    parser.process(app);
+
+    // 路由每条消息都会打 info 日志，压测时默认关闭以免测到的是日志 I/O
+    if (!parser.isSet(verboseOpt))
+        QLoggingCategory::setFilterRules(QStringLiteral("default.debug=false\ndefault.info=false"));
+
+    qRegisterMetaType<PlatformMessage>("PlatformMessage");
+    qRegisterMetaType<ConversationInfo>("ConversationInfo");
+    qRegisterMetaType<MessageRecord>("MessageRecord");
+
+    QTemporaryDir tempDir;
+    const QString databasePath = parser.isSet(databaseOpt)
+        ? parser.value(databaseOpt)
+        : tempDir.filePath(QStringLiteral("simload.db"));
+    if (!Database::getInstance().open(databasePath)) {
+        QTextStream(stderr) << "failed to open database: " << databasePath << Qt::endl;
+        return 1;
+    }
+    RuntimeMode::setLocalCacheIngestOverride(true);
+
+    SimLoadProfile profile;
+    profile.conversations = parser.value(conversationsOpt).toInt();
+    profile.totalMessages = parser.value(messagesOpt).toInt();
+    profile.messagesPerSecond = parser.value(rateOpt).toDouble();
+    profile.arrival = parser.value(arrivalOpt).compare(QLatin1String("burst"), Qt::CaseInsensitive) == 0
+        ? SimLoadProfile::Arrival::Burst
+        : SimLoadProfile::Arrival::Poisson;
+    profile.burstSize = parser.value(burstOpt).toInt();
+    profile.imageRatio = parser.value(imageOpt).toDouble();
+    profile.duplicateRatio = parser.value(duplicateOpt).toDouble();
+    profile.outOfOrderRatio = parser.value(reorderOpt).toDouble();
+    profile.seed = parser.value(seedOpt).toUInt();
+
+    MessageRouter router;
+    SimPlatformAdapter adapter;
+    router.registerAdapter(&adapter);
+    adapter.connectPlatform();
+    SimLoadRunner runner(&router, &adapter);
+    const SimLoadReport report = runner.run(profile, parser.value(timeoutOpt).toInt());
+
+    QTextStream out(stdout);
+    if (parser.isSet(jsonOpt)) {
+        QJsonObject obj = report.toJson();
+        obj.insert(QStringLiteral("conversations"), profile.conversations);
+        obj.insert(QStringLiteral("rate"), profile.messagesPerSecond);
+        obj.insert(QStringLiteral("arrival"), profile.arrival == SimLoadProfile::Arrival::Burst
+                                                  ? QStringLiteral("burst")
+                                                  : QStringLiteral("poisson"));
+        out << QJsonDocument(obj).toJson(QJsonDocument::Indented);
+    } else {
+        out << "generated=" << report.load.generated
+            << " delivered=" << report.delivered
+            << " duplicates=" << report.load.duplicates
+            << " reordered=" << report.load.reordered
+            << " images=" << report.load.images << Qt::endl;
+        out << "elapsed_ms=" << report.elapsedMs
+            << " msg_per_sec=" << report.messagesPerSecond
+            << " capacity_per_sec=" << report.capacityPerSecond << Qt::endl;
+        out << "latency_ms p50=" << report.p50Ms
+            << " p99=" << report.p99Ms
+            << " max=" << report.maxMs << Qt::endl;
+        out << "rss_bytes start=" << report.rssStartBytes
+            << " peak=" << report.rssPeakBytes
+            << " end=" << report.rssEndBytes << Qt::endl;
+    }
+
+    router.unregisterAdapter(adapter.platformName());
+    Database::getInstance().close();
+    return report.timedOut || report.delivered != report.load.generated ? 2 : 0;
+}
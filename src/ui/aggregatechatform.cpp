@@ -3,12 +3,15 @@
 #include "../core/messagerouter.h"
 #include "../ipc/ipcservice.h"
 #include "conversationlistmodel.h"
+#include "conversationsearch.h"
 #include "messagelistmodel.h"
+#include "thumbnailservice.h"
 #include <QButtonGroup>
 #include "../data/appdatauistatedao.h"
 #include "../data/conversationdao.h"
 #include "../data/airequesteventdao.h"
 #include "../data/customerprofiledao.h"
+#include "../data/dataeventbus.h"
 #include "../data/messagedao.h"
 #include "../data/messagesendeventdao.h"
 #include "../data/qianniuconversationdao.h"
@@ -24,6 +27,7 @@
 #include "../utils/applystyle.h"
 #include "../utils/runtimemode.h"
 #include "../utils/svgresourcepixmap.h"
+#include "../utils/themeengine.h"
 #include <QJsonArray>
 #include <QJsonDocument>
 #include <QJsonObject>
@@ -112,6 +116,9 @@ constexpr int kAggregateConversationPanelShowBreakpoint = 860;
 constexpr int kAggregateConversationPanelCollapseSlop = 2;
 constexpr int kAggregateRightPanelMinWidth = 208;
 constexpr int kAggregateRightPanelPreferredMinWidth = 240;
+constexpr int kCustomerProfileAutoRefreshInboundDefault = 6;
+constexpr qint64 kCustomerProfileRefreshBackoffBaseMs = 60 * 1000;
+constexpr qint64 kCustomerProfileRefreshBackoffMaxMs = 30 * 60 * 1000;
 constexpr int kAggregateRightPanelMaxWidth = 288;
 constexpr int kAggregateChatWithRightMinWidth = 430;
 constexpr int kAggregateRightPanelAutoHideBreakpoint = 700;
@@ -174,6 +181,27 @@ QString formatSendEventLine(const MessageSendEventRecord& e)
     return QStringLiteral("%1  %2").arg(formatProcessingTime(e.createdAt), text);
 }
 
+bool isTerminalSendEvent(const MessageSendEventRecord& e)
+{
+    if (e.phase == QLatin1String("success")
+        || e.phase == QLatin1String("failed")
+        || e.phase == QLatin1String("lock_timeout")) {
+        return true;
+    }
+    return e.phase == QLatin1String("receipt_result")
+        && e.detail.contains(QStringLiteral("success"), Qt::CaseInsensitive);
+}
+
+QString aggregateContextStageDetail(const AiContextStats& stats)
+{
+    if (stats.estimatedPromptTokens <= 0)
+        return QString();
+    QString detail = QStringLiteral("%1 条，约 %2 tokens").arg(stats.keptTurns).arg(stats.estimatedPromptTokens);
+    if (stats.droppedTurns > 0)
+        detail += QStringLiteral("，较早 %1 条已折叠").arg(stats.droppedTurns);
+    return detail;
+}
+
 QString formatAiStageEventLine(const AiRequestStageEventRecord& e)
 {
     QString text;
@@ -185,7 +213,8 @@ QString formatAiStageEventLine(const AiRequestStageEventRecord& e)
     else if (e.stage == QLatin1String("profile_started"))
         text = QStringLiteral("开始整理客户信息");
     else if (e.stage == QLatin1String("context_ready"))
-        text = QStringLiteral("已整理当前会话的最近聊天记录");
+        text = detail.isEmpty() ? QStringLiteral("已整理当前会话的最近聊天记录")
+                                : QStringLiteral("已整理当前会话的最近聊天记录（%1）").arg(detail);
     else if (e.stage == QLatin1String("request_sent"))
         text = detail.isEmpty() ? QStringLiteral("正在请求 AI 模型")
                                 : QStringLiteral("正在请求 %1").arg(detail);
@@ -207,6 +236,14 @@ QString formatAiStageEventLine(const AiRequestStageEventRecord& e)
         text = QStringLiteral("自动回复已提交发送");
     else if (e.stage == QLatin1String("profile_saved"))
         text = QStringLiteral("客户信息已更新");
+    else if (e.stage == QLatin1String("hedge_fired"))
+        text = detail.isEmpty() ? QStringLiteral("首字较慢，已并发请求备用模型")
+                                : QStringLiteral("已并发请求备用模型：%1").arg(detail);
+    else if (e.stage == QLatin1String("hedge_failover"))
+        text = detail.isEmpty() ? QStringLiteral("主模型失败，已切换备用模型")
+                                : QStringLiteral("已切换备用模型：%1").arg(detail);
+    else if (e.stage == QLatin1String("hedge_won"))
+        text = detail;
     if (text.isEmpty())
         return QString();
     return QStringLiteral("%1  %2").arg(formatProcessingTime(e.createdAt), text);
@@ -303,6 +340,46 @@ protected:
     }
 };
 
+/**
+ * 按 ranges 分段绘制，命中片段用 highlight 色；text 是已省略的显示文本，
+ * visibleLength 之后（省略号及被截掉的部分）不再高亮。
+ */
+void drawHighlightedText(QPainter* painter,
+                         const QRect& rect,
+                         int flags,
+                         const QFontMetrics& fm,
+                         const QString& text,
+                         int visibleLength,
+                         const QVector<QPair<int, int>>& ranges,
+                         const QColor& highlight)
+{
+    if (ranges.isEmpty()) {
+        painter->drawText(rect, flags, text);
+        return;
+    }
+    const QPen normalPen = painter->pen();
+    const QPen highlightPen(highlight);
+    int x = rect.left();
+    auto drawRun = [&](int from, int to, const QPen& pen) {
+        if (to <= from)
+            return;
+        const QString run = text.mid(from, to - from);
+        painter->setPen(pen);
+        painter->drawText(QRect(x, rect.top(), qMax(0, rect.right() + 1 - x), rect.height()), flags, run);
+        x += fm.horizontalAdvance(run);
+    };
+    int cursor = 0;
+    for (const auto& range : ranges) {
+        const int start = qBound(cursor, range.first, visibleLength);
+        const int end = qBound(start, range.first + range.second, visibleLength);
+        drawRun(cursor, start, normalPen);
+        drawRun(start, end, highlightPen);
+        cursor = end;
+    }
+    drawRun(cursor, text.size(), normalPen);
+    painter->setPen(normalPen);
+}
+
 class ConversationItemDelegate final : public QStyledItemDelegate
 {
 public:
@@ -322,6 +399,9 @@ public:
     {
         const ConversationInfo conv = index.data(ConversationListModel::ConversationRole).value<ConversationInfo>();
         const QString lastDirection = index.data(ConversationListModel::LastDirectionRole).toString();
+        const ConversationSearchMatch searchMatch =
+            index.data(ConversationListModel::SearchMatchRole).value<ConversationSearchMatch>();
+        const QColor highlightColor(QStringLiteral("#0284C7"));
         const bool selected = option.state.testFlag(QStyle::State_Selected);
         const bool hovered = option.state.testFlag(QStyle::State_MouseOver);
 
@@ -391,8 +471,10 @@ public:
         painter->setFont(titleFont);
         painter->setPen(QColor(QStringLiteral("#111827")));
         const QString title = titleFm.elidedText(conv.customerName, Qt::ElideRight, titleMaxWidth);
-        painter->drawText(QRect(textRect.left(), titleY, titleDrawWidth, titleFm.height()),
-                          Qt::AlignLeft | Qt::AlignVCenter, title);
+        drawHighlightedText(painter, QRect(textRect.left(), titleY, titleDrawWidth, titleFm.height()),
+                            Qt::AlignLeft | Qt::AlignVCenter, titleFm, title,
+                            title == conv.customerName ? title.size() : title.size() - 1,
+                            searchMatch.nameRanges, highlightColor);
 
         painter->setFont(smallFont);
         painter->setPen(QColor(QStringLiteral("#9CA3AF")));
@@ -413,10 +495,13 @@ public:
         if (hasPreview) {
             painter->setFont(previewFont);
             painter->setPen(QColor(QStringLiteral("#4B5563")));
-            preview = bodyFm.elidedText(preview, Qt::ElideRight, textRect.width() - (conv.unreadCount > 0 ? 22 : 0));
-            painter->drawText(QRect(textRect.left(), titleY + titleFm.height() + 8,
-                                    textRect.width() - (conv.unreadCount > 0 ? 22 : 0), bodyFm.height() + 4),
-                              Qt::AlignLeft | Qt::AlignTop, preview);
+            const QString elidedPreview =
+                bodyFm.elidedText(preview, Qt::ElideRight, textRect.width() - (conv.unreadCount > 0 ? 22 : 0));
+            drawHighlightedText(painter, QRect(textRect.left(), titleY + titleFm.height() + 8,
+                                               textRect.width() - (conv.unreadCount > 0 ? 22 : 0), bodyFm.height() + 4),
+                                Qt::AlignLeft | Qt::AlignTop, bodyFm, elidedPreview,
+                                elidedPreview == preview ? elidedPreview.size() : elidedPreview.size() - 1,
+                                searchMatch.previewRanges, highlightColor);
         }
 
         if (conv.unreadCount > 0) {
@@ -667,6 +752,10 @@ public:
     {
         if (QPixmapCache::cacheLimit() < 32768)
             QPixmapCache::setCacheLimit(32768);
+        // 缩略图在后台线程就绪；尺寸变化要重新布局，只有像素变化时重绘即可
+        ThumbnailService& thumbnails = ThumbnailService::instance();
+        connect(&thumbnails, &ThumbnailService::metadataReady, this, [this]() { scheduleRefresh(true); });
+        connect(&thumbnails, &ThumbnailService::thumbnailReady, this, [this]() { scheduleRefresh(false); });
     }
 
     void setSelfProfile(const QString& displayName, const QPixmap& avatar)
@@ -735,8 +824,8 @@ public:
         paintMeta(painter, QRect(bubbleX, topY, bubbleW, metaH), msg, outgoing, metaFont);
 
         const QRect bubbleRect(bubbleX, topY + metaH, bubbleW, bubbleH);
-        painter->setPen(outgoing ? QColor(QStringLiteral("#20B8E8")) : QColor(QStringLiteral("#E5E7EB")));
-        painter->setBrush(outgoing ? QColor(QStringLiteral("#20B8E8")) : QColor(QStringLiteral("#FFFFFF")));
+        painter->setPen(outgoing ? m_palette.bubbleBorderOut : m_palette.bubbleBorderIn);
+        painter->setBrush(outgoing ? m_palette.bubbleFillOut : m_palette.bubbleFillIn);
         painter->drawRoundedRect(bubbleRect, 13, 13);
 
         paintMessageContent(painter, bubbleRect, bubbleW, msg, outgoing, bodyFont, statusFont);
@@ -748,6 +837,24 @@ public:
     }
 
 private:
+    void scheduleRefresh(bool relayout)
+    {
+        m_relayoutPending = m_relayoutPending || relayout;
+        if (m_refreshScheduled)
+            return;
+        m_refreshScheduled = true;
+        // 一屏图片往往前后脚就绪，合并到一帧里处理
+        QTimer::singleShot(16, this, [this]() {
+            m_refreshScheduled = false;
+            if (std::exchange(m_relayoutPending, false)) {
+                emit sizeHintChanged(QModelIndex());
+                return;
+            }
+            if (auto* view = qobject_cast<QAbstractItemView*>(parent()))
+                view->viewport()->update();
+        });
+    }
+
     static QFont bodyTextFont(const QFont& base)
     {
         QFont f(base);
@@ -826,9 +933,11 @@ private:
             return parts.at(1);
         if (isVideoMessage(msg))
             return QStringLiteral("视频");
-        const QFileInfo info(msg.contentImagePath);
-        if (info.exists() && !info.fileName().isEmpty())
-            return info.fileName();
+        const QString fileName = QFileInfo(msg.contentImagePath).fileName();
+        const auto status = mediaProbe(msg).status;
+        if (!fileName.isEmpty() && status != ThumbnailService::Status::Missing
+            && status != ThumbnailService::Status::Loading)
+            return fileName;
         if (!msg.content.trimmed().isEmpty())
             return msg.content.trimmed();
         return isFileMessage(msg) ? QStringLiteral("文件") : QStringLiteral("视频");
@@ -843,9 +952,8 @@ private:
         }
         if (isVideoMessage(msg) && parts.size() >= 2)
             return parts.mid(1).join(QStringLiteral(" "));
-        const QFileInfo info(msg.contentImagePath);
-        if (info.exists() && info.isFile()) {
-            const qint64 bytes = info.size();
+        const qint64 bytes = mediaProbe(msg).fileSize;
+        if (bytes >= 0) {
             if (bytes >= 1024 * 1024)
                 return QStringLiteral("%1 MB").arg(QString::number(bytes / 1024.0 / 1024.0, 'f', 1));
             if (bytes >= 1024)
@@ -854,94 +962,23 @@ private:
         return msg.content.trimmed();
     }
 
-    static QString mediaCacheBaseKey(const MessageRecord& msg)
+    /** 只查 ThumbnailService 的内存索引；paint()/sizeHint() 里不直接访问文件。 */
+    static ThumbnailService::Probe mediaProbe(const MessageRecord& msg)
     {
-        if (msg.contentImagePath.isEmpty())
-            return {};
-        const QFileInfo info(msg.contentImagePath);
-        if (!info.exists() || !info.isFile())
-            return {};
-        return QStringLiteral("%1:%2:%3")
-            .arg(info.absoluteFilePath())
-            .arg(info.size())
-            .arg(info.lastModified().toMSecsSinceEpoch());
+        return ThumbnailService::instance().probe(msg.contentImagePath);
     }
 
     static QSize originalPreviewSize(const MessageRecord& msg)
     {
-        const QString key = mediaCacheBaseKey(msg);
-        if (key.isEmpty())
-            return {};
-
-        static QHash<QString, QSize> sizeCache;
-        if (const auto it = sizeCache.constFind(key); it != sizeCache.constEnd())
-            return it.value();
-
-        QImageReader reader(msg.contentImagePath);
-        reader.setAutoTransform(true);
-        QSize size = reader.size();
-        if (!size.isValid()) {
-            const QPixmap pm = loadPreviewPixmap(msg);
-            size = pm.size();
-        }
-        if (!size.isEmpty()) {
-            sizeCache.insert(key, size);
-            if (sizeCache.size() > 2000)
-                sizeCache.clear();
-        }
-        return size;
-    }
-
-    static QPixmap loadPreviewPixmap(const MessageRecord& msg)
-    {
-        const QString key = mediaCacheBaseKey(msg);
-        if (key.isEmpty())
-            return {};
-
-        QPixmap pm;
-        const QString cacheKey = QStringLiteral("aggregate.preview.original:%1").arg(key);
-        if (QPixmapCache::find(cacheKey, &pm))
-            return pm;
-
-        QImageReader reader(msg.contentImagePath);
-        reader.setAutoTransform(true);
-        const QImage image = reader.read();
-        if (image.isNull())
+        if (msg.contentImagePath.isEmpty())
             return {};
-
-        pm = QPixmap::fromImage(image);
-        QPixmapCache::insert(cacheKey, pm);
-        return pm;
+        return mediaProbe(msg).originalSize;
     }
 
     static QPixmap loadScaledPreviewPixmap(const MessageRecord& msg, const QSize& targetSize,
                                            Qt::AspectRatioMode aspectMode = Qt::KeepAspectRatio)
     {
-        if (targetSize.isEmpty())
-            return {};
-
-        const QString key = mediaCacheBaseKey(msg);
-        if (key.isEmpty())
-            return {};
-
-        const QString modeKey = aspectMode == Qt::KeepAspectRatioByExpanding
-                                    ? QStringLiteral("expand")
-                                    : QStringLiteral("fit");
-        const QString cacheKey = QStringLiteral("aggregate.preview.scaled:%1:%2:%3x%4")
-                                     .arg(modeKey, key)
-                                     .arg(targetSize.width())
-                                     .arg(targetSize.height());
-        QPixmap pm;
-        if (QPixmapCache::find(cacheKey, &pm))
-            return pm;
-
-        const QPixmap original = loadPreviewPixmap(msg);
-        if (original.isNull())
-            return {};
-
-        pm = original.scaled(targetSize, aspectMode, Qt::SmoothTransformation);
-        QPixmapCache::insert(cacheKey, pm);
-        return pm;
+        return ThumbnailService::instance().thumbnail(msg.contentImagePath, targetSize, aspectMode);
     }
 
     static QSize messageImageSize(const MessageRecord& msg, int bubbleWidth)
@@ -968,11 +1005,16 @@ private:
             return msg.content;
         if (msg.contentImagePath.isEmpty())
             return QStringLiteral("暂未识别到文本");
-        if (!QFile::exists(msg.contentImagePath))
+        switch (mediaProbe(msg).status) {
+        case ThumbnailService::Status::Loading:
+            return QStringLiteral("图片加载中…");
+        case ThumbnailService::Status::Missing:
             return QStringLiteral("图片文件不存在");
-        QPixmap pm(msg.contentImagePath);
-        if (pm.isNull())
+        case ThumbnailService::Status::Failed:
             return QStringLiteral("图片加载失败");
+        case ThumbnailService::Status::Ready:
+            break;
+        }
         return QStringLiteral("图片内容待识别");
     }
 
@@ -1057,16 +1099,16 @@ private:
                                 option.rect.center().y() - textSize.height() / 2),
                          textSize);
         painter->setPen(Qt::NoPen);
-        painter->setBrush(QColor(QStringLiteral("#E5E7EB")));
+        painter->setBrush(m_palette.separatorBg);
         painter->drawRoundedRect(pill, 14, 14);
-        painter->setPen(QColor(QStringLiteral("#6B7280")));
+        painter->setPen(m_palette.separatorText);
         painter->drawText(pill, Qt::AlignCenter, text);
     }
 
     void paintAvatar(QPainter* painter, const QRect& avatarRect, bool outgoing, const QFont& baseFont) const
     {
         painter->setPen(Qt::NoPen);
-        painter->setBrush(QColor(QStringLiteral("#20B8E8")));
+        painter->setBrush(m_palette.avatarBg);
         painter->drawEllipse(avatarRect);
         const QPixmap& avatarPixmap = outgoing ? m_selfAvatarPixmap : m_customerAvatarPixmap;
         if (!avatarPixmap.isNull())
@@ -1096,7 +1138,7 @@ private:
         if (name.isEmpty())
             name = outgoing ? QStringLiteral("我") : QStringLiteral("客户");
 
-        painter->setPen(QColor(QStringLiteral("#6B7280")));
+        painter->setPen(m_palette.metaText);
         if (outgoing) {
             const int nameW = qMin(160, fm.horizontalAdvance(name) + 4);
             const int timeW = timeStr.isEmpty() ? 0 : qMin(92, fm.horizontalAdvance(timeStr) + 4);
@@ -1144,9 +1186,9 @@ private:
                              bubbleW - 24, qMax(1, bubbleRect.bottom() - contentY - statusReserve));
         painter->setFont(bodyFont);
         if (messageDisplayTextIsHint(msg))
-            painter->setPen(outgoing ? QColor(QStringLiteral("#E0F2FE")) : QColor(QStringLiteral("#9CA3AF")));
+            painter->setPen(outgoing ? m_palette.hintOut : m_palette.hintIn);
         else
-            painter->setPen(outgoing ? QColor(QStringLiteral("#FFFFFF")) : QColor(QStringLiteral("#111827")));
+            painter->setPen(outgoing ? m_palette.textOut : m_palette.textIn);
         painter->drawText(textRect,
                           Qt::AlignLeft | Qt::AlignTop | Qt::TextWordWrap | Qt::TextExpandTabs,
                           messageDisplayText(msg));
@@ -1160,9 +1202,9 @@ private:
         const QRect iconRect(contentRect.left(), contentRect.top() + 4, 38, 44);
 
         painter->setPen(Qt::NoPen);
-        painter->setBrush(outgoing ? QColor(QStringLiteral("#DFF7FF")) : QColor(QStringLiteral("#E0F2FE")));
+        painter->setBrush(outgoing ? m_palette.fileIconBgOut : m_palette.fileIconBgIn);
         painter->drawRoundedRect(iconRect, 6, 6);
-        painter->setBrush(outgoing ? QColor(QStringLiteral("#0EA5E9")) : QColor(QStringLiteral("#0284C7")));
+        painter->setBrush(outgoing ? m_palette.fileIconLineOut : m_palette.fileIconLineIn);
         painter->drawRect(QRect(iconRect.left() + 8, iconRect.top() + 10, iconRect.width() - 16, 4));
         painter->drawRect(QRect(iconRect.left() + 8, iconRect.top() + 20, iconRect.width() - 16, 4));
         painter->drawRect(QRect(iconRect.left() + 8, iconRect.top() + 30, iconRect.width() - 22, 4));
@@ -1173,7 +1215,7 @@ private:
         QFont titleFont(bodyFont);
         titleFont.setBold(true);
         painter->setFont(titleFont);
-        painter->setPen(outgoing ? QColor(QStringLiteral("#FFFFFF")) : QColor(QStringLiteral("#111827")));
+        painter->setPen(outgoing ? m_palette.textOut : m_palette.textIn);
         const QFontMetrics titleFm(titleFont);
         painter->drawText(QRect(textRect.left(), textRect.top() + 2, textRect.width(), titleFm.height() + 2),
                           Qt::AlignLeft | Qt::AlignVCenter,
@@ -1182,7 +1224,7 @@ private:
         const QString detail = mediaDetail(msg);
         if (!detail.isEmpty()) {
             painter->setFont(statusFont);
-            painter->setPen(outgoing ? QColor(QStringLiteral("#E0F2FE")) : QColor(QStringLiteral("#6B7280")));
+            painter->setPen(outgoing ? m_palette.detailOut : m_palette.detailIn);
             const QFontMetrics detailFm(statusFont);
             painter->drawText(QRect(textRect.left(), textRect.top() + titleFm.height() + 8,
                                     textRect.width(), detailFm.height() + 2),
@@ -1209,9 +1251,9 @@ private:
                             previewRect.width(),
                             previewRect.height());
             painter->drawPixmap(previewRect, preview, src);
-            painter->fillRect(previewRect, QColor(17, 24, 39, 80));
+            painter->fillRect(previewRect, m_palette.videoOverlay);
         } else {
-            painter->setBrush(outgoing ? QColor(QStringLiteral("#DFF7FF")) : QColor(QStringLiteral("#F3F4F6")));
+            painter->setBrush(outgoing ? m_palette.videoPlaceholderOut : m_palette.videoPlaceholderIn);
             painter->drawRoundedRect(previewRect, 8, 8);
         }
 
@@ -1220,8 +1262,7 @@ private:
         play << QPoint(center.x() - 8, center.y() - 12)
              << QPoint(center.x() - 8, center.y() + 12)
              << QPoint(center.x() + 14, center.y());
-        painter->setBrush(!preview.isNull() || outgoing ? QColor(QStringLiteral("#FFFFFF"))
-                                                         : QColor(QStringLiteral("#0EA5E9")));
+        painter->setBrush(!preview.isNull() || outgoing ? m_palette.playIcon : m_palette.playIconPlain);
         painter->drawPolygon(play);
 
         const QRect textRect(bubbleRect.left() + 12, previewRect.bottom() + 6,
@@ -1229,7 +1270,7 @@ private:
         QFont titleFont(bodyFont);
         titleFont.setBold(true);
         painter->setFont(titleFont);
-        painter->setPen(outgoing ? QColor(QStringLiteral("#FFFFFF")) : QColor(QStringLiteral("#111827")));
+        painter->setPen(outgoing ? m_palette.textOut : m_palette.textIn);
         const QFontMetrics titleFm(titleFont);
         const QString detail = mediaDetail(msg);
         QString title = mediaTitle(msg);
@@ -1249,19 +1290,19 @@ private:
         switch (msg.syncStatus) {
         case 10:
             statusText = QStringLiteral("发送中...");
-            statusColor = QColor(QStringLiteral("#FBBF24"));
+            statusColor = m_palette.statusSending;
             break;
         case 11:
             statusText = QStringLiteral("已发送");
-            statusColor = QColor(QStringLiteral("#E0F2FE"));
+            statusColor = m_palette.statusSent;
             break;
         case 12:
             statusText = QStringLiteral("发送失败");
-            statusColor = QColor(QStringLiteral("#FCA5A5"));
+            statusColor = m_palette.statusFailed;
             break;
         default:
             statusText = QStringLiteral("已发送");
-            statusColor = QColor(QStringLiteral("#E0F2FE"));
+            statusColor = m_palette.statusSent;
             break;
         }
 
@@ -1273,7 +1314,7 @@ private:
         painter->drawText(QRect(bubbleRect.left() + 12, statusTop, bubbleW - 24, statusH),
                           Qt::AlignLeft | Qt::AlignVCenter, statusText);
         if (msg.syncStatus == 12 && !msg.errorReason.isEmpty()) {
-            painter->setPen(QColor(QStringLiteral("#DC2626")));
+            painter->setPen(m_palette.errorText);
             painter->drawText(QRect(bubbleRect.left() + 12, statusTop + statusH + 2, bubbleW - 24, statusH),
                               Qt::AlignLeft | Qt::AlignTop, msg.errorReason);
         }
@@ -1281,6 +1322,15 @@ private:
 
     static QString sizeHintCacheKey(const MessageRecord& msg, int rowWidth, const QFont& font)
     {
+        // 行高取决于探测结果，加载中与就绪后的键不同
+        QString mediaState;
+        if (!msg.contentImagePath.isEmpty()) {
+            const ThumbnailService::Probe probe = mediaProbe(msg);
+            mediaState = QStringLiteral("%1:%2x%3")
+                             .arg(static_cast<int>(probe.status))
+                             .arg(probe.originalSize.width())
+                             .arg(probe.originalSize.height());
+        }
         return QStringList{
             QString::number(rowWidth),
             font.toString(),
@@ -1292,13 +1342,17 @@ private:
             msg.contentType,
             msg.originalTimestamp,
             msg.direction,
+            mediaState,
         }.join(QChar(0x1f));
     }
 
+    ChatBubblePalette m_palette = ThemeEngine::instance().chatBubblePalette(ApplyStyle::MainWindowTheme::Default);
     QString m_selfDisplayName;
     QPixmap m_selfAvatarPixmap;
     QPixmap m_customerAvatarPixmap;
     mutable QHash<QString, QSize> m_sizeHintCache;
+    bool m_refreshScheduled = false;
+    bool m_relayoutPending = false;
 };
 
 class MessageListView final : public QListView
@@ -1500,6 +1554,7 @@ MessageRecord serviceMessageRecord(const QJsonObject& object, int localConversat
     record.observedAt = record.createdAt;
     record.cacheScope = QStringLiteral("service_db");
     record.cacheOrigin = QStringLiteral("python_service_db");
+    MessageAtoms::compact(record);
     return record;
 }
 
@@ -1945,6 +2000,10 @@ bool handleAggregateBuildFailure(QWidget* parent,
                            "并在左栏「管理后台」→「AI 客服后台」→「API 配置/模型」中完成该线路的 "
                            "Base URL、接入点 ID 与 API Key 并保存。"));
         break;
+    case AggregateAiBuildFailure::ProfileUpToDate:
+        showAggregateInfo(parent, QStringLiteral("客户信息"),
+                          QStringLiteral("客户信息已是最新：上次整理之后暂无新的聊天记录。"));
+        break;
     case AggregateAiBuildFailure::None:
         break;
     }
@@ -1958,6 +2017,9 @@ AggregateChatForm::AggregateChatForm(const QString& loginUsername, QWidget* pare
     , m_loginUsername(loginUsername)
 {
     m_conversationListModel = new ConversationListModel(this);
+    m_conversationSearch = new ConversationSearch(this);
+    connect(m_conversationSearch, &ConversationSearch::resultsReady,
+            this, &AggregateChatForm::applyConversationSearchResults);
     m_messageListModel = new MessageListModel(this);
     setupUI();
     m_conversationService = new ConversationAppService();
@@ -2101,6 +2163,7 @@ void AggregateChatForm::setupUI()
 
     m_messageRefreshTimer = new QTimer(this);
     m_messageRefreshTimer->setInterval(500);
+    // 处理动态由 DataEventBus 推送；定时器只在面板展开且有在途请求时兜底补齐其他进程写入的事件
     m_sendTimelineTimer = new QTimer(this);
     m_sendTimelineTimer->setInterval(900);
     m_pythonBackfillTimer = new QTimer(this);
@@ -2122,7 +2185,7 @@ void AggregateChatForm::setupUI()
 
 void AggregateChatForm::setupStyles()
 {
-    setStyleSheet(ApplyStyle::aggregateChatFormStyle());
+    ThemeEngine::instance().apply(this, ThemeEngine::Root::AggregateChatForm, ApplyStyle::MainWindowTheme::Default);
     syncSolidBackgrounds();
 }
 
@@ -2211,8 +2274,9 @@ void AggregateChatForm::schedulePythonServiceBackfill(int delayMs)
 void AggregateChatForm::applyTheme(ApplyStyle::MainWindowTheme theme)
 {
     Q_UNUSED(theme)
-    setStyleSheet(ApplyStyle::aggregateChatFormStyle());
-    syncSolidBackgrounds();
+    // 构造时已按默认主题设置过；主题未变时不重新 polish 整棵子树
+    if (ThemeEngine::instance().apply(this, ThemeEngine::Root::AggregateChatForm, ApplyStyle::MainWindowTheme::Default))
+        syncSolidBackgrounds();
     updateAggregateAiControlsVisibility();
     scheduleChatInputRelayout();
 }
@@ -2222,6 +2286,8 @@ void AggregateChatForm::showEvent(QShowEvent* event)
     QWidget::showEvent(event);
     scheduleChatInputRelayout();
     scheduleAdaptiveRelayout(false);
+    // 隐藏期间推送来的事件没有追加，重新显示时补一次
+    pollSendTimeline();
 }
 
 void AggregateChatForm::closeEvent(QCloseEvent* event)
@@ -2553,6 +2619,16 @@ void AggregateChatForm::connectSignals()
 
     connect(&mgr, &ConversationManager::messageStatusChanged,
             this, &AggregateChatForm::onMessageStatusChanged);
+    connect(&mgr, &ConversationManager::sendDelegated,
+            this, &AggregateChatForm::onSendDelegated);
+    connect(&mgr, &ConversationManager::delegatedSendFinished,
+            this, &AggregateChatForm::onDelegatedSendFinished);
+
+    auto& dataEvents = DataEventBus::instance();
+    connect(&dataEvents, &DataEventBus::messageSendEventAppended,
+            this, &AggregateChatForm::onSendEventAppended);
+    connect(&dataEvents, &DataEventBus::aiStageEventAppended,
+            this, &AggregateChatForm::onAiStageEventAppended);
 
     auto& ipc = Ipc::IpcService::instance();
     connect(&ipc, &Ipc::IpcService::aiSuggestionReceived,
@@ -2620,7 +2696,6 @@ void AggregateChatForm::connectSignals()
         connect(m_modelPickerList, &QListWidget::itemClicked, this, &AggregateChatForm::onModelPickerListItem);
     connect(m_sendTimelineTimer, &QTimer::timeout,
             this, &AggregateChatForm::pollSendTimeline);
-    m_sendTimelineTimer->start();
 
 }
 
@@ -3157,10 +3232,11 @@ QWidget* AggregateChatForm::buildLeftPanel()
     searchLayout->setSpacing(0);
     m_searchEdit = new QLineEdit(searchRow);
     m_searchEdit->setObjectName("aggregateSearch");
-    m_searchEdit->setPlaceholderText(QStringLiteral("搜索会话或客户名"));
+    m_searchEdit->setPlaceholderText(QStringLiteral("搜索客户名、拼音首字母或消息"));
     m_searchEdit->addAction(QIcon(QStringLiteral(":/aggregate_reception_icons/search_icon.svg")),
                             QLineEdit::LeadingPosition);
-    connect(m_searchEdit, &QLineEdit::textChanged, this, [this]() { refreshConversationList(); });
+    // 输入只触发内存中的匹配，结果经 resultsReady 回到 applyConversationSearchResults
+    connect(m_searchEdit, &QLineEdit::textChanged, m_conversationSearch, &ConversationSearch::setQuery);
     searchLayout->addWidget(m_searchEdit, 1);
     layout->addWidget(searchRow);
 
@@ -3325,13 +3401,6 @@ QWidget* AggregateChatForm::buildCenterPanel()
     m_btnNewMessages->setCursor(Qt::PointingHandCursor);
     m_btnNewMessages->setAutoRaise(false);
     m_btnNewMessages->setVisible(false);
-    m_btnNewMessages->setStyleSheet(QStringLiteral(
-        "QToolButton#aggregateNewMessageHint{"
-        "background:#FFFFFF;color:#0F172A;border:1px solid #CBD5E1;"
-        "border-radius:14px;padding:4px 12px;font-size:12px;"
-        "}"
-        "QToolButton#aggregateNewMessageHint:hover{background:#F8FAFC;border-color:#38BDF8;}"
-        "QToolButton#aggregateNewMessageHint:pressed{background:#E0F2FE;}"));
     connect(m_btnNewMessages, &QToolButton::clicked, this, [this]() {
         clearPendingNewMessageHint();
         scheduleScrollChatToBottom(true);
@@ -3870,6 +3939,8 @@ QWidget* AggregateChatForm::buildRightPanel()
         updateRightBarSendSectionStretch();
         if (expanded)
             pollSendTimeline();
+        else
+            updateSendTimelinePolling();
     });
     m_sendTimelineBody->setVisible(false);
 
@@ -4039,12 +4110,14 @@ void AggregateChatForm::refreshCustomerProfilePanel()
         m_customerProfileText->setText(QStringLiteral("暂无客户信息"));
 
     if (m_btnOrganizeCustomerProfile) {
-        m_btnOrganizeCustomerProfile->setText(m_customerProfileBusy
+        const bool busyHere = m_customerProfileBusy && m_customerProfileTargetConvId == m_currentConvId;
+        m_btnOrganizeCustomerProfile->setText(busyHere
                                                   ? QStringLiteral("整理中")
                                                   : (record ? QStringLiteral("重新整理")
                                                             : QStringLiteral("整理")));
         m_btnOrganizeCustomerProfile->setEnabled(m_currentConvId > 0
-                                                 && !m_customerProfileBusy
+                                                 && !busyHere
+                                                 && !customerProfileForegroundBusy()
                                                  && !m_aggregateAiGenerating
                                                  && !m_autoReplyBusy);
     }
@@ -4061,6 +4134,11 @@ void AggregateChatForm::setCustomerProfileBusy(bool busy)
     refreshCustomerProfilePanel();
 }
 
+bool AggregateChatForm::customerProfileForegroundBusy() const
+{
+    return m_customerProfileBusy && !m_customerProfileBackground;
+}
+
 QJsonObject AggregateChatForm::parseCustomerProfileJson(const QString& text) const
 {
     QString raw = text.trimmed();
@@ -4178,6 +4256,11 @@ void AggregateChatForm::onMessageStatusChanged(int conversationId, int messageId
                                                Models::MessageStatus newStatus,
                                                const QString& errorReason)
 {
+    if ((newStatus == Models::MessageStatus::Sent || newStatus == Models::MessageStatus::Failed)
+        && m_sendTimelineInFlightMessageIds.remove(messageId)) {
+        updateSendTimelinePolling();
+    }
+
     if (conversationId != m_currentConvId)
         return;
 
@@ -4185,7 +4268,6 @@ void AggregateChatForm::onMessageStatusChanged(int conversationId, int messageId
         return;
 
     if (m_messageListModel->updateMessageStatus(messageId, newStatus, errorReason)) {
-        m_currentMessageSignature = m_messageListModel->signature();
         qDebug() << "[AggregateChatForm] 消息状态已更新 msgId=" << messageId
                  << "status=" << Models::toString(newStatus);
 
@@ -4482,16 +4564,14 @@ void AggregateChatForm::refreshComposeAttachments()
         auto* card = new QFrame(m_composeAttachmentsWidget);
         card->setObjectName(QStringLiteral("composeAttachmentCard"));
         card->setFixedSize(190, 64);
-        card->setStyleSheet(QStringLiteral(
-            "QFrame#composeAttachmentCard{background:#F8FAFC;border:1px solid #D9E2EC;border-radius:6px;}"));
         auto* row = new QHBoxLayout(card);
         row->setContentsMargins(8, 6, 6, 6);
         row->setSpacing(8);
 
         auto* thumb = new QLabel(card);
+        thumb->setObjectName(QStringLiteral("composeAttachmentThumb"));
         thumb->setFixedSize(48, 48);
         thumb->setAlignment(Qt::AlignCenter);
-        thumb->setStyleSheet(QStringLiteral("background:#E5E7EB;border-radius:4px;color:#334155;font-size:12px;"));
         if (part.type == OutgoingPartType::Image) {
             QPixmap pixmap(part.localPath);
             if (!pixmap.isNull())
@@ -4509,7 +4589,7 @@ void AggregateChatForm::refreshComposeAttachments()
         textLayout->setContentsMargins(0, 0, 0, 0);
         textLayout->setSpacing(2);
         auto* title = new QLabel(part.fileName.isEmpty() ? QFileInfo(part.localPath).fileName() : part.fileName, textBox);
-        title->setStyleSheet(QStringLiteral("color:#0F172A;font-size:12px;"));
+        title->setObjectName(QStringLiteral("composeAttachmentTitle"));
         title->setMinimumWidth(0);
         title->setSizePolicy(QSizePolicy::Ignored, QSizePolicy::Preferred);
         title->setTextFormat(Qt::PlainText);
@@ -4517,7 +4597,7 @@ void AggregateChatForm::refreshComposeAttachments()
         title->setTextInteractionFlags(Qt::TextSelectableByMouse);
         title->setToolTip(part.localPath);
         auto* detail = new QLabel(readableFileSize(part.sizeBytes), textBox);
-        detail->setStyleSheet(QStringLiteral("color:#64748B;font-size:11px;"));
+        detail->setObjectName(QStringLiteral("composeAttachmentDetail"));
         detail->setMinimumWidth(0);
         detail->setSizePolicy(QSizePolicy::Ignored, QSizePolicy::Preferred);
         textLayout->addWidget(title);
@@ -4525,23 +4605,12 @@ void AggregateChatForm::refreshComposeAttachments()
         row->addWidget(textBox, 1);
 
         auto* removeBtn = new QToolButton(card);
+        removeBtn->setObjectName(QStringLiteral("composeAttachmentRemoveBtn"));
         removeBtn->setText(QStringLiteral("×"));
         removeBtn->setToolTip(QStringLiteral("删除附件"));
         removeBtn->setCursor(Qt::PointingHandCursor);
         removeBtn->setAutoRaise(false);
         removeBtn->setFixedSize(22, 22);
-        removeBtn->setStyleSheet(QStringLiteral(
-            "QToolButton{"
-            "background:#E2E8F0;"
-            "border:1px solid #CBD5E1;"
-            "border-radius:11px;"
-            "color:#334155;"
-            "font-size:14px;"
-            "font-weight:700;"
-            "padding:0;"
-            "}"
-            "QToolButton:hover{background:#FEE2E2;border-color:#FCA5A5;color:#B91C1C;}"
-            "QToolButton:pressed{background:#FECACA;}"));
         connect(removeBtn, &QToolButton::clicked, this, [this, i]() {
             if (i >= 0 && i < m_composeAttachments.size()) {
                 m_composeAttachments.removeAt(i);
@@ -4643,7 +4712,9 @@ void AggregateChatForm::refreshConversationList()
 
     auto& mgr = ConversationManager::instance();
     MessageDao msgDao;
-    const QString keyword = m_searchEdit ? m_searchEdit->text().trimmed() : QString();
+    const QString keyword = m_conversationSearch ? m_conversationSearch->appliedQuery() : QString();
+    if (m_conversationSearch)
+        m_conversationListModel->setSearchMatches(keyword, m_conversationSearch->matches());
     m_conversationListModel->setFilters(static_cast<int>(m_currentTab),
                                         static_cast<int>(m_platformFilter),
                                         keyword,
@@ -4653,7 +4724,7 @@ void AggregateChatForm::refreshConversationList()
     bool loadedFromService = false;
     if (RuntimeMode::isSingleHostServiceDb()) {
         conversations = mgr.allConversations();
-        lastDirections = msgDao.lastCachedDirectionsByConversation();
+        lastDirections = msgDao.lastCachedDirectionsByConversation(conversations);
         qInfo() << "[AggregateChatForm] conversation list loaded from app data db"
                 << "count=" << conversations.size();
     } else if (RuntimeMode::ownsBusinessDatabase() && m_pythonServiceAvailable) {
@@ -4695,13 +4766,28 @@ void AggregateChatForm::refreshConversationList()
 
     if (!RuntimeMode::isSingleHostServiceDb() && !loadedFromService) {
         conversations = mgr.allConversations();
-        lastDirections = msgDao.lastCachedDirectionsByConversation();
+        lastDirections = msgDao.lastCachedDirectionsByConversation(conversations);
     }
     m_conversationListModel->setSourceConversations(conversations, lastDirections);
+    if (m_conversationSearch)
+        m_conversationSearch->setConversations(conversations);
     renderConversationListFromModel();
     return;
 }
 
+void AggregateChatForm::applyConversationSearchResults()
+{
+    if (!m_conversationListModel || !m_conversationSearch)
+        return;
+    const QString keyword = m_conversationSearch->appliedQuery();
+    m_conversationListModel->setSearchMatches(keyword, m_conversationSearch->matches());
+    m_conversationListModel->setFilters(static_cast<int>(m_currentTab),
+                                        static_cast<int>(m_platformFilter),
+                                        keyword,
+                                        m_pendingStickyConvId);
+    renderConversationListFromModel();
+}
+
 void AggregateChatForm::reloadFromLocalCache()
 {
     refreshConversationList();
@@ -5112,11 +5198,11 @@ void AggregateChatForm::renderConversationMessagesFromModel()
 
 void AggregateChatForm::appendMessageBubble(const MessageRecord& msg)
 {
+    // 追加与状态回执都是 O(1) 的增量更新，不再每次重算整段签名；
+    // 签名落后时 refreshVisibleConversationMessages 走模型的差异刷新，未变化的行不会重绘
     if (m_messageListModel)
         m_messageListModel->appendMessage(msg);
     renderConversationMessagesFromModel();
-    if (m_messageListModel)
-        m_currentMessageSignature = m_messageListModel->signature();
 }
 
 QString AggregateChatForm::buildMessageSignature(const QVector<MessageRecord>& messages) const
@@ -5250,14 +5336,112 @@ void AggregateChatForm::resetSendTimelineForConversation()
     MessageSendEventDao dao;
     m_sendTimelineBaselineId = dao.globalMaxId();
     m_aiStageTimelineBaselineId = AiRequestEventDao().globalStageMaxId();
+    updateSendTimelinePolling();
 }
 
-void AggregateChatForm::pollSendTimeline()
+bool AggregateChatForm::sendTimelineInFlight() const
+{
+    return m_aggregateAiRequestEventId > 0
+        || m_autoReplyRequestEventId > 0
+        || m_customerProfileRequestEventId > 0
+        || !m_sendTimelineInFlightMessageIds.isEmpty()
+        || !m_sendTimelineDelegatedSends.isEmpty();
+}
+
+void AggregateChatForm::updateSendTimelinePolling()
+{
+    if (!m_sendTimelineTimer)
+        return;
+    const bool poll = m_currentConvId > 0
+        && m_sendTimelineBody && m_sendTimelineBody->isVisible()
+        && sendTimelineInFlight();
+    if (poll && !m_sendTimelineTimer->isActive())
+        m_sendTimelineTimer->start();
+    else if (!poll && m_sendTimelineTimer->isActive())
+        m_sendTimelineTimer->stop();
+}
+
+void AggregateChatForm::onSendEventAppended(const MessageSendEventRecord& event)
+{
+    if (event.phase == QLatin1String("send_attempt"))
+        m_sendTimelineInFlightMessageIds.insert(event.messageId);
+    else if (event.phase != QLatin1String("receipt_result"))
+        m_sendTimelineInFlightMessageIds.remove(event.messageId);
+
+    const bool visible = m_currentConvId > 0 && m_sendTimeline
+        && m_sendTimelineBody && m_sendTimelineBody->isVisible();
+    if (event.conversationId == m_currentConvId && visible) {
+        if (event.id == m_sendTimelineBaselineId + 1) {
+            const QString line = formatSendEventLine(event);
+            if (!line.isEmpty())
+                m_sendTimeline->appendPlainText(line);
+            m_sendTimelineBaselineId = event.id;
+        } else if (event.id > m_sendTimelineBaselineId) {
+            // 中间有其他进程写入、未经推送的行，回表按 id 补齐（含本条）
+            pollSendTimeline();
+        }
+    } else if (event.conversationId != m_currentConvId && event.id == m_sendTimelineBaselineId + 1) {
+        m_sendTimelineBaselineId = event.id;
+    }
+    updateSendTimelinePolling();
+}
+
+void AggregateChatForm::onSendDelegated(int conversationId, const QString& clientMessageId)
+{
+    if (clientMessageId.isEmpty())
+        return;
+    m_sendTimelineDelegatedSends.insert(clientMessageId, conversationId);
+    updateSendTimelinePolling();
+}
+
+void AggregateChatForm::onDelegatedSendFinished(int conversationId, const QString& clientMessageId)
 {
-    if (m_currentConvId <= 0 || !m_sendTimeline)
+    if (!m_sendTimelineDelegatedSends.remove(clientMessageId))
         return;
-    if (!m_sendTimelineBody || !m_sendTimelineBody->isVisible())
+    // 结果回来时服务写的终态行可能还没轮询到，当前会话再回表一次
+    if (conversationId == m_currentConvId)
+        pollSendTimeline();
+    else
+        updateSendTimelinePolling();
+}
+
+void AggregateChatForm::retireDelegatedSend(int conversationId)
+{
+    for (auto it = m_sendTimelineDelegatedSends.begin(); it != m_sendTimelineDelegatedSends.end(); ++it) {
+        if (it.value() == conversationId) {
+            m_sendTimelineDelegatedSends.erase(it);
+            return;
+        }
+    }
+}
+
+void AggregateChatForm::onAiStageEventAppended(const AiRequestStageEventRecord& event)
+{
+    const bool visible = m_currentConvId > 0 && m_sendTimeline
+        && m_sendTimelineBody && m_sendTimelineBody->isVisible();
+    if (event.conversationId == m_currentConvId && visible) {
+        if (event.id == m_aiStageTimelineBaselineId + 1) {
+            const QString line = formatAiStageEventLine(event);
+            if (!line.isEmpty())
+                m_sendTimeline->appendPlainText(line);
+            m_aiStageTimelineBaselineId = event.id;
+        } else if (event.id > m_aiStageTimelineBaselineId) {
+            pollSendTimeline();
+        }
+    } else if (event.conversationId != m_currentConvId && event.id == m_aiStageTimelineBaselineId + 1) {
+        m_aiStageTimelineBaselineId = event.id;
+    }
+    updateSendTimelinePolling();
+}
+
+void AggregateChatForm::pollSendTimeline()
+{
+    if (m_currentConvId <= 0 || !m_sendTimeline
+        || !m_sendTimelineBody || !m_sendTimelineBody->isVisible()) {
+        updateSendTimelinePolling();
         return;
+    }
+    constexpr int kPageLimit = 200;
 
     struct TimelineLine {
         QDateTime createdAt;
@@ -5265,26 +5449,37 @@ void AggregateChatForm::pollSendTimeline()
     };
     QVector<TimelineLine> lines;
 
+    // 先取全表最大 id 再查本会话：查询前已提交的行都在结果里，基线可以直接推进到该值，
+    // 之后推送来的事件 id 连续时就不必再回表
     MessageSendEventDao sendDao;
+    const qint64 sendHorizon = sendDao.globalMaxId();
     const QVector<MessageSendEventRecord> rows =
-        sendDao.listSince(m_currentConvId, m_sendTimelineBaselineId);
+        sendDao.listSince(m_currentConvId, m_sendTimelineBaselineId, kPageLimit);
     for (const MessageSendEventRecord& e : rows) {
         const QString line = formatSendEventLine(e);
         if (!line.isEmpty())
             lines.push_back({e.createdAt, line});
+        if (isTerminalSendEvent(e))
+            retireDelegatedSend(m_currentConvId);
         m_sendTimelineBaselineId = std::max(m_sendTimelineBaselineId, e.id);
     }
+    if (rows.size() < kPageLimit)
+        m_sendTimelineBaselineId = std::max(m_sendTimelineBaselineId, sendHorizon);
 
     AiRequestEventDao aiDao;
+    const qint64 aiHorizon = aiDao.globalStageMaxId();
     const QVector<AiRequestStageEventRecord> aiRows =
-        aiDao.listStagesSince(m_currentConvId, m_aiStageTimelineBaselineId);
+        aiDao.listStagesSince(m_currentConvId, m_aiStageTimelineBaselineId, kPageLimit);
     for (const AiRequestStageEventRecord& e : aiRows) {
         const QString line = formatAiStageEventLine(e);
         if (!line.isEmpty())
             lines.push_back({e.createdAt, line});
         m_aiStageTimelineBaselineId = std::max(m_aiStageTimelineBaselineId, e.id);
     }
+    if (aiRows.size() < kPageLimit)
+        m_aiStageTimelineBaselineId = std::max(m_aiStageTimelineBaselineId, aiHorizon);
 
+    updateSendTimelinePolling();
     if (lines.isEmpty())
         return;
 
@@ -5638,6 +5833,9 @@ void AggregateChatForm::onNewMessage(int conversationId, const MessageRecord& ms
     refreshConversationList();
     showStatusMessage(QStringLiteral("新消息: %1").arg(msg.content.left(30)), 3000);
 
+    // 先判断客户信息增量刷新：自动回复一旦启动会占用 AI 忙碌态
+    if (msg.direction == QLatin1String("in"))
+        maybeRefreshCustomerProfileInBackground(conversationId);
     if (conversationId == m_currentConvId && msg.direction == QLatin1String("in"))
         tryAggregateAutoReply(conversationId, QStringLiteral("T2"));
     qInfo() << "[AggregateChatForm] inbound message UI timing"
@@ -5814,7 +6012,7 @@ void AggregateChatForm::updateAggregateAiControlsVisibility()
     const bool convOk = m_currentConvId > 0;
     const bool onChat = m_centerStack && m_centerStack->currentWidget() == m_chatArea;
     const bool showControls = convOk && onChat;
-    const bool aiBusy = m_aggregateAiGenerating || m_autoReplyBusy || m_customerProfileBusy;
+    const bool aiBusy = m_aggregateAiGenerating || m_autoReplyBusy || customerProfileForegroundBusy();
     if (m_btnAiModelPick) {
         m_btnAiModelPick->setVisible(showControls);
         m_btnAiModelPick->setEnabled(showControls && !aiBusy);
@@ -5825,7 +6023,8 @@ void AggregateChatForm::updateAggregateAiControlsVisibility()
     }
     if (m_btnAutoReplyToggle) {
         m_btnAutoReplyToggle->setVisible(showControls);
-        m_btnAutoReplyToggle->setEnabled(showControls && !m_aggregateAiGenerating && !m_customerProfileBusy);
+        m_btnAutoReplyToggle->setEnabled(showControls && !m_aggregateAiGenerating
+                                         && !customerProfileForegroundBusy());
     }
     if (m_btnOrganizeCustomerProfile) {
         m_btnOrganizeCustomerProfile->setEnabled(showControls && !aiBusy);
@@ -5898,21 +6097,15 @@ void AggregateChatForm::abortAggregateAiRequest()
         m_autoReplyRequestEventId = 0;
         m_autoReplyFirstTokenMs = 0;
     }
-    if (m_customerProfileBusy && m_customerProfileRequestEventId > 0) {
-        AiRequestEventDao().appendStage(m_customerProfileRequestEventId, m_currentConvId,
-                                         QStringLiteral("canceled"));
-        AiRequestEventDao().cancelEvent(m_customerProfileRequestEventId,
-                                        int(m_customerProfileRequestTimer.elapsed()));
-        m_customerProfileRequestEventId = 0;
-        m_customerProfileFirstTokenMs = 0;
-    }
+    // 后台刷新可能属于其他会话，切换或离开当前会话时不必中止
+    if (customerProfileForegroundBusy())
+        abortCustomerProfileRequest();
     if (!m_aggregateAiIpcRequestId.isEmpty()) {
         Ipc::IpcService::instance().cancelRequest(m_aggregateAiIpcRequestId);
         m_aggregateAiIpcRequestId.clear();
     }
     clearStreamingSession(m_aggregateAiSession);
     clearStreamingSession(m_autoReplySession);
-    clearStreamingSession(m_customerProfileSession);
     if (m_aggregateAiGenerating)
         setAggregateAiBusy(false);
     if (m_autoReplyBusy) {
@@ -5920,10 +6113,6 @@ void AggregateChatForm::abortAggregateAiRequest()
         m_autoReplyTargetConvId = -1;
         m_autoReplyAccumulated.clear();
     }
-    if (m_customerProfileBusy) {
-        m_customerProfileBusy = false;
-        m_customerProfileAccumulated.clear();
-    }
     updateAggregateAiControlsVisibility();
     refreshRightBarMetrics();
 }
@@ -5948,6 +6137,26 @@ void AggregateChatForm::abortAutoReplyRequest()
     refreshRightBarMetrics();
 }
 
+void AggregateChatForm::abortCustomerProfileRequest()
+{
+    if (m_customerProfileBusy && m_customerProfileRequestEventId > 0) {
+        AiRequestEventDao().appendStage(m_customerProfileRequestEventId, m_customerProfileTargetConvId,
+                                         QStringLiteral("canceled"));
+        AiRequestEventDao().cancelEvent(m_customerProfileRequestEventId,
+                                        int(m_customerProfileRequestTimer.elapsed()));
+        m_customerProfileRequestEventId = 0;
+        m_customerProfileFirstTokenMs = 0;
+    }
+    clearStreamingSession(m_customerProfileSession);
+    if (m_customerProfileBusy) {
+        m_customerProfileBusy = false;
+        m_customerProfileBackground = false;
+        m_customerProfileAccumulated.clear();
+    }
+    updateAggregateAiControlsVisibility();
+    refreshRightBarMetrics();
+}
+
 void AggregateChatForm::clearStreamingSession(IAiStreamingSession*& session)
 {
     if (!session)
@@ -6050,7 +6259,9 @@ void AggregateChatForm::onAggregateAiModelMenuTriggered(QAction* action)
 
 void AggregateChatForm::onOrganizeCustomerProfileClicked()
 {
-    if (m_currentConvId <= 0 || m_customerProfileBusy)
+    if (m_currentConvId <= 0 || customerProfileForegroundBusy())
+        return;
+    if (m_customerProfileBusy && m_customerProfileTargetConvId == m_currentConvId)
         return;
     if (m_aggregateAiGenerating || m_autoReplyBusy) {
         showStatusMessage(QStringLiteral("AI 正在处理其他任务，请稍后再整理客户信息"), 5000);
@@ -6060,18 +6271,103 @@ void AggregateChatForm::onOrganizeCustomerProfileClicked()
         showStatusMessage(QStringLiteral("AI 服务未初始化"), 4000);
         return;
     }
+    // 手动整理优先：让出其他会话的后台刷新，该会话再有新消息时会重新触发
+    if (m_customerProfileBusy)
+        abortCustomerProfileRequest();
+    startCustomerProfileRefresh(m_currentConvId, false);
+}
+
+void AggregateChatForm::maybeRefreshCustomerProfileInBackground(int conversationId)
+{
+    if (conversationId <= 0 || !m_aiChatService)
+        return;
+    if (m_customerProfileBusy || m_aggregateAiGenerating || m_autoReplyBusy)
+        return;
+
+    QSettings settings = AppSettings::create();
+    const int threshold = settings.value(QStringLiteral("aggregateAi/profileAutoRefreshInboundCount"),
+                                         kCustomerProfileAutoRefreshInboundDefault)
+                              .toInt();
+    if (threshold <= 0)
+        return;
+    const auto backoff = m_customerProfileRefreshBackoff.constFind(conversationId);
+    if (backoff != m_customerProfileRefreshBackoff.constEnd()
+        && QDateTime::currentMSecsSinceEpoch() < backoff->retryAfterMs) {
+        return;
+    }
+
+    // 只维护已整理过的客户信息；从未整理过的会话仍由客服手动触发
+    const auto record = CustomerProfileDao().findByConversationId(conversationId);
+    if (!record || record->profile.isEmpty())
+        return;
+    if (MessageDao().countCachedInboundAfter(conversationId, record->lastMessageId) < threshold)
+        return;
+
+    qInfo() << "[AggregateCustomerProfile] background refresh conv=" << conversationId
+            << "afterMessageId=" << record->lastMessageId;
+    startCustomerProfileRefresh(conversationId, true);
+}
+
+void AggregateChatForm::noteCustomerProfileRefreshOutcome(int conversationId, bool succeeded)
+{
+    if (conversationId <= 0)
+        return;
+    if (succeeded) {
+        m_customerProfileRefreshBackoff.remove(conversationId);
+        return;
+    }
+    CustomerProfileRefreshBackoff& backoff = m_customerProfileRefreshBackoff[conversationId];
+    backoff.failures = qMin(backoff.failures + 1, 16);
+    const qint64 delayMs = qMin(kCustomerProfileRefreshBackoffBaseMs << (backoff.failures - 1),
+                                kCustomerProfileRefreshBackoffMaxMs);
+    backoff.retryAfterMs = QDateTime::currentMSecsSinceEpoch() + delayMs;
+    qInfo() << "[AggregateCustomerProfile] refresh failed conv=" << conversationId
+            << "failures=" << backoff.failures << "backgroundRetryInMs=" << delayMs;
+}
 
+void AggregateChatForm::startCustomerProfileRefresh(int conversationId, bool background)
+{
     AggregateAiBuiltRequest built =
-        m_aiChatService->buildAggregateCustomerProfileRequest(m_currentConvId, m_aggregateAiSessionModelKey);
-    if (!handleAggregateBuildFailure(this, built, false, nullptr))
+        m_aiChatService->buildAggregateCustomerProfileRequest(conversationId, m_aggregateAiSessionModelKey);
+    if (!handleAggregateBuildFailure(this, built, background, nullptr)) {
+        if (built.failure != AggregateAiBuildFailure::ProfileUpToDate)
+            noteCustomerProfileRefreshOutcome(conversationId, false);
         return;
+    }
 
+    m_customerProfileTargetConvId = conversationId;
+    m_customerProfileCoveredMessageId = built.coveredMessageId;
+    m_customerProfileBackground = background;
     m_customerProfileAccumulated.clear();
     m_customerProfileRequestTimer.restart();
     m_customerProfileFirstTokenMs = 0;
+    m_customerProfileWinnerStartMs = 0;
     built.request.extraRootFields.insert(QStringLiteral("max_tokens"), 360);
     clearStreamingSession(m_customerProfileSession);
-    m_customerProfileSession = m_aiChatService->createSession(built.config, built.request, this);
+    m_customerProfileSession = m_aiChatService->createSession(built, this);
+    connect(m_customerProfileSession, &IAiStreamingSession::stageReported, this,
+            [this](const QString& stage, const QString& detail) {
+                AiRequestEventDao().appendStage(m_customerProfileRequestEventId,
+                                                m_customerProfileTargetConvId,
+                                                stage,
+                                                detail);
+            });
+    connect(m_customerProfileSession, &IAiStreamingSession::usageReported, this,
+            [this](const AiTokenUsage& usage) {
+                AiRequestEventDao().recordTokenUsage(m_customerProfileRequestEventId, usage.promptTokens,
+                                                     usage.cachedPromptTokens, usage.completionTokens);
+            });
+    connect(m_customerProfileSession, &IAiStreamingSession::hedgeResolved, this,
+            [this, primaryKey = built.config.sessionModelKey, backup = built.hedge.backupConfig](
+                bool backupWon, int winnerStartedAfterMs, int loserElapsedMs) {
+                m_customerProfileWinnerStartMs = winnerStartedAfterMs;
+                AiRequestEventDao eventDao;
+                if (backupWon)
+                    eventDao.recordServingModel(m_customerProfileRequestEventId, backup.sessionModelKey, backup.model);
+                eventDao.recordHedgeLoser(m_customerProfileRequestEventId,
+                                          backupWon ? primaryKey : backup.sessionModelKey,
+                                          loserElapsedMs);
+            });
     connect(m_customerProfileSession, &IAiStreamingSession::delta,
             this, &AggregateChatForm::onCustomerProfileStreamDelta);
     connect(m_customerProfileSession, &IAiStreamingSession::completed,
@@ -6081,23 +6377,27 @@ void AggregateChatForm::onOrganizeCustomerProfileClicked()
 
     m_customerProfileRequestEventId = AiRequestEventDao().beginEvent(
         QStringLiteral("aggregate_customer_profile"),
-        m_currentConvId,
+        m_customerProfileTargetConvId,
         m_aggregateAiSessionModelKey,
         built.config.model,
-        QStringLiteral("customer-profile"));
+        built.incrementalProfile ? QStringLiteral("customer-profile-incremental")
+                                 : QStringLiteral("customer-profile"));
     if (m_customerProfileRequestEventId > 0) {
         AiRequestEventDao eventDao;
-        eventDao.appendStage(m_customerProfileRequestEventId, m_currentConvId,
+        eventDao.appendStage(m_customerProfileRequestEventId, m_customerProfileTargetConvId,
                              QStringLiteral("profile_started"));
-        eventDao.appendStage(m_customerProfileRequestEventId, m_currentConvId,
-                             QStringLiteral("context_ready"));
-        eventDao.appendStage(m_customerProfileRequestEventId, m_currentConvId,
+        eventDao.appendStage(m_customerProfileRequestEventId, m_customerProfileTargetConvId,
+                             QStringLiteral("context_ready"),
+                             aggregateContextStageDetail(built.context));
+        eventDao.recordEstimatedPromptTokens(m_customerProfileRequestEventId, built.context.estimatedPromptTokens);
+        eventDao.appendStage(m_customerProfileRequestEventId, m_customerProfileTargetConvId,
                              QStringLiteral("request_sent"),
                              aggregateModelMenuLabel(m_aggregateAiSessionModelKey));
     }
 
     setCustomerProfileBusy(true);
-    showStatusMessage(QStringLiteral("正在整理客户信息..."), 0);
+    if (!background)
+        showStatusMessage(QStringLiteral("正在整理客户信息..."), 0);
     m_customerProfileSession->start();
 }
 
@@ -6125,12 +6425,33 @@ void AggregateChatForm::onGenerateAiDraftClicked()
 
     built.request.extraRootFields.insert(QStringLiteral("max_tokens"), 512);
     clearStreamingSession(m_aggregateAiSession);
-    m_aggregateAiSession = m_aiChatService->createSession(built.config, built.request, this);
+    m_aggregateAiSession = m_aiChatService->createSession(built, this);
+    connect(m_aggregateAiSession, &IAiStreamingSession::stageReported, this,
+            [this](const QString& stage, const QString& detail) {
+                AiRequestEventDao().appendStage(m_aggregateAiRequestEventId, m_currentConvId, stage, detail);
+            });
+    connect(m_aggregateAiSession, &IAiStreamingSession::usageReported, this,
+            [this](const AiTokenUsage& usage) {
+                AiRequestEventDao().recordTokenUsage(m_aggregateAiRequestEventId, usage.promptTokens,
+                                                     usage.cachedPromptTokens, usage.completionTokens);
+            });
+    connect(m_aggregateAiSession, &IAiStreamingSession::hedgeResolved, this,
+            [this, primaryKey = built.config.sessionModelKey, backup = built.hedge.backupConfig](
+                bool backupWon, int winnerStartedAfterMs, int loserElapsedMs) {
+                m_aggregateAiWinnerStartMs = winnerStartedAfterMs;
+                AiRequestEventDao eventDao;
+                if (backupWon)
+                    eventDao.recordServingModel(m_aggregateAiRequestEventId, backup.sessionModelKey, backup.model);
+                eventDao.recordHedgeLoser(m_aggregateAiRequestEventId,
+                                          backupWon ? primaryKey : backup.sessionModelKey,
+                                          loserElapsedMs);
+            });
     connect(m_aggregateAiSession, &IAiStreamingSession::delta, this, &AggregateChatForm::onAggregateAiStreamDelta);
     connect(m_aggregateAiSession, &IAiStreamingSession::completed, this, &AggregateChatForm::onAggregateAiCompleted);
     connect(m_aggregateAiSession, &IAiStreamingSession::failed, this, &AggregateChatForm::onAggregateAiFailed);
     m_aggregateAiRequestTimer.restart();
     m_aggregateAiFirstTokenMs = 0;
+    m_aggregateAiWinnerStartMs = 0;
     m_aggregateAiRequestEventId = AiRequestEventDao().beginEvent(
         QStringLiteral("aggregate_manual"),
         m_currentConvId,
@@ -6142,7 +6463,9 @@ void AggregateChatForm::onGenerateAiDraftClicked()
         eventDao.appendStage(m_aggregateAiRequestEventId, m_currentConvId,
                              QStringLiteral("manual_started"));
         eventDao.appendStage(m_aggregateAiRequestEventId, m_currentConvId,
-                             QStringLiteral("context_ready"));
+                             QStringLiteral("context_ready"),
+                             aggregateContextStageDetail(built.context));
+        eventDao.recordEstimatedPromptTokens(m_aggregateAiRequestEventId, built.context.estimatedPromptTokens);
         eventDao.appendStage(m_aggregateAiRequestEventId, m_currentConvId,
                              QStringLiteral("request_sent"),
                              aggregateModelMenuLabel(m_aggregateAiSessionModelKey));
@@ -6225,6 +6548,7 @@ void AggregateChatForm::tryAggregateAutoReply(int conversationId, const QString&
     m_autoReplyBusy = true;
     m_autoReplyRequestTimer.restart();
     m_autoReplyFirstTokenMs = 0;
+    m_autoReplyWinnerStartMs = 0;
     m_autoReplyRequestEventId = AiRequestEventDao().beginEvent(
         QStringLiteral("aggregate_auto"),
         conversationId,
@@ -6236,7 +6560,9 @@ void AggregateChatForm::tryAggregateAutoReply(int conversationId, const QString&
         eventDao.appendStage(m_autoReplyRequestEventId, conversationId,
                              QStringLiteral("auto_started"));
         eventDao.appendStage(m_autoReplyRequestEventId, conversationId,
-                             QStringLiteral("context_ready"));
+                             QStringLiteral("context_ready"),
+                             aggregateContextStageDetail(built.context));
+        eventDao.recordEstimatedPromptTokens(m_autoReplyRequestEventId, built.context.estimatedPromptTokens);
         eventDao.appendStage(m_autoReplyRequestEventId, conversationId,
                              QStringLiteral("request_sent"),
                              aggregateModelMenuLabel(m_aggregateAiSessionModelKey));
@@ -6244,7 +6570,27 @@ void AggregateChatForm::tryAggregateAutoReply(int conversationId, const QString&
     updateAggregateAiControlsVisibility();
     built.request.extraRootFields.insert(QStringLiteral("max_tokens"), 512);
     clearStreamingSession(m_autoReplySession);
-    m_autoReplySession = m_aiChatService->createSession(built.config, built.request, this);
+    m_autoReplySession = m_aiChatService->createSession(built, this);
+    connect(m_autoReplySession, &IAiStreamingSession::stageReported, this,
+            [this](const QString& stage, const QString& detail) {
+                AiRequestEventDao().appendStage(m_autoReplyRequestEventId, m_autoReplyTargetConvId, stage, detail);
+            });
+    connect(m_autoReplySession, &IAiStreamingSession::usageReported, this,
+            [this](const AiTokenUsage& usage) {
+                AiRequestEventDao().recordTokenUsage(m_autoReplyRequestEventId, usage.promptTokens,
+                                                     usage.cachedPromptTokens, usage.completionTokens);
+            });
+    connect(m_autoReplySession, &IAiStreamingSession::hedgeResolved, this,
+            [this, primaryKey = built.config.sessionModelKey, backup = built.hedge.backupConfig](
+                bool backupWon, int winnerStartedAfterMs, int loserElapsedMs) {
+                m_autoReplyWinnerStartMs = winnerStartedAfterMs;
+                AiRequestEventDao eventDao;
+                if (backupWon)
+                    eventDao.recordServingModel(m_autoReplyRequestEventId, backup.sessionModelKey, backup.model);
+                eventDao.recordHedgeLoser(m_autoReplyRequestEventId,
+                                          backupWon ? primaryKey : backup.sessionModelKey,
+                                          loserElapsedMs);
+            });
     connect(m_autoReplySession, &IAiStreamingSession::delta, this, &AggregateChatForm::onAutoReplyStreamDelta);
     connect(m_autoReplySession, &IAiStreamingSession::completed, this, &AggregateChatForm::onAutoReplyCompleted);
     connect(m_autoReplySession, &IAiStreamingSession::failed, this, &AggregateChatForm::onAutoReplyFailed);
@@ -6258,7 +6604,7 @@ void AggregateChatForm::onAutoReplyStreamDelta(const QString& delta)
     if (!m_autoReplyBusy)
         return;
     if (m_autoReplyFirstTokenMs <= 0) {
-        m_autoReplyFirstTokenMs = int(m_autoReplyRequestTimer.elapsed());
+        m_autoReplyFirstTokenMs = qMax(1, int(m_autoReplyRequestTimer.elapsed()) - m_autoReplyWinnerStartMs);
         AiRequestEventDao().appendStage(
             m_autoReplyRequestEventId,
             m_autoReplyTargetConvId,
@@ -6355,7 +6701,7 @@ void AggregateChatForm::onAggregateAiStreamDelta(const QString& delta)
     if (!m_aggregateAiGenerating)
         return;
     if (m_aggregateAiFirstTokenMs <= 0) {
-        m_aggregateAiFirstTokenMs = int(m_aggregateAiRequestTimer.elapsed());
+        m_aggregateAiFirstTokenMs = qMax(1, int(m_aggregateAiRequestTimer.elapsed()) - m_aggregateAiWinnerStartMs);
         AiRequestEventDao().appendStage(
             m_aggregateAiRequestEventId,
             m_currentConvId,
@@ -6441,10 +6787,10 @@ void AggregateChatForm::onCustomerProfileStreamDelta(const QString& delta)
     if (!m_customerProfileBusy)
         return;
     if (m_customerProfileFirstTokenMs <= 0) {
-        m_customerProfileFirstTokenMs = int(m_customerProfileRequestTimer.elapsed());
+        m_customerProfileFirstTokenMs = qMax(1, int(m_customerProfileRequestTimer.elapsed()) - m_customerProfileWinnerStartMs);
         AiRequestEventDao().appendStage(
             m_customerProfileRequestEventId,
-            m_currentConvId,
+            m_customerProfileTargetConvId,
             QStringLiteral("first_token"),
             aggregateMetricDurationLabel(m_customerProfileFirstTokenMs));
     }
@@ -6461,7 +6807,7 @@ void AggregateChatForm::onCustomerProfileCompleted()
     const QString raw = m_customerProfileAccumulated.trimmed();
     if (raw.isEmpty()) {
         if (m_customerProfileRequestEventId > 0) {
-            AiRequestEventDao().appendStage(m_customerProfileRequestEventId, m_currentConvId,
+            AiRequestEventDao().appendStage(m_customerProfileRequestEventId, m_customerProfileTargetConvId,
                                              QStringLiteral("failed"),
                                              QStringLiteral("模型未返回客户信息"));
             AiRequestEventDao().failEvent(m_customerProfileRequestEventId,
@@ -6471,6 +6817,7 @@ void AggregateChatForm::onCustomerProfileCompleted()
             m_customerProfileFirstTokenMs = 0;
         }
         m_customerProfileAccumulated.clear();
+        noteCustomerProfileRefreshOutcome(m_customerProfileTargetConvId, false);
         setCustomerProfileBusy(false);
         refreshRightBarMetrics();
         showStatusMessage(QStringLiteral("客户信息整理失败：模型未返回内容"), 5000);
@@ -6478,24 +6825,25 @@ void AggregateChatForm::onCustomerProfileCompleted()
     }
 
     const QJsonObject profile = parseCustomerProfileJson(raw);
-    const bool saved = CustomerProfileDao().upsert(m_currentConvId,
+    const bool saved = CustomerProfileDao().upsert(m_customerProfileTargetConvId,
                                                    profile,
                                                    m_aggregateAiSessionModelKey,
-                                                   m_customerProfileRequestEventId);
+                                                   m_customerProfileRequestEventId,
+                                                   m_customerProfileCoveredMessageId);
     if (m_customerProfileRequestEventId > 0) {
         AiRequestEventDao eventDao;
         if (saved) {
-            eventDao.appendStage(m_customerProfileRequestEventId, m_currentConvId,
+            eventDao.appendStage(m_customerProfileRequestEventId, m_customerProfileTargetConvId,
                                  QStringLiteral("profile_completed"),
                                  QStringLiteral("耗时 %1").arg(aggregateMetricDurationLabel(durationMs)));
-            eventDao.appendStage(m_customerProfileRequestEventId, m_currentConvId,
+            eventDao.appendStage(m_customerProfileRequestEventId, m_customerProfileTargetConvId,
                                  QStringLiteral("profile_saved"));
             eventDao.completeEvent(m_customerProfileRequestEventId,
                                    durationMs,
                                    m_customerProfileFirstTokenMs,
                                    raw.size());
         } else {
-            eventDao.appendStage(m_customerProfileRequestEventId, m_currentConvId,
+            eventDao.appendStage(m_customerProfileRequestEventId, m_customerProfileTargetConvId,
                                  QStringLiteral("failed"),
                                  QStringLiteral("客户信息保存失败"));
             eventDao.failEvent(m_customerProfileRequestEventId,
@@ -6507,12 +6855,15 @@ void AggregateChatForm::onCustomerProfileCompleted()
     }
 
     m_customerProfileAccumulated.clear();
+    noteCustomerProfileRefreshOutcome(m_customerProfileTargetConvId, saved);
     setCustomerProfileBusy(false);
     refreshRightBarMetrics();
     refreshCustomerProfilePanel();
-    showStatusMessage(saved ? QStringLiteral("客户信息已更新")
-                            : QStringLiteral("客户信息保存失败"),
-                      saved ? 4000 : 6000);
+    if (!m_customerProfileBackground || !saved) {
+        showStatusMessage(saved ? QStringLiteral("客户信息已更新")
+                                : QStringLiteral("客户信息保存失败"),
+                          saved ? 4000 : 6000);
+    }
 }
 
 void AggregateChatForm::onCustomerProfileFailed(const QString& reason)
@@ -6522,7 +6873,7 @@ void AggregateChatForm::onCustomerProfileFailed(const QString& reason)
     clearStreamingSession(m_customerProfileSession);
     m_customerProfileAccumulated.clear();
     if (m_customerProfileRequestEventId > 0) {
-        AiRequestEventDao().appendStage(m_customerProfileRequestEventId, m_currentConvId,
+        AiRequestEventDao().appendStage(m_customerProfileRequestEventId, m_customerProfileTargetConvId,
                                          QStringLiteral("failed"),
                                          reason.left(120));
         AiRequestEventDao().failEvent(m_customerProfileRequestEventId,
@@ -6531,6 +6882,7 @@ void AggregateChatForm::onCustomerProfileFailed(const QString& reason)
         m_customerProfileRequestEventId = 0;
         m_customerProfileFirstTokenMs = 0;
     }
+    noteCustomerProfileRefreshOutcome(m_customerProfileTargetConvId, false);
     setCustomerProfileBusy(false);
     refreshRightBarMetrics();
     showStatusMessage(QStringLiteral("客户信息整理失败：%1").arg(reason.left(120)), 6000);
@@ -9,6 +9,7 @@
 #include <QListWidget>
 #include <QListWidgetItem>
 #include <QWidget>
+#include <QHash>
 #include <QMap>
 #include <QSet>
 #include <QPlainTextEdit>
@@ -34,7 +35,10 @@ class ConversationAppService;
 class AiChatAppService;
 class IAiStreamingSession;
 class ConversationListModel;
+class ConversationSearch;
 class MessageListModel;
+struct AiRequestStageEventRecord;
+struct MessageSendEventRecord;
 class QJsonObject;
 class QStyledItemDelegate;
 class QToolButton;
@@ -88,6 +92,8 @@ private:
     void applyCacheSnapshotToLocalCache(const QJsonObject& snapshot);
     QVector<MessageRecord> messagesForDisplay(int conversationId) const;
     void renderConversationListFromModel();
+    /** 搜索结果回来后只重新过滤已加载的会话，不重新读库。 */
+    void applyConversationSearchResults();
     void showConversation(int conversationId);
     void renderConversationMessages(const QVector<MessageRecord>& messages);
     void renderConversationMessagesFromModel();
@@ -111,6 +117,16 @@ private:
     void restoreLastSelectedConversation();
     void updateCustomerInfo(const ConversationInfo& conv);
     void resetSendTimelineForConversation();
+    /** 事件表写入推送：当前会话且面板展开时直接追加一行，id 不连续时回表补齐。 */
+    void onSendEventAppended(const MessageSendEventRecord& event);
+    void onAiStageEventAppended(const AiRequestStageEventRecord& event);
+    /** 发送转交给 Python 服务时没有本地推送，按客户端消息 id 记在途，收到结果或时间线终态行时移除。 */
+    void onSendDelegated(int conversationId, const QString& clientMessageId);
+    void onDelegatedSendFinished(int conversationId, const QString& clientMessageId);
+    void retireDelegatedSend(int conversationId);
+    /** 有 AI 请求或消息发送在途时才需要兜底轮询（其他进程写入的事件不会推送过来）。 */
+    bool sendTimelineInFlight() const;
+    void updateSendTimelinePolling();
     void showCenterEmptyState();
     void showRightEmptyState();
     void showStatusMessage(const QString& text, int timeoutMs);
@@ -133,6 +149,7 @@ private:
     bool currentConversationIsWechat() const;
     void abortAggregateAiRequest();
     void abortAutoReplyRequest();
+    void abortCustomerProfileRequest();
     void clearStreamingSession(IAiStreamingSession*& session);
     /** 自动回复开启后，在满足条件时尝试生成并发送（T1 切换会话 / T2 当前会话新入站）。 */
     void tryAggregateAutoReply(int conversationId, const QString& triggerTag);
@@ -144,7 +161,13 @@ private:
     void refreshRightBarMetrics();
     void refreshCustomerProfilePanel();
     void setCustomerProfileBusy(bool busy);
+    /** 仅手动整理占用当前会话的 AI 控件；后台刷新可能属于其他会话，不计入。 */
+    bool customerProfileForegroundBusy() const;
     QJsonObject parseCustomerProfileJson(const QString& text) const;
+    void startCustomerProfileRefresh(int conversationId, bool background);
+    /** 已有客户信息的会话累计 N 条新入站后，在后台增量合并一次。 */
+    void maybeRefreshCustomerProfileInBackground(int conversationId);
+    void noteCustomerProfileRefreshOutcome(int conversationId, bool succeeded);
     void setConversationTab(AggregateConversationTab tab);
     /** 折叠/展开「处理动态」时切换竖直 stretch，使折叠时主内容区顶对齐、不分散大块空白。 */
     void updateRightBarSendSectionStretch();
@@ -261,6 +284,7 @@ private:
     QPushButton* m_btnAiGenerate = nullptr;
     QPushButton* m_btnSend = nullptr;
     ConversationListModel* m_conversationListModel = nullptr;
+    ConversationSearch* m_conversationSearch = nullptr;
     MessageListModel* m_messageListModel = nullptr;
     QStyledItemDelegate* m_messageItemDelegate = nullptr;
     ConversationAppService* m_conversationService = nullptr;
@@ -279,15 +303,28 @@ private:
     qint64 m_aggregateAiRequestEventId = 0;
     QElapsedTimer m_aggregateAiRequestTimer;
     int m_aggregateAiFirstTokenMs = 0;
+    /** 对冲由备用一路胜出时其相对请求开始的启动时刻，首字耗时按胜者自身扣除。 */
+    int m_aggregateAiWinnerStartMs = 0;
     qint64 m_autoReplyRequestEventId = 0;
     QElapsedTimer m_autoReplyRequestTimer;
     int m_autoReplyFirstTokenMs = 0;
+    int m_autoReplyWinnerStartMs = 0;
     bool m_customerProfileBusy = false;
     bool m_shuttingDown = false;
     qint64 m_customerProfileRequestEventId = 0;
+    int m_customerProfileTargetConvId = 0;
+    qint64 m_customerProfileCoveredMessageId = 0;
+    bool m_customerProfileBackground = false;
     QElapsedTimer m_customerProfileRequestTimer;
     int m_customerProfileFirstTokenMs = 0;
+    int m_customerProfileWinnerStartMs = 0;
     QString m_customerProfileAccumulated;
+    /** 按会话记整理连续失败次数与下次允许后台重试的时间，失败后不会每来一条入站就重新触发。 */
+    struct CustomerProfileRefreshBackoff {
+        int failures = 0;
+        qint64 retryAfterMs = 0;
+    };
+    QHash<int, CustomerProfileRefreshBackoff> m_customerProfileRefreshBackoff;
     QWidget* m_chatHeaderBar = nullptr;
     QToolButton* m_btnBackToConversationList = nullptr;
     QLabel* m_chatHeader = nullptr;
@@ -334,6 +371,8 @@ private:
     QTimer* m_chatInputRelayoutTimer = nullptr;
     qint64 m_sendTimelineBaselineId = 0;
     qint64 m_aiStageTimelineBaselineId = 0;
+    QSet<int> m_sendTimelineInFlightMessageIds;
+    QHash<QString, int> m_sendTimelineDelegatedSends;
     bool m_rightBarHidden = false;
     bool m_rightBarAutoHidden = false;
     int m_lastRightBarWidth = 296;
@@ -1,8 +1,10 @@
 #include "aicustomerservicebackendwindow.h"
 #include "aiproviderconfigpage.h"
+#include "performancemetricspage.h"
 #include "sidebartocdelegate.h"
 
 #include "../utils/applystyle.h"
+#include "../utils/themeengine.h"
 
 #include <QColor>
 #include <QFontMetrics>
@@ -46,6 +48,7 @@ constexpr int kStackProductKnowledge = 2;
 constexpr int kStackFaqKnowledge = 3;
 constexpr int kStackApiModel = 4;
 constexpr int kStackGeneralSettings = 5;
+constexpr int kStackPerformance = 6;
 
 QTreeWidgetItem* findNavItemByStackIndex(QTreeWidgetItem* node, int stackIdx)
 {
@@ -1025,6 +1028,7 @@ AiCustomerServiceBackendWindow::AiCustomerServiceBackendWindow(QWidget* parent)
     m_apiConfigPage = new AiProviderConfigPage(central);
     m_stack->addWidget(m_apiConfigPage);
     m_stack->addWidget(makePlaceholderPage(QStringLiteral("通用设置")));
+    m_stack->addWidget(new PerformanceMetricsPage(central));
 
     QWidget* nav = buildNavSidebar();
     root->addWidget(nav, 0);
@@ -1099,6 +1103,7 @@ QWidget* AiCustomerServiceBackendWindow::buildNavSidebar()
 
     addTopLeaf(QStringLiteral("API 配置/模型"), kStackApiModel);
     addTopLeaf(QStringLiteral("通用设置"), kStackGeneralSettings);
+    addTopLeaf(QStringLiteral("性能监控"), kStackPerformance);
 
     agentGroup->setExpanded(true);
     kbGroup->setExpanded(true);
@@ -1182,10 +1187,8 @@ QWidget* AiCustomerServiceBackendWindow::buildDashboardPage()
     return page;
 }
 
-void AiCustomerServiceBackendWindow::applyLocalStyle()
+static QString aiBackendWindowQss(ApplyStyle::MainWindowTheme navTheme)
 {
-    setObjectName(QStringLiteral("aiBackendWindowRoot"));
-    const ApplyStyle::MainWindowTheme navTheme = ApplyStyle::loadSavedMainWindowTheme();
     QString navStrip;
     switch (navTheme) {
     case ApplyStyle::MainWindowTheme::Cool:
@@ -1205,7 +1208,7 @@ void AiCustomerServiceBackendWindow::applyLocalStyle()
     const QString treeQss =
         ApplyStyle::sidebarTocTreeStyleSheet(QStringLiteral("aiBackendNavTree"), navTheme);
 
-    setStyleSheet(QStringLiteral(
+    return QStringLiteral(
                       R"QSS(
 QMainWindow#aiBackendWindowRoot { background: %1; }
 QWidget#aiBackendCentral { background: %1; }
@@ -1457,7 +1460,17 @@ QWidget#aiProviderConfigPage QLabel#robotAssistantPrivacy { color: #64748b; font
 QWidget#aiProviderConfigPage QLabel#aiProviderConfigStatus { color: #334155; font-size: 13px; background: transparent; }
 )QSS")
             .arg(QLatin1String(kAiBackendContentBg))
-        + ApplyStyle::globalScrollBarStyle());
+        + ApplyStyle::globalScrollBarStyle();
+}
+
+void AiCustomerServiceBackendWindow::applyLocalStyle()
+{
+    setObjectName(QStringLiteral("aiBackendWindowRoot"));
+    const ApplyStyle::MainWindowTheme navTheme = ApplyStyle::loadSavedMainWindowTheme();
+    // 样式表按主题缓存，重复打开后台窗口不再拼接整段 QSS
+    ThemeEngine::instance().apply(this,
+                                  QStringLiteral("aiBackendWindow:%1").arg(static_cast<int>(navTheme)),
+                                  [navTheme]() { return aiBackendWindowQss(navTheme); });
 }
 
 void AiCustomerServiceBackendWindow::focusApiModelPage()
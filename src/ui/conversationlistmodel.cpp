@@ -29,6 +29,8 @@ QVariant ConversationListModel::data(const QModelIndex& index, int role) const
         return row.lastDirection;
     case SelectedRole:
         return row.conversation.id == m_selectedConversationId;
+    case SearchMatchRole:
+        return m_keyword.isEmpty() ? QVariant() : QVariant::fromValue(row.match);
     default:
         return {};
     }
@@ -54,6 +56,13 @@ void ConversationListModel::setFilters(int tab,
     rebuildRows();
 }
 
+void ConversationListModel::setSearchMatches(const QString& keyword,
+                                             const QHash<int, ConversationSearchMatch>& matches)
+{
+    m_searchKeyword = keyword.trimmed();
+    m_searchMatches = matches;
+}
+
 void ConversationListModel::setSelectedConversationId(int conversationId)
 {
     if (m_selectedConversationId == conversationId)
@@ -112,14 +121,16 @@ void ConversationListModel::rebuildRows()
     m_rows.reserve(m_allConversations.size());
     for (const ConversationInfo& conversation : m_allConversations) {
         const QString lastDirection = m_lastDirections.value(conversation.id);
-        if (accepts(conversation, lastDirection))
-            m_rows.push_back(Row{conversation, lastDirection});
+        ConversationSearchMatch match;
+        if (accepts(conversation, lastDirection, &match))
+            m_rows.push_back(Row{conversation, lastDirection, match});
     }
     endResetModel();
 }
 
 bool ConversationListModel::accepts(const ConversationInfo& conversation,
-                                    const QString& lastDirection) const
+                                    const QString& lastDirection,
+                                    ConversationSearchMatch* match) const
 {
     bool inThisTab = false;
     if (m_tab == 0) {
@@ -138,11 +149,19 @@ bool ConversationListModel::accepts(const ConversationInfo& conversation,
     if (!platform.isEmpty() && conversation.platform != platform)
         return false;
 
-    if (!m_keyword.isEmpty()
-        && !conversation.customerName.contains(m_keyword, Qt::CaseInsensitive)
-        && !conversation.lastMessage.contains(m_keyword, Qt::CaseInsensitive))
+    if (m_keyword.isEmpty())
+        return true;
+    if (m_searchKeyword == m_keyword) {
+        const auto it = m_searchMatches.constFind(conversation.id);
+        if (it == m_searchMatches.constEnd())
+            return false;
+        *match = it.value();
+        return true;
+    }
+    const std::optional<ConversationSearchMatch> found = ConversationSearch::match(conversation, m_keyword);
+    if (!found)
         return false;
-
+    *match = *found;
     return true;
 }
 
@@ -6,6 +6,7 @@
 #include <QVector>
 #include <optional>
 #include "../core/types.h"
+#include "conversationsearch.h"
 
 class ConversationListModel : public QAbstractListModel
 {
@@ -16,6 +17,7 @@ public:
         ConversationRole,
         LastDirectionRole,
         SelectedRole,
+        SearchMatchRole,
     };
 
     explicit ConversationListModel(QObject* parent = nullptr);
@@ -29,6 +31,11 @@ public:
                     int platform,
                     const QString& keyword,
                     int pendingStickyConversationId);
+    /**
+     * ConversationSearch 在后台算好的结果；keyword 与 setFilters 的关键词一致时直接按它过滤，
+     * 否则逐条同步匹配。只存不重建，调用方随后调 setFilters。
+     */
+    void setSearchMatches(const QString& keyword, const QHash<int, ConversationSearchMatch>& matches);
     void setSelectedConversationId(int conversationId);
 
     int selectedConversationId() const;
@@ -42,10 +49,13 @@ private:
     struct Row {
         ConversationInfo conversation;
         QString lastDirection;
+        ConversationSearchMatch match;
     };
 
     void rebuildRows();
-    bool accepts(const ConversationInfo& conversation, const QString& lastDirection) const;
+    bool accepts(const ConversationInfo& conversation,
+                 const QString& lastDirection,
+                 ConversationSearchMatch* match) const;
     QString platformFilterValue() const;
 
     QVector<ConversationInfo> m_allConversations;
@@ -55,6 +65,8 @@ private:
     int m_tab = 1;
     int m_platform = 0;
     QString m_keyword;
+    QString m_searchKeyword;
+    QHash<int, ConversationSearchMatch> m_searchMatches;
     int m_pendingStickyConversationId = -1;
 };
 
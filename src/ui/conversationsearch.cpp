@@ -0,0 +1,322 @@
+#include "conversationsearch.h"
+
+#include "../utils/metrics.h"
+#include "../utils/pinyin.h"
+
+namespace {
+
+// 任务检查是否已被新输入取代的间隔（条）
+constexpr int kCancelCheckInterval = 512;
+
+Metrics::Histogram* searchLatency(bool narrowed)
+{
+    static Metrics::Histogram* const full = Metrics::histogram(
+        QStringLiteral("conversation_search_us"), {{QStringLiteral("mode"), QStringLiteral("full")}},
+        QStringLiteral("会话搜索一次匹配的耗时；narrow 为 GUI 线程在上次结果上收窄，full 为后台全量匹配（含建索引）"));
+    static Metrics::Histogram* const narrow = Metrics::histogram(
+        QStringLiteral("conversation_search_us"), {{QStringLiteral("mode"), QStringLiteral("narrow")}},
+        QStringLiteral("会话搜索一次匹配的耗时；narrow 为 GUI 线程在上次结果上收窄，full 为后台全量匹配（含建索引）"));
+    return narrowed ? narrow : full;
+}
+
+/** owners[from, from+length) 指向的名字下标合并为连续区间。 */
+QVector<QPair<int, int>> ownerRanges(const QVector<int>& owners, int from, int length)
+{
+    QVector<QPair<int, int>> ranges;
+    int last = -2;
+    for (int i = from; i < from + length; ++i) {
+        const int owner = owners.at(i);
+        if (owner == last)
+            continue;
+        if (!ranges.isEmpty() && owner == last + 1)
+            ++ranges.last().second;
+        else
+            ranges.append({owner, 1});
+        last = owner;
+    }
+    return ranges;
+}
+
+} // namespace
+
+ConversationSearch::ConversationSearch(QObject* parent)
+    : QObject(parent)
+{
+    // 单线程：任务天然串行，新任务入队前 clear() 丢掉还没开始的旧任务
+    m_pool.setMaxThreadCount(1);
+    m_debounce.setSingleShot(true);
+    m_debounce.setInterval(kDebounceMs);
+    connect(&m_debounce, &QTimer::timeout, this, &ConversationSearch::startJob);
+}
+
+ConversationSearch::~ConversationSearch()
+{
+    ++m_generation;
+    m_pool.clear();
+    m_pool.waitForDone();
+}
+
+void ConversationSearch::setConversations(const QVector<ConversationInfo>& conversations)
+{
+    m_conversations = conversations;
+    ++m_revision;
+    ++m_generation;
+    m_debounce.stop();
+    // 关键词为空时也在后台把索引建好，第一次输入不必再等
+    startJob();
+}
+
+void ConversationSearch::setQuery(const QString& query)
+{
+    const QString text = query.trimmed();
+    if (text == m_query)
+        return;
+    m_query = text;
+    ++m_generation;
+    m_debounce.stop();
+
+    if (text.isEmpty()) {
+        m_pool.clear();
+        m_result = Result();
+        emit resultsReady();
+        return;
+    }
+
+    // 追加输入：结果只会是上次结果的子集，数量不多时当场收窄
+    if (!m_result.query.isEmpty()
+        && m_result.snapshot
+        && m_result.snapshot->revision == m_revision
+        && m_result.rows.size() <= kSyncNarrowLimit
+        && text.startsWith(m_result.query, Qt::CaseInsensitive)) {
+        m_pool.clear();
+        Result narrowed;
+        {
+            Metrics::ScopedTimer timer(searchLatency(true));
+            const QVector<int> rows = m_result.rows;
+            evaluate(m_result.snapshot, text, &rows, []() { return false; }, &narrowed);
+        }
+        m_result = narrowed;
+        emit resultsReady();
+        return;
+    }
+
+    m_debounce.start();
+}
+
+std::optional<ConversationSearchMatch> ConversationSearch::match(const ConversationInfo& conversation,
+                                                                 const QString& query)
+{
+    const Query parsed = parseQuery(query.trimmed());
+    if (parsed.text.isEmpty())
+        return ConversationSearchMatch();
+    // 非字母关键词只做子串匹配，不必算拼音
+    Entry entry;
+    if (parsed.letters.isEmpty()) {
+        entry.conversationId = conversation.id;
+        entry.name = conversation.customerName;
+        entry.message = conversation.lastMessage;
+    } else {
+        entry = buildEntry(conversation);
+    }
+    ConversationSearchMatch result;
+    if (!matchEntry(entry, parsed, &result))
+        return std::nullopt;
+    return result;
+}
+
+ConversationSearch::Entry ConversationSearch::buildEntry(const ConversationInfo& conversation)
+{
+    Entry entry;
+    entry.conversationId = conversation.id;
+    entry.name = conversation.customerName;
+    entry.message = conversation.lastMessage;
+    Spelling primary = buildSpelling(entry.name, false);
+    if (!primary.full.isEmpty())
+        entry.spellings.push_back(std::move(primary));
+    if (!entry.name.isEmpty() && !Pinyin::surnameReading(entry.name.at(0)).isEmpty())
+        entry.spellings.push_back(buildSpelling(entry.name, true));
+    return entry;
+}
+
+ConversationSearch::Spelling ConversationSearch::buildSpelling(const QString& name, bool surnameReading)
+{
+    Spelling spelling;
+    spelling.full.reserve(name.size() * 4);
+    spelling.fullOwners.reserve(name.size() * 4);
+    spelling.initials.reserve(name.size());
+    spelling.initialOwners.reserve(name.size());
+    for (int i = 0; i < name.size(); ++i) {
+        const QChar ch = name.at(i);
+        const QLatin1String syllable = surnameReading && i == 0 ? Pinyin::surnameReading(ch) : Pinyin::syllable(ch);
+        if (!syllable.isEmpty()) {
+            spelling.full.append(syllable.data(), syllable.size());
+            spelling.fullOwners.insert(spelling.fullOwners.size(), syllable.size(), i);
+            spelling.initials.append(syllable.at(0).toLatin1());
+            spelling.initialOwners.push_back(i);
+            continue;
+        }
+        // 名字里的字母数字各自当一个音节，"小王abc" 可用 "xwabc" 搜到；其余符号跳过
+        if (ch.unicode() < 0x80 && ch.isLetterOrNumber()) {
+            const char latin = ch.toLower().toLatin1();
+            spelling.full.append(latin);
+            spelling.fullOwners.push_back(i);
+            spelling.initials.append(latin);
+            spelling.initialOwners.push_back(i);
+        }
+    }
+    return spelling;
+}
+
+QSharedPointer<const ConversationSearch::Snapshot> ConversationSearch::buildSnapshot(
+    const QVector<ConversationInfo>& conversations,
+    quint64 revision,
+    const QSharedPointer<const Snapshot>& previous)
+{
+    auto snapshot = QSharedPointer<Snapshot>::create();
+    snapshot->revision = revision;
+    snapshot->entries.reserve(conversations.size());
+    snapshot->rowById.reserve(conversations.size());
+    for (const ConversationInfo& conversation : conversations) {
+        if (snapshot->rowById.contains(conversation.id))
+            continue;
+        const int previousRow = previous ? previous->rowById.value(conversation.id, -1) : -1;
+        if (previousRow >= 0 && previous->entries.at(previousRow).name == conversation.customerName) {
+            // 名字没变，拼音沿用；最后一条消息每次刷新都可能变
+            Entry entry = previous->entries.at(previousRow);
+            entry.message = conversation.lastMessage;
+            snapshot->rowById.insert(conversation.id, snapshot->entries.size());
+            snapshot->entries.push_back(std::move(entry));
+            continue;
+        }
+        snapshot->rowById.insert(conversation.id, snapshot->entries.size());
+        snapshot->entries.push_back(buildEntry(conversation));
+    }
+    return snapshot;
+}
+
+ConversationSearch::Query ConversationSearch::parseQuery(const QString& text)
+{
+    Query query;
+    query.text = text;
+    query.letters.reserve(text.size());
+    for (const QChar ch : text) {
+        if (ch == QLatin1Char(' ') || ch == QLatin1Char('\''))
+            continue;
+        if (ch.unicode() >= 0x80 || !ch.isLetterOrNumber()) {
+            query.letters.clear();
+            return query;
+        }
+        char latin = ch.toLower().toLatin1();
+        if (latin == 'v')
+            latin = 'u';
+        query.letters.append(latin);
+    }
+    return query;
+}
+
+bool ConversationSearch::matchEntry(const Entry& entry, const Query& query, ConversationSearchMatch* match)
+{
+    bool hit = false;
+    const int nameAt = entry.name.indexOf(query.text, 0, Qt::CaseInsensitive);
+    if (nameAt >= 0) {
+        match->nameRanges = {{nameAt, int(query.text.size())}};
+        hit = true;
+    } else if (!query.letters.isEmpty()) {
+        const QByteArray& letters = query.letters;
+        for (const Spelling& spelling : entry.spellings) {
+            const int initialAt = spelling.initials.indexOf(letters);
+            if (initialAt >= 0) {
+                match->nameRanges = ownerRanges(spelling.initialOwners, initialAt, letters.size());
+                hit = true;
+                break;
+            }
+            // 全拼须从某个字的音节开头匹配，避免 "an" 命中 "张(zh-an-g)"
+            for (int at = spelling.full.indexOf(letters); at >= 0; at = spelling.full.indexOf(letters, at + 1)) {
+                if (at == 0 || spelling.fullOwners.at(at) != spelling.fullOwners.at(at - 1)) {
+                    match->nameRanges = ownerRanges(spelling.fullOwners, at, letters.size());
+                    hit = true;
+                    break;
+                }
+            }
+            if (hit)
+                break;
+        }
+    }
+
+    const int messageAt = entry.message.indexOf(query.text, 0, Qt::CaseInsensitive);
+    if (messageAt >= 0) {
+        match->previewRanges = {{messageAt, int(query.text.size())}};
+        hit = true;
+    }
+    return hit;
+}
+
+template <typename Cancelled>
+bool ConversationSearch::evaluate(const QSharedPointer<const Snapshot>& snapshot,
+                                  const QString& text,
+                                  const QVector<int>* rows,
+                                  Cancelled cancelled,
+                                  Result* result)
+{
+    result->query = text;
+    result->snapshot = snapshot;
+    result->rows.clear();
+    result->matches.clear();
+    if (!snapshot || text.isEmpty())
+        return true;
+
+    const Query query = parseQuery(text);
+    const int count = rows ? rows->size() : snapshot->entries.size();
+    for (int i = 0; i < count; ++i) {
+        if (i % kCancelCheckInterval == 0 && cancelled())
+            return false;
+        const int row = rows ? rows->at(i) : i;
+        const Entry& entry = snapshot->entries.at(row);
+        ConversationSearchMatch match;
+        if (matchEntry(entry, query, &match)) {
+            result->rows.push_back(row);
+            result->matches.insert(entry.conversationId, match);
+        }
+    }
+    return true;
+}
+
+void ConversationSearch::startJob()
+{
+    const quint64 generation = m_generation.load();
+    const quint64 revision = m_revision;
+    const QString query = m_query;
+    const QVector<ConversationInfo> conversations = m_conversations;
+    const QSharedPointer<const Snapshot> base = m_snapshot;
+    m_pool.clear();
+    m_pool.start([this, generation, revision, query, conversations, base]() {
+        QSharedPointer<const Snapshot> snapshot = base;
+        Result result;
+        {
+            Metrics::ScopedTimer timer(searchLatency(false));
+            if (!snapshot || snapshot->revision != revision)
+                snapshot = buildSnapshot(conversations, revision, base);
+            evaluate(snapshot, query, nullptr, [this, generation]() {
+                return m_generation.load(std::memory_order_relaxed) != generation;
+            }, &result);
+        }
+        QMetaObject::invokeMethod(this, [this, generation, snapshot, result]() {
+            onJobFinished(generation, snapshot, result);
+        }, Qt::QueuedConnection);
+    });
+}
+
+void ConversationSearch::onJobFinished(quint64 generation,
+                                       const QSharedPointer<const Snapshot>& snapshot,
+                                       const Result& result)
+{
+    // 任务即使被取代，建好的索引也留下给下一次用
+    if (snapshot && (!m_snapshot || snapshot->revision > m_snapshot->revision))
+        m_snapshot = snapshot;
+    if (generation != m_generation.load())
+        return;
+    const bool wasEmpty = m_result.query.isEmpty();
+    m_result = result;
+    if (!(wasEmpty && result.query.isEmpty()))
+        emit resultsReady();
+}
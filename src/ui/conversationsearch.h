@@ -0,0 +1,134 @@
+#ifndef CONVERSATIONSEARCH_H
+#define CONVERSATIONSEARCH_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QMetaType>
+#include <QObject>
+#include <QPair>
+#include <QSharedPointer>
+#include <QString>
+#include <QThreadPool>
+#include <QTimer>
+#include <QVector>
+#include <atomic>
+#include <optional>
+#include "../core/types.h"
+
+/** 一条会话命中的位置，(起点, 长度) 以 QChar 计，供列表委托高亮。 */
+struct ConversationSearchMatch {
+    QVector<QPair<int, int>> nameRanges;    // customerName 中命中的字
+    QVector<QPair<int, int>> previewRanges; // lastMessage 中命中的片段
+};
+
+Q_DECLARE_METATYPE(ConversationSearchMatch)
+
+/**
+ * 会话列表的边输入边搜索。
+ *
+ * 匹配规则（任一命中即保留）：
+ * - 客户名或最后一条消息包含关键词（不区分大小写），与原先的 contains 过滤一致；
+ * - 关键词是字母时，按客户名的全拼（"zhangsan"、"zhangs"，须从某个字的音节开头匹配）
+ *   或首字母（"zs"）匹配；姓是多音字时（曾、单、仇…）姓氏读音同样可以命中。
+ *
+ * 客户名的拼音在建索引时算好，按会话 id 缓存，名字不变的会话刷新列表时不重算。
+ *
+ * 延迟：输入在上次结果上追加字符且上次结果不超过 kSyncNarrowLimit 条时，直接在 GUI 线程
+ * 对上次结果收窄，当次返回；其余情况（首个字符、删除字符、列表刷新）合并 kDebounceMs 内的
+ * 输入后交给后台线程全量匹配，新输入到来时旧任务在下一个检查点放弃。
+ *
+ * 只在 GUI 线程调用。
+ */
+class ConversationSearch : public QObject
+{
+    Q_OBJECT
+public:
+    static constexpr int kDebounceMs = 8;
+    static constexpr int kSyncNarrowLimit = 2000;
+
+    explicit ConversationSearch(QObject* parent = nullptr);
+    ~ConversationSearch() override;
+
+    /** 替换被搜索的会话；有关键词时后台重新匹配，完成后发 resultsReady。 */
+    void setConversations(const QVector<ConversationInfo>& conversations);
+    /** 关键词前后空白忽略；空关键词立即生效。 */
+    void setQuery(const QString& query);
+
+    /** 最近一次 setQuery 的关键词。 */
+    QString query() const { return m_query; }
+    /** matches() 对应的关键词；后台任务未回来前可能落后于 query()。 */
+    QString appliedQuery() const { return m_result.query; }
+    /** 命中的会话 id 与高亮区间；关键词为空时为空。 */
+    const QHash<int, ConversationSearchMatch>& matches() const { return m_result.matches; }
+    bool isPending() const { return m_result.query != m_query; }
+
+    /** 同步匹配单条会话，不走索引缓存；未命中返回 nullopt。 */
+    static std::optional<ConversationSearchMatch> match(const ConversationInfo& conversation,
+                                                        const QString& query);
+
+signals:
+    void resultsReady();
+
+private:
+    /** 客户名的一种读法：全拼与首字母，每个字母记下它来自名字里的第几个字。 */
+    struct Spelling {
+        QByteArray full;
+        QVector<int> fullOwners;
+        QByteArray initials;
+        QVector<int> initialOwners;
+    };
+
+    struct Entry {
+        int conversationId = 0;
+        QString name;
+        QString message;
+        QVector<Spelling> spellings;
+    };
+
+    struct Snapshot {
+        quint64 revision = 0;
+        QVector<Entry> entries;
+        QHash<int, int> rowById;
+    };
+
+    struct Query {
+        QString text;
+        QByteArray letters; // 去掉空格与隔音符、小写、v→u；含非字母时为空
+    };
+
+    struct Result {
+        QString query;
+        QSharedPointer<const Snapshot> snapshot;
+        QVector<int> rows; // 命中的 snapshot 行号，供继续输入时收窄
+        QHash<int, ConversationSearchMatch> matches;
+    };
+
+    static Entry buildEntry(const ConversationInfo& conversation);
+    static Spelling buildSpelling(const QString& name, bool surnameReading);
+    static QSharedPointer<const Snapshot> buildSnapshot(const QVector<ConversationInfo>& conversations,
+                                                        quint64 revision,
+                                                        const QSharedPointer<const Snapshot>& previous);
+    static Query parseQuery(const QString& text);
+    static bool matchEntry(const Entry& entry, const Query& query, ConversationSearchMatch* match);
+    /** rows 为空指针时扫描整个 snapshot；cancelled 返回 true 时放弃并返回 false。 */
+    template <typename Cancelled>
+    static bool evaluate(const QSharedPointer<const Snapshot>& snapshot,
+                         const QString& text,
+                         const QVector<int>* rows,
+                         Cancelled cancelled,
+                         Result* result);
+
+    void startJob();
+    void onJobFinished(quint64 generation, const QSharedPointer<const Snapshot>& snapshot, const Result& result);
+
+    QVector<ConversationInfo> m_conversations;
+    quint64 m_revision = 0;
+    QSharedPointer<const Snapshot> m_snapshot;
+    QString m_query;
+    Result m_result;
+    std::atomic<quint64> m_generation{0};
+    QTimer m_debounce;
+    QThreadPool m_pool;
+};
+
+#endif // CONVERSATIONSEARCH_H
@@ -11,6 +11,7 @@
 #include "../utils/appsettings.h"
 #include "../utils/applystyle.h"
 #include "../utils/swordcursor.h"
+#include "../utils/themeengine.h"
 #include "../utils/win32windowhelper.h"
 #include <QAbstractItemModel>
 #include <QAbstractItemView>
@@ -1954,7 +1955,7 @@ void MainWindow::applyMainWindowTheme(ApplyStyle::MainWindowTheme theme)
 {
     Q_UNUSED(theme)
     m_mainWindowTheme = ApplyStyle::MainWindowTheme::Default;
-    setStyleSheet(ApplyStyle::mainWindowStyle());
+    ThemeEngine::instance().apply(this, ThemeEngine::Root::MainWindow, m_mainWindowTheme);
     if (m_platformTree && m_platformTree->viewport())
         m_platformTree->viewport()->update();
     if (m_aggregateChatForm)
@@ -3,6 +3,40 @@
 #include <QSet>
 #include <QStringList>
 
+namespace {
+
+QDate messageDate(const MessageRecord& message)
+{
+    return message.createdAt.isValid() ? message.createdAt.date() : QDate::currentDate();
+}
+
+bool sameMessage(const MessageRecord& a, const MessageRecord& b)
+{
+    return a.id == b.id
+        && a.conversationId == b.conversationId
+        && a.syncStatus == b.syncStatus
+        && a.confidence == b.confidence
+        && a.direction == b.direction
+        && a.content == b.content
+        && a.sender == b.sender
+        && a.senderName == b.senderName
+        && a.createdAt == b.createdAt
+        && a.platformMsgId == b.platformMsgId
+        && a.errorReason == b.errorReason
+        && a.originalTimestamp == b.originalTimestamp
+        && a.contentImagePath == b.contentImagePath
+        && a.clientMessageId == b.clientMessageId
+        && a.status == b.status
+        && a.sourceType == b.sourceType
+        && a.verificationStatus == b.verificationStatus
+        && a.contentType == b.contentType
+        && a.observedAt == b.observedAt
+        && a.cacheScope == b.cacheScope
+        && a.cacheOrigin == b.cacheOrigin;
+}
+
+} // namespace
+
 MessageListModel::MessageListModel(QObject* parent)
     : QAbstractListModel(parent)
 {
@@ -36,13 +70,13 @@ QVariant MessageListModel::data(const QModelIndex& index, int role) const
     case IsSeparatorRole:
         return false;
     case MessageIdRole:
-        return row.message.id;
+        return rowMessage(row).id;
     case MessageRole:
-        return QVariant::fromValue(row.message);
+        return QVariant::fromValue(rowMessage(row));
     case MessageStatusRole:
-        return row.message.status;
+        return rowMessage(row).status;
     case Qt::DisplayRole:
-        return row.message.content;
+        return rowMessage(row).content;
     default:
         return {};
     }
@@ -51,10 +85,8 @@ QVariant MessageListModel::data(const QModelIndex& index, int role) const
 void MessageListModel::setConversationMessages(int conversationId,
                                                const QVector<MessageRecord>& messages)
 {
-    beginResetModel();
-    m_conversationId = conversationId;
-    m_messages.clear();
-    m_messages.reserve(messages.size());
+    QVector<MessageRecord> next;
+    next.reserve(messages.size());
     QSet<int> seenIds;
     for (const MessageRecord& message : messages) {
         if (message.id > 0) {
@@ -62,9 +94,17 @@ void MessageListModel::setConversationMessages(int conversationId,
                 continue;
             seenIds.insert(message.id);
         }
-        m_messages.push_back(message);
+        next.push_back(message);
     }
-    rebuildRows();
+
+    if (conversationId == m_conversationId && !m_messages.isEmpty() && !next.isEmpty() && applyDiff(next))
+        return;
+
+    beginResetModel();
+    m_conversationId = conversationId;
+    m_messages = std::move(next);
+    m_rows = buildRows(m_messages);
+    rebuildIndex();
     endResetModel();
 }
 
@@ -79,49 +119,37 @@ void MessageListModel::appendMessage(const MessageRecord& message)
         return;
 
     m_conversationId = message.conversationId;
-    QDate lastMsgDate;
-    for (int i = m_rows.size() - 1; i >= 0; --i) {
-        if (m_rows[i].separator)
-            continue;
-        lastMsgDate = m_rows[i].message.createdAt.isValid()
-            ? m_rows[i].message.createdAt.date()
-            : QDate::currentDate();
-        break;
-    }
-    const QDate msgDate = message.createdAt.isValid() ? message.createdAt.date() : QDate::currentDate();
-    const bool needsSeparator = !lastMsgDate.isValid() || msgDate != lastMsgDate;
+    // 行与消息同序，最后一条消息就是最后一个消息行
+    const QDate msgDate = messageDate(message);
+    const bool needsSeparator = m_messages.isEmpty() || messageDate(m_messages.constLast()) != msgDate;
     const int first = m_rows.size();
     const int last = first + (needsSeparator ? 1 : 0);
     beginInsertRows(QModelIndex(), first, last);
     m_messages.push_back(message);
     if (needsSeparator) {
-        m_rows.push_back(Row{true, msgDate, {}});
+        m_rows.push_back(Row{true, msgDate, -1});
     }
-    m_rows.push_back(Row{false, {}, message});
+    m_rows.push_back(Row{false, {}, int(m_messages.size()) - 1});
+    if (message.id > 0)
+        m_messageIndexById.insert(message.id, m_messages.size() - 1);
+    m_messageRows.push_back(last);
     endInsertRows();
 }
 
 bool MessageListModel::containsMessageId(int messageId) const
 {
-    return messageId > 0 && findMessageIndex(messageId) >= 0;
+    return messageId > 0 && m_messageIndexById.contains(messageId);
 }
 
 int MessageListModel::findMessageIndex(int messageId) const
 {
-    for (int i = 0; i < m_messages.size(); ++i) {
-        if (m_messages[i].id == messageId)
-            return i;
-    }
-    return -1;
+    return m_messageIndexById.value(messageId, -1);
 }
 
 int MessageListModel::findRowByMessageId(int messageId) const
 {
-    for (int i = 0; i < m_rows.size(); ++i) {
-        if (!m_rows[i].separator && m_rows[i].message.id == messageId)
-            return i;
-    }
-    return -1;
+    const int msgIdx = findMessageIndex(messageId);
+    return msgIdx >= 0 ? m_messageRows.at(msgIdx) : -1;
 }
 
 bool MessageListModel::updateMessageStatus(int messageId, Models::MessageStatus newStatus, const QString& errorReason)
@@ -135,12 +163,8 @@ bool MessageListModel::updateMessageStatus(int messageId, Models::MessageStatus
     if (!errorReason.isEmpty())
         m_messages[msgIdx].errorReason = errorReason;
 
-    int rowIdx = findRowByMessageId(messageId);
-    if (rowIdx >= 0) {
-        m_rows[rowIdx].message = m_messages[msgIdx];
-        QModelIndex idx = index(rowIdx);
-        emit dataChanged(idx, idx, {MessageRole, MessageStatusRole});
-    }
+    QModelIndex idx = index(m_messageRows.at(msgIdx));
+    emit dataChanged(idx, idx, {MessageRole, MessageStatusRole});
 
     emit messageStatusChanged(messageId, newStatus);
     return true;
@@ -153,13 +177,14 @@ bool MessageListModel::updateMessageById(int messageId, const MessageRecord& upd
         return false;
 
     m_messages[msgIdx] = updatedMessage;
-
-    int rowIdx = findRowByMessageId(messageId);
-    if (rowIdx >= 0) {
-        m_rows[rowIdx].message = updatedMessage;
-        QModelIndex idx = index(rowIdx);
-        emit dataChanged(idx, idx, {MessageRole, MessageStatusRole});
+    if (updatedMessage.id != messageId) {
+        m_messageIndexById.remove(messageId);
+        if (updatedMessage.id > 0)
+            m_messageIndexById.insert(updatedMessage.id, msgIdx);
     }
+
+    QModelIndex idx = index(m_messageRows.at(msgIdx));
+    emit dataChanged(idx, idx, {MessageRole, MessageStatusRole});
     return true;
 }
 
@@ -190,16 +215,160 @@ QString MessageListModel::signature() const
     return parts.join(QChar('|'));
 }
 
-void MessageListModel::rebuildRows()
+QVector<MessageListModel::Row> MessageListModel::buildRows(const QVector<MessageRecord>& messages)
 {
-    m_rows.clear();
+    QVector<Row> rows;
+    rows.reserve(messages.size() + 8);
     QDate lastDate;
-    for (const MessageRecord& msg : m_messages) {
-        const QDate msgDate = msg.createdAt.isValid() ? msg.createdAt.date() : QDate::currentDate();
+    for (int i = 0; i < messages.size(); ++i) {
+        const QDate msgDate = messageDate(messages.at(i));
         if (!lastDate.isValid() || msgDate != lastDate) {
-            m_rows.push_back(Row{true, msgDate, {}});
+            rows.push_back(Row{true, msgDate, -1});
             lastDate = msgDate;
         }
-        m_rows.push_back(Row{false, {}, msg});
+        rows.push_back(Row{false, {}, i});
+    }
+    return rows;
+}
+
+QVector<qint64> MessageListModel::rowKeys(const QVector<Row>& rows, const QVector<MessageRecord>& messages)
+{
+    // 消息行取 id（> 0）；分隔行取 -(日期, 同日第几次出现)，消息乱序时同一日期可能出现多次
+    QVector<qint64> keys;
+    keys.reserve(rows.size());
+    QHash<qint64, int> separatorOccurrences;
+    for (const Row& row : rows) {
+        if (!row.separator) {
+            keys.push_back(messages.at(row.messageIndex).id);
+            continue;
+        }
+        const qint64 day = row.separatorDate.toJulianDay();
+        const int occurrence = separatorOccurrences[day]++;
+        keys.push_back(-((day << 16) | qMin(occurrence, 0xFFFF)) - 1);
+    }
+    return keys;
+}
+
+bool MessageListModel::applyDiff(const QVector<MessageRecord>& messages)
+{
+    // 没有 id 的消息（本地尚未入库）无法与旧行对齐，交给整表重置
+    for (const MessageRecord& message : messages) {
+        if (message.id <= 0)
+            return false;
+    }
+    if (m_messageIndexById.size() != m_messages.size())
+        return false;
+
+    const QVector<Row> nextRows = buildRows(messages);
+    const QVector<qint64> nextKeys = rowKeys(nextRows, messages);
+    QVector<qint64> keys = rowKeys(m_rows, m_messages);
+
+    QHash<qint64, int> nextPos;
+    nextPos.reserve(nextKeys.size());
+    for (int i = 0; i < nextKeys.size(); ++i)
+        nextPos.insert(nextKeys.at(i), i);
+    if (nextPos.size() != nextKeys.size())
+        return false;
+
+    // 保留下来的行在新旧两边必须同序，否则只能重置
+    QSet<qint64> kept;
+    int lastPos = -1;
+    for (qint64 key : keys) {
+        const int pos = nextPos.value(key, -1);
+        if (pos < 0)
+            continue;
+        if (pos < lastPos || kept.contains(key))
+            return false;
+        lastPos = pos;
+        kept.insert(key);
+    }
+    if (kept.isEmpty())
+        return false;
+
+    // 变更检测要用旧记录，先于替换 m_messages 完成
+    QVector<int> changedRows;
+    for (int i = 0; i < nextRows.size(); ++i) {
+        const Row& row = nextRows.at(i);
+        if (row.separator)
+            continue;
+        const MessageRecord& message = messages.at(row.messageIndex);
+        const int oldIdx = findMessageIndex(message.id);
+        if (oldIdx >= 0 && !sameMessage(m_messages.at(oldIdx), message))
+            changedRows.push_back(i);
+    }
+
+    // 1. 从后往前删除新列表里没有的行，连续的行合并为一次信号
+    for (int end = keys.size() - 1; end >= 0;) {
+        if (kept.contains(keys.at(end))) {
+            --end;
+            continue;
+        }
+        int begin = end;
+        while (begin > 0 && !kept.contains(keys.at(begin - 1)))
+            --begin;
+        beginRemoveRows(QModelIndex(), begin, end);
+        m_rows.remove(begin, end - begin + 1);
+        keys.remove(begin, end - begin + 1);
+        endRemoveRows();
+        end = begin - 1;
+    }
+
+    // 2. 插入新增行；插入期间新行引用追加在旧消息之后的新记录
+    const int offset = m_messages.size();
+    m_messages.append(messages);
+    int row = 0;
+    for (int i = 0; i < nextRows.size();) {
+        if (row < keys.size() && keys.at(row) == nextKeys.at(i)) {
+            ++row;
+            ++i;
+            continue;
+        }
+        int j = i;
+        while (j < nextRows.size() && !kept.contains(nextKeys.at(j)))
+            ++j;
+        beginInsertRows(QModelIndex(), row, row + (j - i) - 1);
+        for (int k = i; k < j; ++k) {
+            Row inserted = nextRows.at(k);
+            if (!inserted.separator)
+                inserted.messageIndex += offset;
+            m_rows.insert(row + (k - i), inserted);
+            keys.insert(row + (k - i), nextKeys.at(k));
+        }
+        endInsertRows();
+        row += j - i;
+        i = j;
+    }
+
+    // 3. 行结构已与新列表一致，换成新记录后只通知内容变了的行
+    m_messages = messages;
+    m_rows = nextRows;
+    rebuildIndex();
+    emitRowsChanged(changedRows);
+    return true;
+}
+
+void MessageListModel::emitRowsChanged(const QVector<int>& rows)
+{
+    for (int i = 0; i < rows.size();) {
+        int j = i + 1;
+        while (j < rows.size() && rows.at(j) == rows.at(j - 1) + 1)
+            ++j;
+        emit dataChanged(index(rows.at(i)), index(rows.at(j - 1)), {MessageRole, MessageStatusRole, Qt::DisplayRole});
+        i = j;
+    }
+}
+
+void MessageListModel::rebuildIndex()
+{
+    m_messageIndexById.clear();
+    m_messageIndexById.reserve(m_messages.size());
+    for (int i = 0; i < m_messages.size(); ++i) {
+        if (m_messages.at(i).id > 0)
+            m_messageIndexById.insert(m_messages.at(i).id, i);
+    }
+    m_messageRows.resize(m_messages.size());
+    for (int row = 0; row < m_rows.size(); ++row) {
+        if (!m_rows.at(row).separator)
+            m_messageRows[m_rows.at(row).messageIndex] = row;
     }
 }
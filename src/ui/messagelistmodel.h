@@ -4,8 +4,17 @@
 #include "../core/types.h"
 #include "../models/unifiedmodels.h"
 #include <QAbstractListModel>
+#include <QHash>
 #include <QVector>
 
+/**
+ * 聊天区消息模型：消息行之间按日期插入分隔行。
+ *
+ * - 按消息 id 建索引，状态回执、按 id 查行都是 O(1)；
+ * - appendMessage 只比较最后一条消息的日期决定是否补分隔行；
+ * - 同一会话再次 setConversationMessages 时按行做差异，只发出增删行与变更行信号，
+ *   视图的滚动位置与选中不受影响；换会话或无法对齐（id 缺失、顺序变化）时才整表重置。
+ */
 class MessageListModel : public QAbstractListModel
 {
     Q_OBJECT
@@ -41,18 +50,27 @@ signals:
     void messageStatusChanged(int messageId, Models::MessageStatus newStatus);
 
 private:
+    // 行只引用 m_messages 下标，不再复制一份 MessageRecord
     struct Row {
         bool separator = false;
         QDate separatorDate;
-        MessageRecord message;
+        int messageIndex = -1;
     };
 
-    void rebuildRows();
+    const MessageRecord& rowMessage(const Row& row) const { return m_messages.at(row.messageIndex); }
+
+    static QVector<Row> buildRows(const QVector<MessageRecord>& messages);
+    static QVector<qint64> rowKeys(const QVector<Row>& rows, const QVector<MessageRecord>& messages);
+    bool applyDiff(const QVector<MessageRecord>& messages);
+    void emitRowsChanged(const QVector<int>& rows);
+    void rebuildIndex();
     int findMessageIndex(int messageId) const;
 
     int m_conversationId = -1;
     QVector<MessageRecord> m_messages;
     QVector<Row> m_rows;
+    QHash<int, int> m_messageIndexById; // 消息 id → m_messages 下标，仅 id > 0
+    QVector<int> m_messageRows;         // m_messages 下标 → 行号
 };
 
 #endif // MESSAGELISTMODEL_H
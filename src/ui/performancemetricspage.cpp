@@ -0,0 +1,227 @@
+#include "performancemetricspage.h"
+
+#include "../utils/metrics.h"
+
+#include <QAbstractItemView>
+#include <QColor>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileDialog>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QJsonDocument>
+#include <QLabel>
+#include <QPalette>
+#include <QPushButton>
+#include <QTableWidget>
+#include <QTableWidgetItem>
+#include <QTimer>
+#include <QVBoxLayout>
+
+namespace {
+
+enum Column {
+    ColName = 0,
+    ColType,
+    ColValue,
+    ColRate,
+    ColP50,
+    ColP90,
+    ColP99,
+    ColMax,
+    ColCount
+};
+
+QString sampleKey(const Metrics::Sample& sample)
+{
+    QStringList parts;
+    for (const auto& label : sample.labels)
+        parts << QStringLiteral("%1=\"%2\"").arg(label.first, label.second);
+    return parts.isEmpty() ? sample.name : QStringLiteral("%1{%2}").arg(sample.name, parts.join(QLatin1Char(',')));
+}
+
+QString typeText(Metrics::Type type)
+{
+    switch (type) {
+    case Metrics::Type::Counter:
+        return QStringLiteral("计数器");
+    case Metrics::Type::Gauge:
+        return QStringLiteral("仪表");
+    case Metrics::Type::Histogram:
+        return QStringLiteral("直方图");
+    }
+    return QString();
+}
+
+QString numberText(double value)
+{
+    if (value == static_cast<double>(static_cast<qint64>(value)))
+        return QString::number(static_cast<qint64>(value));
+    return QString::number(value, 'f', 2);
+}
+
+QTableWidgetItem* cell(const QString& text, bool numeric = true)
+{
+    auto* item = new QTableWidgetItem(text);
+    item->setFlags(item->flags() & ~Qt::ItemIsEditable);
+    if (numeric)
+        item->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+    return item;
+}
+
+} // namespace
+
+PerformanceMetricsPage::PerformanceMetricsPage(QWidget* parent)
+    : QWidget(parent)
+    , m_refreshTimer(new QTimer(this))
+{
+    setObjectName(QStringLiteral("aiBackendPerformancePage"));
+    setAutoFillBackground(true);
+    {
+        QPalette pal = palette();
+        pal.setColor(QPalette::Window, QColor(QStringLiteral("#F4F4F5")));
+        setPalette(pal);
+    }
+
+    auto* outer = new QVBoxLayout(this);
+    outer->setContentsMargins(32, 28, 32, 32);
+    outer->setSpacing(16);
+
+    auto* titleL = new QLabel(QStringLiteral("性能监控"), this);
+    titleL->setObjectName(QStringLiteral("aiBackendDashTitle"));
+    auto* subL = new QLabel(
+        QStringLiteral("路由、数据库、IPC、AI 与发送队列的运行指标；耗时单位为微秒，分位数为启动以来累计。"), this);
+    subL->setObjectName(QStringLiteral("aiBackendDashSubtitle"));
+    subL->setWordWrap(true);
+    outer->addWidget(titleL);
+    outer->addWidget(subL);
+
+    auto* actions = new QHBoxLayout;
+    actions->setSpacing(8);
+    m_statusLabel = new QLabel(this);
+    m_statusLabel->setObjectName(QStringLiteral("aiBackendPerformanceStatus"));
+    auto* exportJsonBtn = new QPushButton(QStringLiteral("导出 JSON"), this);
+    auto* exportPromBtn = new QPushButton(QStringLiteral("导出 Prometheus"), this);
+    actions->addWidget(m_statusLabel, 1);
+    actions->addWidget(exportJsonBtn);
+    actions->addWidget(exportPromBtn);
+    outer->addLayout(actions);
+
+    m_table = new QTableWidget(0, ColCount, this);
+    m_table->setObjectName(QStringLiteral("aiBackendPerformanceTable"));
+    m_table->setHorizontalHeaderLabels({QStringLiteral("指标"),
+                                        QStringLiteral("类型"),
+                                        QStringLiteral("当前值"),
+                                        QStringLiteral("速率(/s)"),
+                                        QStringLiteral("p50"),
+                                        QStringLiteral("p90"),
+                                        QStringLiteral("p99"),
+                                        QStringLiteral("max")});
+    m_table->verticalHeader()->setVisible(false);
+    m_table->setSelectionBehavior(QAbstractItemView::SelectRows);
+    m_table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_table->horizontalHeader()->setSectionResizeMode(ColName, QHeaderView::Stretch);
+    for (int column = ColType; column < ColCount; ++column)
+        m_table->horizontalHeader()->setSectionResizeMode(column, QHeaderView::ResizeToContents);
+    outer->addWidget(m_table, 1);
+
+    m_refreshTimer->setInterval(1000);
+    connect(m_refreshTimer, &QTimer::timeout, this, &PerformanceMetricsPage::refresh);
+    connect(exportJsonBtn, &QPushButton::clicked, this, &PerformanceMetricsPage::onExportJson);
+    connect(exportPromBtn, &QPushButton::clicked, this, &PerformanceMetricsPage::onExportPrometheus);
+}
+
+void PerformanceMetricsPage::showEvent(QShowEvent* event)
+{
+    QWidget::showEvent(event);
+    refresh();
+    m_refreshTimer->start();
+}
+
+void PerformanceMetricsPage::hideEvent(QHideEvent* event)
+{
+    m_refreshTimer->stop();
+    QWidget::hideEvent(event);
+}
+
+void PerformanceMetricsPage::refresh()
+{
+    const QVector<Metrics::Sample> samples = Metrics::Registry::instance().snapshot();
+    const qint64 nowMs = QDateTime::currentMSecsSinceEpoch();
+    const double elapsedSec = m_lastRefreshMs > 0 ? (nowMs - m_lastRefreshMs) / 1000.0 : 0.0;
+
+    QHash<QString, double> totals;
+    m_table->setUpdatesEnabled(false);
+    m_table->setRowCount(samples.size());
+    for (int row = 0; row < samples.size(); ++row) {
+        const Metrics::Sample& sample = samples.at(row);
+        const QString key = sampleKey(sample);
+        m_table->setItem(row, ColName, cell(key, false));
+        m_table->setItem(row, ColType, cell(typeText(sample.type), false));
+
+        double total = 0.0;
+        bool hasRate = false;
+        if (sample.type == Metrics::Type::Histogram) {
+            const Metrics::Histogram::Summary& h = sample.histogram;
+            total = static_cast<double>(h.count);
+            hasRate = true;
+            m_table->setItem(row, ColValue, cell(QString::number(h.count)));
+            m_table->setItem(row, ColP50, cell(QString::number(h.p50)));
+            m_table->setItem(row, ColP90, cell(QString::number(h.p90)));
+            m_table->setItem(row, ColP99, cell(QString::number(h.p99)));
+            m_table->setItem(row, ColMax, cell(QString::number(h.max)));
+        } else {
+            total = sample.value;
+            hasRate = sample.type == Metrics::Type::Counter;
+            m_table->setItem(row, ColValue, cell(numberText(sample.value)));
+            for (int column = ColP50; column < ColCount; ++column)
+                m_table->setItem(row, column, cell(QString()));
+        }
+
+        QString rateText;
+        if (hasRate) {
+            totals.insert(key, total);
+            const auto previous = m_lastTotals.constFind(key);
+            if (elapsedSec > 0.0 && previous != m_lastTotals.constEnd())
+                rateText = QString::number(qMax(0.0, total - previous.value()) / elapsedSec, 'f', 1);
+        }
+        m_table->setItem(row, ColRate, cell(rateText));
+    }
+    m_table->setUpdatesEnabled(true);
+
+    m_lastTotals = totals;
+    m_lastRefreshMs = nowMs;
+    m_statusLabel->setText(QStringLiteral("共 %1 项指标，更新于 %2")
+                               .arg(samples.size())
+                               .arg(QDateTime::currentDateTime().toString(QStringLiteral("HH:mm:ss"))));
+}
+
+void PerformanceMetricsPage::onExportJson()
+{
+    exportText(QStringLiteral("导出 JSON"), QStringLiteral("json"),
+               QJsonDocument(Metrics::Registry::instance().toJson()).toJson(QJsonDocument::Indented));
+}
+
+void PerformanceMetricsPage::onExportPrometheus()
+{
+    exportText(QStringLiteral("导出 Prometheus"), QStringLiteral("prom"),
+               Metrics::Registry::instance().toPrometheus().toUtf8());
+}
+
+void PerformanceMetricsPage::exportText(const QString& title, const QString& suffix, const QByteArray& content)
+{
+    const QString defaultName = QDir::home().filePath(
+        QStringLiteral("metrics-%1.%2")
+            .arg(QDateTime::currentDateTime().toString(QStringLiteral("yyyyMMdd-HHmmss")), suffix));
+    const QString path = QFileDialog::getSaveFileName(this, title, defaultName);
+    if (path.isEmpty())
+        return;
+
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate) || file.write(content) != content.size()) {
+        m_statusLabel->setText(QStringLiteral("导出失败：%1").arg(file.errorString()));
+        return;
+    }
+    m_statusLabel->setText(QStringLiteral("已导出到 %1").arg(QDir::toNativeSeparators(path)));
+}
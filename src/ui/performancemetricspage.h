@@ -0,0 +1,40 @@
+#ifndef PERFORMANCEMETRICSPAGE_H
+#define PERFORMANCEMETRICSPAGE_H
+
+#include <QHash>
+#include <QWidget>
+
+class QLabel;
+class QTableWidget;
+class QTimer;
+
+/**
+ * 「AI 客服后台」中的「性能监控」页：展示 Metrics::Registry 中的计数器、仪表与直方图，
+ * 页面可见时每秒刷新；计数器与直方图的速率按两次刷新之间的增量计算。
+ */
+class PerformanceMetricsPage : public QWidget
+{
+    Q_OBJECT
+public:
+    explicit PerformanceMetricsPage(QWidget* parent = nullptr);
+
+protected:
+    void showEvent(QShowEvent* event) override;
+    void hideEvent(QHideEvent* event) override;
+
+private slots:
+    void refresh();
+    void onExportJson();
+    void onExportPrometheus();
+
+private:
+    void exportText(const QString& title, const QString& suffix, const QByteArray& content);
+
+    QTableWidget* m_table = nullptr;
+    QLabel* m_statusLabel = nullptr;
+    QTimer* m_refreshTimer = nullptr;
+    QHash<QString, double> m_lastTotals;
+    qint64 m_lastRefreshMs = 0;
+};
+
+#endif // PERFORMANCEMETRICSPAGE_H
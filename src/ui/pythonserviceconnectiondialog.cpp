@@ -3,9 +3,13 @@
 #include "../ipc/ipcservice.h"
 #include "../utils/applystyle.h"
 #include "../utils/appsettings.h"
+#include "../utils/tracing.h"
 
 #include <QCheckBox>
+#include <QDateTime>
+#include <QDir>
 #include <QHBoxLayout>
+#include <QJsonArray>
 #include <QLabel>
 #include <QLineEdit>
 #include <QMessageBox>
@@ -61,7 +65,11 @@ void PythonServiceConnectionDialog::setupUI()
 
     auto* bottom = new QHBoxLayout();
     bottom->setSpacing(10);
+    m_btnExportTrace = new QPushButton(QStringLiteral("导出性能追踪"), this);
+    m_btnExportTrace->setToolTip(
+        QStringLiteral("合并客户端与 Python 服务最近的耗时记录，导出为 Chrome trace 文件，可在 chrome://tracing 或 Perfetto 中打开。"));
     m_btnClose = new QPushButton(QStringLiteral("关闭"), this);
+    bottom->addWidget(m_btnExportTrace);
     bottom->addStretch(1);
     bottom->addWidget(m_btnClose);
     mainLayout->addLayout(bottom);
@@ -70,6 +78,8 @@ void PythonServiceConnectionDialog::setupUI()
             this, &PythonServiceConnectionDialog::onSaveServiceClicked);
     connect(m_btnTestService, &QPushButton::clicked,
             this, &PythonServiceConnectionDialog::onTestServiceClicked);
+    connect(m_btnExportTrace, &QPushButton::clicked,
+            this, &PythonServiceConnectionDialog::onExportTraceClicked);
     connect(m_btnClose, &QPushButton::clicked, this, &QDialog::reject);
 }
 
@@ -95,3 +105,26 @@ void PythonServiceConnectionDialog::onTestServiceClicked()
         QStringLiteral("本机 Python 服务"),
         ok ? QStringLiteral("连接成功。") : QStringLiteral("连接失败：%1").arg(error));
 }
+
+void PythonServiceConnectionDialog::onExportTraceClicked()
+{
+    Ipc::ResponseStatus status = Ipc::ResponseStatus::Success;
+    QString serviceError;
+    const QJsonObject serviceTrace = Ipc::IpcService::instance().fetchServiceTrace(QString(), 5000, &status, &serviceError);
+    const QJsonArray serviceEvents = serviceTrace.value(QStringLiteral("traceEvents")).toArray();
+
+    const QDir logsDir(QStringLiteral(PROJECT_ROOT_DIR) + QStringLiteral("/logs"));
+    logsDir.mkpath(QStringLiteral("."));
+    const QString path = logsDir.filePath(
+        QStringLiteral("trace-%1.json").arg(QDateTime::currentDateTime().toString(QStringLiteral("yyyyMMdd-HHmmss"))));
+    QString error;
+    if (!Tracing::writeChromeTrace(path, serviceEvents, &error)) {
+        QMessageBox::warning(this, QStringLiteral("导出性能追踪"), QStringLiteral("写入失败：%1").arg(error));
+        return;
+    }
+    QString message = QStringLiteral("已导出到：\n%1").arg(QDir::toNativeSeparators(path));
+    if (status != Ipc::ResponseStatus::Success || serviceEvents.isEmpty())
+        message += QStringLiteral("\n\n未获取到 Python 服务的追踪记录（%1），仅包含客户端事件。")
+                       .arg(serviceError.isEmpty() ? Ipc::toString(status) : serviceError);
+    QMessageBox::information(this, QStringLiteral("导出性能追踪"), message);
+}
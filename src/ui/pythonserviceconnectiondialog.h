@@ -20,6 +20,7 @@ public:
 private slots:
     void onSaveServiceClicked();
     void onTestServiceClicked();
+    void onExportTraceClicked();
 
 private:
     void setupUI();
@@ -29,6 +30,7 @@ private:
     QCheckBox* m_startupBackfillCheck = nullptr;
     QPushButton* m_btnSaveService = nullptr;
     QPushButton* m_btnTestService = nullptr;
+    QPushButton* m_btnExportTrace = nullptr;
     QPushButton* m_btnClose = nullptr;
 };
 
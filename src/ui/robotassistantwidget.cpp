@@ -9,6 +9,7 @@
 #include "../utils/appsettings.h"
 #include "../utils/applystyle.h"
 #include "../utils/svgresourcepixmap.h"
+#include "../utils/themeengine.h"
 #include "../utils/imagedataurl.h"
 #include <QApplication>
 #include <QImage>
@@ -86,14 +87,6 @@ QPixmap roundedRobotAvatarPixmap(const QPixmap& source, int logicalSide, qreal d
     return out;
 }
 
-QString robotAssistantQss(ApplyStyle::MainWindowTheme theme)
-{
-    QString qss = ApplyStyle::aggregateChatFormStyle(theme);
-    qss.replace(QStringLiteral("AggregateChatForm"), QStringLiteral("RobotAssistantWidget"));
-    qss += ApplyStyle::robotAssistantExtraStyle(theme);
-    return qss;
-}
-
 static QPixmap pixmapFromSvgResource(const QString& resPath, int logicalSide)
 {
     return svgResourcePixmapFittedInSquare(resPath, logicalSide);
@@ -571,7 +564,7 @@ void RobotAssistantWidget::applyTheme(ApplyStyle::MainWindowTheme theme)
 {
     Q_UNUSED(theme)
     m_theme = ApplyStyle::MainWindowTheme::Default;
-    setStyleSheet(robotAssistantQss(m_theme));
+    ThemeEngine::instance().apply(this, ThemeEngine::Root::RobotAssistant, m_theme);
     applySendButtonPolicy();
 }
 
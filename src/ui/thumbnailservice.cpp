@@ -0,0 +1,328 @@
+#include "thumbnailservice.h"
+
+#include "../utils/metrics.h"
+
+#include <QCryptographicHash>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QImageIOHandler>
+#include <QImageReader>
+#include <QImageWriter>
+#include <QPixmapCache>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+namespace {
+
+const char kOriginalSizeKey[] = "YYOriginalSize";
+
+QString pixmapCacheKey(const QString& path, const QSize& targetSize, Qt::AspectRatioMode aspectMode)
+{
+    return QStringLiteral("thumbnail:%1:%2x%3:%4")
+        .arg(aspectMode == Qt::KeepAspectRatioByExpanding ? QStringLiteral("fill") : QStringLiteral("fit"))
+        .arg(targetSize.width())
+        .arg(targetSize.height())
+        .arg(path);
+}
+
+QString diskCachePath(const QString& cacheDir, const QString& contentHash,
+                      const QSize& targetSize, Qt::AspectRatioMode aspectMode)
+{
+    return QStringLiteral("%1/%2/%3_%4x%5_%6.png")
+        .arg(cacheDir, contentHash.left(2), contentHash)
+        .arg(targetSize.width())
+        .arg(targetSize.height())
+        .arg(aspectMode == Qt::KeepAspectRatioByExpanding ? QStringLiteral("fill") : QStringLiteral("fit"));
+}
+
+QString fileContentHash(const QString& path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
+        return {};
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    if (!hash.addData(&file))
+        return {};
+    return QString::fromLatin1(hash.result().toHex());
+}
+
+/** reader.size() 是存储方向的尺寸；EXIF 旋转 90° 时宽高互换。 */
+bool rotatesQuarterTurn(const QImageReader& reader)
+{
+    return reader.transformation().testFlag(QImageIOHandler::TransformationRotate90);
+}
+
+QSize orientedSize(const QImageReader& reader)
+{
+    QSize size = reader.size();
+    if (size.isValid() && rotatesQuarterTurn(reader))
+        size.transpose();
+    return size;
+}
+
+QSize parseSize(const QString& text)
+{
+    const QStringList parts = text.split(QLatin1Char('x'));
+    if (parts.size() != 2)
+        return {};
+    return { parts.at(0).toInt(), parts.at(1).toInt() };
+}
+
+Metrics::Histogram* decodeLatency()
+{
+    static Metrics::Histogram* const histogram = Metrics::histogram(
+        QStringLiteral("thumbnail_decode_us"), {}, QStringLiteral("后台按目标尺寸解码一张缩略图的耗时"));
+    return histogram;
+}
+
+Metrics::Counter* diskCacheCounter(bool hit)
+{
+    static Metrics::Counter* const hits = Metrics::counter(
+        QStringLiteral("thumbnail_disk_cache_total"), {{QStringLiteral("result"), QStringLiteral("hit")}},
+        QStringLiteral("缩略图磁盘缓存查找次数"));
+    static Metrics::Counter* const misses = Metrics::counter(
+        QStringLiteral("thumbnail_disk_cache_total"), {{QStringLiteral("result"), QStringLiteral("miss")}},
+        QStringLiteral("缩略图磁盘缓存查找次数"));
+    return hit ? hits : misses;
+}
+
+} // namespace
+
+ThumbnailService& ThumbnailService::instance()
+{
+    static ThumbnailService service;
+    return service;
+}
+
+ThumbnailService::ThumbnailService()
+{
+    // 解码是 IO + CPU 混合负载，两条线程足够跟上滚动，也不和全局线程池抢核
+    m_pool.setMaxThreadCount(2);
+    QString root = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+    if (root.isEmpty())
+        root = QDir::tempPath();
+    m_cacheDir = root + QStringLiteral("/thumbnails");
+}
+
+ThumbnailService::~ThumbnailService()
+{
+    m_pool.clear();
+    m_pool.waitForDone();
+}
+
+void ThumbnailService::setCacheDirectory(const QString& dir)
+{
+    m_pool.clear();
+    m_pool.waitForDone();
+    m_cacheDir = dir;
+    m_entries.clear();
+    ++m_generation;
+}
+
+bool ThumbnailService::waitForIdle(int timeoutMs)
+{
+    return m_pool.waitForDone(timeoutMs);
+}
+
+ThumbnailService::Entry& ThumbnailService::entryFor(const QString& path)
+{
+    auto it = m_entries.find(path);
+    if (it != m_entries.end())
+        return it.value();
+
+    if (m_entries.size() >= kMaxEntries) {
+        // 只丢空闲条目；进行中的任务回来时还要找到自己的条目
+        for (auto drop = m_entries.begin(); drop != m_entries.end();) {
+            if (!drop->probing && drop->pendingKeys.isEmpty())
+                drop = m_entries.erase(drop);
+            else
+                ++drop;
+        }
+    }
+    return m_entries[path];
+}
+
+ThumbnailService::Probe ThumbnailService::probe(const QString& path)
+{
+    if (path.isEmpty()) {
+        Probe missing;
+        missing.status = Status::Missing;
+        return missing;
+    }
+
+    Entry& entry = entryFor(path);
+    if (entry.probe.status == Status::Loading && !entry.probing) {
+        entry.probing = true;
+        const quint64 generation = m_generation;
+        m_pool.start([this, path, generation]() {
+            const Probe result = probeFile(path);
+            QMetaObject::invokeMethod(this, [this, path, generation, result]() {
+                if (generation == m_generation)
+                    onProbed(path, result);
+            }, Qt::QueuedConnection);
+        });
+    }
+    return entry.probe;
+}
+
+QPixmap ThumbnailService::thumbnail(const QString& path, const QSize& targetSize,
+                                    Qt::AspectRatioMode aspectMode)
+{
+    if (path.isEmpty() || targetSize.isEmpty())
+        return {};
+
+    const QString key = pixmapCacheKey(path, targetSize, aspectMode);
+    QPixmap pm;
+    if (QPixmapCache::find(key, &pm))
+        return pm;
+
+    Entry& entry = entryFor(path);
+    if (entry.probe.status == Status::Missing || entry.probe.status == Status::Failed)
+        return {};
+    if (entry.pendingKeys.contains(key))
+        return {};
+
+    entry.pendingKeys.insert(key);
+    const QString knownHash = entry.contentHash;
+    const QString cacheDir = m_cacheDir;
+    const quint64 generation = m_generation;
+    m_pool.start([this, path, key, knownHash, targetSize, aspectMode, cacheDir, generation]() {
+        const DecodeResult result = decodeThumbnail(path, knownHash, targetSize, aspectMode, cacheDir);
+        QMetaObject::invokeMethod(this, [this, path, key, generation, result]() {
+            if (generation == m_generation)
+                onDecoded(path, key, result);
+        }, Qt::QueuedConnection);
+    });
+    return {};
+}
+
+void ThumbnailService::onProbed(const QString& path, const Probe& probe)
+{
+    Entry& entry = entryFor(path);
+    entry.probing = false;
+    const QSize decodedSize = entry.probe.originalSize; // 解码任务可能先一步拿到了原图尺寸
+    entry.probe = probe;
+    if (probe.originalSize.isEmpty() && !decodedSize.isEmpty()) {
+        entry.probe.status = Status::Ready;
+        entry.probe.originalSize = decodedSize;
+    }
+    emit metadataReady(path);
+}
+
+void ThumbnailService::onDecoded(const QString& path, const QString& pixmapKey, const DecodeResult& result)
+{
+    Entry& entry = entryFor(path);
+    entry.pendingKeys.remove(pixmapKey);
+    if (!result.contentHash.isEmpty())
+        entry.contentHash = result.contentHash;
+
+    bool metadataChanged = false;
+    if (result.missing) {
+        metadataChanged = entry.probe.status != Status::Missing;
+        entry.probe = Probe();
+        entry.probe.status = Status::Missing;
+    } else if (result.image.isNull()) {
+        // 记为失败，避免每次重绘都重新排队解码
+        metadataChanged = entry.probe.status != Status::Failed;
+        entry.probe.status = Status::Failed;
+    } else {
+        QPixmapCache::insert(pixmapKey, QPixmap::fromImage(result.image));
+        if (entry.probe.originalSize.isEmpty() && !result.originalSize.isEmpty()) {
+            entry.probe.status = Status::Ready;
+            entry.probe.originalSize = result.originalSize;
+            metadataChanged = true;
+        }
+    }
+
+    if (metadataChanged)
+        emit metadataReady(path);
+    emit thumbnailReady(path);
+}
+
+ThumbnailService::Probe ThumbnailService::probeFile(const QString& path)
+{
+    Probe result;
+    const QFileInfo info(path);
+    if (!info.exists() || !info.isFile()) {
+        result.status = Status::Missing;
+        return result;
+    }
+    result.fileSize = info.size();
+
+    QImageReader reader(path);
+    reader.setAutoTransform(true);
+    if (!reader.canRead()) {
+        result.status = Status::Failed;
+        return result;
+    }
+    result.originalSize = orientedSize(reader);
+    if (!result.originalSize.isValid()) {
+        // 文件头里没有尺寸的格式只能整图解码一次
+        result.originalSize = reader.read().size();
+    }
+    result.status = result.originalSize.isEmpty() ? Status::Failed : Status::Ready;
+    return result;
+}
+
+ThumbnailService::DecodeResult ThumbnailService::decodeThumbnail(const QString& path,
+                                                                 const QString& knownHash,
+                                                                 const QSize& targetSize,
+                                                                 Qt::AspectRatioMode aspectMode,
+                                                                 const QString& cacheDir)
+{
+    Metrics::ScopedTimer timer(decodeLatency());
+    DecodeResult result;
+    result.contentHash = knownHash.isEmpty() ? fileContentHash(path) : knownHash;
+    if (result.contentHash.isEmpty()) {
+        result.missing = !QFileInfo::exists(path);
+        return result;
+    }
+
+    const QString cachePath = cacheDir.isEmpty()
+        ? QString()
+        : diskCachePath(cacheDir, result.contentHash, targetSize, aspectMode);
+    if (!cachePath.isEmpty() && QFileInfo::exists(cachePath)) {
+        QImageReader cached(cachePath);
+        result.image = cached.read();
+        if (!result.image.isNull()) {
+            diskCacheCounter(true)->increment();
+            result.originalSize = parseSize(cached.text(QString::fromLatin1(kOriginalSizeKey)));
+            return result;
+        }
+    }
+    diskCacheCounter(false)->increment();
+
+    QImageReader reader(path);
+    reader.setAutoTransform(true);
+    result.originalSize = orientedSize(reader);
+    if (result.originalSize.isValid()) {
+        QSize decodeSize = result.originalSize.scaled(targetSize, aspectMode);
+        // scaledSize 作用于存储方向，旋转在解码之后
+        if (rotatesQuarterTurn(reader))
+            decodeSize.transpose();
+        reader.setScaledSize(decodeSize);
+        result.image = reader.read();
+    } else {
+        const QImage original = reader.read();
+        result.originalSize = original.size();
+        if (!original.isNull())
+            result.image = original.scaled(targetSize, aspectMode, Qt::SmoothTransformation);
+    }
+    if (result.image.isNull() || cachePath.isEmpty())
+        return result;
+
+    result.image.setText(QString::fromLatin1(kOriginalSizeKey),
+                         QStringLiteral("%1x%2").arg(result.originalSize.width()).arg(result.originalSize.height()));
+    QDir().mkpath(QFileInfo(cachePath).absolutePath());
+    QSaveFile out(cachePath);
+    if (!out.open(QIODevice::WriteOnly)) {
+        qWarning() << "[ThumbnailService] 缩略图缓存不可写:" << cachePath;
+        return result;
+    }
+    QImageWriter writer(&out, "png");
+    if (!writer.write(result.image) || !out.commit())
+        qWarning() << "[ThumbnailService] 写入缩略图缓存失败:" << cachePath << writer.errorString();
+    return result;
+}
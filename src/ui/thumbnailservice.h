@@ -0,0 +1,90 @@
+#ifndef THUMBNAILSERVICE_H
+#define THUMBNAILSERVICE_H
+
+#include <QHash>
+#include <QImage>
+#include <QObject>
+#include <QPixmap>
+#include <QSet>
+#include <QSize>
+#include <QString>
+#include <QThreadPool>
+
+/**
+ * 聊天气泡中的图片缩略图与媒体文件信息。
+ *
+ * - probe()/thumbnail() 只查内存，供委托的 sizeHint()/paint() 调用，不碰文件系统；
+ *   未就绪时排队到后台线程，完成后发 metadataReady / thumbnailReady；
+ * - 后台用 QImageReader::setScaledSize 直接按目标尺寸解码，不先读全尺寸原图；
+ * - 缩略图按文件内容 SHA-1 落盘（PNG 文本块里带原图尺寸），重启或同一张图换路径后直接命中。
+ *
+ * 内存中按路径索引，假定聊天媒体文件写入后不会原地改写。只在 GUI 线程使用。
+ */
+class ThumbnailService : public QObject
+{
+    Q_OBJECT
+public:
+    enum class Status { Loading, Ready, Missing, Failed };
+
+    struct Probe {
+        Status status = Status::Loading;
+        QSize originalSize; // 已按 EXIF 方向校正；不可解码的文件为空
+        qint64 fileSize = -1;
+    };
+
+    static constexpr int kMaxEntries = 4000;
+
+    static ThumbnailService& instance();
+
+    /** 文件是否存在、字节数与原图尺寸；首次查询时排队探测并返回 Loading。 */
+    Probe probe(const QString& path);
+    /** targetSize 下的缩略图；未就绪时排队解码并返回空 QPixmap。 */
+    QPixmap thumbnail(const QString& path, const QSize& targetSize,
+                      Qt::AspectRatioMode aspectMode = Qt::KeepAspectRatio);
+
+    QString cacheDirectory() const { return m_cacheDir; }
+    /** 修改落盘目录并清空内存索引；测试用。 */
+    void setCacheDirectory(const QString& dir);
+    /** 等后台任务全部结束；测试与退出时使用。 */
+    bool waitForIdle(int timeoutMs = -1);
+
+signals:
+    /** 探测完成：存在性、大小或原图尺寸已知，行高可能变化。 */
+    void metadataReady(const QString& path);
+    /** 某个尺寸的缩略图已进内存缓存（或解码失败），只需重绘。 */
+    void thumbnailReady(const QString& path);
+
+private:
+    struct Entry {
+        Probe probe;
+        bool probing = false;
+        QString contentHash;
+        QSet<QString> pendingKeys;
+    };
+
+    struct DecodeResult {
+        QImage image;
+        QSize originalSize;
+        QString contentHash;
+        bool missing = false;
+    };
+
+    ThumbnailService();
+    ~ThumbnailService() override;
+
+    Entry& entryFor(const QString& path);
+    void onProbed(const QString& path, const Probe& probe);
+    void onDecoded(const QString& path, const QString& pixmapKey, const DecodeResult& result);
+
+    static Probe probeFile(const QString& path);
+    static DecodeResult decodeThumbnail(const QString& path, const QString& knownHash,
+                                        const QSize& targetSize, Qt::AspectRatioMode aspectMode,
+                                        const QString& cacheDir);
+
+    QHash<QString, Entry> m_entries;
+    QThreadPool m_pool;
+    QString m_cacheDir;
+    quint64 m_generation = 0;
+};
+
+#endif // THUMBNAILSERVICE_H
@@ -2455,6 +2455,57 @@ QString buildAggregateChatFormQss(const AggregateChatTokens& t)
             background: %15;
             border-color: %11;
         }
+        QToolButton#aggregateNewMessageHint {
+            background: #FFFFFF;
+            color: #0F172A;
+            border: 1px solid #CBD5E1;
+            border-radius: 14px;
+            padding: 4px 12px;
+            font-size: 12px;
+        }
+        QToolButton#aggregateNewMessageHint:hover {
+            background: #F8FAFC;
+            border-color: #38BDF8;
+        }
+        QToolButton#aggregateNewMessageHint:pressed {
+            background: #E0F2FE;
+        }
+        QFrame#composeAttachmentCard {
+            background: #F8FAFC;
+            border: 1px solid #D9E2EC;
+            border-radius: 6px;
+        }
+        QLabel#composeAttachmentThumb {
+            background: #E5E7EB;
+            border-radius: 4px;
+            color: #334155;
+            font-size: 12px;
+        }
+        QLabel#composeAttachmentTitle {
+            color: #0F172A;
+            font-size: 12px;
+        }
+        QLabel#composeAttachmentDetail {
+            color: #64748B;
+            font-size: 11px;
+        }
+        QToolButton#composeAttachmentRemoveBtn {
+            background: #E2E8F0;
+            border: 1px solid #CBD5E1;
+            border-radius: 11px;
+            color: #334155;
+            font-size: 14px;
+            font-weight: 700;
+            padding: 0;
+        }
+        QToolButton#composeAttachmentRemoveBtn:hover {
+            background: #FEE2E2;
+            border-color: #FCA5A5;
+            color: #B91C1C;
+        }
+        QToolButton#composeAttachmentRemoveBtn:pressed {
+            background: #FECACA;
+        }
 
     )QSS");
     replaceAggregateChatPlaceholders(qss, t);
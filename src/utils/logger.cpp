@@ -1,86 +1,429 @@
 #include "logger.h"
 #include <QDateTime>
+#include <QDeadlineTimer>
 #include <QDir>
+#include <QFileInfo>
 #include <QMutexLocker>
-#include <QTextStream>
+#include <QThread>
+#include <QWaitCondition>
 #include <QtGlobal>
+#include <atomic>
 #include <cstdio>
+#include <memory>
+#include <thread>
 
 QFile Logger::s_logFile;
 QMutex Logger::s_mutex;
 bool Logger::s_initialized = false;
 
-void Logger::messageHandler(QtMsgType type, const QMessageLogContext& context, const QString& msg)
+namespace {
+
+struct LogRecord {
+    QtMsgType type = QtDebugMsg;
+    qint64 epochMs = 0;
+    const char* file = nullptr; // QMessageLogContext::file 指向静态字符串，可跨线程保留
+    int line = 0;
+    QString msg;
+};
+
+struct LogNode {
+    std::atomic<LogNode*> next{nullptr};
+    LogRecord record;
+};
+
+/**
+ * Vyukov 侵入式 MPSC 队列：入队只有一次 exchange，不加锁；
+ * 只有后台写线程出队。生产者恰好处于 exchange 与链接之间时 pop 返回空，下一轮再取。
+ */
+class MpscLogQueue
 {
-    QMutexLocker locker(&s_mutex);
+public:
+    MpscLogQueue()
+        : m_head(&m_stub)
+        , m_tail(&m_stub)
+    {
+    }
+
+    void push(LogNode* node)
+    {
+        node->next.store(nullptr, std::memory_order_relaxed);
+        LogNode* prev = m_head.exchange(node, std::memory_order_acq_rel);
+        prev->next.store(node, std::memory_order_release);
+    }
+
+    LogNode* pop()
+    {
+        LogNode* tail = m_tail;
+        LogNode* next = tail->next.load(std::memory_order_acquire);
+        if (tail == &m_stub) {
+            if (!next)
+                return nullptr;
+            m_tail = next;
+            tail = next;
+            next = next->next.load(std::memory_order_acquire);
+        }
+        if (next) {
+            m_tail = next;
+            return tail;
+        }
+        if (tail != m_head.load(std::memory_order_acquire))
+            return nullptr;
+        push(&m_stub);
+        next = tail->next.load(std::memory_order_acquire);
+        if (next) {
+            m_tail = next;
+            return tail;
+        }
+        return nullptr;
+    }
 
-    QString timestamp = QDateTime::currentDateTime().toString("yyyy-MM-dd hh:mm:ss.zzz");
-    const char* levels[] = {"DEBUG", "INFO ", "WARN ", "ERROR", "FATAL"};
-    int idx = 0;
+private:
+    std::atomic<LogNode*> m_head;
+    LogNode* m_tail;
+    LogNode m_stub;
+};
+
+struct RateBucket {
+    std::atomic<qint64> windowSec{0};
+    std::atomic<int> count{0};
+};
+
+struct AsyncLogState {
+    Logger::Options options;
+    MpscLogQueue queue;
+    std::atomic<bool> running{false};
+    std::atomic<bool> stop{false};
+    std::atomic<quint64> enqueued{0};
+    std::atomic<quint64> written{0};
+    std::atomic<quint64> dropped{0};
+    std::atomic<quint64> rateLimited{0};
+    std::unique_ptr<RateBucket[]> buckets;
+    QMutex wakeMutex;
+    QWaitCondition wake;
+    std::thread thread;
+
+    // 以下只由写线程访问
+    QDate fileDate;
+    int fileIndex = 0;
+    quint64 reportedDropped = 0;
+    quint64 reportedRateLimited = 0;
+    qint64 lastReportMs = 0;
+};
+
+AsyncLogState* s_async = nullptr;
+QString s_logDir;
+QtMessageHandler s_previousHandler = nullptr;
+
+const char* levelName(QtMsgType type)
+{
     switch (type) {
-    case QtDebugMsg:    idx = 0; break;
-    case QtInfoMsg:     idx = 1; break;
-    case QtWarningMsg:  idx = 2; break;
-    case QtCriticalMsg: idx = 3; break;
-    case QtFatalMsg:    idx = 4; break;
+    case QtDebugMsg:    return "DEBUG";
+    case QtInfoMsg:     return "INFO ";
+    case QtWarningMsg:  return "WARN ";
+    case QtCriticalMsg: return "ERROR";
+    case QtFatalMsg:    return "FATAL";
     }
+    return "DEBUG";
+}
 
-    QString formatted = QString("[%1] [%2] %3").arg(timestamp, levels[idx], msg);
-    if (context.file && context.line > 0) {
-        QString file = QString::fromUtf8(context.file);
+QString formatLine(QtMsgType type, qint64 epochMs, const char* contextFile, int line, const QString& msg)
+{
+    const QString timestamp = QDateTime::fromMSecsSinceEpoch(epochMs).toString(QStringLiteral("yyyy-MM-dd hh:mm:ss.zzz"));
+    QString formatted = QStringLiteral("[%1] [%2] %3").arg(timestamp, QLatin1String(levelName(type)), msg);
+    if (contextFile && line > 0) {
+        QString file = QString::fromUtf8(contextFile);
         int lastSlash = file.lastIndexOf('/');
         int lastBackslash = file.lastIndexOf('\\');
         int pos = qMax(lastSlash, lastBackslash);
         if (pos >= 0)
             file = file.mid(pos + 1);
-        formatted += QString(" (%1:%2)").arg(file).arg(context.line);
+        formatted += QStringLiteral(" (%1:%2)").arg(file).arg(line);
     }
+    return formatted;
+}
+
+QString logPathFor(const QDate& date, int index)
+{
+    const QString day = date.toString(QStringLiteral("yyyy-MM-dd"));
+    return index <= 0
+        ? s_logDir + QStringLiteral("/") + day + QStringLiteral(".log")
+        : s_logDir + QStringLiteral("/%1.%2.log").arg(day).arg(index);
+}
+
+int rateBucketIndex(const AsyncLogState& state, const QString& msg)
+{
+    // qInfo() << "[MessageRouter] ..." 以前缀开头；QString 参数会带引号
+    const int offset = msg.startsWith(QLatin1Char('"')) ? 1 : 0;
+    const QStringList& prefixes = state.options.rateLimitedPrefixes;
+    for (int i = 0; i < prefixes.size(); ++i) {
+        if (QStringView(msg).mid(offset).startsWith(prefixes.at(i)))
+            return i;
+    }
+    return -1;
+}
+
+bool takeRateToken(RateBucket& bucket, qint64 nowSec, int limit)
+{
+    qint64 window = bucket.windowSec.load(std::memory_order_relaxed);
+    if (window != nowSec && bucket.windowSec.compare_exchange_strong(window, nowSec, std::memory_order_relaxed))
+        bucket.count.store(0, std::memory_order_relaxed);
+    return bucket.count.fetch_add(1, std::memory_order_relaxed) < limit;
+}
+
+} // namespace
+
+void Logger::writeSync(QtMsgType type, const QMessageLogContext& context, const QString& msg)
+{
+    QMutexLocker locker(&s_mutex);
+    const QString formatted = formatLine(type, QDateTime::currentMSecsSinceEpoch(), context.file, context.line, msg);
 
     fprintf(stderr, "%s\n", formatted.toLocal8Bit().constData());
     fflush(stderr);
 
     if (s_logFile.isOpen()) {
-        QTextStream stream(&s_logFile);
-        stream << formatted << "\n";
-        stream.flush();
+        s_logFile.write(formatted.toUtf8());
+        s_logFile.write("\n");
+        s_logFile.flush();
+    }
+}
+
+void Logger::messageHandler(QtMsgType type, const QMessageLogContext& context, const QString& msg)
+{
+    AsyncLogState* state = s_async;
+    if (!state || !state->running.load(std::memory_order_acquire)) {
+        writeSync(type, context, msg);
+        return;
     }
+    if (type == QtFatalMsg) {
+        // 进程随后会 abort：先把已入队的写完，再同步写出这一条
+        flush();
+        writeSync(type, context, msg);
+        return;
+    }
+
+    const qint64 nowMs = QDateTime::currentMSecsSinceEpoch();
+    const bool droppable = type == QtDebugMsg || type == QtInfoMsg;
+    if (droppable) {
+        const int bucket = rateBucketIndex(*state, msg);
+        if (bucket >= 0 && !takeRateToken(state->buckets[bucket], nowMs / 1000, state->options.rateLimitPerSecond)) {
+            state->rateLimited.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        const quint64 backlog = state->enqueued.load(std::memory_order_relaxed)
+            - state->written.load(std::memory_order_relaxed);
+        if (backlog >= quint64(state->options.queueCapacity)) {
+            state->dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+    }
+
+    auto* node = new LogNode;
+    node->record.type = type;
+    node->record.epochMs = nowMs;
+    node->record.file = context.file;
+    node->record.line = context.line;
+    node->record.msg = msg;
+    state->enqueued.fetch_add(1, std::memory_order_relaxed);
+    state->queue.push(node);
+    if (!droppable)
+        state->wake.wakeOne();
+}
+
+namespace {
+
+void rotateIfNeeded(AsyncLogState& state, QFile& file, qint64 incomingBytes)
+{
+    const QDate today = QDate::currentDate();
+    const qint64 maxBytes = state.options.maxFileBytes;
+    bool reopen = false;
+    if (today != state.fileDate) {
+        state.fileDate = today;
+        state.fileIndex = 0;
+        reopen = true;
+    }
+    if (maxBytes > 0 && file.isOpen() && file.size() > 0 && file.size() + incomingBytes > maxBytes) {
+        ++state.fileIndex;
+        reopen = true;
+    }
+    if (!reopen && file.isOpen())
+        return;
+    // 跳过当天已写满的分片（重启后继续写最后一个未满的文件）
+    QString path = logPathFor(state.fileDate, state.fileIndex);
+    while (maxBytes > 0 && QFileInfo(path).size() >= maxBytes) {
+        ++state.fileIndex;
+        path = logPathFor(state.fileDate, state.fileIndex);
+    }
+    if (file.isOpen())
+        file.close();
+    file.setFileName(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text))
+        fprintf(stderr, "[Logger] 无法打开日志文件: %s\n", path.toLocal8Bit().constData());
 }
 
+} // namespace
+
 void Logger::init()
+{
+    Options options;
+    if (qEnvironmentVariableIntValue("YY_LOG_SYNC") == 1)
+        options.async = false;
+    bool ok = false;
+    const int maxMb = qEnvironmentVariableIntValue("YY_LOG_MAX_MB", &ok);
+    if (ok)
+        options.maxFileBytes = qint64(maxMb) * 1024 * 1024;
+    init(options);
+}
+
+void Logger::init(const Options& options)
 {
     if (s_initialized)
         return;
 
-    QString logDir = QStringLiteral(PROJECT_ROOT_DIR) + QStringLiteral("/logs");
-    QDir().mkpath(logDir);
-    QString logPath = logDir + "/"
-                      + QDateTime::currentDateTime().toString("yyyy-MM-dd") + ".log";
+    s_logDir = options.directory.isEmpty()
+        ? QStringLiteral(PROJECT_ROOT_DIR) + QStringLiteral("/logs")
+        : options.directory;
+    QDir().mkpath(s_logDir);
+
+    if (!s_async)
+        s_async = new AsyncLogState; // 不释放：退出阶段仍可能有线程在打日志
+    AsyncLogState& state = *s_async;
+    state.options = options;
+    state.options.queueCapacity = qMax(1, options.queueCapacity);
+    state.options.flushIntervalMs = qMax(1, options.flushIntervalMs);
+    state.buckets.reset(new RateBucket[qMax(1, int(options.rateLimitedPrefixes.size()))]);
+    state.fileDate = QDate::currentDate();
+    state.fileIndex = 0;
+    state.reportedDropped = state.dropped.load();
+    state.reportedRateLimited = state.rateLimited.load();
 
-    s_logFile.setFileName(logPath);
-    if (!s_logFile.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text)) {
-        fprintf(stderr, "[Logger] 无法打开日志文件: %s\n", logPath.toLocal8Bit().constData());
+    {
+        QMutexLocker locker(&s_mutex);
+        rotateIfNeeded(state, s_logFile, 0);
     }
 
-    qInstallMessageHandler(messageHandler);
+    if (options.async) {
+        state.stop.store(false);
+        state.thread = std::thread([&state]() {
+            QByteArray fileBatch;
+            QByteArray stderrBatch;
+            auto appendLine = [&](const QString& line) {
+                fileBatch += line.toUtf8();
+                fileBatch += '\n';
+                stderrBatch += line.toLocal8Bit();
+                stderrBatch += '\n';
+            };
+            for (;;) {
+                const bool stopping = state.stop.load(std::memory_order_acquire);
+                quint64 batchCount = 0;
+                while (LogNode* node = state.queue.pop()) {
+                    const LogRecord& r = node->record;
+                    appendLine(formatLine(r.type, r.epochMs, r.file, r.line, r.msg));
+                    delete node;
+                    ++batchCount;
+                    if (fileBatch.size() >= 256 * 1024)
+                        break;
+                }
+
+                const qint64 nowMs = QDateTime::currentMSecsSinceEpoch();
+                const quint64 dropped = state.dropped.load(std::memory_order_relaxed);
+                const quint64 rateLimited = state.rateLimited.load(std::memory_order_relaxed);
+                if ((dropped != state.reportedDropped || rateLimited != state.reportedRateLimited)
+                    && (nowMs - state.lastReportMs >= 1000 || stopping)) {
+                    appendLine(formatLine(QtWarningMsg, nowMs, nullptr, 0,
+                                          QStringLiteral("[Logger] 丢弃日志：积压 %1 条，限流 %2 条（累计 %3 / %4）")
+                                              .arg(dropped - state.reportedDropped)
+                                              .arg(rateLimited - state.reportedRateLimited)
+                                              .arg(dropped)
+                                              .arg(rateLimited)));
+                    state.reportedDropped = dropped;
+                    state.reportedRateLimited = rateLimited;
+                    state.lastReportMs = nowMs;
+                }
+
+                if (!fileBatch.isEmpty()) {
+                    fwrite(stderrBatch.constData(), 1, size_t(stderrBatch.size()), stderr);
+                    fflush(stderr);
+                    {
+                        QMutexLocker locker(&s_mutex);
+                        rotateIfNeeded(state, s_logFile, fileBatch.size());
+                        if (s_logFile.isOpen()) {
+                            s_logFile.write(fileBatch);
+                            s_logFile.flush();
+                        }
+                    }
+                    fileBatch.clear();
+                    stderrBatch.clear();
+                }
+                state.written.fetch_add(batchCount, std::memory_order_release);
+
+                if (batchCount > 0)
+                    continue;
+                if (stopping)
+                    break;
+                QMutexLocker locker(&state.wakeMutex);
+                state.wake.wait(&state.wakeMutex, QDeadlineTimer(state.options.flushIntervalMs));
+            }
+        });
+        state.running.store(true, std::memory_order_release);
+    }
+
+    s_previousHandler = qInstallMessageHandler(messageHandler);
     s_initialized = true;
 
     qInfo() << "====== 应用启动 ======";
-    qInfo() << "日志文件:" << logPath;
+    qInfo() << "日志文件:" << logFilePath() << "async=" << options.async;
+}
+
+void Logger::flush()
+{
+    AsyncLogState* state = s_async;
+    if (!state || !state->running.load(std::memory_order_acquire))
+        return;
+    if (state->thread.get_id() == std::this_thread::get_id())
+        return;
+    const quint64 target = state->enqueued.load(std::memory_order_acquire);
+    QDeadlineTimer deadline(2000);
+    while (state->written.load(std::memory_order_acquire) < target && !deadline.hasExpired()) {
+        state->wake.wakeOne();
+        QThread::msleep(1);
+    }
 }
 
 void Logger::shutdown()
 {
+    if (s_async && s_async->running.load()) {
+        qInfo() << "====== 应用关闭 ======";
+        s_async->running.store(false, std::memory_order_release);
+        s_async->stop.store(true, std::memory_order_release);
+        s_async->wake.wakeOne();
+        if (s_async->thread.joinable())
+            s_async->thread.join();
+    } else if (s_logFile.isOpen()) {
+        QMutexLocker locker(&s_mutex);
+        s_logFile.write(QStringLiteral("[%1] [INFO ] ====== 应用关闭 ======\n")
+                            .arg(QDateTime::currentDateTime().toString("yyyy-MM-dd hh:mm:ss.zzz"))
+                            .toUtf8());
+    }
+    qInstallMessageHandler(s_previousHandler);
+    s_previousHandler = nullptr;
     QMutexLocker locker(&s_mutex);
-    if (s_logFile.isOpen()) {
-        QTextStream stream(&s_logFile);
-        stream << QString("[%1] [INFO ] ====== 应用关闭 ======\n")
-                      .arg(QDateTime::currentDateTime().toString("yyyy-MM-dd hh:mm:ss.zzz"));
+    if (s_logFile.isOpen())
         s_logFile.close();
-    }
     s_initialized = false;
 }
 
 QString Logger::logFilePath()
 {
+    QMutexLocker locker(&s_mutex);
     return s_logFile.fileName();
 }
+
+quint64 Logger::droppedCount()
+{
+    return s_async ? s_async->dropped.load(std::memory_order_relaxed) : 0;
+}
+
+quint64 Logger::rateLimitedCount()
+{
+    return s_async ? s_async->rateLimited.load(std::memory_order_relaxed) : 0;
+}
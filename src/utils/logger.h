@@ -6,16 +6,45 @@
 #include <QMessageLogContext>
 #include <QMutex>
 #include <QString>
+#include <QStringList>
 
+/**
+ * 应用日志。
+ *
+ * 默认异步：调用线程只把消息压入无锁 MPSC 队列，由后台线程统一格式化、
+ * 批量写入 stderr 和日志文件。队列积压超过上限时丢弃 debug/info 并计数，
+ * warning 及以上始终保留；fatal 会先排空队列再同步写出。
+ * 环境变量 YY_LOG_SYNC=1 退回原先的同步写入。
+ */
 class Logger
 {
 public:
+    struct Options {
+        bool async = true;
+        QString directory;                     // 为空时使用 PROJECT_ROOT_DIR/logs
+        qint64 maxFileBytes = 50ll * 1024 * 1024; // 超过后切到 yyyy-MM-dd.N.log；<= 0 不按大小切分
+        int queueCapacity = 65536;              // 未写出的消息条数上限
+        int flushIntervalMs = 200;              // 后台线程最长多久落盘一次
+        // 高频分类（按消息前缀匹配）每秒最多写入的 debug/info 条数
+        QStringList rateLimitedPrefixes{QStringLiteral("[MessageRouter]"), QStringLiteral("[IpcService]")};
+        int rateLimitPerSecond = 200;
+    };
+
     static void init();
+    static void init(const Options& options);
     static void shutdown();
     static QString logFilePath();
+    /** 等待已入队的消息全部写出（测试和退出前使用）。 */
+    static void flush();
+
+    /** 因队列积压丢弃的条数（累计）。 */
+    static quint64 droppedCount();
+    /** 因分类限流丢弃的条数（累计）。 */
+    static quint64 rateLimitedCount();
 
 private:
     static void messageHandler(QtMsgType type, const QMessageLogContext& context, const QString& msg);
+    static void writeSync(QtMsgType type, const QMessageLogContext& context, const QString& msg);
 
     static QFile s_logFile;
     static QMutex s_mutex;
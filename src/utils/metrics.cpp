@@ -0,0 +1,370 @@
+#include "metrics.h"
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QMutexLocker>
+#include <QStringList>
+#include <QTimer>
+#include <QtAlgorithms>
+#include <algorithm>
+#include <cmath>
+#include <memory>
+
+namespace Metrics {
+
+namespace {
+
+qint64 monotonicNs()
+{
+    static QElapsedTimer clock = []() {
+        QElapsedTimer t;
+        t.start();
+        return t;
+    }();
+    return clock.nsecsElapsed();
+}
+
+QString labelsText(const Labels& labels, const QString& extra = QString())
+{
+    QStringList parts;
+    for (const auto& label : labels) {
+        QString value = label.second;
+        value.replace(QLatin1Char('\\'), QStringLiteral("\\\\"));
+        value.replace(QLatin1Char('"'), QStringLiteral("\\\""));
+        value.replace(QLatin1Char('\n'), QStringLiteral("\\n"));
+        parts.append(QStringLiteral("%1=\"%2\"").arg(label.first, value));
+    }
+    if (!extra.isEmpty())
+        parts.append(extra);
+    return parts.isEmpty() ? QString() : QStringLiteral("{%1}").arg(parts.join(QLatin1Char(',')));
+}
+
+const char* typeName(Type type)
+{
+    switch (type) {
+    case Type::Counter:   return "counter";
+    case Type::Gauge:     return "gauge";
+    case Type::Histogram: return "histogram";
+    }
+    return "counter";
+}
+
+QString formatNumber(double value)
+{
+    if (std::isfinite(value) && value == std::floor(value) && std::fabs(value) < 1e15)
+        return QString::number(qint64(value));
+    return QString::number(value, 'g', 12);
+}
+
+} // namespace
+
+void Gauge::add(double delta)
+{
+    double current = m_value.load(std::memory_order_relaxed);
+    while (!m_value.compare_exchange_weak(current, current + delta, std::memory_order_relaxed)) {
+    }
+}
+
+Histogram::Histogram()
+{
+    for (auto& bucket : m_buckets)
+        bucket.store(0, std::memory_order_relaxed);
+}
+
+int Histogram::bucketIndex(qint64 value)
+{
+    if (value < kSubBuckets)
+        return int(qMax<qint64>(0, value));
+    const int msb = 63 - qCountLeadingZeroBits(quint64(value));
+    if (msb > kMaxExponent)
+        return kBucketCount - 1;
+    const int shift = msb - kSubBucketBits;
+    const int sub = int((quint64(value) >> shift) & (kSubBuckets - 1));
+    return kSubBuckets + shift * kSubBuckets + sub;
+}
+
+qint64 Histogram::bucketUpperBound(int index)
+{
+    if (index < kSubBuckets)
+        return index;
+    const int shift = (index - kSubBuckets) / kSubBuckets;
+    const int sub = (index - kSubBuckets) % kSubBuckets;
+    return ((qint64(kSubBuckets + sub + 1)) << shift) - 1;
+}
+
+void Histogram::record(qint64 value)
+{
+    if (value < 0)
+        value = 0;
+    m_buckets[bucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+    m_count.fetch_add(1, std::memory_order_relaxed);
+    m_sum.fetch_add(value, std::memory_order_relaxed);
+    qint64 seen = m_max.load(std::memory_order_relaxed);
+    while (value > seen && !m_max.compare_exchange_weak(seen, value, std::memory_order_relaxed)) {
+    }
+    seen = m_min.load(std::memory_order_relaxed);
+    while (value < seen && !m_min.compare_exchange_weak(seen, value, std::memory_order_relaxed)) {
+    }
+}
+
+qint64 Histogram::percentileFromCounts(const QVector<quint64>& counts, quint64 total, double q, qint64 max) const
+{
+    if (total == 0)
+        return 0;
+    const quint64 rank = qMax<quint64>(1, quint64(std::ceil(qBound(0.0, q, 1.0) * double(total))));
+    quint64 seen = 0;
+    for (int i = 0; i < counts.size(); ++i) {
+        seen += counts.at(i);
+        if (seen >= rank)
+            return qMin(bucketUpperBound(i), max);
+    }
+    return max;
+}
+
+qint64 Histogram::percentile(double q) const
+{
+    QVector<quint64> counts(kBucketCount);
+    quint64 total = 0;
+    for (int i = 0; i < kBucketCount; ++i) {
+        counts[i] = m_buckets[i].load(std::memory_order_relaxed);
+        total += counts[i];
+    }
+    return percentileFromCounts(counts, total, q, m_max.load(std::memory_order_relaxed));
+}
+
+Histogram::Summary Histogram::summary() const
+{
+    QVector<quint64> counts(kBucketCount);
+    quint64 total = 0;
+    for (int i = 0; i < kBucketCount; ++i) {
+        counts[i] = m_buckets[i].load(std::memory_order_relaxed);
+        total += counts[i];
+    }
+    Summary s;
+    s.count = total;
+    if (total == 0)
+        return s;
+    s.sum = m_sum.load(std::memory_order_relaxed);
+    s.min = m_min.load(std::memory_order_relaxed);
+    s.max = m_max.load(std::memory_order_relaxed);
+    s.p50 = percentileFromCounts(counts, total, 0.50, s.max);
+    s.p90 = percentileFromCounts(counts, total, 0.90, s.max);
+    s.p99 = percentileFromCounts(counts, total, 0.99, s.max);
+    s.p999 = percentileFromCounts(counts, total, 0.999, s.max);
+    return s;
+}
+
+ScopedTimer::ScopedTimer(Histogram* histogram)
+    : m_histogram(histogram)
+    , m_startNs(monotonicNs())
+{
+}
+
+ScopedTimer::~ScopedTimer()
+{
+    if (m_histogram)
+        m_histogram->record((monotonicNs() - m_startNs) / 1000);
+}
+
+struct Registry::Entry {
+    QString name;
+    Labels labels;
+    QString help;
+    Type type = Type::Counter;
+    Counter counter;
+    Gauge gauge;
+    Histogram* histogram = nullptr; // 直方图较大，只在需要时分配
+};
+
+Registry& Registry::instance()
+{
+    static Registry* registry = new Registry(); // 不析构：退出阶段仍可能有线程在记录
+    return *registry;
+}
+
+Registry::Entry* Registry::findOrCreate(const QString& name, const Labels& labels, const QString& help, Type type)
+{
+    const QString key = name + labelsText(labels);
+    QMutexLocker locker(&m_mutex);
+    Entry* entry = m_entries.value(key, nullptr);
+    if (entry) {
+        if (entry->type != type)
+            qWarning() << "[Metrics] metric registered with different type:" << key;
+        if (entry->help.isEmpty() && !help.isEmpty())
+            entry->help = help;
+        return entry;
+    }
+    entry = new Entry;
+    entry->name = name;
+    entry->labels = labels;
+    entry->help = help;
+    entry->type = type;
+    if (type == Type::Histogram)
+        entry->histogram = new Histogram;
+    m_entries.insert(key, entry);
+    return entry;
+}
+
+Counter* Registry::counter(const QString& name, const Labels& labels, const QString& help)
+{
+    return &findOrCreate(name, labels, help, Type::Counter)->counter;
+}
+
+Gauge* Registry::gauge(const QString& name, const Labels& labels, const QString& help)
+{
+    return &findOrCreate(name, labels, help, Type::Gauge)->gauge;
+}
+
+Histogram* Registry::histogram(const QString& name, const Labels& labels, const QString& help)
+{
+    Entry* entry = findOrCreate(name, labels, help, Type::Histogram);
+    if (!entry->histogram) // 同名指标先以其他类型注册过；返回独立对象，记录不会丢进别的指标
+        return new Histogram;
+    return entry->histogram;
+}
+
+void Registry::addCollector(std::function<void()> collector)
+{
+    QMutexLocker locker(&m_mutex);
+    m_collectors.append(std::move(collector));
+}
+
+QVector<Sample> Registry::snapshot()
+{
+    QList<std::function<void()>> collectors;
+    QList<Entry*> entries;
+    {
+        QMutexLocker locker(&m_mutex);
+        collectors = m_collectors;
+    }
+    for (const auto& collect : collectors)
+        collect();
+    {
+        QMutexLocker locker(&m_mutex);
+        entries = m_entries.values();
+    }
+
+    QVector<Sample> samples;
+    samples.reserve(entries.size());
+    for (const Entry* entry : entries) {
+        Sample sample;
+        sample.name = entry->name;
+        sample.labels = entry->labels;
+        sample.help = entry->help;
+        sample.type = entry->type;
+        switch (entry->type) {
+        case Type::Counter:
+            sample.value = double(entry->counter.value());
+            break;
+        case Type::Gauge:
+            sample.value = entry->gauge.value();
+            break;
+        case Type::Histogram:
+            if (entry->histogram)
+                sample.histogram = entry->histogram->summary();
+            break;
+        }
+        samples.append(sample);
+    }
+    std::sort(samples.begin(), samples.end(), [](const Sample& a, const Sample& b) {
+        if (a.name != b.name)
+            return a.name < b.name;
+        return labelsText(a.labels) < labelsText(b.labels);
+    });
+    return samples;
+}
+
+QJsonObject Registry::toJson()
+{
+    QJsonArray metrics;
+    for (const Sample& sample : snapshot()) {
+        QJsonObject obj;
+        obj.insert(QStringLiteral("name"), sample.name);
+        obj.insert(QStringLiteral("type"), QString::fromLatin1(typeName(sample.type)));
+        if (!sample.help.isEmpty())
+            obj.insert(QStringLiteral("help"), sample.help);
+        QJsonObject labels;
+        for (const auto& label : sample.labels)
+            labels.insert(label.first, label.second);
+        if (!labels.isEmpty())
+            obj.insert(QStringLiteral("labels"), labels);
+        if (sample.type == Type::Histogram) {
+            const Histogram::Summary& h = sample.histogram;
+            obj.insert(QStringLiteral("count"), double(h.count));
+            obj.insert(QStringLiteral("sum"), double(h.sum));
+            obj.insert(QStringLiteral("mean"), h.mean());
+            obj.insert(QStringLiteral("min"), double(h.min));
+            obj.insert(QStringLiteral("max"), double(h.max));
+            obj.insert(QStringLiteral("p50"), double(h.p50));
+            obj.insert(QStringLiteral("p90"), double(h.p90));
+            obj.insert(QStringLiteral("p99"), double(h.p99));
+            obj.insert(QStringLiteral("p999"), double(h.p999));
+        } else {
+            obj.insert(QStringLiteral("value"), sample.value);
+        }
+        metrics.append(obj);
+    }
+    QJsonObject root;
+    root.insert(QStringLiteral("generated_at"), QDateTime::currentDateTime().toString(Qt::ISODateWithMs));
+    root.insert(QStringLiteral("metrics"), metrics);
+    return root;
+}
+
+QString Registry::toPrometheus()
+{
+    QString out;
+    QString lastName;
+    for (const Sample& sample : snapshot()) {
+        if (sample.name != lastName) {
+            lastName = sample.name;
+            if (!sample.help.isEmpty())
+                out += QStringLiteral("# HELP %1 %2\n").arg(sample.name, sample.help);
+            // 直方图按 summary 导出分位数，便于直接与 p50/p99 对照
+            out += QStringLiteral("# TYPE %1 %2\n")
+                       .arg(sample.name, sample.type == Type::Histogram ? QStringLiteral("summary")
+                                                                         : QString::fromLatin1(typeName(sample.type)));
+        }
+        if (sample.type != Type::Histogram) {
+            out += QStringLiteral("%1%2 %3\n").arg(sample.name, labelsText(sample.labels), formatNumber(sample.value));
+            continue;
+        }
+        const Histogram::Summary& h = sample.histogram;
+        const QPair<const char*, qint64> quantiles[] = {
+            {"0.5", h.p50}, {"0.9", h.p90}, {"0.99", h.p99}, {"0.999", h.p999}};
+        for (const auto& q : quantiles) {
+            out += QStringLiteral("%1%2 %3\n")
+                       .arg(sample.name,
+                            labelsText(sample.labels, QStringLiteral("quantile=\"%1\"").arg(QLatin1String(q.first))),
+                            QString::number(q.second));
+        }
+        out += QStringLiteral("%1_sum%2 %3\n").arg(sample.name, labelsText(sample.labels), QString::number(h.sum));
+        out += QStringLiteral("%1_count%2 %3\n").arg(sample.name, labelsText(sample.labels), QString::number(h.count));
+    }
+    return out;
+}
+
+Histogram* dbStatementLatency(const char* statement)
+{
+    return histogram(QStringLiteral("db_statement_us"),
+                     {{QStringLiteral("statement"), QString::fromLatin1(statement)}},
+                     QStringLiteral("DAO 语句耗时（微秒）"));
+}
+
+void startEventLoopLagProbe(QObject* parent, int intervalMs)
+{
+    Histogram* lag = histogram(QStringLiteral("ui_event_loop_lag_us"), {},
+                               QStringLiteral("主线程定时器实际触发时间超出预期的部分（微秒）"));
+    auto* timer = new QTimer(parent);
+    timer->setTimerType(Qt::PreciseTimer);
+    timer->setInterval(qMax(1, intervalMs));
+    auto lastNs = std::make_shared<qint64>(monotonicNs());
+    const qint64 expectedNs = qint64(timer->interval()) * 1000000;
+    QObject::connect(timer, &QTimer::timeout, timer, [lag, lastNs, expectedNs]() {
+        const qint64 now = monotonicNs();
+        lag->record(qMax<qint64>(0, now - *lastNs - expectedNs) / 1000);
+        *lastNs = now;
+    });
+    timer->start();
+}
+
+} // namespace Metrics
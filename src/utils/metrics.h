@@ -0,0 +1,174 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <QHash>
+#include <QJsonObject>
+#include <QList>
+#include <QMutex>
+#include <QPair>
+#include <QString>
+#include <QVector>
+#include <QtGlobal>
+#include <atomic>
+#include <functional>
+#include <limits>
+
+class QObject;
+
+/**
+ * 进程内运行指标：计数器、仪表和 HDR 风格的对数分桶直方图。
+ *
+ * 指标对象由注册表持有、进程内不释放，调用方可以把指针缓存在静态变量里；
+ * 记录路径只有原子操作。后台窗口「性能监控」页和 JSON / Prometheus 导出读取同一份快照。
+ * 直方图统一以微秒记录，指标名以 _us 结尾。
+ */
+namespace Metrics {
+
+using Labels = QList<QPair<QString, QString>>;
+
+class Counter
+{
+public:
+    void increment(quint64 n = 1) { m_value.fetch_add(n, std::memory_order_relaxed); }
+    quint64 value() const { return m_value.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<quint64> m_value{0};
+};
+
+class Gauge
+{
+public:
+    void set(double value) { m_value.store(value, std::memory_order_relaxed); }
+    void add(double delta);
+    double value() const { return m_value.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<double> m_value{0.0};
+};
+
+/**
+ * 对数-线性分桶：小于 16 的值精确计数，之后每个 2 的幂区间再分 16 档，
+ * 相对误差约 6%，覆盖到约 4 年（微秒）。分位数取桶上界并以实际最大值封顶。
+ */
+class Histogram
+{
+public:
+    static constexpr int kSubBucketBits = 4;
+    static constexpr int kSubBuckets = 1 << kSubBucketBits;
+    static constexpr int kMaxExponent = 47;
+    static constexpr int kBucketCount = kSubBuckets + (kMaxExponent - kSubBucketBits + 1) * kSubBuckets;
+
+    struct Summary {
+        quint64 count = 0;
+        qint64 sum = 0;
+        qint64 min = 0;
+        qint64 max = 0;
+        qint64 p50 = 0;
+        qint64 p90 = 0;
+        qint64 p99 = 0;
+        qint64 p999 = 0;
+        double mean() const { return count ? double(sum) / double(count) : 0.0; }
+    };
+
+    Histogram();
+
+    void record(qint64 value);
+    quint64 count() const { return m_count.load(std::memory_order_relaxed); }
+    /** q 取 0~1；没有样本时返回 0。 */
+    qint64 percentile(double q) const;
+    Summary summary() const;
+
+    static int bucketIndex(qint64 value);
+    static qint64 bucketUpperBound(int index);
+
+private:
+    qint64 percentileFromCounts(const QVector<quint64>& counts, quint64 total, double q, qint64 max) const;
+
+    std::atomic<quint64> m_buckets[kBucketCount];
+    std::atomic<quint64> m_count{0};
+    std::atomic<qint64> m_sum{0};
+    std::atomic<qint64> m_min{std::numeric_limits<qint64>::max()};
+    std::atomic<qint64> m_max{0};
+};
+
+/** 作用域计时：析构时把耗时（微秒）记入直方图。 */
+class ScopedTimer
+{
+public:
+    explicit ScopedTimer(Histogram* histogram);
+    ~ScopedTimer();
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+private:
+    Histogram* m_histogram = nullptr;
+    qint64 m_startNs = 0;
+};
+
+enum class Type { Counter, Gauge, Histogram };
+
+struct Sample {
+    QString name;
+    Labels labels;
+    QString help;
+    Type type = Type::Counter;
+    double value = 0.0; // Counter / Gauge
+    Histogram::Summary histogram;
+};
+
+class Registry
+{
+public:
+    static Registry& instance();
+
+    Counter* counter(const QString& name, const Labels& labels = {}, const QString& help = QString());
+    Gauge* gauge(const QString& name, const Labels& labels = {}, const QString& help = QString());
+    Histogram* histogram(const QString& name, const Labels& labels = {}, const QString& help = QString());
+
+    /** 快照前调用，用于按需采集的仪表（内存、日志丢弃数等）。 */
+    void addCollector(std::function<void()> collector);
+
+    /** 按名称、标签排序。 */
+    QVector<Sample> snapshot();
+    QJsonObject toJson();
+    QString toPrometheus();
+
+private:
+    Registry() = default;
+    struct Entry;
+    Entry* findOrCreate(const QString& name, const Labels& labels, const QString& help, Type type);
+
+    QMutex m_mutex;
+    QHash<QString, Entry*> m_entries; // 键为 name{labels}
+    QList<std::function<void()>> m_collectors;
+};
+
+inline Counter* counter(const QString& name, const Labels& labels = {}, const QString& help = QString())
+{
+    return Registry::instance().counter(name, labels, help);
+}
+
+inline Gauge* gauge(const QString& name, const Labels& labels = {}, const QString& help = QString())
+{
+    return Registry::instance().gauge(name, labels, help);
+}
+
+inline Histogram* histogram(const QString& name, const Labels& labels = {}, const QString& help = QString())
+{
+    return Registry::instance().histogram(name, labels, help);
+}
+
+/** DAO 语句耗时：db_statement_us{statement="Dao::method"}。 */
+Histogram* dbStatementLatency(const char* statement);
+
+/**
+ * 主线程事件循环延迟探针：按固定间隔触发定时器，把实际间隔超出预期的部分
+ * 记入 ui_event_loop_lag_us，近似界面掉帧/卡顿时长。
+ */
+void startEventLoopLagProbe(QObject* parent, int intervalMs = 50);
+
+} // namespace Metrics
+
+#endif // METRICS_H
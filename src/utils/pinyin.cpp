@@ -0,0 +1,42 @@
+#include "pinyin.h"
+
+namespace {
+
+#include "pinyintable.inc"
+
+struct SurnameReading {
+    char16_t ch;
+    const char* reading;
+};
+
+// ICU 首选读音与姓氏读音不同的常见姓氏
+constexpr SurnameReading kSurnameReadings[] = {
+    {u'曾', "zeng"}, {u'单', "shan"}, {u'仇', "qiu"},  {u'解', "xie"},  {u'朴', "piao"},
+    {u'区', "ou"},   {u'查', "zha"},  {u'盖', "ge"},   {u'翟', "zhai"}, {u'乐', "yue"},
+    {u'覃', "qin"},  {u'召', "shao"}, {u'缪', "miao"}, {u'长', "chang"}, {u'重', "chong"},
+    {u'尉', "yu"},   {u'种', "chong"}, {u'员', "yun"}, {u'秘', "bi"},   {u'繁', "po"},
+};
+
+} // namespace
+
+namespace Pinyin {
+
+QLatin1String syllable(QChar ch)
+{
+    const char32_t code = ch.unicode();
+    if (code < kHanFirst || code > kHanLast)
+        return {};
+    const quint16 index = kHanSyllable[code - kHanFirst];
+    return index ? QLatin1String(kSyllables[index]) : QLatin1String();
+}
+
+QLatin1String surnameReading(QChar ch)
+{
+    for (const SurnameReading& entry : kSurnameReadings) {
+        if (entry.ch == ch.unicode())
+            return QLatin1String(entry.reading);
+    }
+    return {};
+}
+
+} // namespace Pinyin
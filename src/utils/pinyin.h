@@ -0,0 +1,23 @@
+#ifndef PINYIN_H
+#define PINYIN_H
+
+#include <QChar>
+#include <QLatin1String>
+
+/**
+ * 汉字转拼音，供会话搜索建索引使用。
+ *
+ * 只覆盖 CJK 基本区（U+4E00–U+9FFF），每字一个首选读音，小写、无声调，ü 写作 u。
+ * 查表为 O(1)，表编译进程序，不依赖 ICU 或资源文件。
+ */
+namespace Pinyin {
+
+/** 汉字的拼音；非汉字或表中没有读音时返回空。 */
+QLatin1String syllable(QChar ch);
+
+/** 常见多音姓氏在姓氏位置的读音（曾→zeng、单→shan 等）；不是多音姓氏返回空。 */
+QLatin1String surnameReading(QChar ch);
+
+} // namespace Pinyin
+
+#endif // PINYIN_H
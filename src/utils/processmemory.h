@@ -0,0 +1,13 @@
+#ifndef PROCESSMEMORY_H
+#define PROCESSMEMORY_H
+
+#include <QtGlobal>
+
+namespace ProcessMemory {
+
+/** 当前进程常驻内存（Windows 为工作集）字节数；平台不支持时返回 -1。 */
+qint64 residentBytes();
+
+} // namespace ProcessMemory
+
+#endif // PROCESSMEMORY_H
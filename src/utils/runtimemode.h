@@ -51,9 +51,22 @@ inline bool isClientCacheDb()
     return false;
 }
 
+// 模拟平台压测专用：让客户端按本地缓存模式自行入库，以便在没有 Python 服务时
+// 测量 MessageRouter + DAO + 列表模型。正常运行时始终为 false。
+inline bool& localCacheIngestOverride()
+{
+    static bool enabled = false;
+    return enabled;
+}
+
+inline void setLocalCacheIngestOverride(bool enabled)
+{
+    localCacheIngestOverride() = enabled;
+}
+
 inline bool ownsBusinessDatabase()
 {
-    return true;
+    return !localCacheIngestOverride();
 }
 
 } // namespace RuntimeMode
@@ -0,0 +1,142 @@
+#include "themeengine.h"
+
+#include "metrics.h"
+
+#include <QVariant>
+#include <QWidget>
+
+namespace {
+
+const char kAppliedThemeProperty[] = "_yy_applied_theme";
+
+int sheetKey(ThemeEngine::Root root, ApplyStyle::MainWindowTheme theme)
+{
+    return (static_cast<int>(root) << 8) | static_cast<int>(theme);
+}
+
+Metrics::Histogram* applyLatency()
+{
+    static Metrics::Histogram* const histogram = Metrics::histogram(
+        QStringLiteral("theme_apply_us"), {}, QStringLiteral("在根控件上设置主题样式表（含子树 polish）的耗时"));
+    return histogram;
+}
+
+Metrics::Counter* applyCounter(bool applied)
+{
+    static Metrics::Counter* const appliedCounter = Metrics::counter(
+        QStringLiteral("theme_apply_total"), {{QStringLiteral("result"), QStringLiteral("applied")}},
+        QStringLiteral("主题应用次数；skipped 为根控件已是目标主题、未重新 polish"));
+    static Metrics::Counter* const skippedCounter = Metrics::counter(
+        QStringLiteral("theme_apply_total"), {{QStringLiteral("result"), QStringLiteral("skipped")}},
+        QStringLiteral("主题应用次数；skipped 为根控件已是目标主题、未重新 polish"));
+    return applied ? appliedCounter : skippedCounter;
+}
+
+/** 与 ApplyStyle 中 kAggDefault 的气泡配色一致；其余主题目前都回落到默认主题。 */
+ChatBubblePalette buildChatBubblePalette(ApplyStyle::MainWindowTheme theme)
+{
+    Q_UNUSED(theme)
+    ChatBubblePalette p;
+    p.bubbleFillIn = QColor(0xFF, 0xFF, 0xFF);
+    p.bubbleFillOut = QColor(0x20, 0xB8, 0xE8);
+    p.bubbleBorderIn = QColor(0xE5, 0xE7, 0xEB);
+    p.bubbleBorderOut = QColor(0x20, 0xB8, 0xE8);
+    p.textIn = QColor(0x11, 0x18, 0x27);
+    p.textOut = QColor(0xFF, 0xFF, 0xFF);
+    p.hintIn = QColor(0x9C, 0xA3, 0xAF);
+    p.hintOut = QColor(0xE0, 0xF2, 0xFE);
+    p.detailIn = QColor(0x6B, 0x72, 0x80);
+    p.detailOut = QColor(0xE0, 0xF2, 0xFE);
+    p.metaText = QColor(0x6B, 0x72, 0x80);
+    p.avatarBg = QColor(0x20, 0xB8, 0xE8);
+    p.separatorBg = QColor(0xE5, 0xE7, 0xEB);
+    p.separatorText = QColor(0x6B, 0x72, 0x80);
+    p.fileIconBgIn = QColor(0xE0, 0xF2, 0xFE);
+    p.fileIconBgOut = QColor(0xDF, 0xF7, 0xFF);
+    p.fileIconLineIn = QColor(0x02, 0x84, 0xC7);
+    p.fileIconLineOut = QColor(0x0E, 0xA5, 0xE9);
+    p.videoPlaceholderIn = QColor(0xF3, 0xF4, 0xF6);
+    p.videoPlaceholderOut = QColor(0xDF, 0xF7, 0xFF);
+    p.videoOverlay = QColor(17, 24, 39, 80);
+    p.playIcon = QColor(0xFF, 0xFF, 0xFF);
+    p.playIconPlain = QColor(0x0E, 0xA5, 0xE9);
+    p.statusSending = QColor(0xFB, 0xBF, 0x24);
+    p.statusSent = QColor(0xE0, 0xF2, 0xFE);
+    p.statusFailed = QColor(0xFC, 0xA5, 0xA5);
+    p.errorText = QColor(0xDC, 0x26, 0x26);
+    return p;
+}
+
+} // namespace
+
+ThemeEngine& ThemeEngine::instance()
+{
+    static ThemeEngine engine;
+    return engine;
+}
+
+QString ThemeEngine::buildSheet(Root root, ApplyStyle::MainWindowTheme theme)
+{
+    switch (root) {
+    case Root::MainWindow:
+        return ApplyStyle::mainWindowStyle(theme);
+    case Root::AggregateChatForm:
+        return ApplyStyle::aggregateChatFormStyle(theme);
+    case Root::RobotAssistant: {
+        QString qss = ApplyStyle::aggregateChatFormStyle(theme);
+        qss.replace(QStringLiteral("AggregateChatForm"), QStringLiteral("RobotAssistantWidget"));
+        qss += ApplyStyle::robotAssistantExtraStyle(theme);
+        return qss;
+    }
+    }
+    return {};
+}
+
+QString ThemeEngine::styleSheet(Root root, ApplyStyle::MainWindowTheme theme)
+{
+    const int key = sheetKey(root, theme);
+    auto it = m_sheets.constFind(key);
+    if (it == m_sheets.constEnd())
+        it = m_sheets.insert(key, buildSheet(root, theme));
+    return it.value();
+}
+
+bool ThemeEngine::apply(QWidget* widget, Root root, ApplyStyle::MainWindowTheme theme)
+{
+    return applySheet(widget, QString::number(sheetKey(root, theme)), styleSheet(root, theme));
+}
+
+bool ThemeEngine::applySheet(QWidget* widget, const QString& key, const QString& qss)
+{
+    if (!widget)
+        return false;
+    const QString applied = QString::number(m_generation) + QLatin1Char(':') + key;
+    if (widget->property(kAppliedThemeProperty).toString() == applied) {
+        applyCounter(false)->increment();
+        return false;
+    }
+    {
+        Metrics::ScopedTimer timer(applyLatency());
+        widget->setStyleSheet(qss);
+    }
+    widget->setProperty(kAppliedThemeProperty, applied);
+    applyCounter(true)->increment();
+    return true;
+}
+
+ChatBubblePalette ThemeEngine::chatBubblePalette(ApplyStyle::MainWindowTheme theme)
+{
+    const int key = static_cast<int>(theme);
+    auto it = m_palettes.constFind(key);
+    if (it == m_palettes.constEnd())
+        it = m_palettes.insert(key, buildChatBubblePalette(theme));
+    return it.value();
+}
+
+void ThemeEngine::invalidate()
+{
+    m_sheets.clear();
+    m_customSheets.clear();
+    m_palettes.clear();
+    ++m_generation;
+}
@@ -0,0 +1,95 @@
+#ifndef THEMEENGINE_H
+#define THEMEENGINE_H
+
+#include "applystyle.h"
+
+#include <QColor>
+#include <QHash>
+#include <QString>
+
+class QWidget;
+
+/** 聊天气泡自绘用色；委托按主题取一份副本，paint() 中不再逐次解析颜色字符串。 */
+struct ChatBubblePalette {
+    QColor bubbleFillIn;
+    QColor bubbleFillOut;
+    QColor bubbleBorderIn;
+    QColor bubbleBorderOut;
+    QColor textIn;
+    QColor textOut;
+    QColor hintIn;
+    QColor hintOut;
+    QColor detailIn;
+    QColor detailOut;
+    QColor metaText;
+    QColor avatarBg;
+    QColor separatorBg;
+    QColor separatorText;
+    QColor fileIconBgIn;
+    QColor fileIconBgOut;
+    QColor fileIconLineIn;
+    QColor fileIconLineOut;
+    QColor videoPlaceholderIn;
+    QColor videoPlaceholderOut;
+    QColor videoOverlay;
+    QColor playIcon;
+    QColor playIconPlain;
+    QColor statusSending;
+    QColor statusSent;
+    QColor statusFailed;
+    QColor errorText;
+};
+
+/**
+ * 主题样式缓存。
+ *
+ * - styleSheet() 按 (根控件类型, 主题) 缓存 ApplyStyle 生成的 QSS，每个主题只生成一次；
+ * - apply() 只在顶层根控件上设置样式表，子控件靠选择器命中；同一根控件已是该主题时直接返回，
+ *   避免 setStyleSheet 触发整棵子树重新 polish；
+ * - chatBubblePalette() 供自绘委托使用，与样式表无关。
+ *
+ * 只在 GUI 线程使用。
+ */
+class ThemeEngine
+{
+public:
+    enum class Root {
+        MainWindow,
+        AggregateChatForm,
+        RobotAssistant,
+    };
+
+    static ThemeEngine& instance();
+
+    QString styleSheet(Root root, ApplyStyle::MainWindowTheme theme);
+    /** 返回是否真的重新设置了样式表。 */
+    bool apply(QWidget* widget, Root root, ApplyStyle::MainWindowTheme theme);
+    /** 不在枚举内的根控件（如 AI 后台窗口）：cacheKey 相同且已应用时跳过，否则调用 build 生成并缓存。 */
+    template <typename Build>
+    bool apply(QWidget* widget, const QString& cacheKey, Build build)
+    {
+        auto it = m_customSheets.constFind(cacheKey);
+        if (it == m_customSheets.constEnd())
+            it = m_customSheets.insert(cacheKey, build());
+        return applySheet(widget, cacheKey, it.value());
+    }
+
+    ChatBubblePalette chatBubblePalette(ApplyStyle::MainWindowTheme theme);
+
+    /** 丢弃所有缓存；已应用的根控件下次 apply() 会重新设置。 */
+    void invalidate();
+    int cachedSheetCount() const { return m_sheets.size() + m_customSheets.size(); }
+
+private:
+    ThemeEngine() = default;
+
+    bool applySheet(QWidget* widget, const QString& key, const QString& qss);
+    static QString buildSheet(Root root, ApplyStyle::MainWindowTheme theme);
+
+    QHash<int, QString> m_sheets;
+    QHash<QString, QString> m_customSheets;
+    QHash<int, ChatBubblePalette> m_palettes;
+    quint64 m_generation = 1;
+};
+
+#endif // THEMEENGINE_H
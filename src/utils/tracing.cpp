@@ -0,0 +1,240 @@
+#include "tracing.h"
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QFile>
+#include <QJsonDocument>
+#include <QThread>
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+
+namespace Tracing {
+
+namespace {
+
+constexpr quint64 kCapacity = 1u << 14;
+constexpr quint64 kMask = kCapacity - 1;
+
+// 顺序锁槽位：写入前把 sequence 置为奇数，写完置为偶数；
+// 读取方前后两次读到相同的偶数才认为拷贝有效，写入方从不等待。
+struct Slot {
+    std::atomic<quint64> sequence{0};
+    Event event;
+};
+
+struct Ring {
+    std::atomic<quint64> next{0};
+    Slot slots[kCapacity];
+};
+
+Ring& ring()
+{
+    static Ring* instance = new Ring(); // 进程退出时不析构，避免退出阶段的 Span 访问已销毁对象
+    return *instance;
+}
+
+std::atomic<bool>& enabledFlag()
+{
+    static std::atomic<bool> enabled{!qEnvironmentVariableIsSet("YY_TRACE_DISABLED")};
+    return enabled;
+}
+
+struct Clock {
+    QElapsedTimer monotonic;
+    qint64 epochBaseUs = 0;
+
+    Clock()
+    {
+        monotonic.start();
+        epochBaseUs = QDateTime::currentMSecsSinceEpoch() * 1000;
+    }
+};
+
+const Clock& clock()
+{
+    static const Clock instance;
+    return instance;
+}
+
+quint64 currentThreadId()
+{
+    return quint64(reinterpret_cast<quintptr>(QThread::currentThreadId()));
+}
+
+QJsonObject toChromeEvent(const Event& event, qint64 pid)
+{
+    QJsonObject obj;
+    obj.insert(QStringLiteral("name"), QString::fromLatin1(event.name));
+    obj.insert(QStringLiteral("cat"), QString::fromLatin1(event.category));
+    obj.insert(QStringLiteral("ph"), QStringLiteral("X"));
+    obj.insert(QStringLiteral("ts"), double(event.startUs));
+    obj.insert(QStringLiteral("dur"), double(event.durationUs));
+    obj.insert(QStringLiteral("pid"), double(pid));
+    obj.insert(QStringLiteral("tid"), double(event.threadId));
+    if (event.correlationId[0]) {
+        QJsonObject args;
+        args.insert(QStringLiteral("correlation_id"), QString::fromUtf8(event.correlationId));
+        obj.insert(QStringLiteral("args"), args);
+    }
+    return obj;
+}
+
+} // namespace
+
+void setEnabled(bool enabled)
+{
+    enabledFlag().store(enabled, std::memory_order_relaxed);
+}
+
+bool isEnabled()
+{
+    return enabledFlag().load(std::memory_order_relaxed);
+}
+
+qint64 nowUs()
+{
+    const Clock& c = clock();
+    return c.epochBaseUs + c.monotonic.nsecsElapsed() / 1000;
+}
+
+void record(const char* name, const char* category, qint64 startUs, qint64 durationUs, const QString& correlationId)
+{
+    if (!isEnabled() || !name)
+        return;
+
+    Ring& r = ring();
+    const quint64 ticket = r.next.fetch_add(1, std::memory_order_relaxed);
+    Slot& slot = r.slots[ticket & kMask];
+    slot.sequence.store(ticket * 2 + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    Event& event = slot.event;
+    event.name = name;
+    event.category = category ? category : "app";
+    event.startUs = startUs;
+    event.durationUs = durationUs;
+    event.threadId = currentThreadId();
+    event.correlationId[0] = '\0';
+    if (!correlationId.isEmpty()) {
+        const QByteArray utf8 = correlationId.toUtf8();
+        const int n = qMin(int(utf8.size()), kMaxCorrelationIdBytes - 1);
+        std::memcpy(event.correlationId, utf8.constData(), size_t(n));
+        event.correlationId[n] = '\0';
+    }
+
+    slot.sequence.store(ticket * 2 + 2, std::memory_order_release);
+}
+
+QVector<Event> snapshot()
+{
+    Ring& r = ring();
+    const quint64 end = r.next.load(std::memory_order_acquire);
+    const quint64 begin = end > kCapacity ? end - kCapacity : 0;
+    QVector<Event> events;
+    events.reserve(int(end - begin));
+    for (quint64 ticket = begin; ticket < end; ++ticket) {
+        const Slot& slot = r.slots[ticket & kMask];
+        const quint64 before = slot.sequence.load(std::memory_order_acquire);
+        if (before != ticket * 2 + 2)
+            continue; // 尚未写完或已被更新的记录覆盖
+        Event copy = slot.event;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.sequence.load(std::memory_order_relaxed) != before)
+            continue;
+        copy.correlationId[kMaxCorrelationIdBytes - 1] = '\0';
+        events.append(copy);
+    }
+    std::sort(events.begin(), events.end(), [](const Event& a, const Event& b) {
+        return a.startUs < b.startUs;
+    });
+    return events;
+}
+
+void clear()
+{
+    Ring& r = ring();
+    for (Slot& slot : r.slots)
+        slot.sequence.store(0, std::memory_order_relaxed);
+    r.next.store(0, std::memory_order_release);
+}
+
+QJsonArray chromeTraceEvents(const QString& correlationId)
+{
+    const qint64 pid = QCoreApplication::applicationPid();
+    const QByteArray filter = correlationId.toUtf8().left(kMaxCorrelationIdBytes - 1);
+    QJsonArray events;
+
+    QJsonObject processName;
+    processName.insert(QStringLiteral("name"), QStringLiteral("process_name"));
+    processName.insert(QStringLiteral("ph"), QStringLiteral("M"));
+    processName.insert(QStringLiteral("pid"), double(pid));
+    processName.insert(QStringLiteral("args"),
+                       QJsonObject{{QStringLiteral("name"), QStringLiteral("yy-ai-customer-service")}});
+    events.append(processName);
+
+    for (const Event& event : snapshot()) {
+        if (!filter.isEmpty() && filter != QByteArray(event.correlationId))
+            continue;
+        events.append(toChromeEvent(event, pid));
+    }
+    return events;
+}
+
+QJsonObject exportChromeTrace(const QJsonArray& extraEvents, const QString& correlationId)
+{
+    QJsonArray events = chromeTraceEvents(correlationId);
+    for (const QJsonValue& value : extraEvents)
+        events.append(value);
+    QJsonObject root;
+    root.insert(QStringLiteral("traceEvents"), events);
+    root.insert(QStringLiteral("displayTimeUnit"), QStringLiteral("ms"));
+    return root;
+}
+
+bool writeChromeTrace(const QString& path, const QJsonArray& extraEvents, QString* errorOut)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        if (errorOut)
+            *errorOut = file.errorString();
+        return false;
+    }
+    file.write(QJsonDocument(exportChromeTrace(extraEvents)).toJson(QJsonDocument::Compact));
+    return true;
+}
+
+Span::Span(const char* name, const char* category, const QString& correlationId)
+    : m_name(name)
+    , m_category(category)
+    , m_correlationId(correlationId)
+    , m_startUs(nowUs())
+{
+    m_timer.start();
+}
+
+Span::~Span()
+{
+    end();
+}
+
+qint64 Span::end()
+{
+    if (!m_ended) {
+        m_ended = true;
+        m_durationUs = m_timer.nsecsElapsed() / 1000;
+        record(m_name, m_category, m_startUs, m_durationUs, m_correlationId);
+    }
+    return m_durationUs / 1000;
+}
+
+void Span::restart(const char* name)
+{
+    end();
+    m_name = name;
+    m_ended = false;
+    m_durationUs = 0;
+    m_startUs = nowUs();
+    m_timer.restart();
+}
+
+} // namespace Tracing
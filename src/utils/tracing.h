@@ -0,0 +1,79 @@
+#ifndef TRACING_H
+#define TRACING_H
+
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QString>
+#include <QVector>
+#include <QtGlobal>
+
+/**
+ * 热路径追踪：作用域 Span 写入进程内无锁环形缓冲（写满后覆盖最旧的记录），
+ * 按需导出 Chrome / Perfetto 可读的 trace JSON。
+ *
+ * 时间戳为基于 Unix 纪元的微秒（单调时钟推算），与 Python 服务 /api/debug/trace
+ * 的输出可以直接合并到同一个文件里查看。关联 ID 沿用 client_message_id / event_id。
+ */
+namespace Tracing {
+
+constexpr int kMaxCorrelationIdBytes = 48;
+
+struct Event {
+    const char* name = nullptr;     // 必须是静态字符串
+    const char* category = nullptr; // 同上
+    qint64 startUs = 0;
+    qint64 durationUs = 0;
+    quint64 threadId = 0;
+    char correlationId[kMaxCorrelationIdBytes] = {};
+};
+
+void setEnabled(bool enabled);
+bool isEnabled();
+/** 纪元微秒；进程内单调递增。 */
+qint64 nowUs();
+void record(const char* name, const char* category, qint64 startUs, qint64 durationUs,
+            const QString& correlationId = QString());
+/** 当前缓冲区里完整写入的事件，按开始时间排序。 */
+QVector<Event> snapshot();
+void clear();
+
+/** correlationId 非空时只导出该关联 ID 的事件。 */
+QJsonArray chromeTraceEvents(const QString& correlationId = QString());
+/** {"traceEvents": [...]}；extraEvents 用于并入其他进程（Python 服务）的事件。 */
+QJsonObject exportChromeTrace(const QJsonArray& extraEvents = QJsonArray(),
+                              const QString& correlationId = QString());
+bool writeChromeTrace(const QString& path,
+                      const QJsonArray& extraEvents = QJsonArray(),
+                      QString* errorOut = nullptr);
+
+class Span
+{
+public:
+    explicit Span(const char* name, const char* category = "app", const QString& correlationId = QString());
+    ~Span();
+
+    Span(const Span&) = delete;
+    Span& operator=(const Span&) = delete;
+
+    void setCorrelationId(const QString& correlationId) { m_correlationId = correlationId; }
+    /** 替代原先的 QElapsedTimer，日志里的 xxxElapsedMs 直接取自 Span；结束后返回最终耗时。 */
+    qint64 elapsedMs() const { return m_ended ? m_durationUs / 1000 : m_timer.elapsed(); }
+    /** 提前结束并写入缓冲，返回耗时（毫秒）；析构时不再重复写入。 */
+    qint64 end();
+    /** 结束当前阶段（如未结束）并以新名称重新计时，对应原先的 stageTimer.restart()。 */
+    void restart(const char* name);
+
+private:
+    const char* m_name = nullptr;
+    const char* m_category = nullptr;
+    QString m_correlationId;
+    qint64 m_startUs = 0;
+    qint64 m_durationUs = 0;
+    QElapsedTimer m_timer;
+    bool m_ended = false;
+};
+
+} // namespace Tracing
+
+#endif // TRACING_H
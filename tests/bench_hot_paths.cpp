@@ -0,0 +1,528 @@
+#include <QtTest>
+
+#include "core/messagerouter.h"
+#include "data/conversationdao.h"
+#include "data/messagedao.h"
+#include "services/ai/openaicompatclient.h"
+#include "services/platforms/iplatformadapter.h"
+#include "testdatabase.h"
+#include "ui/conversationlistmodel.h"
+#include "ui/conversationsearch.h"
+#include "ui/messagelistmodel.h"
+#include "utils/runtimemode.h"
+
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QLoggingCategory>
+#include <QMap>
+#include <QNetworkAccessManager>
+#include <QSet>
+#include <QSignalSpy>
+#include <QSysInfo>
+
+// 热路径基准：每个用例都在 1k / 10k / 100k 条消息规模上运行。
+//
+// - YY_BENCH_MAX_MESSAGES：跳过超过该规模的数据行（ctest 注册时为 1000，完整跑需手动执行）
+// - YY_BENCH_JSON：结果 JSON 路径，默认当前目录下 yy-ai-customer-service-benchmarks.json
+//
+// QtTest 为了达到可信的测量时间可能多次调用同一用例，JSON 只保留最后被接受的那一轮。
+
+namespace {
+
+constexpr int kConversations = 50;
+
+class BenchPlatformAdapter : public IPlatformAdapter
+{
+public:
+    explicit BenchPlatformAdapter(QObject* parent = nullptr)
+        : IPlatformAdapter(parent)
+    {
+    }
+
+    QString platformName() const override { return QStringLiteral("simulator"); }
+    void connectPlatform() override { }
+    void disconnectPlatform() override { }
+    void startListening() override { }
+    void stopListening() override { }
+    void sendMessage(const QString&, const QString&, const QString&) override { }
+    bool isConnected() const override { return true; }
+
+    void emitIncoming(const PlatformMessage& msg) { emit incomingMessage(msg); }
+};
+
+int maxDatasetSize()
+{
+    bool ok = false;
+    const int limit = qEnvironmentVariableIntValue("YY_BENCH_MAX_MESSAGES", &ok);
+    return ok && limit > 0 ? limit : 100000;
+}
+
+QString resultsPath()
+{
+    const QString path = qEnvironmentVariable("YY_BENCH_JSON");
+    return path.isEmpty() ? QStringLiteral("yy-ai-customer-service-benchmarks.json") : path;
+}
+
+QMap<QString, QJsonObject>& results()
+{
+    static QMap<QString, QJsonObject> map;
+    return map;
+}
+
+void recordResult(int items, int iterations, qint64 elapsedNs)
+{
+    const QString function = QString::fromLatin1(QTest::currentTestFunction());
+    const QString dataset = QString::fromLatin1(QTest::currentDataTag());
+    const double perIterationNs = iterations > 0 ? double(elapsedNs) / iterations : 0.0;
+    QJsonObject obj;
+    obj.insert(QStringLiteral("benchmark"), function);
+    obj.insert(QStringLiteral("dataset"), dataset);
+    obj.insert(QStringLiteral("items"), items);
+    obj.insert(QStringLiteral("iterations"), iterations);
+    obj.insert(QStringLiteral("ns_per_iteration"), perIterationNs);
+    obj.insert(QStringLiteral("ns_per_item"), items > 0 ? perIterationNs / items : 0.0);
+    obj.insert(QStringLiteral("items_per_second"), perIterationNs > 0 ? items * 1e9 / perIterationNs : 0.0);
+    results().insert(function + QLatin1Char('/') + dataset, obj);
+}
+
+// body(iteration) 在 QBENCHMARK 内执行；iteration 用于生成每轮不重复的消息 ID
+template <typename Body>
+void measure(int items, Body body)
+{
+    int iterations = 0;
+    QElapsedTimer timer;
+    timer.start();
+    QBENCHMARK {
+        body(iterations);
+        ++iterations;
+    }
+    recordResult(items, iterations, timer.nsecsElapsed());
+}
+
+void addDatasetRows()
+{
+    QTest::addColumn<int>("messages");
+    QTest::newRow("1k") << 1000;
+    QTest::newRow("10k") << 10000;
+    QTest::newRow("100k") << 100000;
+}
+
+QVector<int> createConversations(int count)
+{
+    ConversationDao dao;
+    QVector<int> ids;
+    ids.reserve(count);
+    for (int i = 0; i < count; ++i)
+        ids.append(dao.create(QStringLiteral("simulator"),
+                              QStringLiteral("bench_conv_%1").arg(i),
+                              QStringLiteral("基准买家%1").arg(i)));
+    return ids;
+}
+
+QJsonObject snapshotMessage(const QString& platformMsgId, int seq)
+{
+    QJsonObject message;
+    message.insert(QStringLiteral("platform_msg_id"), platformMsgId);
+    message.insert(QStringLiteral("direction"), seq % 3 == 0 ? QStringLiteral("out") : QStringLiteral("in"));
+    message.insert(QStringLiteral("content"), QStringLiteral("请问这款还有货吗？第 %1 条").arg(seq));
+    message.insert(QStringLiteral("content_type"), QStringLiteral("text"));
+    message.insert(QStringLiteral("status"), QStringLiteral("sent"));
+    message.insert(QStringLiteral("created_at"),
+                   QDateTime(QDate(2026, 1, 1), QTime(9, 0)).addSecs(seq).toString(Qt::ISODate));
+    return message;
+}
+
+// 与 AggregateChatForm::applyCacheSnapshotToLocalCache 相同的 DAO 调用序列（不含平台扩展表）
+int applySnapshot(const QJsonArray& conversations)
+{
+    ConversationDao conversationDao;
+    MessageDao messageDao;
+    int applied = 0;
+    for (const QJsonValue& value : conversations) {
+        const QJsonObject conversation = value.toObject();
+        const int conversationId = conversationDao.upsertSnapshotCacheConversation(conversation);
+        if (conversationId <= 0)
+            continue;
+        const QJsonArray messages = conversation.value(QStringLiteral("messages")).toArray();
+        QSet<QString> keepPlatformMessageIds;
+        for (const QJsonValue& messageValue : messages)
+            keepPlatformMessageIds.insert(messageValue.toObject().value(QStringLiteral("platform_msg_id")).toString());
+        messageDao.deleteMissingSnapshotCacheMessages(conversationId, keepPlatformMessageIds, {});
+        for (const QJsonValue& messageValue : messages) {
+            if (messageDao.upsertSnapshotCacheMessage(conversationId, messageValue.toObject()) > 0)
+                ++applied;
+        }
+    }
+    return applied;
+}
+
+} // namespace
+
+class BenchHotPaths : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void routerIncomingMessage_data();
+    void routerIncomingMessage();
+    void upsertSnapshotCacheMessage_data();
+    void upsertSnapshotCacheMessage();
+    void applyCacheSnapshot_data();
+    void applyCacheSnapshot();
+    void conversationListModel_setSourceAndFilter_data();
+    void conversationListModel_setSourceAndFilter();
+    void conversationSearch_typing_data();
+    void conversationSearch_typing();
+    void messageListModel_setConversationMessages_data();
+    void messageListModel_setConversationMessages();
+    void messageListModel_statusTick_data();
+    void messageListModel_statusTick();
+    void sseParsing_data();
+    void sseParsing();
+};
+
+void BenchHotPaths::initTestCase()
+{
+    qRegisterMetaType<ConversationInfo>("ConversationInfo");
+    qRegisterMetaType<MessageRecord>("MessageRecord");
+    qRegisterMetaType<Models::Message>("Models::Message");
+    // 路由与 DAO 每条消息都会打日志，基准里只测业务路径本身
+    QLoggingCategory::setFilterRules(QStringLiteral("default.debug=false\ndefault.info=false"));
+    RuntimeMode::setLocalCacheIngestOverride(true);
+    results().clear();
+}
+
+void BenchHotPaths::cleanupTestCase()
+{
+    RuntimeMode::setLocalCacheIngestOverride(false);
+    QLoggingCategory::setFilterRules(QString());
+
+    QJsonObject root;
+    root.insert(QStringLiteral("suite"), QStringLiteral("yy_ai_customer_service_benchmarks"));
+    root.insert(QStringLiteral("generated_at"), QDateTime::currentDateTimeUtc().toString(Qt::ISODate));
+    root.insert(QStringLiteral("qt_version"), QString::fromLatin1(qVersion()));
+    root.insert(QStringLiteral("cpu_arch"), QSysInfo::currentCpuArchitecture());
+    root.insert(QStringLiteral("os"), QSysInfo::prettyProductName());
+#ifdef QT_DEBUG
+    root.insert(QStringLiteral("build"), QStringLiteral("debug"));
+#else
+    root.insert(QStringLiteral("build"), QStringLiteral("release"));
+#endif
+    root.insert(QStringLiteral("max_messages"), maxDatasetSize());
+    QJsonArray entries;
+    for (const QJsonObject& obj : results())
+        entries.append(obj);
+    root.insert(QStringLiteral("results"), entries);
+
+    QFile file(resultsPath());
+    QVERIFY2(file.open(QIODevice::WriteOnly | QIODevice::Truncate), qPrintable(file.errorString()));
+    file.write(QJsonDocument(root).toJson(QJsonDocument::Indented));
+    qInfo().noquote() << QStringLiteral("benchmark results written to %1").arg(file.fileName());
+}
+
+void BenchHotPaths::routerIncomingMessage_data()
+{
+    addDatasetRows();
+}
+
+void BenchHotPaths::routerIncomingMessage()
+{
+    QFETCH(int, messages);
+    if (messages > maxDatasetSize())
+        QSKIP("dataset larger than YY_BENCH_MAX_MESSAGES");
+
+    ScopedTestDatabase db;
+    Q_UNUSED(db);
+    MessageRouter router;
+    BenchPlatformAdapter adapter;
+    router.registerAdapter(&adapter);
+
+    QVector<PlatformMessage> batch(messages);
+    for (int i = 0; i < messages; ++i) {
+        PlatformMessage& msg = batch[i];
+        msg.platform = adapter.platformName();
+        msg.platformConversationId = QStringLiteral("bench_conv_%1").arg(i % kConversations);
+        msg.customerName = QStringLiteral("基准买家%1").arg(i % kConversations);
+        msg.content = QStringLiteral("请问这款还有货吗？第 %1 条").arg(i);
+        msg.direction = QStringLiteral("in");
+        msg.sender = QStringLiteral("customer");
+        msg.createdAt = QDateTime(QDate(2026, 1, 1), QTime(9, 0)).addSecs(i);
+        msg.sourceType = QStringLiteral("ui_observed");
+    }
+
+    measure(messages, [&](int iteration) {
+        const QString prefix = QStringLiteral("bench-%1-").arg(iteration);
+        for (int i = 0; i < messages; ++i) {
+            batch[i].platformMsgId = prefix + QString::number(i);
+            adapter.emitIncoming(batch[i]);
+        }
+    });
+}
+
+void BenchHotPaths::upsertSnapshotCacheMessage_data()
+{
+    addDatasetRows();
+}
+
+void BenchHotPaths::upsertSnapshotCacheMessage()
+{
+    QFETCH(int, messages);
+    if (messages > maxDatasetSize())
+        QSKIP("dataset larger than YY_BENCH_MAX_MESSAGES");
+
+    ScopedTestDatabase db;
+    Q_UNUSED(db);
+    const QVector<int> conversationIds = createConversations(kConversations);
+
+    QVector<QJsonObject> payloads;
+    payloads.reserve(messages);
+    for (int i = 0; i < messages; ++i)
+        payloads.append(snapshotMessage(QString(), i));
+
+    MessageDao dao;
+    measure(messages, [&](int iteration) {
+        const QString prefix = QStringLiteral("snap-%1-").arg(iteration);
+        for (int i = 0; i < messages; ++i) {
+            QJsonObject& payload = payloads[i];
+            payload.insert(QStringLiteral("platform_msg_id"), prefix + QString::number(i));
+            dao.upsertSnapshotCacheMessage(conversationIds.at(i % kConversations), payload);
+        }
+    });
+}
+
+void BenchHotPaths::applyCacheSnapshot_data()
+{
+    addDatasetRows();
+}
+
+void BenchHotPaths::applyCacheSnapshot()
+{
+    QFETCH(int, messages);
+    if (messages > maxDatasetSize())
+        QSKIP("dataset larger than YY_BENCH_MAX_MESSAGES");
+
+    ScopedTestDatabase db;
+    Q_UNUSED(db);
+
+    QVector<QJsonArray> perConversation(kConversations);
+    for (int i = 0; i < messages; ++i)
+        perConversation[i % kConversations].append(snapshotMessage(QStringLiteral("snap-%1").arg(i), i));
+    QJsonArray conversations;
+    for (int c = 0; c < kConversations; ++c) {
+        QJsonObject conversation;
+        conversation.insert(QStringLiteral("platform"), QStringLiteral("simulator"));
+        conversation.insert(QStringLiteral("platform_conversation_id"), QStringLiteral("bench_conv_%1").arg(c));
+        conversation.insert(QStringLiteral("customer_name"), QStringLiteral("基准买家%1").arg(c));
+        conversation.insert(QStringLiteral("last_message"), QStringLiteral("最后一条"));
+        conversation.insert(QStringLiteral("messages"), perConversation.at(c));
+        conversations.append(conversation);
+    }
+
+    // 第一轮为插入，之后为同一快照的重复刷新（更新路径），与客户端周期性拉取一致
+    int applied = 0;
+    measure(messages, [&](int) {
+        applied = applySnapshot(conversations);
+    });
+    QCOMPARE(applied, messages);
+}
+
+void BenchHotPaths::conversationListModel_setSourceAndFilter_data()
+{
+    addDatasetRows();
+}
+
+void BenchHotPaths::conversationListModel_setSourceAndFilter()
+{
+    QFETCH(int, messages);
+    if (messages > maxDatasetSize())
+        QSKIP("dataset larger than YY_BENCH_MAX_MESSAGES");
+
+    // 每个会话对应列表中的一行；规模与消息数相同，用于观察排序/过滤的伸缩性
+    QVector<ConversationInfo> conversations;
+    QHash<int, QString> lastDirections;
+    conversations.reserve(messages);
+    const QDateTime base(QDate(2026, 1, 1), QTime(9, 0));
+    for (int i = 0; i < messages; ++i) {
+        ConversationInfo conv;
+        conv.id = i + 1;
+        conv.platform = i % 2 ? QStringLiteral("wechat") : QStringLiteral("qianniu");
+        conv.platformConversationId = QStringLiteral("bench_conv_%1").arg(i);
+        conv.customerName = QStringLiteral("基准买家%1").arg(i);
+        conv.lastMessage = QStringLiteral("请问这款还有货吗？第 %1 条").arg(i);
+        conv.lastTime = base.addSecs((i * 7919) % messages);
+        conv.updatedAt = conv.lastTime;
+        conversations.append(conv);
+        lastDirections.insert(conv.id, i % 3 ? QStringLiteral("in") : QStringLiteral("out"));
+    }
+
+    ConversationListModel model;
+    measure(messages, [&](int) {
+        model.setSourceConversations(conversations, lastDirections);
+        model.setFilters(1, 0, QStringLiteral("买家1"), -1);
+    });
+    QVERIFY(model.rowCount() > 0);
+}
+
+void BenchHotPaths::conversationSearch_typing_data()
+{
+    addDatasetRows();
+}
+
+void BenchHotPaths::conversationSearch_typing()
+{
+    QFETCH(int, messages);
+    if (messages > maxDatasetSize())
+        QSKIP("dataset larger than YY_BENCH_MAX_MESSAGES");
+
+    static const QString kSurnames = QStringLiteral("张王李赵刘陈杨黄周吴曾单");
+    static const QString kGivenNames = QStringLiteral("伟芳娜敏静丽强磊军洋勇艳杰娟涛明超秀霞平");
+    QVector<ConversationInfo> conversations;
+    conversations.reserve(messages);
+    for (int i = 0; i < messages; ++i) {
+        ConversationInfo conv;
+        conv.id = i + 1;
+        conv.platform = QStringLiteral("wechat");
+        conv.platformConversationId = QStringLiteral("bench_conv_%1").arg(i);
+        conv.customerName = QString(kSurnames.at(i % kSurnames.size()))
+                            + kGivenNames.at((i / kSurnames.size()) % kGivenNames.size())
+                            + kGivenNames.at((i / 7) % kGivenNames.size());
+        conv.lastMessage = QStringLiteral("请问这款还有货吗？第 %1 条").arg(i);
+        conversations.append(conv);
+    }
+
+    ConversationSearch search;
+    QSignalSpy ready(&search, &ConversationSearch::resultsReady);
+    search.setConversations(conversations);
+    QTest::qWait(0);
+
+    // 一轮是逐字输入 "zhangw"：首字母后台全量匹配（含 kDebounceMs 合并等待），
+    // 结果不超过 kSyncNarrowLimit 后的按键在 GUI 线程同步收窄
+    const QStringList keystrokes{QStringLiteral("z"), QStringLiteral("zh"), QStringLiteral("zha"),
+                                 QStringLiteral("zhan"), QStringLiteral("zhang"), QStringLiteral("zhangw")};
+    int matched = 0;
+    measure(messages, [&](int) {
+        for (const QString& text : keystrokes) {
+            search.setQuery(text);
+            if (search.isPending())
+                QVERIFY(ready.wait(5000));
+        }
+        matched = search.matches().size();
+        search.setQuery(QString());
+    });
+    QVERIFY(matched > 0);
+}
+
+void BenchHotPaths::messageListModel_setConversationMessages_data()
+{
+    addDatasetRows();
+}
+
+void BenchHotPaths::messageListModel_setConversationMessages()
+{
+    QFETCH(int, messages);
+    if (messages > maxDatasetSize())
+        QSKIP("dataset larger than YY_BENCH_MAX_MESSAGES");
+
+    QVector<MessageRecord> records;
+    records.reserve(messages);
+    const QDateTime base(QDate(2026, 1, 1), QTime(9, 0));
+    for (int i = 0; i < messages; ++i) {
+        MessageRecord rec;
+        rec.id = i + 1;
+        rec.conversationId = 1;
+        rec.direction = i % 3 ? QStringLiteral("in") : QStringLiteral("out");
+        rec.sender = i % 3 ? QStringLiteral("customer") : QStringLiteral("agent");
+        rec.content = QStringLiteral("请问这款还有货吗？第 %1 条").arg(i);
+        rec.platformMsgId = QStringLiteral("bench-%1").arg(i);
+        // 约 30 天跨度，带出日期分隔行
+        rec.createdAt = base.addSecs(qint64(i) * 30 * 86400 / messages);
+        records.append(rec);
+    }
+
+    MessageListModel model;
+    measure(messages, [&](int iteration) {
+        // 交替会话 ID，避免模型对同一会话做短路
+        model.setConversationMessages(1 + (iteration % 2), records);
+    });
+    QVERIFY(model.rowCount() >= messages);
+}
+
+void BenchHotPaths::messageListModel_statusTick_data()
+{
+    addDatasetRows();
+}
+
+void BenchHotPaths::messageListModel_statusTick()
+{
+    QFETCH(int, messages);
+    if (messages > maxDatasetSize())
+        QSKIP("dataset larger than YY_BENCH_MAX_MESSAGES");
+
+    QVector<MessageRecord> records;
+    records.reserve(messages);
+    const QDateTime base(QDate(2026, 1, 1), QTime(9, 0));
+    for (int i = 0; i < messages; ++i) {
+        MessageRecord rec;
+        rec.id = i + 1;
+        rec.conversationId = 1;
+        rec.direction = QStringLiteral("out");
+        rec.sender = QStringLiteral("agent");
+        rec.content = QStringLiteral("回复第 %1 条").arg(i);
+        rec.createdAt = base.addSecs(qint64(i) * 30 * 86400 / messages);
+        records.append(rec);
+    }
+
+    MessageListModel model;
+    model.setConversationMessages(1, records);
+    // 每轮一次发送回执加一条新消息，耗时应与会话已有消息数无关
+    measure(1, [&](int iteration) {
+        const int id = 1 + (iteration * 7919) % messages;
+        model.updateMessageStatus(id, iteration % 2 ? Models::MessageStatus::Sent : Models::MessageStatus::Pending);
+        MessageRecord rec = records.constLast();
+        rec.id = messages + iteration + 1;
+        model.appendMessage(rec);
+    });
+    QVERIFY(model.rowCount() > messages);
+}
+
+void BenchHotPaths::sseParsing_data()
+{
+    addDatasetRows();
+}
+
+void BenchHotPaths::sseParsing()
+{
+    QFETCH(int, messages);
+    if (messages > maxDatasetSize())
+        QSKIP("dataset larger than YY_BENCH_MAX_MESSAGES");
+
+    // 每条消息对应一个 SSE 增量包，夹杂 keep-alive 与空行
+    QByteArray stream;
+    for (int i = 0; i < messages; ++i) {
+        if (i % 50 == 0)
+            stream += ": keep-alive\n";
+        stream += "data: {\"choices\":[{\"delta\":{\"content\":\"你好，第";
+        stream += QByteArray::number(i);
+        stream += "段\"}}]}\n\n";
+    }
+    stream += "data: [DONE]\n";
+
+    QNetworkAccessManager nam;
+    OpenAiCompatClient client(&nam);
+    int deltas = 0;
+    connect(&client, &OpenAiCompatClient::streamDelta, this, [&deltas](const QString&) { ++deltas; });
+
+    measure(messages, [&](int) {
+        client.m_sseBuffer = stream;
+        client.processSseBuffer();
+    });
+    QVERIFY(client.m_sseBuffer.isEmpty());
+    QVERIFY(deltas >= messages);
+}
+
+QTEST_MAIN(BenchHotPaths)
+#include "bench_hot_paths.moc"
@@ -0,0 +1,313 @@
+#include <QtTest>
+
+#include "utils/applystyle.h"
+#include "utils/themeengine.h"
+
+#include <QFile>
+#include <QFrame>
+#include <QHBoxLayout>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QLabel>
+#include <QLineEdit>
+#include <QListWidget>
+#include <QMap>
+#include <QPlainTextEdit>
+#include <QPushButton>
+#include <QScrollArea>
+#include <QSysInfo>
+#include <QToolButton>
+#include <QVBoxLayout>
+
+// 主题基准：对比改造前（每次重新生成 QSS、构造后再 applyTheme 一次、附件卡片逐个 setStyleSheet）
+// 与 ThemeEngine（按主题缓存 QSS、只设在根控件上、主题未变时跳过）在窗口创建和主题切换上的耗时。
+//
+// - YY_BENCH_JSON：结果 JSON 路径，默认当前目录下 yy-ai-customer-service-theme-benchmarks.json
+
+// 与真实窗体同名，让 QSS 中的类型选择器按原样命中
+class AggregateChatForm : public QWidget
+{
+    Q_OBJECT
+public:
+    using QWidget::QWidget;
+};
+
+namespace {
+
+constexpr int kConversationRows = 60;
+constexpr int kMessageBubbles = 40;
+constexpr int kAttachmentCards = 6;
+
+QString resultsPath()
+{
+    const QString path = qEnvironmentVariable("YY_BENCH_JSON");
+    return path.isEmpty() ? QStringLiteral("yy-ai-customer-service-theme-benchmarks.json") : path;
+}
+
+QMap<QString, QJsonObject>& results()
+{
+    static QMap<QString, QJsonObject> map;
+    return map;
+}
+
+template <typename Body>
+void measure(Body body)
+{
+    int iterations = 0;
+    QElapsedTimer timer;
+    timer.start();
+    QBENCHMARK {
+        body();
+        ++iterations;
+    }
+    const qint64 elapsedNs = timer.nsecsElapsed();
+    const QString function = QString::fromLatin1(QTest::currentTestFunction());
+    const QString variant = QString::fromLatin1(QTest::currentDataTag());
+    QJsonObject obj;
+    obj.insert(QStringLiteral("benchmark"), function);
+    obj.insert(QStringLiteral("variant"), variant);
+    obj.insert(QStringLiteral("iterations"), iterations);
+    obj.insert(QStringLiteral("ns_per_iteration"), iterations > 0 ? double(elapsedNs) / iterations : 0.0);
+    results().insert(function + QLatin1Char('/') + variant, obj);
+}
+
+QWidget* labeled(QWidget* parent, const QString& objectName, const QString& text)
+{
+    auto* label = new QLabel(text, parent);
+    label->setObjectName(objectName);
+    return label;
+}
+
+/** 改造前附件卡片各自带样式表。 */
+void addAttachmentCard(QWidget* parent, QLayout* layout, bool perWidgetStyle)
+{
+    auto* card = new QFrame(parent);
+    card->setObjectName(QStringLiteral("composeAttachmentCard"));
+    auto* row = new QHBoxLayout(card);
+    auto* thumb = new QLabel(QStringLiteral("图片"), card);
+    thumb->setObjectName(QStringLiteral("composeAttachmentThumb"));
+    auto* title = new QLabel(QStringLiteral("order.pdf"), card);
+    title->setObjectName(QStringLiteral("composeAttachmentTitle"));
+    auto* removeBtn = new QToolButton(card);
+    removeBtn->setObjectName(QStringLiteral("composeAttachmentRemoveBtn"));
+    if (perWidgetStyle) {
+        card->setStyleSheet(QStringLiteral(
+            "QFrame#composeAttachmentCard{background:#F8FAFC;border:1px solid #D9E2EC;border-radius:6px;}"));
+        thumb->setStyleSheet(QStringLiteral("background:#E5E7EB;border-radius:4px;color:#334155;font-size:12px;"));
+        title->setStyleSheet(QStringLiteral("color:#0F172A;font-size:12px;"));
+        removeBtn->setStyleSheet(QStringLiteral(
+            "QToolButton{background:#E2E8F0;border:1px solid #CBD5E1;border-radius:11px;color:#334155;}"
+            "QToolButton:hover{background:#FEE2E2;border-color:#FCA5A5;color:#B91C1C;}"));
+    }
+    row->addWidget(thumb);
+    row->addWidget(title, 1);
+    row->addWidget(removeBtn);
+    layout->addWidget(card);
+}
+
+/** 与聚合接待页同量级的控件树：会话列表、消息气泡、输入区、右侧信息栏。 */
+AggregateChatForm* buildForm(bool perWidgetStyle)
+{
+    auto* form = new AggregateChatForm;
+    auto* outer = new QHBoxLayout(form);
+
+    auto* left = new QWidget(form);
+    auto* leftLayout = new QVBoxLayout(left);
+    for (int i = 0; i < 8; ++i) {
+        auto* button = new QToolButton(left);
+        button->setObjectName(QStringLiteral("aggregateToolBarButton"));
+        leftLayout->addWidget(button);
+    }
+    auto* search = new QLineEdit(left);
+    search->setObjectName(QStringLiteral("aggregateSearchEdit"));
+    leftLayout->addWidget(search);
+    auto* list = new QListWidget(left);
+    for (int i = 0; i < kConversationRows; ++i) {
+        auto* item = new QWidget;
+        item->setObjectName(QStringLiteral("convItemWidget"));
+        auto* itemLayout = new QVBoxLayout(item);
+        itemLayout->addWidget(labeled(item, QStringLiteral("convItemName"), QStringLiteral("买家%1").arg(i)));
+        itemLayout->addWidget(labeled(item, QStringLiteral("convItemPreview"), QStringLiteral("请问还有货吗")));
+        itemLayout->addWidget(labeled(item, QStringLiteral("unreadBadge"), QStringLiteral("3")));
+        auto* row = new QListWidgetItem(list);
+        list->setItemWidget(row, item);
+    }
+    leftLayout->addWidget(list, 1);
+    outer->addWidget(left);
+
+    auto* chatArea = new QWidget(form);
+    chatArea->setObjectName(QStringLiteral("chatArea"));
+    auto* chatLayout = new QVBoxLayout(chatArea);
+    chatLayout->addWidget(labeled(chatArea, QStringLiteral("chatHeaderTitle"), QStringLiteral("买家0")));
+    for (int i = 0; i < kMessageBubbles; ++i) {
+        const bool out = i % 2 == 0;
+        auto* bubble = new QFrame(chatArea);
+        bubble->setObjectName(out ? QStringLiteral("bubbleOut") : QStringLiteral("bubbleIn"));
+        auto* bubbleLayout = new QVBoxLayout(bubble);
+        bubbleLayout->addWidget(labeled(bubble, out ? QStringLiteral("bubbleTextOut") : QStringLiteral("bubbleTextIn"),
+                                        QStringLiteral("第 %1 条消息").arg(i)));
+        bubbleLayout->addWidget(labeled(bubble, out ? QStringLiteral("bubbleMetaOut") : QStringLiteral("bubbleMetaIn"),
+                                        QStringLiteral("09:%1").arg(i, 2, 10, QLatin1Char('0'))));
+        chatLayout->addWidget(bubble);
+    }
+    auto* inputPanel = new QWidget(chatArea);
+    inputPanel->setObjectName(QStringLiteral("aggregateChatInputPanel"));
+    auto* inputLayout = new QVBoxLayout(inputPanel);
+    auto* attachments = new QWidget(inputPanel);
+    attachments->setObjectName(QStringLiteral("composeAttachmentsWidget"));
+    auto* attachmentsLayout = new QHBoxLayout(attachments);
+    for (int i = 0; i < kAttachmentCards; ++i)
+        addAttachmentCard(attachments, attachmentsLayout, perWidgetStyle);
+    inputLayout->addWidget(attachments);
+    inputLayout->addWidget(new QPlainTextEdit(inputPanel));
+    auto* send = new QPushButton(QStringLiteral("发送"), inputPanel);
+    send->setObjectName(QStringLiteral("aggregateSendButton"));
+    inputLayout->addWidget(send);
+    chatLayout->addWidget(inputPanel);
+    outer->addWidget(chatArea, 1);
+
+    auto* right = new QScrollArea(form);
+    auto* rightContent = new QWidget;
+    auto* rightLayout = new QVBoxLayout(rightContent);
+    for (int i = 0; i < 24; ++i)
+        rightLayout->addWidget(labeled(rightContent, QStringLiteral("aggregateRightValue"), QStringLiteral("字段%1").arg(i)));
+    right->setWidget(rightContent);
+    outer->addWidget(right);
+    return form;
+}
+
+/** 改造前：setupStyles + MainWindow 打开窗口后的 applyTheme，两次都重新生成并设置整段 QSS。 */
+void legacyApply(QWidget* form)
+{
+    form->setStyleSheet(ApplyStyle::aggregateChatFormStyle());
+}
+
+void engineApply(QWidget* form)
+{
+    ThemeEngine::instance().apply(form, ThemeEngine::Root::AggregateChatForm, ApplyStyle::MainWindowTheme::Default);
+}
+
+} // namespace
+
+class BenchThemeSwitch : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void styleSheetGeneration_data();
+    void styleSheetGeneration();
+    void windowCreation_data();
+    void windowCreation();
+    void themeSwitch_data();
+    void themeSwitch();
+};
+
+void BenchThemeSwitch::initTestCase()
+{
+    results().clear();
+}
+
+void BenchThemeSwitch::cleanupTestCase()
+{
+    QJsonObject root;
+    root.insert(QStringLiteral("suite"), QStringLiteral("yy_ai_customer_service_theme_benchmarks"));
+    root.insert(QStringLiteral("generated_at"), QDateTime::currentDateTimeUtc().toString(Qt::ISODate));
+    root.insert(QStringLiteral("qt_version"), QString::fromLatin1(qVersion()));
+    root.insert(QStringLiteral("cpu_arch"), QSysInfo::currentCpuArchitecture());
+    root.insert(QStringLiteral("os"), QSysInfo::prettyProductName());
+    QJsonArray entries;
+    for (const QJsonObject& obj : results())
+        entries.append(obj);
+    root.insert(QStringLiteral("results"), entries);
+
+    QFile file(resultsPath());
+    QVERIFY2(file.open(QIODevice::WriteOnly | QIODevice::Truncate), qPrintable(file.errorString()));
+    file.write(QJsonDocument(root).toJson(QJsonDocument::Indented));
+    qInfo().noquote() << QStringLiteral("benchmark results written to %1").arg(file.fileName());
+}
+
+void BenchThemeSwitch::styleSheetGeneration_data()
+{
+    QTest::addColumn<bool>("cached");
+    QTest::newRow("legacy") << false;
+    QTest::newRow("engine") << true;
+}
+
+void BenchThemeSwitch::styleSheetGeneration()
+{
+    QFETCH(bool, cached);
+    ThemeEngine::instance().invalidate();
+    qsizetype length = 0;
+    measure([&]() {
+        const QString qss = cached
+            ? ThemeEngine::instance().styleSheet(ThemeEngine::Root::AggregateChatForm, ApplyStyle::MainWindowTheme::Default)
+            : ApplyStyle::aggregateChatFormStyle();
+        length += qss.size();
+    });
+    QVERIFY(length > 0);
+}
+
+void BenchThemeSwitch::windowCreation_data()
+{
+    QTest::addColumn<bool>("engine");
+    QTest::newRow("legacy") << false;
+    QTest::newRow("engine") << true;
+}
+
+void BenchThemeSwitch::windowCreation()
+{
+    QFETCH(bool, engine);
+    ThemeEngine::instance().invalidate();
+    measure([&]() {
+        QScopedPointer<AggregateChatForm> form(buildForm(!engine));
+        if (engine) {
+            engineApply(form.data());
+            form->ensurePolished();
+            engineApply(form.data());
+        } else {
+            legacyApply(form.data());
+            form->ensurePolished();
+            legacyApply(form.data());
+        }
+    });
+}
+
+void BenchThemeSwitch::themeSwitch_data()
+{
+    QTest::addColumn<QString>("mode");
+    QTest::newRow("legacy") << QStringLiteral("legacy");
+    // 主题确实变化：两份已缓存的样式表交替设置，只剩 polish 本身的开销
+    QTest::newRow("engine_changed") << QStringLiteral("engine_changed");
+    QTest::newRow("engine_unchanged") << QStringLiteral("engine_unchanged");
+}
+
+void BenchThemeSwitch::themeSwitch()
+{
+    QFETCH(QString, mode);
+    ThemeEngine& themes = ThemeEngine::instance();
+    themes.invalidate();
+    QScopedPointer<AggregateChatForm> form(buildForm(mode == QLatin1String("legacy")));
+    form->ensurePolished();
+    bool flip = false;
+    measure([&]() {
+        if (mode == QLatin1String("legacy")) {
+            legacyApply(form.data());
+        } else if (mode == QLatin1String("engine_changed")) {
+            flip = !flip;
+            themes.apply(form.data(),
+                         flip ? ThemeEngine::Root::RobotAssistant : ThemeEngine::Root::AggregateChatForm,
+                         ApplyStyle::MainWindowTheme::Default);
+        } else {
+            engineApply(form.data());
+        }
+    });
+    QVERIFY(!form->styleSheet().isEmpty());
+    if (mode == QLatin1String("engine_unchanged"))
+        QVERIFY(!themes.apply(form.data(), ThemeEngine::Root::AggregateChatForm, ApplyStyle::MainWindowTheme::Default));
+}
+
+QTEST_MAIN(BenchThemeSwitch)
+#include "bench_theme_switch.moc"
@@ -1,5 +1,6 @@
 #include <QtTest>
 
+#include "services/ai/aicontextassembler.h"
 #include "services/ai/aiprovidercatalog.h"
 #include "services/ai/airequestassembler.h"
 #include "services/ai/aiservicefacade.h"
@@ -9,6 +10,51 @@
 #include <QNetworkAccessManager>
 #include <QTemporaryDir>
 
+namespace {
+
+class FakeAiSession : public IAiStreamingSession
+{
+public:
+    using IAiStreamingSession::IAiStreamingSession;
+
+    void start() override { ++startCount; }
+    void abort() override { ++abortCount; }
+
+    int startCount = 0;
+    int abortCount = 0;
+};
+
+QList<AiContextHistoryTurn> makeHistory(int count, int charsPerTurn)
+{
+    QList<AiContextHistoryTurn> history;
+    for (int i = 0; i < count; ++i) {
+        AiContextHistoryTurn entry;
+        entry.turn = makeAiTextTurn(i % 2 == 0 ? QStringLiteral("user") : QStringLiteral("assistant"),
+                                    QStringLiteral("第%1条").arg(i) + QString(charsPerTurn, QChar(0x597D)));
+        entry.ordinal = i;
+        history.append(entry);
+    }
+    return history;
+}
+
+QStringList turnTexts(const QList<AiConversationTurn>& turns)
+{
+    QStringList texts;
+    for (const AiConversationTurn& turn : turns)
+        texts.append(turn.role + QLatin1Char('|') + plainTextForAiTurn(turn));
+    return texts;
+}
+
+QStringList reportedStages(const QSignalSpy& spy)
+{
+    QStringList stages;
+    for (const QList<QVariant>& args : spy)
+        stages.append(args.at(0).toString());
+    return stages;
+}
+
+} // namespace
+
 class TestAiAbstractions : public QObject
 {
     Q_OBJECT
@@ -18,6 +64,13 @@ private slots:
     void buildChatMessages_supportsMultimodalUserTurn();
     void buildArkFileRequestData_projectsHistoryAndAttachment();
     void serviceFacade_routesRequestsByCapabilities();
+    void hedgedSession_firesBackupAndAbortsLoser();
+    void hedgedSession_failsOverWhenPrimaryFailsBeforeFirstToken();
+    void estimateAiTokens_countsCjkAndLatinSeparately();
+    void assembleAiContext_keepsShortHistoryIntact();
+    void assembleAiContext_fitsBudgetWithStablePrefix();
+    void assembleAiContext_prefixSurvivesFetchWindowSliding();
+    void assembleAiContextOldestFirst_sendsOnlyWholeLeadingTurns();
 };
 
 void TestAiAbstractions::presetDefinition_exposesCapabilities()
@@ -165,5 +218,182 @@ void TestAiAbstractions::serviceFacade_routesRequestsByCapabilities()
     rejectedSession->deleteLater();
 }
 
+void TestAiAbstractions::hedgedSession_firesBackupAndAbortsLoser()
+{
+    auto* primary = new FakeAiSession;
+    auto* backup = new FakeAiSession;
+    HedgedAiSession hedged(primary, backup, 20, QStringLiteral("DeepSeek"), QStringLiteral("豆包"));
+    QSignalSpy stageSpy(&hedged, &IAiStreamingSession::stageReported);
+    QSignalSpy deltaSpy(&hedged, &IAiStreamingSession::delta);
+    QSignalSpy completedSpy(&hedged, &IAiStreamingSession::completed);
+    QSignalSpy resolvedSpy(&hedged, &IAiStreamingSession::hedgeResolved);
+
+    hedged.start();
+    QCOMPARE(primary->startCount, 1);
+    QCOMPARE(backup->startCount, 0);
+    QTRY_COMPARE(backup->startCount, 1);
+
+    emit backup->delta(QStringLiteral("您好"));
+    emit primary->delta(QStringLiteral("迟到的主模型输出"));
+    QCOMPARE(deltaSpy.count(), 1);
+    QCOMPARE(deltaSpy.at(0).at(0).toString(), QStringLiteral("您好"));
+    QVERIFY(primary->abortCount >= 1);
+    // 备用胜出：调用方要据此改记模型，并以备用的启动时刻扣减首字耗时。
+    QCOMPARE(resolvedSpy.count(), 1);
+    QCOMPARE(resolvedSpy.at(0).at(0).toBool(), true);
+    QVERIFY(resolvedSpy.at(0).at(1).toInt() > 0);
+    // 被中止的主模型至少等了整个对冲延迟，这段时长要作为截尾样本记给主模型。
+    QVERIFY(resolvedSpy.at(0).at(2).toInt() >= resolvedSpy.at(0).at(1).toInt());
+
+    emit backup->completed();
+    QCOMPARE(completedSpy.count(), 1);
+
+    const QStringList stages = reportedStages(stageSpy);
+    QVERIFY(stages.contains(QStringLiteral("hedge_armed")));
+    QVERIFY(stages.contains(QStringLiteral("hedge_fired")));
+    QVERIFY(stages.contains(QStringLiteral("hedge_won")));
+}
+
+void TestAiAbstractions::hedgedSession_failsOverWhenPrimaryFailsBeforeFirstToken()
+{
+    auto* primary = new FakeAiSession;
+    auto* backup = new FakeAiSession;
+    HedgedAiSession hedged(primary, backup, 60000, QStringLiteral("DeepSeek"), QStringLiteral("豆包"));
+    QSignalSpy stageSpy(&hedged, &IAiStreamingSession::stageReported);
+    QSignalSpy failedSpy(&hedged, &IAiStreamingSession::failed);
+
+    hedged.start();
+    emit primary->failed(QStringLiteral("HTTP 503"));
+    QCOMPARE(backup->startCount, 1);
+    QVERIFY(reportedStages(stageSpy).contains(QStringLiteral("hedge_failover")));
+    QCOMPARE(failedSpy.count(), 0);
+
+    emit backup->failed(QStringLiteral("HTTP 429"));
+    QCOMPARE(failedSpy.count(), 1);
+    const QString reason = failedSpy.at(0).at(0).toString();
+    QVERIFY(reason.contains(QStringLiteral("HTTP 503")));
+    QVERIFY(reason.contains(QStringLiteral("HTTP 429")));
+}
+
+void TestAiAbstractions::estimateAiTokens_countsCjkAndLatinSeparately()
+{
+    QCOMPARE(estimateAiTokens(QString()), 0);
+    QCOMPARE(estimateAiTokens(QStringLiteral("你好")), 2);
+    QCOMPARE(estimateAiTokens(QStringLiteral("hello world")), 3);
+    QCOMPARE(estimateAiTokens(QStringLiteral("订单 order")), 4);
+}
+
+void TestAiAbstractions::assembleAiContext_keepsShortHistoryIntact()
+{
+    const QList<AiContextHistoryTurn> history = makeHistory(6, 20);
+    AiContextBudget budget;
+    budget.maxPromptTokens = 4000;
+
+    const AiContextAssembly context = assembleAiContext(
+        QStringLiteral("系统提示"), history, {makeAiTextTurn(QStringLiteral("user"), QStringLiteral("请回复"))}, budget);
+
+    QCOMPARE(context.turns.size(), 6);
+    QCOMPARE(context.systemPrompt, QStringLiteral("系统提示"));
+    QCOMPARE(context.stats.keptTurns, 6);
+    QCOMPARE(context.stats.droppedTurns, 0);
+    QCOMPARE(context.stats.digestedTurns, 0);
+    QVERIFY(context.stats.estimatedPromptTokens > 0);
+    QVERIFY(context.stats.estimatedPromptTokens <= budget.maxPromptTokens);
+}
+
+void TestAiAbstractions::assembleAiContext_fitsBudgetWithStablePrefix()
+{
+    AiContextBudget budget;
+    budget.maxPromptTokens = 1500;
+    budget.digestTokens = 200;
+    budget.anchorStride = 8;
+    const QString systemPrompt = QStringLiteral("系统");
+    const QList<AiConversationTurn> tail = {makeAiTextTurn(QStringLiteral("user"), QStringLiteral("请回复"))};
+
+    QList<AiContextHistoryTurn> history = makeHistory(40, 100);
+    const AiContextAssembly first = assembleAiContext(systemPrompt, history, tail, budget);
+    QVERIFY(first.stats.droppedTurns > 0);
+    QVERIFY(first.stats.digestedTurns > 0);
+    QVERIFY(first.stats.estimatedPromptTokens <= budget.maxPromptTokens);
+    QCOMPARE(first.stats.droppedTurns % budget.anchorStride, 0);
+    // 摘要并入开头的 system 提示，历史里只有真实消息
+    QVERIFY(first.systemPrompt.startsWith(systemPrompt));
+    QVERIFY(first.systemPrompt.contains(QStringLiteral("较早聊天摘要")));
+    QCOMPARE(first.turns.size(), first.stats.keptTurns);
+    for (const AiConversationTurn& turn : first.turns)
+        QVERIFY(turn.role != QStringLiteral("system"));
+    QCOMPARE(plainTextForAiTurn(first.turns.last()), plainTextForAiTurn(history.last().turn));
+
+    // 新消息到来后，只要未跨过对齐点，之前的摘要与历史应逐条不变，仅在末尾追加
+    history.append(makeHistory(41, 100).last());
+    const AiContextAssembly second = assembleAiContext(systemPrompt, history, tail, budget);
+    QCOMPARE(second.stats.droppedTurns, first.stats.droppedTurns);
+    QCOMPARE(second.systemPrompt, first.systemPrompt);
+    QCOMPARE(second.turns.size(), first.turns.size() + 1);
+    const QStringList firstTexts = turnTexts(first.turns);
+    QCOMPARE(turnTexts(second.turns).mid(0, firstTexts.size()), firstTexts);
+}
+
+void TestAiAbstractions::assembleAiContext_prefixSurvivesFetchWindowSliding()
+{
+    AiContextBudget budget;
+    budget.maxPromptTokens = 1500;
+    budget.digestTokens = 200;
+    budget.anchorStride = 8;
+    const QString systemPrompt = QStringLiteral("系统");
+    const QList<AiConversationTurn> tail = {makeAiTextTurn(QStringLiteral("user"), QStringLiteral("请回复"))};
+
+    // 读取窗口固定 40 条：新消息进来时最旧的一条移出窗口，下标整体前移、序号不变
+    QList<AiContextHistoryTurn> history = makeHistory(41, 100);
+    history.removeFirst();
+    const AiContextAssembly first = assembleAiContext(systemPrompt, history, tail, budget);
+    QVERIFY(first.stats.digestedTurns > 0);
+
+    history.append(makeHistory(42, 100).last());
+    history.removeFirst();
+    const AiContextAssembly second = assembleAiContext(systemPrompt, history, tail, budget);
+
+    QCOMPARE(second.systemPrompt, first.systemPrompt);
+    const QStringList firstTexts = turnTexts(first.turns);
+    QCOMPARE(turnTexts(second.turns).mid(0, firstTexts.size()), firstTexts);
+    // 省略条数按会话内序号计，而不是窗口内下标
+    QVERIFY(first.systemPrompt.contains(QStringLiteral("已省略 %1 条").arg(41 - first.stats.keptTurns)));
+}
+
+void TestAiAbstractions::assembleAiContextOldestFirst_sendsOnlyWholeLeadingTurns()
+{
+    AiContextBudget budget;
+    budget.maxPromptTokens = 1500;
+    budget.digestTokens = 200;
+    budget.anchorStride = 8;
+    const QString systemPrompt = QStringLiteral("系统");
+    const QList<AiConversationTurn> tail = {makeAiTextTurn(QStringLiteral("user"), QStringLiteral("请合并更新"))};
+
+    // 增量整理客户信息：高水位之后的新消息放不下时，只能完整发出最早的一段，
+    // 较新的消息既不能被摘要也不能被丢弃后计入已整理，否则高水位会越过它们
+    const QList<AiContextHistoryTurn> history = makeHistory(20, 100);
+    QVERIFY(assembleAiContext(systemPrompt, history, tail, budget).stats.droppedTurns > 0);
+
+    const AiContextAssembly context = assembleAiContextOldestFirst(systemPrompt, history, tail, budget);
+    const int sent = context.stats.keptTurns;
+    QVERIFY(sent > 0);
+    QVERIFY(sent < history.size());
+    QCOMPARE(context.stats.droppedTurns, 0);
+    QCOMPARE(context.stats.digestedTurns, 0);
+    QVERIFY(context.stats.estimatedPromptTokens <= budget.maxPromptTokens);
+    QList<AiConversationTurn> leading;
+    for (int i = 0; i < sent; ++i)
+        leading.append(history.at(i).turn);
+    QCOMPARE(turnTexts(context.turns), turnTexts(leading));
+
+    // 放得下时全部发出；单条就超预算时也至少发出最早一条
+    const QList<AiContextHistoryTurn> shortHistory = makeHistory(4, 20);
+    QCOMPARE(assembleAiContextOldestFirst(systemPrompt, shortHistory, tail, budget).stats.keptTurns, 4);
+    const QList<AiContextHistoryTurn> oversized = makeHistory(3, 3000);
+    const AiContextAssembly first = assembleAiContextOldestFirst(systemPrompt, oversized, tail, budget);
+    QCOMPARE(first.stats.keptTurns, 1);
+    QCOMPARE(turnTexts(first.turns), turnTexts({oversized.first().turn}));
+}
+
 QTEST_MAIN(TestAiAbstractions)
 #include "test_aiabstractions.moc"
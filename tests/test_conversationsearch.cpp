@@ -0,0 +1,197 @@
+#include <QtTest>
+#include <QSignalSpy>
+#include "ui/conversationlistmodel.h"
+#include "ui/conversationsearch.h"
+#include "utils/pinyin.h"
+
+namespace {
+
+ConversationInfo makeConversation(int id, const QString& name, const QString& lastMessage = QString())
+{
+    ConversationInfo conv;
+    conv.id = id;
+    conv.platform = QStringLiteral("wechat");
+    conv.platformConversationId = QStringLiteral("conv-%1").arg(id);
+    conv.customerName = name;
+    conv.lastMessage = lastMessage;
+    return conv;
+}
+
+using Ranges = QVector<QPair<int, int>>;
+
+Ranges nameRanges(const ConversationInfo& conv, const QString& query)
+{
+    const auto match = ConversationSearch::match(conv, query);
+    return match ? match->nameRanges : Ranges{{-1, -1}};
+}
+
+QVector<ConversationInfo> sampleConversations()
+{
+    return {
+        makeConversation(1, QStringLiteral("张三"), QStringLiteral("发货了吗")),
+        makeConversation(2, QStringLiteral("李小明"), QStringLiteral("好的")),
+        makeConversation(3, QStringLiteral("曾丽"), QStringLiteral("张家口的地址")),
+        makeConversation(4, QStringLiteral("西安客户"), QStringLiteral("")),
+        makeConversation(5, QStringLiteral("Alice"), QStringLiteral("zs 的订单")),
+    };
+}
+
+QList<int> matchedIds(const ConversationSearch& search)
+{
+    QList<int> ids = search.matches().keys();
+    std::sort(ids.begin(), ids.end());
+    return ids;
+}
+
+} // namespace
+
+class TestConversationSearch : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void pinyin_lookup();
+    void match_substringAndPinyin();
+    void match_fullPinyinRequiresSyllableStart();
+    void match_surnameReading();
+    void match_previewRange();
+    void search_backgroundThenNarrow();
+    void search_staleQueryIsDropped();
+    void search_reindexKeepsQuery();
+    void model_usesSearchMatches();
+};
+
+void TestConversationSearch::pinyin_lookup()
+{
+    QCOMPARE(QString(Pinyin::syllable(QChar(u'张'))), QStringLiteral("zhang"));
+    QCOMPARE(QString(Pinyin::syllable(QChar(u'吕'))), QStringLiteral("lu"));
+    QVERIFY(Pinyin::syllable(QChar(u'a')).isEmpty());
+    QCOMPARE(QString(Pinyin::surnameReading(QChar(u'曾'))), QStringLiteral("zeng"));
+    QVERIFY(Pinyin::surnameReading(QChar(u'张')).isEmpty());
+}
+
+void TestConversationSearch::match_substringAndPinyin()
+{
+    const ConversationInfo zhang = makeConversation(1, QStringLiteral("张三"));
+    QCOMPARE(nameRanges(zhang, QStringLiteral("张")), (Ranges{{0, 1}}));
+    QCOMPARE(nameRanges(zhang, QStringLiteral("zs")), (Ranges{{0, 2}}));
+    QCOMPARE(nameRanges(zhang, QStringLiteral("zhangsan")), (Ranges{{0, 2}}));
+    QCOMPARE(nameRanges(zhang, QStringLiteral("Zhang S")), (Ranges{{0, 2}}));
+    QCOMPARE(nameRanges(zhang, QStringLiteral("san")), (Ranges{{1, 1}}));
+    QVERIFY(!ConversationSearch::match(zhang, QStringLiteral("lisi")));
+
+    const ConversationInfo alice = makeConversation(2, QStringLiteral("Alice"));
+    QCOMPARE(nameRanges(alice, QStringLiteral("LIC")), (Ranges{{1, 3}}));
+}
+
+void TestConversationSearch::match_fullPinyinRequiresSyllableStart()
+{
+    // "an" 只能命中「安」，不能命中「张」里的 zh-an-g
+    QVERIFY(!ConversationSearch::match(makeConversation(1, QStringLiteral("张三")), QStringLiteral("ang")));
+    QCOMPARE(nameRanges(makeConversation(2, QStringLiteral("西安客户")), QStringLiteral("an")), (Ranges{{1, 1}}));
+    // 跨字连拼
+    QCOMPARE(nameRanges(makeConversation(2, QStringLiteral("西安客户")), QStringLiteral("xian")), (Ranges{{0, 2}}));
+}
+
+void TestConversationSearch::match_surnameReading()
+{
+    const ConversationInfo zeng = makeConversation(1, QStringLiteral("曾丽"));
+    QCOMPARE(nameRanges(zeng, QStringLiteral("zengli")), (Ranges{{0, 2}}));
+    QCOMPARE(nameRanges(zeng, QStringLiteral("zl")), (Ranges{{0, 2}}));
+    QCOMPARE(nameRanges(zeng, QStringLiteral("cl")), (Ranges{{0, 2}}));
+    // 姓氏读音只用于第一个字
+    QVERIFY(!ConversationSearch::match(makeConversation(2, QStringLiteral("李曾")), QStringLiteral("lz")));
+}
+
+void TestConversationSearch::match_previewRange()
+{
+    const auto match = ConversationSearch::match(makeConversation(1, QStringLiteral("曾丽"), QStringLiteral("张家口的地址")),
+                                                 QStringLiteral("地址"));
+    QVERIFY(match.has_value());
+    QVERIFY(match->nameRanges.isEmpty());
+    QCOMPARE(match->previewRanges, (Ranges{{4, 2}}));
+}
+
+void TestConversationSearch::search_backgroundThenNarrow()
+{
+    ConversationSearch search;
+    QSignalSpy ready(&search, &ConversationSearch::resultsReady);
+    search.setConversations(sampleConversations());
+
+    search.setQuery(QStringLiteral("z"));
+    QVERIFY(search.isPending());
+    QVERIFY(ready.wait(2000));
+    QCOMPARE(search.appliedQuery(), QStringLiteral("z"));
+    QCOMPARE(matchedIds(search), (QList<int>{1, 3, 5}));
+
+    // 追加输入在上次结果上同步收窄，当次就有结果
+    ready.clear();
+    search.setQuery(QStringLiteral("zs"));
+    QCOMPARE(ready.count(), 1);
+    QVERIFY(!search.isPending());
+    QCOMPARE(matchedIds(search), (QList<int>{1, 5}));
+    QCOMPARE(search.matches().value(1).nameRanges, (Ranges{{0, 2}}));
+    QCOMPARE(search.matches().value(5).previewRanges, (Ranges{{0, 2}}));
+
+    search.setQuery(QString());
+    QCOMPARE(ready.count(), 2);
+    QVERIFY(search.matches().isEmpty());
+}
+
+void TestConversationSearch::search_staleQueryIsDropped()
+{
+    ConversationSearch search;
+    QSignalSpy ready(&search, &ConversationSearch::resultsReady);
+    search.setConversations(sampleConversations());
+
+    search.setQuery(QStringLiteral("li"));
+    search.setQuery(QStringLiteral("xa"));
+    QVERIFY(ready.wait(2000));
+    QTest::qWait(ConversationSearch::kDebounceMs * 4);
+    QCOMPARE(ready.count(), 1);
+    QCOMPARE(search.appliedQuery(), QStringLiteral("xa"));
+    QCOMPARE(matchedIds(search), (QList<int>{4}));
+}
+
+void TestConversationSearch::search_reindexKeepsQuery()
+{
+    ConversationSearch search;
+    QSignalSpy ready(&search, &ConversationSearch::resultsReady);
+    search.setConversations(sampleConversations());
+    search.setQuery(QStringLiteral("xm"));
+    QVERIFY(ready.wait(2000));
+    QCOMPARE(matchedIds(search), (QList<int>{2}));
+
+    QVector<ConversationInfo> refreshed = sampleConversations();
+    refreshed.push_back(makeConversation(6, QStringLiteral("夏梦"), QStringLiteral("在吗")));
+    ready.clear();
+    search.setConversations(refreshed);
+    QVERIFY(ready.wait(2000));
+    QCOMPARE(matchedIds(search), (QList<int>{2, 6}));
+}
+
+void TestConversationSearch::model_usesSearchMatches()
+{
+    ConversationListModel model;
+    model.setFilters(0, 0, QString(), -1);
+    model.setSourceConversations(sampleConversations(), {});
+    QCOMPARE(model.rowCount(), 5);
+    QVERIFY(!model.index(0).data(ConversationListModel::SearchMatchRole).isValid());
+
+    // 未提供后台结果时同步匹配
+    model.setFilters(0, 0, QStringLiteral("zs"), -1);
+    QCOMPARE(model.rowCount(), 2);
+    const auto first = model.index(0).data(ConversationListModel::SearchMatchRole).value<ConversationSearchMatch>();
+    QCOMPARE(first.nameRanges, (Ranges{{0, 2}}));
+
+    // 后台结果与关键词一致时直接采用
+    QHash<int, ConversationSearchMatch> matches;
+    matches.insert(4, ConversationSearchMatch());
+    model.setSearchMatches(QStringLiteral("zs"), matches);
+    model.setFilters(0, 0, QStringLiteral("zs"), -1);
+    QCOMPARE(model.rowCount(), 1);
+    QCOMPARE(model.conversationIdAt(0), 4);
+}
+
+QTEST_MAIN(TestConversationSearch)
+#include "test_conversationsearch.moc"
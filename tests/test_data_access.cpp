@@ -1,5 +1,6 @@
 #include <QtTest>
 
+#include "data/airequesteventdao.h"
 #include "data/conversationdao.h"
 #include "data/appdatauistatedao.h"
 #include "data/database.h"
@@ -7,10 +8,14 @@
 #include "data/wechatmessagedao.h"
 #include "testdatabase.h"
 
+#include <QDir>
+#include <QFile>
 #include <QJsonObject>
+#include <QRegularExpression>
 #include <QScopeGuard>
 #include <QSet>
 #include <QSqlDatabase>
+#include <QSqlError>
 #include <QSqlQuery>
 #include <QTemporaryDir>
 
@@ -26,6 +31,73 @@ QStringList tableColumns(QSqlDatabase db, const QString& tableName)
     return columns;
 }
 
+// 改造前的 MessageRecord 字段顺序，仅用于对比结构体大小（int 与 QString 交错带来填充）
+struct LegacyMessageRecordLayout {
+    int id;
+    int conversationId;
+    QString direction, content, sender, senderName;
+    QDateTime createdAt;
+    QString platformMsgId;
+    int syncStatus;
+    QString errorReason, originalTimestamp, contentImagePath, clientMessageId, status, sourceType;
+    int confidence;
+    QString verificationStatus, contentType;
+    QDateTime observedAt;
+    QString cacheScope, cacheOrigin;
+};
+
+/** 估算字符串独占的堆字节：静态字面量与已统计过的共享数据计 0。 */
+qsizetype stringHeapBytes(const QString& value, QSet<const void*>& seen)
+{
+    const void* block = value.data_ptr().d_ptr();
+    if (!block || seen.contains(block))
+        return 0;
+    seen.insert(block);
+    return qsizetype(sizeof(QArrayData)) + (value.capacity() + 1) * qsizetype(sizeof(QChar));
+}
+
+qsizetype enumFieldHeapBytes(const QVector<MessageRecord>& records)
+{
+    QSet<const void*> seen;
+    qsizetype total = 0;
+    for (const MessageRecord& m : records) {
+        for (const QString* field : {&m.direction, &m.sender, &m.status, &m.sourceType,
+                                     &m.verificationStatus, &m.contentType, &m.cacheScope, &m.cacheOrigin})
+            total += stringHeapBytes(*field, seen);
+    }
+    return total;
+}
+
+QString detachedCopy(const QString& value)
+{
+    return value.isEmpty() ? QString() : QString(value.constData(), value.size());
+}
+
+/** 按语句拆分 database/app_data_schema.sql（触发器体内的分号到 END; 为止），模拟 Python 服务建库。 */
+QStringList appDataSchemaStatements()
+{
+    QFile file(QStringLiteral(PROJECT_ROOT_DIR "/database/app_data_schema.sql"));
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+        return {};
+    QStringList statements;
+    QString current;
+    const QStringList lines = QString::fromUtf8(file.readAll()).split(QLatin1Char('\n'));
+    for (const QString& line : lines) {
+        const QString trimmed = line.trimmed();
+        if (trimmed.isEmpty() || trimmed.startsWith(QStringLiteral("--")))
+            continue;
+        current += line + QLatin1Char('\n');
+        if (!trimmed.endsWith(QLatin1Char(';')))
+            continue;
+        const bool inTrigger = current.trimmed().startsWith(QStringLiteral("CREATE TRIGGER"));
+        if (inTrigger && trimmed != QStringLiteral("END;"))
+            continue;
+        statements.append(current.trimmed().chopped(1));
+        current.clear();
+    }
+    return statements;
+}
+
 } // namespace
 
 class TestDataAccess : public QObject
@@ -37,9 +109,16 @@ private slots:
     void conversation_fullKeyFindsAndUpgradesLegacyShortKey();
     void message_latestInboundSnapshotAndClear();
     void message_mediaPathFallsBackToEvidenceRef();
+    void message_recentAndIncrementalWindows();
+    void message_enumFieldsAreInternedAtDbEdge();
     void snapshot_upsertWritesLocalCache();
+    void database_preparedStatementCacheReusesAndResetsBindings();
+    void database_hotStatementsAvoidFullTableScans();
+    void message_lastDirectionsTrackInsertsAndDeletes();
     void appDataUiState_conversationDraftRoundtrip();
     void database_runMigrations_upgradesLegacySchema();
+    void database_unifiedAppDataReadsDenormalizedLastDirection();
+    void aiRequestEvent_firstTokenPercentileCountsCensoredHedgeLosers();
 };
 
 void TestDataAccess::conversation_roundtripAndUnread()
@@ -203,6 +282,94 @@ void TestDataAccess::message_latestInboundSnapshotAndClear()
     QVERIFY(!msgDao.latestInboundSnapshot(convId).has_value());
 }
 
+void TestDataAccess::message_recentAndIncrementalWindows()
+{
+    ScopedTestDatabase db;
+    Q_UNUSED(db);
+
+    ConversationDao convDao;
+    MessageDao msgDao;
+    const int convId = convDao.create(QStringLiteral("test_platform"),
+                                      QStringLiteral("conv-window"),
+                                      QStringLiteral("王五"));
+    QVERIFY(convId > 0);
+
+    QVector<int> ids;
+    for (int i = 0; i < 6; ++i) {
+        const int id = msgDao.create(convId,
+                                     i % 3 == 2 ? QStringLiteral("out") : QStringLiteral("in"),
+                                     QStringLiteral("消息%1").arg(i),
+                                     i % 3 == 2 ? QStringLiteral("agent") : QStringLiteral("customer"),
+                                     QStringLiteral("msg-window-%1").arg(i));
+        QVERIFY(id > 0);
+        ids.append(id);
+    }
+
+    QCOMPARE(msgDao.countCachedMessages(convId), 6);
+    const auto recent = msgDao.listRecentCachedMessages(convId, 3);
+    QCOMPARE(recent.size(), 3);
+    QCOMPARE(recent.first().content, QStringLiteral("消息3"));
+    QCOMPARE(recent.last().content, QStringLiteral("消息5"));
+
+    const auto after = msgDao.listCachedMessagesAfter(convId, ids.at(2), 10);
+    QCOMPARE(after.size(), 3);
+    QCOMPARE(after.first().id, ids.at(3));
+    QCOMPARE(msgDao.listCachedMessagesAfter(convId, ids.at(2), 2).size(), 2);
+    QCOMPARE(msgDao.countCachedInboundAfter(convId, ids.at(2)), 2);
+    QCOMPARE(msgDao.countCachedInboundAfter(convId, 0), 4);
+    QCOMPARE(msgDao.countCachedInboundAfter(convId, ids.last()), 0);
+}
+
+void TestDataAccess::message_enumFieldsAreInternedAtDbEdge()
+{
+    ScopedTestDatabase db;
+    Q_UNUSED(db);
+
+    ConversationDao convDao;
+    MessageDao msgDao;
+    const int convId = convDao.create(QStringLiteral("test_platform"),
+                                      QStringLiteral("conv-memory"),
+                                      QStringLiteral("赵六"));
+    QVERIFY(convId > 0);
+
+    constexpr int kMessages = 500;
+    for (int i = 0; i < kMessages; ++i) {
+        const bool outbound = i % 2 == 1;
+        QVERIFY(msgDao.create(convId,
+                              outbound ? QStringLiteral("out") : QStringLiteral("in"),
+                              QStringLiteral("内存基准消息 %1").arg(i),
+                              outbound ? QStringLiteral("agent") : QStringLiteral("customer"),
+                              QStringLiteral("msg-memory-%1").arg(i)) > 0);
+    }
+
+    const QVector<MessageRecord> compact = msgDao.listCachedMessages(convId, kMessages, 0);
+    QCOMPARE(compact.size(), kMessages);
+    QCOMPARE(compact.at(0).direction, QStringLiteral("in"));
+    QCOMPARE(compact.at(1).sender, QStringLiteral("agent"));
+    QCOMPARE(compact.at(0).status.constData(), compact.at(2).status.constData());
+    QCOMPARE(MessageAtoms::intern(QStringLiteral("custom_origin")).constData(),
+             MessageAtoms::intern(QStringLiteral("custom_origin")).constData());
+
+    // 改造前每行解码都会为这些字段各分配一次
+    QVector<MessageRecord> legacy = compact;
+    for (MessageRecord& m : legacy) {
+        for (QString* field : {&m.direction, &m.sender, &m.status, &m.sourceType,
+                               &m.verificationStatus, &m.contentType, &m.cacheScope, &m.cacheOrigin})
+            *field = detachedCopy(*field);
+    }
+
+    const double legacyBytes = double(sizeof(LegacyMessageRecordLayout))
+        + double(enumFieldHeapBytes(legacy)) / kMessages;
+    const double compactBytes = double(sizeof(MessageRecord))
+        + double(enumFieldHeapBytes(compact)) / kMessages;
+    qInfo().noquote() << QStringLiteral("MessageRecord enum-field bytes/message: legacy=%1 compact=%2")
+                             .arg(legacyBytes, 0, 'f', 1)
+                             .arg(compactBytes, 0, 'f', 1);
+    QVERIFY(sizeof(MessageRecord) <= sizeof(LegacyMessageRecordLayout));
+    QVERIFY(enumFieldHeapBytes(compact) == 0);
+    QVERIFY(compactBytes < legacyBytes);
+}
+
 void TestDataAccess::message_mediaPathFallsBackToEvidenceRef()
 {
     ScopedTestDatabase db;
@@ -358,6 +525,175 @@ void TestDataAccess::snapshot_upsertWritesLocalCache()
     QCOMPARE(convDao.rpaReplayCursor(QStringLiteral("wechat")), QStringLiteral("42"));
 }
 
+void TestDataAccess::database_preparedStatementCacheReusesAndResetsBindings()
+{
+    ScopedTestDatabase db;
+    Q_UNUSED(db);
+    Database& database = Database::getInstance();
+    QCOMPARE(database.cachedStatementCount(), 0);
+
+    ConversationDao convDao;
+    MessageDao msgDao;
+    const int convId = convDao.create(QStringLiteral("wechat"), QStringLiteral("conv-cache"), QStringLiteral("缓存"));
+    QVERIFY(convId > 0);
+
+    // 热路径语句只在第一次调用时 prepare
+    QVERIFY(!msgDao.existsByPlatformMsgId(QStringLiteral("cache-msg-1")));
+    const int preparedAfterFirst = database.statementPrepareCount();
+    for (int i = 0; i < 20; ++i) {
+        QVERIFY(convDao.incrementUnread(convId));
+        QVERIFY(!msgDao.existsByPlatformMsgId(QStringLiteral("cache-msg-%1").arg(i)));
+    }
+    QCOMPARE(database.statementPrepareCount(), preparedAfterFirst + 1); // incrementUnread 首次
+    QCOMPARE(convDao.findById(convId)->unreadCount, 20);
+
+    const QString sql = QStringLiteral("SELECT :a, :b");
+    {
+        CachedQuery stmt = database.prepareCached(sql);
+        stmt.query().bindValue(QStringLiteral(":a"), 1);
+        stmt.query().bindValue(QStringLiteral(":b"), 2);
+        QVERIFY(stmt.query().exec());
+        QVERIFY(stmt.query().next());
+        QCOMPARE(stmt.query().value(1).toInt(), 2);
+    }
+    {
+        // 复用时上次的绑定值已清空，漏绑的参数是 NULL
+        CachedQuery stmt = database.prepareCached(sql);
+        stmt.query().bindValue(QStringLiteral(":a"), 3);
+        QVERIFY(stmt.query().exec());
+        QVERIFY(stmt.query().next());
+        QCOMPARE(stmt.query().value(0).toInt(), 3);
+        QVERIFY(stmt.query().value(1).isNull());
+
+        // 同一条 SQL 嵌套借用时拿到独立的一次性语句
+        const int cachedBefore = database.cachedStatementCount();
+        CachedQuery nested = database.prepareCached(sql);
+        QVERIFY(&nested.query() != &stmt.query());
+        nested.query().bindValue(QStringLiteral(":a"), 4);
+        nested.query().bindValue(QStringLiteral(":b"), 5);
+        QVERIFY(nested.query().exec());
+        QVERIFY(nested.query().next());
+        QCOMPARE(nested.query().value(1).toInt(), 5);
+        QCOMPARE(stmt.query().value(0).toInt(), 3);
+        QCOMPARE(database.cachedStatementCount(), cachedBefore);
+    }
+
+    {
+        CachedQuery broken = database.prepareCached(QStringLiteral("SELECT * FROM no_such_table"));
+        QVERIFY(!broken.query().exec());
+    }
+    QVERIFY(database.cachedStatementCount() > 0);
+
+    database.close();
+    QCOMPARE(database.cachedStatementCount(), 0);
+}
+
+void TestDataAccess::database_hotStatementsAvoidFullTableScans()
+{
+    ScopedTestDatabase db;
+    Q_UNUSED(db);
+    Database& database = Database::getInstance();
+
+    ConversationDao convDao;
+    MessageDao msgDao;
+    const int convId = convDao.create(QStringLiteral("wechat"), QStringLiteral("conv-plan"), QStringLiteral("索引"));
+    QVERIFY(convId > 0);
+    QVERIFY(msgDao.create(convId, QStringLiteral("in"), QStringLiteral("你好"),
+                          QStringLiteral("customer"), QStringLiteral("plan-in-1")) > 0);
+    QVERIFY(msgDao.create(convId, QStringLiteral("out"), QStringLiteral("在的"),
+                          QStringLiteral("agent"), QString(), 0, QString(), QString(),
+                          QString(), QString(), QStringLiteral("plan-cmid-1")) > 0);
+
+    // 走一遍热点读路径，让对应语句进入预编译缓存
+    QCOMPARE(msgDao.listRecentCachedMessages(convId, 20).size(), 2);
+    QCOMPARE(msgDao.listCachedMessagesAfter(convId, 0, 20).size(), 2);
+    QCOMPARE(msgDao.countCachedInboundAfter(convId, 0), 1);
+    QVERIFY(msgDao.lastMessageForConversation(convId).has_value());
+    QVERIFY(msgDao.latestInboundSnapshot(convId).has_value());
+    msgDao.latestOutboundByClientMessageId(convId, QStringLiteral("plan-cmid-1"));
+    msgDao.latestPendingOutboundByClientMessageId(convId, QStringLiteral("plan-cmid-1"));
+    QCOMPARE(msgDao.lastDirectionsByConversation().value(convId), QStringLiteral("out"));
+    QVERIFY(msgDao.existsByPlatformMsgId(QStringLiteral("plan-in-1")));
+    QVERIFY(convDao.findById(convId).has_value());
+    QCOMPARE(convDao.listAll().size(), 1);
+
+    QStringList statements = database.cachedStatementSql();
+    QVERIFY(statements.size() >= 10);
+    // 快照对账的删除语句带可变长 IN 列表，不进缓存：直接取 DAO 生成的语句，按两种保留列表都有的形态检查
+    statements << MessageDao::deleteMissingSnapshotCacheMessagesSql(2, 1)
+               << MessageDao::deleteMissingSnapshotCacheMessagesSql(0, 0);
+
+    // 任何 SCAN（含按索引顺序遍历整张表）都算全表扫描，除非在下面逐条点名；
+    // 旧版 SQLite 的写法为 "SCAN TABLE x"，先归一成新版写法再比对
+    static const QSet<QString> allowedScans = {
+        // listAll 本就要列出全部会话，按 last_time 索引顺序遍历只为省掉排序
+        QStringLiteral("SCAN conversations USING INDEX idx_conversations_last_time"),
+    };
+    static const QRegularExpression legacyScan(QStringLiteral("^SCAN TABLE "));
+    static const QRegularExpression placeholder(QStringLiteral(":[A-Za-z_][A-Za-z0-9_]*"));
+    for (const QString& sql : std::as_const(statements)) {
+        QSqlQuery plan(database.connection());
+        QVERIFY2(plan.prepare(QStringLiteral("EXPLAIN QUERY PLAN ") + sql), qPrintable(sql));
+        QSet<QString> names;
+        for (auto it = placeholder.globalMatch(sql); it.hasNext();)
+            names.insert(it.next().captured());
+        for (const QString& name : std::as_const(names))
+            plan.bindValue(name, QVariant());
+        QVERIFY2(plan.exec(), qPrintable(sql));
+        while (plan.next()) {
+            QString detail = plan.value(3).toString();
+            detail.replace(legacyScan, QStringLiteral("SCAN "));
+            QVERIFY2(!detail.startsWith(QLatin1String("SCAN ")) || allowedScans.contains(detail),
+                     qPrintable(QStringLiteral("%1\n  -> %2").arg(sql, detail)));
+        }
+    }
+}
+
+void TestDataAccess::message_lastDirectionsTrackInsertsAndDeletes()
+{
+    ScopedTestDatabase db;
+    Q_UNUSED(db);
+
+    ConversationDao convDao;
+    MessageDao msgDao;
+    const int pendingConv = convDao.create(QStringLiteral("wechat"), QStringLiteral("dir-a"), QStringLiteral("甲"));
+    const int repliedConv = convDao.create(QStringLiteral("wechat"), QStringLiteral("dir-b"), QStringLiteral("乙"));
+    const int emptyConv = convDao.create(QStringLiteral("wechat"), QStringLiteral("dir-c"), QStringLiteral("丙"));
+    QVERIFY(pendingConv > 0 && repliedConv > 0 && emptyConv > 0);
+
+    QVERIFY(msgDao.create(repliedConv, QStringLiteral("in"), QStringLiteral("在吗"), QStringLiteral("customer")) > 0);
+    QVERIFY(msgDao.create(repliedConv, QStringLiteral("out"), QStringLiteral("在的"), QStringLiteral("agent")) > 0);
+
+    QJsonObject snapshot;
+    snapshot.insert(QStringLiteral("direction"), QStringLiteral("out"));
+    snapshot.insert(QStringLiteral("content"), QStringLiteral("您好"));
+    snapshot.insert(QStringLiteral("sender"), QStringLiteral("agent"));
+    snapshot.insert(QStringLiteral("platform_msg_id"), QStringLiteral("dir-a-1"));
+    QVERIFY(msgDao.upsertSnapshotCacheMessage(pendingConv, snapshot) > 0);
+    snapshot.insert(QStringLiteral("direction"), QStringLiteral("in"));
+    snapshot.insert(QStringLiteral("content"), QStringLiteral("发货了吗"));
+    snapshot.insert(QStringLiteral("sender"), QStringLiteral("customer"));
+    snapshot.insert(QStringLiteral("platform_msg_id"), QStringLiteral("dir-a-2"));
+    QVERIFY(msgDao.upsertSnapshotCacheMessage(pendingConv, snapshot) > 0);
+
+    auto directions = msgDao.lastDirectionsByConversation();
+    QCOMPARE(directions.value(pendingConv), QStringLiteral("in"));
+    QCOMPARE(directions.value(repliedConv), QStringLiteral("out"));
+    QVERIFY(!directions.contains(emptyConv));
+
+    // 删掉最后一条后退回到前一条的方向
+    QSet<QString> keep;
+    keep.insert(QStringLiteral("dir-a-1"));
+    QCOMPARE(msgDao.deleteMissingSnapshotCacheMessages(pendingConv, keep, {}), 1);
+    directions = msgDao.lastDirectionsByConversation();
+    QCOMPARE(directions.value(pendingConv), QStringLiteral("out"));
+
+    QVERIFY(msgDao.clearAllForConversation(repliedConv));
+    directions = msgDao.lastDirectionsByConversation();
+    QVERIFY(!directions.contains(repliedConv));
+    QCOMPARE(directions.size(), 1);
+}
+
 void TestDataAccess::appDataUiState_conversationDraftRoundtrip()
 {
     QTemporaryDir dir;
@@ -488,6 +824,8 @@ void TestDataAccess::database_runMigrations_upgradesLegacySchema()
     QVERIFY(tableColumns(db, QStringLiteral("conversations")).contains(QStringLiteral("created_at")));
     QVERIFY(tableColumns(db, QStringLiteral("conversations")).contains(QStringLiteral("updated_at")));
     QVERIFY(tableColumns(db, QStringLiteral("conversations")).contains(QStringLiteral("deleted_at")));
+    QVERIFY(tableColumns(db, QStringLiteral("conversations")).contains(QStringLiteral("last_message_id")));
+    QVERIFY(tableColumns(db, QStringLiteral("conversations")).contains(QStringLiteral("last_direction")));
     QVERIFY(!tableColumns(db, QStringLiteral("conversations")).contains(QStringLiteral("source_type")));
     QVERIFY(!tableColumns(db, QStringLiteral("conversations")).contains(QStringLiteral("confidence")));
     QVERIFY(!tableColumns(db, QStringLiteral("conversations")).contains(QStringLiteral("canonical_conversation_id")));
@@ -495,5 +833,108 @@ void TestDataAccess::database_runMigrations_upgradesLegacySchema()
     Database::getInstance().close();
 }
 
+void TestDataAccess::database_unifiedAppDataReadsDenormalizedLastDirection()
+{
+    Database::getInstance().close();
+
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString dbPath = dir.filePath(QStringLiteral("app_data.db"));
+
+    const QByteArray envName("AI_CUSTOMER_SERVICE_APP_DB");
+    const QByteArray oldValue = qgetenv(envName.constData());
+    const bool hadOldValue = qEnvironmentVariableIsSet(envName.constData());
+    qputenv(envName.constData(), dbPath.toUtf8());
+    auto restoreEnv = qScopeGuard([&]() {
+        Database::getInstance().close();
+        if (hadOldValue)
+            qputenv(envName.constData(), oldValue);
+        else
+            qunsetenv(envName.constData());
+    });
+    Q_UNUSED(restoreEnv);
+
+    // 与生产一致：库由 Python 服务按 app_data_schema.sql 建好并写入消息，客户端只打开
+    {
+        const QString connName = QStringLiteral("app_data_schema_builder");
+        {
+            QSqlDatabase service = QSqlDatabase::addDatabase(QStringLiteral("QSQLITE"), connName);
+            service.setDatabaseName(dbPath);
+            QVERIFY(service.open());
+            const QStringList statements = appDataSchemaStatements();
+            QVERIFY(!statements.isEmpty());
+            QSqlQuery q(service);
+            for (const QString& sql : statements)
+                QVERIFY2(q.exec(sql), qPrintable(sql + QStringLiteral("\n") + q.lastError().text()));
+            QVERIFY(q.exec(QStringLiteral(
+                "INSERT INTO conversations (id, platform, platform_conversation_id, customer_name, last_time) VALUES "
+                "(1, 'wechat', 'wechat:甲', '甲', '2026-06-03 13:02:00'),"
+                "(2, 'wechat', 'wechat:乙', '乙', '2026-06-03 13:01:00'),"
+                "(3, 'wechat', 'wechat:丙', '丙', '2026-06-03 13:00:00')")));
+            QVERIFY(q.exec(QStringLiteral(
+                "INSERT INTO messages (conversation_id, direction, sender, content) VALUES "
+                "(1, 'in', 'customer', '在吗'), (2, 'in', 'customer', '你好'),"
+                "(2, 'out', 'agent', '您好'), (1, 'out', 'agent', '在的'), (1, 'in', 'customer', '发货了吗')")));
+            service.close();
+        }
+        QSqlDatabase::removeDatabase(connName);
+    }
+
+    QVERIFY(Database::getInstance().open());
+    QCOMPARE(QDir::cleanPath(Database::getInstance().connection().databaseName()), QDir::cleanPath(dbPath));
+
+    const QVector<ConversationInfo> rows = ConversationDao().listCachedConversations();
+    QCOMPARE(rows.size(), 3);
+    for (const ConversationInfo& conv : rows)
+        QVERIFY(conv.lastDirectionKnown);
+
+    const int preparedBefore = Database::getInstance().statementPrepareCount();
+    const QHash<int, QString> directions = MessageDao().lastCachedDirectionsByConversation(rows);
+    // 方向随会话行一起读出，不再额外准备任何语句
+    QCOMPARE(Database::getInstance().statementPrepareCount(), preparedBefore);
+    QCOMPARE(directions.value(1), QStringLiteral("in"));
+    QCOMPARE(directions.value(2), QStringLiteral("out"));
+    QVERIFY(!directions.contains(3));
+    QCOMPARE(directions, MessageDao().lastDirectionsByConversation());
+    for (const QString& sql : Database::getInstance().cachedStatementSql())
+        QVERIFY2(!sql.contains(QStringLiteral("GROUP BY")), qPrintable(sql));
+}
+
+void TestDataAccess::aiRequestEvent_firstTokenPercentileCountsCensoredHedgeLosers()
+{
+    ScopedTestDatabase db;
+    Q_UNUSED(db);
+
+    const QString primaryKey = QStringLiteral("deepseek");
+    const QString backupKey = QStringLiteral("doubao");
+    AiRequestEventDao dao;
+
+    for (int i = 0; i < 10; ++i) {
+        const qint64 id = dao.beginEvent(QStringLiteral("auto_reply"), 0, primaryKey,
+                                         QStringLiteral("deepseek-chat"), QString());
+        QVERIFY(id > 0);
+        QVERIFY(dao.completeEvent(id, 1200, 400, 20));
+    }
+    // 一段主模型变慢的时期：每次都是备用先出首字，主模型等了 3s 仍无输出被中止
+    for (int i = 0; i < 10; ++i) {
+        const qint64 id = dao.beginEvent(QStringLiteral("auto_reply"), 0, primaryKey,
+                                         QStringLiteral("deepseek-chat"), QString());
+        QVERIFY(id > 0);
+        QVERIFY(dao.recordServingModel(id, backupKey, QStringLiteral("doubao-pro")));
+        QVERIFY(dao.recordHedgeLoser(id, primaryKey, 3000));
+        QVERIFY(dao.completeEvent(id, 2000, 600, 20));
+    }
+
+    int samples = 0;
+    QCOMPARE(dao.firstTokenPercentileMs(primaryKey, 90, 200, &samples), 3000);
+    QCOMPARE(samples, 20);
+    // 截尾样本只算给落败的模型，胜出的备用仍按自己的首字耗时统计
+    QCOMPARE(dao.firstTokenPercentileMs(backupKey, 90, 200, &samples), 600);
+    QCOMPARE(samples, 10);
+    // 最近的样本优先：只取 10 条时全是慢的主模型
+    QCOMPARE(dao.firstTokenPercentileMs(primaryKey, 50, 10, &samples), 3000);
+    QCOMPARE(samples, 10);
+}
+
 QTEST_MAIN(TestDataAccess)
 #include "test_data_access.moc"
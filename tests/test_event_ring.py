@@ -0,0 +1,106 @@
+import sys
+import unittest
+from pathlib import Path
+
+
+REPO_ROOT = Path(__file__).resolve().parents[1]
+PYTHON_DIR = REPO_ROOT / "python"
+if str(PYTHON_DIR) not in sys.path:
+    sys.path.insert(0, str(PYTHON_DIR))
+
+import service.event_ring as event_ring_module
+from service.event_ring import EventRing, event_size
+
+
+def make_event(seq, platform, text="x"):
+    return {"seq": seq, "cursor": str(seq), "platform": platform, "payload": {"content": text}}
+
+
+class EventRingTests(unittest.TestCase):
+    def test_evicts_oldest_by_bytes_and_tracks_floor(self):
+        size = event_size(make_event(1, "wechat"))
+        ring = EventRing(max_bytes=size * 3)
+        for seq in range(1, 6):
+            ring.append(seq, "wechat", make_event(seq, "wechat"))
+
+        self.assertEqual([event["seq"] for event in ring.after(0, limit=50)], [3, 4, 5])
+        stats = ring.stats()
+        self.assertEqual((stats["events"], stats["oldest_seq"], stats["evicted_through"]), (3, 3, 2))
+        self.assertLessEqual(stats["bytes"], size * 3)
+
+    def test_oversized_event_is_still_kept_as_latest(self):
+        ring = EventRing(max_bytes=64)
+        ring.append(1, "wechat", make_event(1, "wechat"))
+        ring.append(2, "wechat", make_event(2, "wechat", "很长" * 100))
+        self.assertEqual([event["seq"] for event in ring.after(0, limit=50)], [2])
+        self.assertEqual(ring.evicted_through, 1)
+
+    def test_platform_index_skips_other_platforms(self):
+        ring = EventRing()
+        for seq in range(1, 21):
+            platform = "qianniu" if seq % 5 == 0 else "wechat"
+            ring.append(seq, platform, make_event(seq, platform))
+
+        self.assertEqual([event["seq"] for event in ring.after(5, "qianniu", limit=2)], [10, 15])
+        self.assertEqual([event["seq"] for event in ring.after(17, "wechat", limit=50)], [18, 19])
+        self.assertEqual(ring.after(0, "douyin", limit=50), [])
+        self.assertEqual(ring.stats()["platforms"], {"wechat": 16, "qianniu": 4})
+
+    def test_start_after_and_increasing_seq(self):
+        ring = EventRing(start_after=41)
+        self.assertEqual((ring.evicted_through, ring.latest_seq), (41, 41))
+        with self.assertRaises(ValueError):
+            ring.append(41, "wechat", make_event(41, "wechat"))
+        ring.append(42, "wechat", make_event(42, "wechat"))
+        self.assertEqual([event["seq"] for event in ring.after(41, limit=1)], [42])
+
+    def test_compaction_keeps_lookups_consistent(self):
+        original = event_ring_module._COMPACT_THRESHOLD
+        event_ring_module._COMPACT_THRESHOLD = 4
+        self.addCleanup(setattr, event_ring_module, "_COMPACT_THRESHOLD", original)
+
+        size = event_size(make_event(100, "wechat"))
+        ring = EventRing(max_bytes=size * 5)
+        for seq in range(100, 140):
+            platform = "wechat" if seq % 3 else "weixin"
+            ring.append(seq, platform, make_event(seq, platform))
+
+        self.assertEqual([event["seq"] for event in ring.after(0, limit=50)], [135, 136, 137, 138, 139])
+        self.assertEqual([event["seq"] for event in ring.after(136, "weixin", limit=50)], [138])
+        self.assertEqual(ring.evicted_through, 134)
+        self.assertLess(len(ring._all.seqs), 20)
+
+    def test_tracks_evicted_events_missing_from_durable_log(self):
+        size = event_size(make_event(10, "wechat"))
+        ring = EventRing(max_bytes=size * 2)
+        for seq in range(1, 7):
+            platform = "qianniu" if seq == 3 else "wechat"
+            ring.append(seq, platform, make_event(seq, platform), durable=seq not in (3, 4))
+
+        self.assertEqual(ring.evicted_through, 4)
+        self.assertTrue(ring.lost_between(0, 4))
+        self.assertTrue(ring.lost_between(3, 4))
+        self.assertFalse(ring.lost_between(4, 6))
+        self.assertFalse(ring.lost_between(0, 2))
+        self.assertTrue(ring.lost_between(0, 4, "qianniu"))
+        self.assertFalse(ring.lost_between(3, 4, "qianniu"))
+        self.assertTrue(ring.lost_between(0, 4, "wechat"))
+
+    def test_lost_seqs_beyond_limit_keep_a_conservative_floor(self):
+        original = event_ring_module._LOST_SEQ_LIMIT
+        event_ring_module._LOST_SEQ_LIMIT = 2
+        self.addCleanup(setattr, event_ring_module, "_LOST_SEQ_LIMIT", original)
+
+        ring = EventRing(max_bytes=1)
+        for seq in range(1, 6):
+            ring.append(seq, "wechat", make_event(seq, "wechat"), durable=False)
+
+        self.assertEqual(ring.evicted_through, 4)
+        # 只精确记得 3、4，1、2 折进 floor：跨过 floor 的区间按有缺口处理
+        self.assertTrue(ring.lost_between(1, 2))
+        self.assertTrue(ring.lost_between(2, 3))
+        self.assertFalse(ring.lost_between(4, 5))
+
+
+if __name__ == "__main__":
+    unittest.main()
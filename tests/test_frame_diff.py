@@ -0,0 +1,119 @@
+import sys
+import unittest
+from pathlib import Path
+
+
+REPO_ROOT = Path(__file__).resolve().parents[1]
+PYTHON_DIR = REPO_ROOT / "python"
+if str(PYTHON_DIR) not in sys.path:
+    sys.path.insert(0, str(PYTHON_DIR))
+
+from rpa.core.frame_diff import FrameDiffer, Region, crop_bgra, tile_hashes
+
+
+def _frame(width: int, height: int, fill: int = 0x20) -> bytearray:
+    return bytearray([fill, fill, fill, 0xFF] * (width * height))
+
+
+def _paint(frame: bytearray, width: int, x: int, y: int, w: int, h: int, value: int) -> None:
+    for row in range(y, y + h):
+        for col in range(x, x + w):
+            offset = (row * width + col) * 4
+            frame[offset : offset + 3] = bytes([value, value, value])
+
+
+def _reference_crop(bgra: bytes, src_w: int, x: int, y: int, w: int, h: int) -> bytes:
+    out = bytearray()
+    for row in range(y, y + h):
+        start = (row * src_w + x) * 4
+        out += bgra[start : start + w * 4]
+    return bytes(out)
+
+
+class CropBgraTests(unittest.TestCase):
+    def test_crop_matches_row_by_row_copy(self):
+        width, height = 37, 23
+        bgra = bytes(range(256)) * ((width * height * 4) // 256 + 1)
+        bgra = bgra[: width * height * 4]
+
+        self.assertEqual(crop_bgra(bgra, width, height, 5, 3, 17, 11), _reference_crop(bgra, width, 5, 3, 17, 11))
+        self.assertEqual(crop_bgra(bgra, width, height, 0, 0, width, height), bgra)
+
+    def test_crop_rejects_out_of_bounds(self):
+        bgra = bytes(_frame(8, 8))
+        with self.assertRaises(ValueError):
+            crop_bgra(bgra, 8, 8, 4, 4, 5, 1)
+        with self.assertRaises(ValueError):
+            crop_bgra(bgra, 8, 8, -1, 0, 2, 2)
+
+
+class FrameDifferTests(unittest.TestCase):
+    def test_first_frame_is_changed_and_identical_frame_is_skipped(self):
+        differ = FrameDiffer(tile_size=16, downsample=2)
+        frame = _frame(64, 48)
+
+        first = differ.diff("wechat", frame, 64, 48)
+        again = differ.diff("wechat", bytes(frame), 64, 48)
+
+        self.assertTrue(first.changed)
+        self.assertTrue(first.first_frame)
+        self.assertEqual(first.regions, [Region(0, 0, 64, 48)])
+        self.assertFalse(again.changed)
+        self.assertEqual(again.regions, [])
+        self.assertEqual(again.tiles_total, 12)
+
+    def test_reports_changed_tiles_as_merged_regions(self):
+        differ = FrameDiffer(tile_size=16, downsample=2)
+        frame = _frame(64, 48)
+        differ.diff(1, frame, 64, 48)
+
+        # 跨两列两行的一块 + 右下角单独一块
+        _paint(frame, 64, 20, 4, 16, 20, 0xC0)
+        _paint(frame, 64, 50, 40, 4, 4, 0x80)
+        diff = differ.diff(1, frame, 64, 48)
+
+        self.assertTrue(diff.changed)
+        self.assertFalse(diff.first_frame)
+        self.assertEqual(diff.tiles_changed, 5)
+        self.assertEqual(diff.regions, [Region(16, 0, 32, 32), Region(48, 32, 16, 16)])
+
+    def test_alpha_and_unsampled_pixels_are_ignored(self):
+        differ = FrameDiffer(tile_size=16, downsample=4)
+        frame = _frame(32, 32)
+        differ.diff("k", frame, 32, 32)
+
+        frame[3] = 0x00  # alpha
+        _paint(frame, 32, 1, 1, 1, 1, 0xFF)  # 不在采样点上
+        self.assertFalse(differ.diff("k", frame, 32, 32).changed)
+
+        _paint(frame, 32, 4, 4, 1, 1, 0xFF)
+        self.assertEqual(differ.diff("k", frame, 32, 32).regions, [Region(0, 0, 16, 16)])
+
+    def test_partial_edge_tiles_are_clamped_to_frame(self):
+        differ = FrameDiffer(tile_size=16, downsample=1)
+        frame = _frame(40, 20)
+        self.assertEqual(tile_hashes(frame, 40, 20, 16, 1).shape, (2, 3))
+        differ.diff("k", frame, 40, 20)
+
+        _paint(frame, 40, 39, 19, 1, 1, 0xFF)
+        self.assertEqual(differ.diff("k", frame, 40, 20).regions, [Region(32, 16, 8, 4)])
+
+    def test_keys_are_independent_and_resize_restarts(self):
+        differ = FrameDiffer(tile_size=16, downsample=2, max_entries=2)
+        frame = _frame(32, 32)
+        differ.diff("a", frame, 32, 32)
+        differ.diff("b", _frame(32, 32, 0x40), 32, 32)
+
+        self.assertFalse(differ.diff("a", frame, 32, 32).changed)
+        self.assertTrue(differ.diff("a", _frame(48, 32), 48, 32).first_frame)
+
+        # 超过 max_entries 时最久未用的 key 被丢弃
+        differ.diff("c", frame, 32, 32)
+        self.assertTrue(differ.diff("b", _frame(32, 32, 0x40), 32, 32).first_frame)
+
+        differ.forget("c")
+        self.assertTrue(differ.diff("c", frame, 32, 32).first_frame)
+
+
+if __name__ == "__main__":
+    unittest.main()
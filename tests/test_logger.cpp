@@ -0,0 +1,120 @@
+#include <QtTest>
+#include <QDir>
+#include <QFile>
+#include <QTemporaryDir>
+#include <QThread>
+#include "utils/logger.h"
+
+class TestLogger : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void async_writesQueuedLinesFromManyThreads();
+    void rateLimit_dropsNoisyCategoryOnly();
+    void rotation_switchesFileWhenSizeExceeded();
+
+private:
+    static QString readAll(const QString& path);
+};
+
+QString TestLogger::readAll(const QString& path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
+        return QString();
+    return QString::fromUtf8(file.readAll());
+}
+
+void TestLogger::async_writesQueuedLinesFromManyThreads()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    Logger::Options options;
+    options.directory = dir.path();
+    options.rateLimitedPrefixes.clear();
+    Logger::init(options);
+    const QString path = Logger::logFilePath();
+
+    QList<QThread*> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.append(QThread::create([t]() {
+            for (int i = 0; i < 250; ++i)
+                qInfo() << "[Worker]" << t << i;
+        }));
+    }
+    for (QThread* thread : threads)
+        thread->start();
+    for (QThread* thread : threads) {
+        thread->wait();
+        delete thread;
+    }
+    qWarning() << "[Worker] done";
+    Logger::flush();
+    Logger::shutdown();
+
+    const QString content = readAll(path);
+    QCOMPARE(content.count(QStringLiteral("[Worker]")), 4 * 250 + 1);
+    QVERIFY(content.contains(QStringLiteral("[WARN ] [Worker] done")));
+    QVERIFY(content.contains(QStringLiteral("应用关闭")));
+    QCOMPARE(Logger::droppedCount(), quint64(0));
+}
+
+void TestLogger::rateLimit_dropsNoisyCategoryOnly()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    Logger::Options options;
+    options.directory = dir.path();
+    options.rateLimitPerSecond = 5;
+    Logger::init(options);
+    const QString path = Logger::logFilePath();
+    const quint64 limitedBefore = Logger::rateLimitedCount();
+
+    for (int i = 0; i < 100; ++i) {
+        qInfo() << "[MessageRouter] incoming" << i;
+        qInfo() << "[Other] line" << i;
+    }
+    qWarning() << "[MessageRouter] warnings are never limited";
+    Logger::flush();
+    Logger::shutdown();
+
+    const QString content = readAll(path);
+    const int routerInfo = content.count(QStringLiteral("[MessageRouter] incoming"));
+    QVERIFY2(routerInfo >= 5 && routerInfo <= 10, qPrintable(QString::number(routerInfo))); // 可能跨过一个秒边界
+    QCOMPARE(content.count(QStringLiteral("[Other] line")), 100);
+    QVERIFY(content.contains(QStringLiteral("warnings are never limited")));
+    QCOMPARE(Logger::rateLimitedCount() - limitedBefore, quint64(100 - routerInfo));
+}
+
+void TestLogger::rotation_switchesFileWhenSizeExceeded()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    Logger::Options options;
+    options.directory = dir.path();
+    options.maxFileBytes = 4096;
+    options.flushIntervalMs = 1;
+    Logger::init(options);
+
+    for (int i = 0; i < 200; ++i) {
+        qInfo() << "[Rotate] padding padding padding padding" << i;
+        if (i % 20 == 0)
+            Logger::flush();
+    }
+    Logger::flush();
+    Logger::shutdown();
+
+    const QStringList files = QDir(dir.path()).entryList({QStringLiteral("*.log")}, QDir::Files, QDir::Name);
+    QVERIFY2(files.size() >= 2, qPrintable(files.join(QLatin1Char(','))));
+    int total = 0;
+    for (const QString& name : files) {
+        const QString content = readAll(dir.filePath(name));
+        total += content.count(QStringLiteral("[Rotate]"));
+        QVERIFY(QFileInfo(dir.filePath(name)).size() <= options.maxFileBytes + 64 * 1024);
+    }
+    QCOMPARE(total, 200);
+}
+
+QTEST_MAIN(TestLogger)
+#include "test_logger.moc"
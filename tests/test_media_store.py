@@ -0,0 +1,162 @@
+import hashlib
+import os
+import sys
+import tempfile
+import unittest
+from pathlib import Path
+from unittest import mock
+
+
+REPO_ROOT = Path(__file__).resolve().parents[1]
+PYTHON_DIR = REPO_ROOT / "python"
+if str(PYTHON_DIR) not in sys.path:
+    sys.path.insert(0, str(PYTHON_DIR))
+
+import rpa.core.media_store as media_store_module
+from rpa.core.media_store import MediaStore, release_media_paths
+
+
+def temporary_directory():
+    root = REPO_ROOT / "Testing" / "tmp"
+    root.mkdir(parents=True, exist_ok=True)
+    return tempfile.TemporaryDirectory(dir=root)
+
+
+def _digest(data: bytes) -> str:
+    return hashlib.sha256(data).hexdigest()
+
+
+class MediaStoreTests(unittest.TestCase):
+    def test_same_content_is_stored_once_and_linked_into_each_session(self):
+        with temporary_directory() as tmp:
+            store = MediaStore(Path(tmp) / "media")
+            source = Path(tmp) / "clip.mp4"
+            source.write_bytes(b"video-bytes" * 100)
+
+            first = store.store_file(source, store.root_dir / "video" / "msg-1", "clip.mp4")
+            second = store.store_file(source, store.root_dir / "video" / "msg-2", "clip.mp4")
+            again = store.store_file(source, store.root_dir / "video" / "msg-1", "clip.mp4")
+
+            blob = store.blob_path(_digest(source.read_bytes()), ".mp4")
+            self.assertEqual(first.read_bytes(), source.read_bytes())
+            self.assertTrue(os.path.samefile(first, blob))
+            self.assertTrue(os.path.samefile(second, blob))
+            self.assertEqual(again, first)
+            self.assertEqual(blob.stat().st_nlink, 3)
+            self.assertEqual(sorted(p.name for p in (store.root_dir / "video" / "msg-1").iterdir()), ["clip.mp4"])
+
+    def test_different_content_with_same_name_gets_suffixed_target(self):
+        with temporary_directory() as tmp:
+            store = MediaStore(Path(tmp) / "media")
+            folder = store.root_dir / "image"
+
+            first = store.store_bytes(b"one", folder, "a.png")
+            second = store.store_bytes(b"two", folder, "a.png")
+
+            self.assertEqual(first.name, "a.png")
+            self.assertEqual(second.name, "a_2.png")
+            self.assertEqual(second.read_bytes(), b"two")
+
+    def test_migrate_replaces_duplicate_files_with_links(self):
+        with temporary_directory() as tmp:
+            root = Path(tmp) / "media"
+            data = b"x" * 4096
+            paths = [
+                root / "image" / "s1" / "abc.jpg",
+                root / "image" / "s1" / "abc_2.jpg",
+                root / "video" / "s2" / "abc.jpg",
+            ]
+            for path in paths:
+                path.parent.mkdir(parents=True, exist_ok=True)
+                path.write_bytes(data)
+            (root / "file" / "s3").mkdir(parents=True)
+            (root / "file" / "s3" / "note.txt").write_bytes(b"unique")
+
+            report = MediaStore(root).migrate()
+
+            self.assertEqual(report.files, 4)
+            self.assertEqual(report.deduplicated, 2)
+            self.assertEqual(report.bytes_reclaimed, 2 * len(data))
+            self.assertEqual(report.errors, [])
+            for path in paths[1:]:
+                self.assertTrue(os.path.samefile(paths[0], path))
+                self.assertEqual(path.read_bytes(), data)
+            self.assertEqual(MediaStore(root).migrate().deduplicated, 0)
+
+    def test_release_collects_blob_after_last_reference(self):
+        with temporary_directory() as tmp:
+            store = MediaStore(Path(tmp) / "media")
+            first = store.store_bytes(b"shared", store.root_dir / "image" / "m1", "a.png")
+            second = store.store_bytes(b"shared", store.root_dir / "image" / "m2", "a.png")
+            blob = store.blob_path(_digest(b"shared"), ".png")
+            referenced = {str(first), str(second)}
+
+            referenced.discard(str(first))
+            self.assertEqual(release_media_paths([str(first)], referenced.__contains__), 1)
+            self.assertFalse(first.exists())
+            self.assertFalse((store.root_dir / "image" / "m1").exists())
+            self.assertTrue(blob.exists())
+
+            referenced.discard(str(second))
+            self.assertEqual(release_media_paths([str(second)], referenced.__contains__), 1)
+            self.assertFalse(second.exists())
+            self.assertFalse(blob.exists())
+
+    def test_release_keeps_referenced_and_foreign_files(self):
+        with temporary_directory() as tmp:
+            store = MediaStore(Path(tmp) / "media")
+            kept = store.store_bytes(b"kept", store.root_dir / "image", "kept.png")
+            foreign = Path(tmp) / "outside.txt"
+            foreign.write_bytes(b"user file")
+
+            released = release_media_paths([str(kept), str(foreign)], lambda path: path == str(kept))
+
+            self.assertEqual(released, 0)
+            self.assertTrue(kept.exists())
+            self.assertTrue(foreign.exists())
+
+    def test_release_finds_blob_stored_under_source_suffix(self):
+        with temporary_directory() as tmp:
+            store = MediaStore(Path(tmp) / "media")
+            source = Path(tmp) / "clip.mp4"
+            source.write_bytes(b"renamed video")
+            # 会话文件名没有后缀时 blob 取源文件后缀
+            placed = store.store_file(source, store.root_dir / "video" / "m1", "clip")
+            blob = store.blob_path(_digest(b"renamed video"), ".mp4")
+            self.assertTrue(os.path.samefile(placed, blob))
+
+            self.assertEqual(release_media_paths([str(placed)], lambda path: False), 1)
+            self.assertFalse(blob.exists())
+            self.assertFalse(store.blob_dir.joinpath(blob.parent.name).exists())
+
+    def test_blob_collected_before_link_is_rewritten(self):
+        with temporary_directory() as tmp:
+            store = MediaStore(Path(tmp) / "media")
+            real_link = os.link
+            calls = []
+
+            def link_after_blob_vanished(src, dst):
+                calls.append(dst)
+                if len(calls) == 1:
+                    Path(src).unlink()
+                return real_link(src, dst)
+
+            with mock.patch.object(media_store_module.os, "link", side_effect=link_after_blob_vanished):
+                placed = store.store_bytes(b"racy", store.root_dir / "image" / "m1", "a.png")
+
+            blob = store.blob_path(_digest(b"racy"), ".png")
+            self.assertEqual(len(calls), 2)
+            self.assertEqual(placed.name, "a.png")
+            self.assertEqual(placed.read_bytes(), b"racy")
+            self.assertTrue(os.path.samefile(placed, blob))
+
+    def test_instances_on_same_root_share_one_lock(self):
+        with temporary_directory() as tmp:
+            root = Path(tmp) / "media"
+            root.mkdir()
+            self.assertIs(MediaStore(root)._lock, MediaStore(root / "image" / "..")._lock)
+            self.assertIsNot(MediaStore(root)._lock, MediaStore(Path(tmp) / "other")._lock)
+
+
+if __name__ == "__main__":
+    unittest.main()
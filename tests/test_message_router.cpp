@@ -2,10 +2,13 @@
 
 #include "core/messagerouter.h"
 #include "data/conversationdao.h"
+#include "data/dataeventbus.h"
 #include "data/database.h"
 #include "data/messagedao.h"
 #include "services/platforms/iplatformadapter.h"
+#include "services/platforms/outboundsendqueue.h"
 #include "testdatabase.h"
+#include "utils/runtimemode.h"
 
 #include <QDir>
 #include <QSqlQuery>
@@ -74,6 +77,7 @@ class TestMessageRouter : public QObject
 
 private slots:
     void initTestCase();
+    void cleanup();
     void incomingMessage_createsConversationAndPersistsMessage();
     void incomingWechatMessage_upgradesLegacyShortConversationKey();
     void incomingQianniuMessage_upgradesLegacyShortConversationKey();
@@ -82,6 +86,9 @@ private slots:
     void sendMessage_autoAck_marksMessageAsSent();
     void sendFailed_mapsBackToConversationIdByAdapterPlatform();
     void sendFailed_marksLatestPendingMessageAsFailed();
+    void sendLifecycle_publishesSendEventsOnBus();
+    void delegatedSend_signalsInFlightUntilAdapterResult();
+    void outboundQueue_keepsConversationOrderAndResumesAfterRestart();
 };
 
 void TestMessageRouter::initTestCase()
@@ -92,6 +99,11 @@ void TestMessageRouter::initTestCase()
     qRegisterMetaType<Models::MessageStatus>("Models::MessageStatus");
 }
 
+void TestMessageRouter::cleanup()
+{
+    RuntimeMode::setLocalCacheIngestOverride(false);
+}
+
 void TestMessageRouter::incomingMessage_createsConversationAndPersistsMessage()
 {
     ScopedTestDatabase db;
@@ -415,5 +427,141 @@ void TestMessageRouter::sendFailed_marksLatestPendingMessageAsFailed()
     QCOMPARE(messages.first().errorReason, QStringLiteral("writer timeout"));
 }
 
+void TestMessageRouter::sendLifecycle_publishesSendEventsOnBus()
+{
+    ScopedTestDatabase db;
+    Q_UNUSED(db);
+    // 时间线行只在客户端自行入库时由路由写入
+    RuntimeMode::setLocalCacheIngestOverride(true);
+
+    ConversationDao convDao;
+    const int convId = convDao.create(QStringLiteral("qianniu"),
+                                      QStringLiteral("qn-conv-3"),
+                                      QStringLiteral("客户丙"));
+    QVERIFY(convId > 0);
+
+    MessageRouter router;
+    FakePlatformAdapter adapter(QStringLiteral("qianniu"));
+    router.registerAdapter(&adapter);
+
+    QSignalSpy busSpy(&DataEventBus::instance(), &DataEventBus::messageSendEventAppended);
+    const qint64 baseline = MessageSendEventDao().globalMaxId();
+
+    router.sendMessage(convId, QStringLiteral("推送时间线"));
+    adapter.emitSendFailed(QStringLiteral("qn-conv-3"), QStringLiteral("writer timeout"));
+
+    QCOMPARE(busSpy.count(), 2);
+    const auto attempt = busSpy.at(0).at(0).value<MessageSendEventRecord>();
+    const auto failed = busSpy.at(1).at(0).value<MessageSendEventRecord>();
+    QCOMPARE(attempt.phase, QStringLiteral("send_attempt"));
+    QCOMPARE(attempt.conversationId, convId);
+    QCOMPARE(failed.phase, QStringLiteral("failed"));
+    QCOMPARE(failed.detail, QStringLiteral("writer timeout"));
+    QCOMPARE(failed.messageId, attempt.messageId);
+    QCOMPARE(failed.id, attempt.id + 1);
+
+    // 推送的记录与表中的行一致，界面回表补齐时不会重复或遗漏
+    const auto rows = MessageSendEventDao().listSince(convId, baseline);
+    QCOMPARE(rows.size(), 2);
+    QCOMPARE(rows.at(0).id, attempt.id);
+    QCOMPARE(rows.at(1).id, failed.id);
+}
+
+void TestMessageRouter::delegatedSend_signalsInFlightUntilAdapterResult()
+{
+    ScopedTestDatabase db;
+    Q_UNUSED(db);
+    QVERIFY(RuntimeMode::ownsBusinessDatabase());
+
+    ConversationDao convDao;
+    const int convId = convDao.create(QStringLiteral("qianniu"),
+                                      QStringLiteral("qn-conv-4"),
+                                      QStringLiteral("客户丁"));
+    QVERIFY(convId > 0);
+
+    MessageRouter router;
+    FakePlatformAdapter adapter(QStringLiteral("qianniu"));
+    router.registerAdapter(&adapter);
+
+    QSignalSpy delegatedSpy(&router, &MessageRouter::sendDelegated);
+    QSignalSpy finishedSpy(&router, &MessageRouter::delegatedSendFinished);
+    QSignalSpy busSpy(&DataEventBus::instance(), &DataEventBus::messageSendEventAppended);
+
+    router.sendMessage(convId, QStringLiteral("转交服务发送"));
+    QCOMPARE(delegatedSpy.count(), 1);
+    QCOMPARE(delegatedSpy.at(0).at(0).toInt(), convId);
+    QCOMPARE(delegatedSpy.at(0).at(1).toString(), adapter.lastClientMessageId);
+    QCOMPARE(finishedSpy.count(), 0);
+    QCOMPARE(busSpy.count(), 0);
+
+    adapter.emitSendFailed(QStringLiteral("qn-conv-4"), QStringLiteral("writer timeout"),
+                           adapter.lastClientMessageId);
+    QCOMPARE(finishedSpy.count(), 1);
+    QCOMPARE(finishedSpy.at(0).at(0).toInt(), convId);
+    QCOMPARE(finishedSpy.at(0).at(1).toString(), adapter.lastClientMessageId);
+}
+
+void TestMessageRouter::outboundQueue_keepsConversationOrderAndResumesAfterRestart()
+{
+    ScopedTestDatabase db;
+    Q_UNUSED(db);
+
+    QStringList dispatched;
+    auto dispatcher = [&dispatched](const OutboundSendRecord& record) {
+        dispatched.append(record.clientMessageId);
+        return OutboundDispatchResult::AwaitingConfirm;
+    };
+
+    {
+        OutboundSendQueue queue(QStringLiteral("qianniu"), QStringLiteral("qianniu"), dispatcher, 2);
+        OutgoingMessagePart part;
+        part.text = QStringLiteral("第一条");
+        queue.enqueue(QStringLiteral("conv-a"), part, QStringLiteral("a1"));
+        queue.enqueue(QStringLiteral("conv-a"), part, QStringLiteral("a2"));
+        queue.enqueue(QStringLiteral("conv-b"), part, QStringLiteral("b1"));
+
+        // a2 必须等 a1 回执；conv-b 不受影响
+        QTRY_COMPARE(dispatched, QStringList({QStringLiteral("a1"), QStringLiteral("b1")}));
+        QCOMPARE(queue.depth(), 1);
+        QCOMPARE(queue.inFlightCount(), 2);
+        QVERIFY(!queue.complete(QStringLiteral("unknown")));
+
+        QVERIFY(queue.complete(QStringLiteral("a1")));
+        QTRY_COMPARE(dispatched.size(), 3);
+        QCOMPARE(dispatched.last(), QStringLiteral("a2"));
+
+        queue.enqueue(QStringLiteral("conv-a"), part, QStringLiteral("a3"));
+        QTest::qWait(20);
+        QCOMPARE(dispatched.size(), 3);
+
+        // 重复入队不排第二份，也不把在途的 a2 改回待发
+        OutgoingMessagePart retry;
+        retry.text = QStringLiteral("重试的另一份内容");
+        QCOMPARE(queue.enqueue(QStringLiteral("conv-a"), retry, QStringLiteral("a3")), QStringLiteral("a3"));
+        QCOMPARE(queue.enqueue(QStringLiteral("conv-a"), retry, QStringLiteral("a2")), QStringLiteral("a2"));
+        QCOMPARE(queue.depth(), 1);
+        QCOMPARE(queue.inFlightCount(), 2);
+        const QVector<OutboundSendRecord> stored
+            = OutboundSendQueueDao().listPending(QStringLiteral("qianniu"), QStringLiteral("qianniu"));
+        QCOMPARE(stored.size(), 3);
+        for (const OutboundSendRecord& record : stored) {
+            QCOMPARE(record.part.text, QStringLiteral("第一条"));
+            if (record.clientMessageId == QLatin1String("a2"))
+                QCOMPARE(record.state, QStringLiteral("in_flight"));
+        }
+    }
+
+    // 模拟重启：已派发未确认的按中断失败，未派发的继续发送
+    dispatched.clear();
+    OutboundSendQueue restored(QStringLiteral("qianniu"), QStringLiteral("qianniu"), dispatcher, 2);
+    QSignalSpy abandoned(&restored, &OutboundSendQueue::sendAbandoned);
+    restored.restorePending();
+    QCOMPARE(abandoned.size(), 2);
+    QCOMPARE(abandoned.at(0).at(1).toString(), QStringLiteral("send_interrupted"));
+    QTRY_COMPARE(dispatched, QStringList({QStringLiteral("a3")}));
+    QVERIFY(restored.complete(QStringLiteral("a3")));
+    QCOMPARE(OutboundSendQueueDao().listPending(QStringLiteral("qianniu"), QStringLiteral("qianniu")).size(), 0);
+}
+
 QTEST_MAIN(TestMessageRouter)
 #include "test_message_router.moc"
@@ -0,0 +1,188 @@
+#include <QtTest>
+#include <QAbstractItemModelTester>
+#include <QSignalSpy>
+#include "ui/messagelistmodel.h"
+
+namespace {
+
+MessageRecord makeMessage(int id, const QDateTime& createdAt, const QString& content = QString())
+{
+    MessageRecord rec;
+    rec.id = id;
+    rec.conversationId = 1;
+    rec.direction = QStringLiteral("in");
+    rec.sender = QStringLiteral("customer");
+    rec.content = content.isEmpty() ? QStringLiteral("消息 %1").arg(id) : content;
+    rec.createdAt = createdAt;
+    return rec;
+}
+
+const QDateTime kDay1(QDate(2026, 3, 1), QTime(9, 0));
+const QDateTime kDay2(QDate(2026, 3, 2), QTime(9, 0));
+const QDateTime kDay3(QDate(2026, 3, 3), QTime(9, 0));
+
+} // namespace
+
+class TestMessageListModel : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void append_insertsSeparatorOnlyWhenDateChanges();
+    void updateStatus_changesOnlyThatRow();
+    void setSameConversation_appendsWithoutReset();
+    void setSameConversation_prependsIntoExistingSeparator();
+    void setSameConversation_removesAndUpdatesRows();
+    void setOtherConversation_resets();
+    void setReordered_fallsBackToReset();
+};
+
+void TestMessageListModel::append_insertsSeparatorOnlyWhenDateChanges()
+{
+    MessageListModel model;
+    QAbstractItemModelTester tester(&model, QAbstractItemModelTester::FailureReportingMode::QtTest);
+    QSignalSpy inserted(&model, &QAbstractItemModel::rowsInserted);
+
+    model.appendMessage(makeMessage(1, kDay1));
+    model.appendMessage(makeMessage(2, kDay1.addSecs(60)));
+    model.appendMessage(makeMessage(3, kDay2));
+    model.appendMessage(makeMessage(3, kDay2));
+
+    // 分隔 / 1 / 2 / 分隔 / 3
+    QCOMPARE(model.rowCount(), 5);
+    QCOMPARE(inserted.count(), 3);
+    QCOMPARE(inserted.at(1).at(1).toInt(), 2);
+    QCOMPARE(inserted.at(1).at(2).toInt(), 2);
+    QCOMPARE(model.findRowByMessageId(2), 2);
+    QCOMPARE(model.findRowByMessageId(3), 4);
+    QVERIFY(model.index(3).data(MessageListModel::IsSeparatorRole).toBool());
+    QVERIFY(!model.containsMessageId(4));
+}
+
+void TestMessageListModel::updateStatus_changesOnlyThatRow()
+{
+    MessageListModel model;
+    model.setConversationMessages(1, {makeMessage(1, kDay1), makeMessage(2, kDay1), makeMessage(3, kDay2)});
+    QSignalSpy changed(&model, &QAbstractItemModel::dataChanged);
+
+    QVERIFY(model.updateMessageStatus(3, Models::MessageStatus::Failed, QStringLiteral("窗口未找到")));
+    QVERIFY(!model.updateMessageStatus(99, Models::MessageStatus::Sent));
+
+    QCOMPARE(changed.count(), 1);
+    QCOMPARE(changed.at(0).at(0).toModelIndex().row(), 4);
+    QCOMPARE(changed.at(0).at(1).toModelIndex().row(), 4);
+    const MessageRecord rec = model.index(4).data(MessageListModel::MessageRole).value<MessageRecord>();
+    QCOMPARE(rec.errorReason, QStringLiteral("窗口未找到"));
+    QCOMPARE(rec.status, Models::toString(Models::MessageStatus::Failed));
+}
+
+void TestMessageListModel::setSameConversation_appendsWithoutReset()
+{
+    MessageListModel model;
+    QAbstractItemModelTester tester(&model, QAbstractItemModelTester::FailureReportingMode::QtTest);
+    const QVector<MessageRecord> initial{makeMessage(1, kDay1), makeMessage(2, kDay1)};
+    model.setConversationMessages(1, initial);
+
+    QSignalSpy reset(&model, &QAbstractItemModel::modelReset);
+    QSignalSpy inserted(&model, &QAbstractItemModel::rowsInserted);
+    QSignalSpy changed(&model, &QAbstractItemModel::dataChanged);
+
+    model.setConversationMessages(1, initial);
+    QCOMPARE(inserted.count(), 0);
+    QCOMPARE(changed.count(), 0);
+
+    model.setConversationMessages(1, initial + QVector<MessageRecord>{makeMessage(3, kDay1), makeMessage(4, kDay2)});
+
+    QCOMPARE(reset.count(), 0);
+    QCOMPARE(inserted.count(), 1);
+    QCOMPARE(inserted.at(0).at(1).toInt(), 3);
+    QCOMPARE(inserted.at(0).at(2).toInt(), 5);
+    QCOMPARE(changed.count(), 0);
+    QCOMPARE(model.rowCount(), 6);
+    QCOMPARE(model.findRowByMessageId(4), 5);
+}
+
+void TestMessageListModel::setSameConversation_prependsIntoExistingSeparator()
+{
+    MessageListModel model;
+    QAbstractItemModelTester tester(&model, QAbstractItemModelTester::FailureReportingMode::QtTest);
+    model.setConversationMessages(1, {makeMessage(10, kDay2), makeMessage(11, kDay3)});
+
+    QSignalSpy reset(&model, &QAbstractItemModel::modelReset);
+    QSignalSpy inserted(&model, &QAbstractItemModel::rowsInserted);
+
+    // 更早的历史：一条与首条同日（并入已有分隔行之后），两条在前一天（带新分隔行）
+    model.setConversationMessages(1, {makeMessage(5, kDay1),
+                                      makeMessage(6, kDay1),
+                                      makeMessage(7, kDay2),
+                                      makeMessage(10, kDay2.addSecs(60)),
+                                      makeMessage(11, kDay3)});
+
+    QCOMPARE(reset.count(), 0);
+    QCOMPARE(inserted.count(), 2);
+    QCOMPARE(inserted.at(0).at(1).toInt(), 0);
+    QCOMPARE(inserted.at(0).at(2).toInt(), 2);
+    QCOMPARE(inserted.at(1).at(1).toInt(), 4);
+    QCOMPARE(inserted.at(1).at(2).toInt(), 4);
+    QCOMPARE(model.rowCount(), 8);
+    QCOMPARE(model.findRowByMessageId(7), 4);
+    QCOMPARE(model.findRowByMessageId(10), 5);
+    QCOMPARE(model.findRowByMessageId(11), 7);
+    QCOMPARE(model.index(3).data(MessageListModel::SeparatorDateRole).toDate(), kDay2.date());
+}
+
+void TestMessageListModel::setSameConversation_removesAndUpdatesRows()
+{
+    MessageListModel model;
+    QAbstractItemModelTester tester(&model, QAbstractItemModelTester::FailureReportingMode::QtTest);
+    model.setConversationMessages(1, {makeMessage(1, kDay1), makeMessage(2, kDay2), makeMessage(3, kDay2)});
+
+    QSignalSpy reset(&model, &QAbstractItemModel::modelReset);
+    QSignalSpy removed(&model, &QAbstractItemModel::rowsRemoved);
+    QSignalSpy changed(&model, &QAbstractItemModel::dataChanged);
+
+    MessageRecord edited = makeMessage(3, kDay2, QStringLiteral("已撤回"));
+    model.setConversationMessages(1, {makeMessage(2, kDay2), edited});
+
+    QCOMPARE(reset.count(), 0);
+    QCOMPARE(removed.count(), 1);
+    QCOMPARE(removed.at(0).at(1).toInt(), 0);
+    QCOMPARE(removed.at(0).at(2).toInt(), 1);
+    QCOMPARE(changed.count(), 1);
+    QCOMPARE(changed.at(0).at(0).toModelIndex().row(), 2);
+    QCOMPARE(model.index(2).data(Qt::DisplayRole).toString(), QStringLiteral("已撤回"));
+    QVERIFY(!model.containsMessageId(1));
+    QCOMPARE(model.findRowByMessageId(3), 2);
+}
+
+void TestMessageListModel::setOtherConversation_resets()
+{
+    MessageListModel model;
+    model.setConversationMessages(1, {makeMessage(1, kDay1)});
+    QSignalSpy reset(&model, &QAbstractItemModel::modelReset);
+
+    model.setConversationMessages(2, {makeMessage(1, kDay1)});
+    model.clear();
+
+    QCOMPARE(reset.count(), 2);
+    QCOMPARE(model.rowCount(), 0);
+    QCOMPARE(model.conversationId(), -1);
+    QVERIFY(!model.containsMessageId(1));
+}
+
+void TestMessageListModel::setReordered_fallsBackToReset()
+{
+    MessageListModel model;
+    QAbstractItemModelTester tester(&model, QAbstractItemModelTester::FailureReportingMode::QtTest);
+    model.setConversationMessages(1, {makeMessage(1, kDay1), makeMessage(2, kDay1)});
+    QSignalSpy reset(&model, &QAbstractItemModel::modelReset);
+
+    model.setConversationMessages(1, {makeMessage(2, kDay1), makeMessage(1, kDay1)});
+
+    QCOMPARE(reset.count(), 1);
+    QCOMPARE(model.findRowByMessageId(2), 1);
+    QCOMPARE(model.findRowByMessageId(1), 2);
+}
+
+QTEST_MAIN(TestMessageListModel)
+#include "test_messagelistmodel.moc"
@@ -0,0 +1,167 @@
+#include <QtTest>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QThread>
+#include <memory>
+#include <vector>
+#include "utils/metrics.h"
+
+// 注册表是进程级单例，各用例使用互不相同的指标名
+class TestMetrics : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void histogram_bucketBoundsCoverValues();
+    void histogram_percentilesWithinRelativeError();
+    void histogram_concurrentRecordsAreCounted();
+    void registry_returnsSameInstanceForSameNameAndLabels();
+    void registry_runsCollectorsBeforeSnapshot();
+    void export_jsonAndPrometheusFormats();
+};
+
+void TestMetrics::histogram_bucketBoundsCoverValues()
+{
+    const qint64 values[] = {0, 1, 15, 16, 17, 31, 32, 100, 1000, 65535, 1000000, qint64(1) << 40};
+    for (qint64 value : values) {
+        const int index = Metrics::Histogram::bucketIndex(value);
+        QVERIFY2(Metrics::Histogram::bucketUpperBound(index) >= value, qPrintable(QString::number(value)));
+        if (index > 0)
+            QVERIFY2(Metrics::Histogram::bucketUpperBound(index - 1) < value, qPrintable(QString::number(value)));
+    }
+    QCOMPARE(Metrics::Histogram::bucketIndex(std::numeric_limits<qint64>::max()),
+             Metrics::Histogram::kBucketCount - 1);
+}
+
+void TestMetrics::histogram_percentilesWithinRelativeError()
+{
+    Metrics::Histogram histogram;
+    QCOMPARE(histogram.percentile(0.5), qint64(0));
+
+    std::vector<qint64> values;
+    for (qint64 v = 1; v <= 100000; ++v)
+        values.push_back(v);
+    for (qint64 v : values)
+        histogram.record(v);
+
+    const Metrics::Histogram::Summary summary = histogram.summary();
+    QCOMPARE(summary.count, quint64(values.size()));
+    QCOMPARE(summary.min, qint64(1));
+    QCOMPARE(summary.max, qint64(100000));
+    QCOMPARE(summary.sum, qint64(100000) * 100001 / 2);
+
+    // 每个 2 的幂区间分 16 档，上界估计的相对误差不超过 1/16
+    const QPair<double, qint64> expected[] = {{0.5, 50000}, {0.9, 90000}, {0.99, 99000}, {0.999, 99900}};
+    for (const auto& item : expected) {
+        const qint64 actual = histogram.percentile(item.first);
+        QVERIFY2(actual >= item.second, qPrintable(QString::number(actual)));
+        QVERIFY2(double(actual - item.second) / double(item.second) <= 1.0 / 16.0, qPrintable(QString::number(actual)));
+    }
+    QCOMPARE(summary.p50, histogram.percentile(0.5));
+    QCOMPARE(histogram.percentile(1.0), qint64(100000));
+}
+
+void TestMetrics::histogram_concurrentRecordsAreCounted()
+{
+    Metrics::Histogram histogram;
+    constexpr int kThreads = 4;
+    constexpr int kPerThread = 20000;
+    QList<QThread*> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.append(QThread::create([&histogram]() {
+            for (int i = 0; i < kPerThread; ++i)
+                histogram.record(i % 500);
+        }));
+    }
+    for (QThread* thread : threads)
+        thread->start();
+    for (QThread* thread : threads) {
+        QVERIFY(thread->wait(10000));
+        delete thread;
+    }
+    QCOMPARE(histogram.count(), quint64(kThreads * kPerThread));
+    QCOMPARE(histogram.summary().max, qint64(499));
+}
+
+void TestMetrics::registry_returnsSameInstanceForSameNameAndLabels()
+{
+    Metrics::Counter* a = Metrics::counter(QStringLiteral("test_requests_total"),
+                                           {{QStringLiteral("method"), QStringLiteral("GET")}});
+    Metrics::Counter* b = Metrics::counter(QStringLiteral("test_requests_total"),
+                                           {{QStringLiteral("method"), QStringLiteral("GET")}});
+    Metrics::Counter* c = Metrics::counter(QStringLiteral("test_requests_total"),
+                                           {{QStringLiteral("method"), QStringLiteral("POST")}});
+    QVERIFY(a);
+    QCOMPARE(a, b);
+    QVERIFY(a != c);
+    a->increment();
+    b->increment(2);
+    QCOMPARE(a->value(), quint64(3));
+    QCOMPARE(c->value(), quint64(0));
+
+    Metrics::Gauge* gauge = Metrics::gauge(QStringLiteral("test_depth"));
+    gauge->set(5);
+    gauge->add(-1.5);
+    QCOMPARE(gauge->value(), 3.5);
+
+    QCOMPARE(Metrics::dbStatementLatency("TestDao::find"), Metrics::dbStatementLatency("TestDao::find"));
+}
+
+void TestMetrics::registry_runsCollectorsBeforeSnapshot()
+{
+    // 采集器在注册表中常驻，后续用例的快照也会调用它
+    auto calls = std::make_shared<int>(0);
+    Metrics::Registry::instance().addCollector([calls]() {
+        ++*calls;
+        Metrics::gauge(QStringLiteral("test_collected_value"))->set(*calls);
+    });
+
+    const QVector<Metrics::Sample> samples = Metrics::Registry::instance().snapshot();
+    QCOMPARE(*calls, 1);
+    bool found = false;
+    for (const Metrics::Sample& sample : samples) {
+        if (sample.name == QLatin1String("test_collected_value")) {
+            found = true;
+            QCOMPARE(sample.type, Metrics::Type::Gauge);
+            QCOMPARE(sample.value, 1.0);
+        }
+    }
+    QVERIFY(found);
+}
+
+void TestMetrics::export_jsonAndPrometheusFormats()
+{
+    Metrics::Histogram* latency = Metrics::histogram(QStringLiteral("test_export_us"),
+                                                     {{QStringLiteral("stage"), QStringLiteral("a\"b")}},
+                                                     QStringLiteral("export test"));
+    for (int i = 1; i <= 100; ++i)
+        latency->record(i);
+    Metrics::counter(QStringLiteral("test_export_total"))->increment(7);
+
+    const QJsonObject json = Metrics::Registry::instance().toJson();
+    QVERIFY(json.contains(QStringLiteral("generated_at")));
+    QJsonObject histogramJson;
+    for (const QJsonValue& value : json.value(QStringLiteral("metrics")).toArray()) {
+        const QJsonObject obj = value.toObject();
+        if (obj.value(QStringLiteral("name")).toString() == QLatin1String("test_export_us"))
+            histogramJson = obj;
+    }
+    QCOMPARE(histogramJson.value(QStringLiteral("type")).toString(), QStringLiteral("histogram"));
+    QCOMPARE(histogramJson.value(QStringLiteral("count")).toDouble(), 100.0);
+    QCOMPARE(histogramJson.value(QStringLiteral("labels")).toObject().value(QStringLiteral("stage")).toString(),
+             QStringLiteral("a\"b"));
+    QVERIFY(histogramJson.value(QStringLiteral("p99")).toDouble() >= 99.0);
+
+    const QString text = Metrics::Registry::instance().toPrometheus();
+    QVERIFY(text.contains(QStringLiteral("# HELP test_export_us export test\n")));
+    QVERIFY(text.contains(QStringLiteral("# TYPE test_export_us summary\n")));
+    QVERIFY(text.contains(QStringLiteral("test_export_us{stage=\"a\\\"b\",quantile=\"0.5\"} ")));
+    QVERIFY(text.contains(QStringLiteral("test_export_us_count{stage=\"a\\\"b\"} 100\n")));
+    QVERIFY(text.contains(QStringLiteral("test_export_us_sum{stage=\"a\\\"b\"} 5050\n")));
+    QVERIFY(text.contains(QStringLiteral("# TYPE test_export_total counter\n")));
+    QVERIFY(text.contains(QStringLiteral("test_export_total 7\n")));
+}
+
+QTEST_MAIN(TestMetrics)
+#include "test_metrics.moc"
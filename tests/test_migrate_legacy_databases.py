@@ -174,6 +174,98 @@ class MigrateLegacyDatabasesTests(unittest.TestCase):
             self.assertFalse(result["migrated"])
             self.assertEqual(result["reason"], "target_business_data_exists")
 
+    def test_schema_upgrade_backfills_and_maintains_last_direction(self):
+        with temporary_directory() as tmp:
+            db_path = Path(tmp) / "app_data.db"
+            conn = sqlite3.connect(str(db_path))
+            try:
+                # 加冗余列之前的会话表
+                conn.executescript(
+                    """
+                    CREATE TABLE conversations (
+                      id INTEGER PRIMARY KEY AUTOINCREMENT,
+                      platform TEXT NOT NULL,
+                      platform_conversation_id TEXT,
+                      account_id TEXT DEFAULT '',
+                      customer_name TEXT NOT NULL,
+                      last_message TEXT DEFAULT '',
+                      last_time DATETIME,
+                      unread_count INTEGER DEFAULT 0,
+                      status TEXT DEFAULT 'new',
+                      updated_at DATETIME,
+                      deleted_at DATETIME,
+                      created_at DATETIME DEFAULT CURRENT_TIMESTAMP,
+                      UNIQUE(platform, platform_conversation_id)
+                    );
+                    CREATE TABLE messages (
+                      id INTEGER PRIMARY KEY AUTOINCREMENT,
+                      conversation_id INTEGER NOT NULL,
+                      platform_message_id TEXT DEFAULT '',
+                      client_message_id TEXT DEFAULT '',
+                      direction TEXT NOT NULL,
+                      sender TEXT NOT NULL,
+                      sender_name TEXT DEFAULT '',
+                      content_type TEXT NOT NULL DEFAULT 'text',
+                      content TEXT NOT NULL,
+                      status TEXT NOT NULL DEFAULT 'observed',
+                      error_reason TEXT DEFAULT '',
+                      message_time DATETIME,
+                      created_at DATETIME DEFAULT CURRENT_TIMESTAMP,
+                      updated_at DATETIME DEFAULT CURRENT_TIMESTAMP,
+                      deleted_at DATETIME
+                    );
+                    INSERT INTO conversations (id, platform, platform_conversation_id, customer_name)
+                    VALUES (1, 'wechat', 'wechat:甲', '甲'), (2, 'wechat', 'wechat:乙', '乙');
+                    INSERT INTO messages (id, conversation_id, direction, sender, content)
+                    VALUES (10, 1, 'in', 'customer', '在吗'), (11, 1, 'out', 'agent', '在的');
+                    """
+                )
+                conn.commit()
+            finally:
+                conn.close()
+
+            ensure_app_database_schema(db_path)
+            ensure_app_database_schema(db_path)
+
+            conn = sqlite3.connect(str(db_path))
+            try:
+                def last(conversation_id):
+                    return conn.execute(
+                        "SELECT last_message_id, last_direction FROM conversations WHERE id = ?",
+                        (conversation_id,),
+                    ).fetchone()
+
+                self.assertEqual(last(1), (11, "out"))
+                self.assertEqual(last(2), (0, ""))
+
+                conn.execute(
+                    "INSERT INTO messages (id, conversation_id, direction, sender, content) "
+                    "VALUES (20, 2, 'in', 'customer', '发货了吗')"
+                )
+                self.assertEqual(last(2), (20, "in"))
+
+                # 软删除、删除最后一条都退回到前一条
+                conn.execute("UPDATE messages SET deleted_at = '2026-06-03 13:00:00' WHERE id = 11")
+                self.assertEqual(last(1), (10, "in"))
+                conn.execute("DELETE FROM messages WHERE id = 20")
+                self.assertEqual(last(2), (0, ""))
+
+                # 会话键归一化把消息挪到另一会话，两边都重算
+                conn.execute("UPDATE messages SET conversation_id = 2 WHERE id = 10")
+                self.assertEqual(last(1), (0, ""))
+                self.assertEqual(last(2), (10, "in"))
+
+                plan = " ".join(
+                    row[3]
+                    for row in conn.execute(
+                        "EXPLAIN QUERY PLAN "
+                        "SELECT id, last_direction FROM conversations WHERE last_message_id > 0"
+                    )
+                )
+                self.assertIn("idx_conversations_last_message", plan)
+            finally:
+                conn.close()
+
 
 if __name__ == "__main__":
     unittest.main()
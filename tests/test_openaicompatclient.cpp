@@ -13,6 +13,8 @@ private slots:
     void buildCompletionsUrl_normalizesBaseUrl();
     void handleSseLine_emitsDeltaOnlyOnce();
     void processSseBuffer_handlesMultipleLinesAndKeepAlive();
+    void handleSseLine_reportsUsageFromFinalChunk();
+    void dropStreamOptionsAfterRejection_retriesOnceOnHttp400();
 };
 
 void TestOpenAiCompatClient::buildCompletionsUrl_normalizesBaseUrl()
@@ -60,5 +62,59 @@ void TestOpenAiCompatClient::processSseBuffer_handlesMultipleLinesAndKeepAlive()
     QVERIFY(client.m_sseBuffer.isEmpty());
 }
 
+void TestOpenAiCompatClient::handleSseLine_reportsUsageFromFinalChunk()
+{
+    QNetworkAccessManager nam;
+    OpenAiCompatClient client(&nam);
+    QSignalSpy deltaSpy(&client, &OpenAiCompatClient::streamDelta);
+    QSignalSpy usageSpy(&client, &OpenAiCompatClient::usageReported);
+
+    // DeepSeek：include_usage 的最后一包 choices 为空，命中缓存数在 prompt_cache_hit_tokens
+    QVERIFY(client.handleSseLine(
+        "data: {\"choices\":[],\"usage\":{\"prompt_tokens\":1200,\"completion_tokens\":80,"
+        "\"prompt_cache_hit_tokens\":1024,\"prompt_cache_miss_tokens\":176}}"));
+    QCOMPARE(deltaSpy.count(), 0);
+    QCOMPARE(usageSpy.count(), 1);
+    QCOMPARE(usageSpy.at(0).at(0).toInt(), 1200);
+    QCOMPARE(usageSpy.at(0).at(1).toInt(), 1024);
+    QCOMPARE(usageSpy.at(0).at(2).toInt(), 80);
+
+    // OpenAI / 方舟：prompt_tokens_details.cached_tokens
+    QVERIFY(client.handleSseLine(
+        "data: {\"choices\":[],\"usage\":{\"prompt_tokens\":900,\"completion_tokens\":40,"
+        "\"prompt_tokens_details\":{\"cached_tokens\":768}}}"));
+    QCOMPARE(usageSpy.count(), 2);
+    QCOMPARE(usageSpy.at(1).at(1).toInt(), 768);
+
+    // 普通增量包不带 usage 时不应误报
+    QVERIFY(client.handleSseLine("data: {\"choices\":[{\"delta\":{\"content\":\"好\"}}],\"usage\":null}"));
+    QCOMPARE(usageSpy.count(), 2);
+    QCOMPARE(deltaSpy.count(), 1);
+}
+
+void TestOpenAiCompatClient::dropStreamOptionsAfterRejection_retriesOnceOnHttp400()
+{
+    QNetworkAccessManager nam;
+    OpenAiCompatClient client(&nam);
+
+    QJsonObject streamOptions;
+    streamOptions[QStringLiteral("include_usage")] = true;
+    client.m_pendingRoot[QStringLiteral("model")] = QStringLiteral("m");
+    client.m_pendingRoot[QStringLiteral("stream_options")] = streamOptions;
+    client.m_sseBuffer = "{\"error\":{\"message\":\"unknown field stream_options\"}}";
+
+    // 其它错误码不重发
+    QVERIFY(!client.dropStreamOptionsAfterRejection(401));
+    QVERIFY(client.m_pendingRoot.contains(QStringLiteral("stream_options")));
+
+    QVERIFY(client.dropStreamOptionsAfterRejection(400));
+    QVERIFY(!client.m_pendingRoot.contains(QStringLiteral("stream_options")));
+    QCOMPARE(client.m_pendingRoot.value(QStringLiteral("model")).toString(), QStringLiteral("m"));
+    QVERIFY(client.m_sseBuffer.isEmpty());
+
+    // 去掉后仍 400 就是别的原因，照常报错
+    QVERIFY(!client.dropStreamOptionsAfterRejection(400));
+}
+
 QTEST_MAIN(TestOpenAiCompatClient)
 #include "test_openaicompatclient.moc"
@@ -0,0 +1,143 @@
+import sys
+import unittest
+from pathlib import Path
+
+
+REPO_ROOT = Path(__file__).resolve().parents[1]
+PYTHON_DIR = REPO_ROOT / "python"
+if str(PYTHON_DIR) not in sys.path:
+    sys.path.insert(0, str(PYTHON_DIR))
+
+from rpa.core.poll_scheduler import AdaptivePollScheduler, PollPolicy
+
+
+class FakeClock:
+    def __init__(self):
+        self.now = 1000.0
+
+    def __call__(self):
+        return self.now
+
+    def advance(self, seconds):
+        self.now += seconds
+
+
+class FakeUnreadReader:
+    """按时间脚本返回会话列表上的未读角标：[(起始时间, {会话: 未读数})]，打开过的会话角标清零。"""
+
+    def __init__(self, clock, script):
+        self.clock = clock
+        self.script = script
+        self.opened = []
+
+    def read(self):
+        visible = {}
+        for started_at, badges in self.script:
+            if self.clock() >= started_at:
+                visible = dict(badges)
+        for key in self.opened:
+            visible.pop(key, None)
+        return visible
+
+
+def run_observer(scheduler, reader, clock, *, until, per_tick=3):
+    """照观察线程的用法驱动调度器，返回每轮的 (时间, 等待秒数, 本轮打开的会话)。"""
+    ticks = []
+    while clock() < until:
+        badges = reader.read()
+        chosen = scheduler.select(badges.items(), key=lambda item: item[0], unread=lambda item: item[1], limit=per_tick)
+        reader.opened.extend(key for key, _ in chosen)
+        delay = scheduler.record(
+            tuple(sorted(badges.items())),
+            worked=bool(chosen),
+            pending=len(badges) - len(chosen),
+        )
+        ticks.append((clock(), delay, [key for key, _ in chosen]))
+        clock.advance(delay)
+    return ticks
+
+
+class AdaptivePollSchedulerTests(unittest.TestCase):
+    def setUp(self):
+        self.clock = FakeClock()
+        self.policy = PollPolicy(min_interval=0.2, max_interval=3.2, backoff=2.0, error_interval=2.0, window_budget=4, budget_window=10.0)
+        self.scheduler = AdaptivePollScheduler(self.policy, clock=self.clock)
+
+    def test_backs_off_exponentially_when_idle_and_caps(self):
+        delays = [self.scheduler.record(()) for _ in range(7)]
+        self.assertEqual(delays, [0.2, 0.4, 0.8, 1.6, 3.2, 3.2, 3.2])
+        self.assertEqual(self.scheduler.snapshot()["idle_polls"], 6)
+
+    def test_change_or_work_resets_to_fast_cadence(self):
+        for _ in range(5):
+            self.scheduler.record(())
+        self.assertEqual(self.scheduler.record((("alice", 1),)), 0.2)
+        self.assertEqual(self.scheduler.record((("alice", 1),)), 0.4)
+        self.assertEqual(self.scheduler.record((("alice", 1),), worked=True), 0.2)
+
+    def test_error_waits_without_resetting_backoff(self):
+        for _ in range(4):
+            self.scheduler.record(())
+        self.assertEqual(self.scheduler.record_error(), 2.0)
+        self.assertEqual(self.scheduler.record(()), 3.2)
+        self.assertEqual(self.scheduler.snapshot()["errors"], 1)
+
+    def test_select_prefers_unread_then_count_then_least_recently_opened(self):
+        items = [("quiet", 0), ("one", 1), ("many", 5), ("other", 1)]
+        pick = lambda limit: [key for key, _ in self.scheduler.select(items, key=lambda i: i[0], unread=lambda i: i[1], limit=limit)]
+
+        self.assertEqual(pick(2), ["many", "one"])
+        self.clock.advance(10.0)
+        # 未读数优先于打开先后；同为 1 条未读时没打开过的 other 先于 one
+        self.assertEqual(pick(3), ["many", "other", "one"])
+
+    def test_window_budget_limits_opens_and_delays_pending_work(self):
+        items = [(f"c{i}", 1) for i in range(6)]
+        first = self.scheduler.select(items, key=lambda i: i[0], unread=lambda i: i[1])
+        self.assertEqual(len(first), 4)
+        self.assertEqual(self.scheduler.budget_remaining(), 0)
+        self.assertEqual(self.scheduler.select(items, key=lambda i: i[0], unread=lambda i: i[1]), [])
+
+        self.clock.advance(3.0)
+        # 还有 2 个未读没处理，但预算要到第 10 秒才腾出来
+        self.assertAlmostEqual(self.scheduler.record(tuple(items), worked=True, pending=2), 7.0)
+        self.clock.advance(7.0)
+        self.assertEqual(self.scheduler.budget_remaining(), 4)
+        self.assertEqual(self.scheduler.record(tuple(items), pending=2), 0.2)
+
+    def test_snapshot_reports_cadence_and_time_since_change(self):
+        self.assertIsNone(self.scheduler.snapshot()["seconds_since_change"])
+        self.scheduler.record(("a",))
+        self.clock.advance(1.5)
+        self.scheduler.record(("a",))
+        self.clock.advance(0.5)
+
+        snapshot = self.scheduler.snapshot()
+        self.assertEqual(snapshot["interval_sec"], 0.4)
+        self.assertEqual(snapshot["seconds_since_change"], 2.0)
+        self.assertEqual(snapshot["seconds_since_poll"], 0.5)
+        self.assertEqual(snapshot["budget"], {"window_sec": 10.0, "limit": 4, "used": 0})
+
+        self.scheduler.reset()
+        self.assertEqual(self.scheduler.record(("a",)), 0.2)
+
+    def test_fake_reader_burst_is_drained_fast_then_backs_off(self):
+        reader = FakeUnreadReader(self.clock, [(1000.0, {}), (1005.0, {"a": 2, "b": 7, "c": 1, "d": 1, "e": 3})])
+        ticks = run_observer(self.scheduler, reader, self.clock, until=1030.0, per_tick=3)
+
+        opened = [key for _, _, keys in ticks for key in keys]
+        # 未读多的先开；预算 4/10s，第 5 个要等时间窗滚动
+        self.assertEqual(opened, ["b", "e", "a", "c", "d"])
+        burst_at = next(at for at, _, keys in ticks if keys)
+        last_open_at = [at for at, _, keys in ticks if keys][-1]
+        self.assertLess(burst_at - 1005.0, 3.2 + 1e-9)
+        self.assertLessEqual(last_open_at - burst_at, 10.0 + 0.2 + 1e-9)
+
+        # 角标清空后逐步退避到上限，而不是一直快速轮询
+        idle_delays = [delay for at, delay, _ in ticks if at > last_open_at]
+        self.assertEqual(idle_delays[:5], [0.2, 0.4, 0.8, 1.6, 3.2])
+        self.assertTrue(all(delay == 3.2 for delay in idle_delays[5:]))
+
+
+if __name__ == "__main__":
+    unittest.main()
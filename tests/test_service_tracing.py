@@ -0,0 +1,74 @@
+import sys
+import unittest
+from pathlib import Path
+
+
+REPO_ROOT = Path(__file__).resolve().parents[1]
+PYTHON_DIR = REPO_ROOT / "python"
+if str(PYTHON_DIR) not in sys.path:
+    sys.path.insert(0, str(PYTHON_DIR))
+
+from service import server
+from service import tracing
+from service.rpa_bridge import RpaEventStore
+
+
+def make_handler(path):
+    handler = object.__new__(server.AiServiceHandler)
+    handler.path = path
+    handler.sent = []
+    handler._send_json = lambda body, status_code=200: handler.sent.append((body, status_code))
+    return handler
+
+
+class ServiceTracingTests(unittest.TestCase):
+    def setUp(self):
+        tracing.set_enabled(True)
+        tracing.clear()
+
+    def test_span_records_chrome_complete_event(self):
+        with tracing.span("unit.work", "test", "cm-1", platform="wechat") as s:
+            pass
+        self.assertGreaterEqual(s.elapsed_ms, 0.0)
+
+        exported = tracing.export_chrome_trace()
+        events = exported["traceEvents"]
+        self.assertEqual(events[0]["ph"], "M")
+        self.assertEqual(len(events), 2)
+        event = events[1]
+        self.assertEqual(event["name"], "unit.work")
+        self.assertEqual(event["ph"], "X")
+        self.assertEqual(event["args"]["correlation_id"], "cm-1")
+        self.assertEqual(event["args"]["platform"], "wechat")
+        self.assertGreater(event["ts"], 1_600_000_000 * 1_000_000)
+
+    def test_event_store_append_is_traced_by_event_id(self):
+        store = RpaEventStore()
+        store.append({"event_id": "evt_1", "event_type": "message_observed", "platform": "wechat"})
+        store.append({"event_id": "evt_2", "event_type": "message_observed", "platform": "wechat"})
+
+        names = [e["name"] for e in tracing.export_chrome_trace("evt_1")["traceEvents"][1:]]
+        self.assertIn("rpa_event_store.append", names)
+        self.assertIn("rpa_event_store.broadcast", names)
+        self.assertTrue(all(e["args"]["correlation_id"] == "evt_1" for e in tracing.export_chrome_trace("evt_1")["traceEvents"][1:]))
+
+    def test_debug_trace_route_filters_by_correlation_id(self):
+        with tracing.span("unit.a", "test", "keep"):
+            pass
+        with tracing.span("unit.b", "test", "drop"):
+            pass
+        handler = make_handler("/api/debug/trace?correlation_id=keep")
+        handler.do_GET()
+        body, status = handler.sent[0]
+        self.assertEqual(status, 200)
+        self.assertEqual([e["name"] for e in body["traceEvents"][1:]], ["unit.a"])
+
+    def test_ring_is_bounded(self):
+        for _ in range(tracing.MAX_EVENTS + 10):
+            with tracing.span("unit.tick", "test"):
+                pass
+        self.assertEqual(len(tracing.export_chrome_trace()["traceEvents"]), tracing.MAX_EVENTS + 1)
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -1,3 +1,4 @@
+import hashlib
 import sqlite3
 import sys
 import tempfile
@@ -10,6 +11,8 @@ PYTHON_DIR = REPO_ROOT / "python"
 if str(PYTHON_DIR) not in sys.path:
     sys.path.insert(0, str(PYTHON_DIR))
 
+from rpa.core.media_store import MediaStore
+import service.rpa_bridge as rpa_bridge_module
 from service.rpa_bridge import RpaEventStore
 import service.truth_store as truth_store_module
 from service.truth_store import PythonServiceTruthStore
@@ -276,6 +279,111 @@ class ServiceTruthStoreTests(unittest.TestCase):
             self.assertEqual(second_page["events"][0]["event_type"], "message_observed")
             self.assertEqual(second_page["events"][0]["payload"]["content"], "重放消息")
 
+    def test_lagging_cursor_reads_evicted_events_from_event_log(self):
+        def conversation_event(index, platform):
+            return {
+                "event_id": f"evt-ring-{index}",
+                "event_type": "conversation_observed",
+                "platform": platform,
+                "account_id": "acct-1",
+                "conversation_key": f"{platform}:客户{index}",
+                "occurred_at": "2026-06-03T13:00:00",
+                "payload": {"display_name": f"客户{index}", "source_type": "ui_observed", "confidence": 80},
+            }
+
+        with temporary_directory() as tmp:
+            db_path = Path(tmp) / "service.db"
+            # 内存窗口只放得下两三条，其余只能从持久日志读
+            store = RpaEventStore(max_bytes=1200, truth_store=PythonServiceTruthStore(db_path))
+            seqs = [store.append(conversation_event(i, "wechat" if i % 2 else "qianniu")) for i in range(10)]
+            self.assertEqual(seqs, list(range(1, 11)))
+
+            collected = []
+            cursor = "0"
+            while True:
+                page = store.list_after(cursor, platform="wechat", limit=2)
+                collected.extend(event["event_id"] for event in page["events"])
+                if not page["events"]:
+                    break
+                cursor = page["cursor"]
+            self.assertEqual(collected, [f"evt-ring-{i}" for i in range(1, 10, 2)])
+            self.assertEqual(cursor, "10")
+            self.assertEqual(page["latest_cursor"], "10")
+            self.assertNotIn("truncated", page)
+
+            # 重启后序号接着持久日志往后编，旧游标仍然有效
+            restarted = RpaEventStore(max_bytes=1200, truth_store=PythonServiceTruthStore(db_path))
+            self.assertEqual(restarted.append(conversation_event(10, "qianniu")), 11)
+            page = restarted.list_after("6", limit=50)
+            self.assertEqual([event["seq"] for event in page["events"]], [7, 8, 9, 10, 11])
+            self.assertEqual(page["cursor"], "11")
+
+    def test_lagging_cursor_reports_evicted_events_missing_from_event_log(self):
+        def event(index, event_type):
+            return {
+                "event_id": f"evt-gap-{index}",
+                "event_type": event_type,
+                "platform": "wechat",
+                "account_id": "acct-1",
+                "conversation_key": f"wechat:客户{index}",
+                "occurred_at": "2026-06-03T13:00:00",
+                "payload": {"display_name": f"客户{index}", "source_type": "ui_observed", "confidence": 80},
+            }
+
+        with temporary_directory() as tmp:
+            db_path = Path(tmp) / "service.db"
+            store = RpaEventStore(max_bytes=1200, truth_store=PythonServiceTruthStore(db_path))
+            # 第 3 条是不落持久日志的健康事件，被挤出内存窗口后无法补齐
+            for i in range(8):
+                store.append(event(i, "platform_health" if i == 2 else "conversation_observed"))
+
+            page = store.list_after("0", platform="wechat", limit=50)
+            self.assertTrue(page["truncated"])
+            self.assertNotIn("evt-gap-2", [item["event_id"] for item in page["events"]])
+            first_page = store.list_after("0", platform="wechat", limit=2)
+            self.assertNotIn("truncated", first_page)
+            self.assertTrue(store.list_after(first_page["cursor"], platform="wechat", limit=2)["truncated"])
+            self.assertNotIn("truncated", store.list_after("3", platform="wechat", limit=50))
+
+    def test_event_store_refuses_to_start_without_latest_event_id(self):
+        class BrokenTruthStore(PythonServiceTruthStore):
+            calls = 0
+
+            def latest_event_id(self):
+                BrokenTruthStore.calls += 1
+                raise sqlite3.OperationalError("database is locked")
+
+        with temporary_directory() as tmp:
+            original_sleep = rpa_bridge_module.time.sleep
+            rpa_bridge_module.time.sleep = lambda _seconds: None
+            self.addCleanup(setattr, rpa_bridge_module.time, "sleep", original_sleep)
+            with self.assertRaises(sqlite3.OperationalError):
+                RpaEventStore(truth_store=BrokenTruthStore(Path(tmp) / "service.db"))
+            self.assertEqual(BrokenTruthStore.calls, rpa_bridge_module.EVENT_ID_READ_ATTEMPTS)
+
+    def test_event_log_keeps_event_when_seq_id_is_taken(self):
+        with temporary_directory() as tmp:
+            db_path = Path(tmp) / "service.db"
+            truth_store = PythonServiceTruthStore(db_path)
+            event = {
+                "event_type": "conversation_observed",
+                "platform": "wechat",
+                "account_id": "acct-1",
+                "occurred_at": "2026-06-03T13:00:00",
+                "payload": {"display_name": "客户", "source_type": "ui_observed", "confidence": 80},
+            }
+            self.assertTrue(truth_store.persist_event({**event, "event_id": "evt-a", "conversation_key": "wechat:甲", "seq": 1}))
+            self.assertTrue(truth_store.persist_event({**event, "event_id": "evt-b", "conversation_key": "wechat:乙", "seq": 1}))
+            # 同一 event_id 重放仍按幂等忽略
+            self.assertTrue(truth_store.persist_event({**event, "event_id": "evt-b", "conversation_key": "wechat:乙", "seq": 9}))
+
+            conn = sqlite3.connect(db_path)
+            try:
+                rows = conn.execute("SELECT id, event_id FROM rpa_events ORDER BY id").fetchall()
+            finally:
+                conn.close()
+            self.assertEqual(rows, [(1, "evt-a"), (2, "evt-b")])
+
 
     def test_filter_observed_message_events_bootstraps_empty_conversation(self):
         with temporary_directory() as tmp:
@@ -472,6 +580,57 @@ class ServiceTruthStoreTests(unittest.TestCase):
             finally:
                 conn.close()
 
+    def test_delete_conversation_releases_media_no_longer_referenced(self):
+        with temporary_directory() as tmp:
+            db_path = Path(tmp) / "service.db"
+            truth_store = PythonServiceTruthStore(db_path)
+            event_store = RpaEventStore(truth_store=truth_store)
+            store = MediaStore(Path(tmp) / "media")
+            shared_deleted = store.store_bytes(b"shared", store.root_dir / "image" / "msg-a", "shared.jpg")
+            shared_kept = store.store_bytes(b"shared", store.root_dir / "image" / "msg-b", "shared.jpg")
+            unique = store.store_bytes(b"unique", store.root_dir / "image" / "msg-c", "unique.jpg")
+
+            for platform_msg_id, path, conversation_key in (
+                ("msg-a", shared_deleted, "qianniu:acct-1:buyer-1"),
+                ("msg-c", unique, "qianniu:acct-1:buyer-1"),
+                ("msg-b", shared_kept, "qianniu:acct-1:buyer-2"),
+            ):
+                event = _message_event(platform_msg_id, "inbound", "customer", "[图片]", content_type="image")
+                event["conversation_key"] = conversation_key
+                event["payload"]["content_image_path"] = str(path)
+                event["payload"]["evidence_ref"] = str(path)
+                event_store.append(event)
+
+            result = truth_store.delete_conversation("qianniu", "qianniu:acct-1:buyer-1", account_id="acct-1")
+
+            self.assertEqual(result["released_media"], 2)
+            self.assertFalse(shared_deleted.exists())
+            self.assertFalse(unique.exists())
+            self.assertFalse(store.blob_path(hashlib.sha256(b"unique").hexdigest(), ".jpg").exists())
+            self.assertEqual(shared_kept.read_bytes(), b"shared")
+            self.assertTrue(store.blob_path(hashlib.sha256(b"shared").hexdigest(), ".jpg").exists())
+
+    def test_media_reference_lookup_uses_path_indexes(self):
+        with temporary_directory() as tmp:
+            db_path = Path(tmp) / "service.db"
+            RpaEventStore(truth_store=PythonServiceTruthStore(db_path)).append(
+                _message_event("msg-a", "inbound", "customer", "你好")
+            )
+            conn = sqlite3.connect(db_path)
+            try:
+                for table_name in ("wechat_messages", "qianniu_messages"):
+                    plan = conn.execute(
+                        f"EXPLAIN QUERY PLAN SELECT 1 FROM {table_name} "
+                        "WHERE content_image_path = ? OR evidence_ref = ? LIMIT 1",
+                        ("a.jpg", "a.jpg"),
+                    ).fetchall()
+                    details = [row[3] for row in plan]
+                    self.assertFalse([d for d in details if d.startswith("SCAN")], details)
+                    self.assertTrue(any(f"idx_{table_name}_content_image_path" in d for d in details), details)
+                    self.assertTrue(any(f"idx_{table_name}_evidence_ref" in d for d in details), details)
+            finally:
+                conn.close()
+
 
 def _message_event(
     platform_msg_id: str,
@@ -0,0 +1,148 @@
+#include <QtTest>
+
+#include "core/messagerouter.h"
+#include "data/conversationdao.h"
+#include "data/messagedao.h"
+#include "services/app/simloadrunner.h"
+#include "services/platforms/simplatformadapter.h"
+#include "testdatabase.h"
+#include "utils/runtimemode.h"
+
+#include <QJsonDocument>
+#include <QLoggingCategory>
+#include <QTextStream>
+
+class TestSimLoad : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void loadGenerator_deliversEachUniqueMessageOnce();
+    void loadGenerator_poissonArrivalsFollowConfiguredRate();
+    void loadGenerator_reportsThroughputLatencyAndRss();
+};
+
+void TestSimLoad::initTestCase()
+{
+    qRegisterMetaType<ConversationInfo>("ConversationInfo");
+    qRegisterMetaType<MessageRecord>("MessageRecord");
+    qRegisterMetaType<Models::Message>("Models::Message");
+    // 路由每条消息都会打 info 日志，几千条会淹没测试输出
+    QLoggingCategory::setFilterRules(QStringLiteral("default.debug=false\ndefault.info=false"));
+    RuntimeMode::setLocalCacheIngestOverride(true);
+}
+
+void TestSimLoad::cleanupTestCase()
+{
+    RuntimeMode::setLocalCacheIngestOverride(false);
+    QLoggingCategory::setFilterRules(QString());
+}
+
+void TestSimLoad::loadGenerator_deliversEachUniqueMessageOnce()
+{
+    ScopedTestDatabase db;
+    Q_UNUSED(db);
+
+    MessageRouter router;
+    SimPlatformAdapter adapter;
+    router.registerAdapter(&adapter);
+    SimLoadRunner runner(&router, &adapter);
+
+    SimLoadProfile profile;
+    profile.conversations = 5;
+    profile.totalMessages = 300;
+    profile.messagesPerSecond = 0;
+    profile.imageRatio = 0.2;
+    profile.duplicateRatio = 0.2;
+    profile.outOfOrderRatio = 0.1;
+    profile.seed = 7;
+    const SimLoadReport report = runner.run(profile, 60000);
+
+    QVERIFY(!report.timedOut);
+    QCOMPARE(report.load.generated, 300);
+    QVERIFY(report.load.duplicates > 0);
+    QVERIFY(report.load.reordered > 0);
+    QVERIFY(report.load.images > 0);
+    // 重复注入被路由按 platformMsgId 丢弃，乱序消息照常入库
+    QCOMPARE(report.delivered, 300);
+
+    ConversationDao convDao;
+    MessageDao msgDao;
+    const QVector<ConversationInfo> conversations = convDao.listCachedConversations();
+    QCOMPARE(conversations.size(), 5);
+    int stored = 0;
+    int images = 0;
+    for (const ConversationInfo& conv : conversations) {
+        QCOMPARE(conv.platform, QStringLiteral("simulator"));
+        const QVector<MessageRecord> messages = msgDao.listCachedMessages(conv.id, 1000);
+        stored += messages.size();
+        for (const MessageRecord& msg : messages) {
+            if (msg.contentType == QLatin1String("image"))
+                ++images;
+        }
+    }
+    QCOMPARE(stored, 300);
+    QCOMPARE(images, report.load.images);
+
+    QCOMPARE(runner.conversationModel()->rowCount(), 5);
+    QVERIFY(runner.messageModel()->conversationId() > 0);
+    QCOMPARE(int(runner.messageModel()->messages().size()),
+             msgDao.countCachedMessages(runner.messageModel()->conversationId()));
+}
+
+void TestSimLoad::loadGenerator_poissonArrivalsFollowConfiguredRate()
+{
+    ScopedTestDatabase db;
+    Q_UNUSED(db);
+
+    MessageRouter router;
+    SimPlatformAdapter adapter;
+    router.registerAdapter(&adapter);
+    SimLoadRunner runner(&router, &adapter);
+
+    SimLoadProfile profile;
+    profile.conversations = 3;
+    profile.totalMessages = 200;
+    profile.messagesPerSecond = 400.0;
+    profile.duplicateRatio = 0.0;
+    profile.outOfOrderRatio = 0.0;
+    const SimLoadReport report = runner.run(profile, 60000);
+
+    QVERIFY(!report.timedOut);
+    QCOMPARE(report.delivered, 200);
+    // 200 条、平均间隔 2.5ms，期望约 500ms；只校验下限，避免慢机器误报
+    QVERIFY2(report.elapsedMs >= 250, qPrintable(QString::number(report.elapsedMs)));
+}
+
+void TestSimLoad::loadGenerator_reportsThroughputLatencyAndRss()
+{
+    ScopedTestDatabase db;
+    Q_UNUSED(db);
+
+    MessageRouter router;
+    SimPlatformAdapter adapter;
+    router.registerAdapter(&adapter);
+    SimLoadRunner runner(&router, &adapter);
+
+    SimLoadProfile profile;
+    profile.conversations = 50;
+    profile.totalMessages = 2000;
+    profile.messagesPerSecond = 5000.0;
+    profile.arrival = SimLoadProfile::Arrival::Burst;
+    profile.burstSize = 50;
+    const SimLoadReport report = runner.run(profile, 120000);
+
+    QVERIFY(!report.timedOut);
+    QCOMPARE(report.delivered, report.load.generated);
+    QVERIFY(report.messagesPerSecond > 0.0);
+    QVERIFY(report.p50Ms <= report.p99Ms);
+    QVERIFY(report.p99Ms <= report.maxMs);
+
+    QTextStream(stdout) << "SIM_LOAD_REPORT "
+                        << QJsonDocument(report.toJson()).toJson(QJsonDocument::Compact) << Qt::endl;
+}
+
+QTEST_MAIN(TestSimLoad)
+#include "test_sim_load.moc"
@@ -0,0 +1,116 @@
+#include <QtTest>
+#include <QDir>
+#include <QDirIterator>
+#include <QImage>
+#include <QPixmapCache>
+#include <QSignalSpy>
+#include <QTemporaryDir>
+#include "ui/thumbnailservice.h"
+#include "utils/metrics.h"
+
+class TestThumbnailService : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+    void probe_reportsSizeAsynchronously();
+    void thumbnail_decodesAtTargetSizeAndPersists();
+    void probe_missingFile();
+
+private:
+    QString writeImage(const QString& name, const QSize& size);
+    int diskCacheFileCount() const;
+
+    QTemporaryDir m_dir;
+};
+
+void TestThumbnailService::init()
+{
+    QVERIFY(m_dir.isValid());
+    ThumbnailService::instance().setCacheDirectory(m_dir.filePath(QStringLiteral("cache")));
+    QPixmapCache::clear();
+}
+
+QString TestThumbnailService::writeImage(const QString& name, const QSize& size)
+{
+    QImage image(size, QImage::Format_RGB32);
+    image.fill(QColor(32, 184, 232));
+    const QString path = m_dir.filePath(name);
+    return image.save(path, "PNG") ? path : QString();
+}
+
+int TestThumbnailService::diskCacheFileCount() const
+{
+    int count = 0;
+    QDirIterator it(ThumbnailService::instance().cacheDirectory(), {QStringLiteral("*.png")},
+                    QDir::Files, QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        it.next();
+        ++count;
+    }
+    return count;
+}
+
+void TestThumbnailService::probe_reportsSizeAsynchronously()
+{
+    ThumbnailService& service = ThumbnailService::instance();
+    const QString path = writeImage(QStringLiteral("probe.png"), QSize(800, 600));
+    QVERIFY(!path.isEmpty());
+
+    QSignalSpy spy(&service, &ThumbnailService::metadataReady);
+    QCOMPARE(service.probe(path).status, ThumbnailService::Status::Loading);
+    QVERIFY(spy.wait(5000));
+    QCOMPARE(spy.first().first().toString(), path);
+
+    const ThumbnailService::Probe probe = service.probe(path);
+    QCOMPARE(probe.status, ThumbnailService::Status::Ready);
+    QCOMPARE(probe.originalSize, QSize(800, 600));
+    QVERIFY(probe.fileSize > 0);
+}
+
+void TestThumbnailService::thumbnail_decodesAtTargetSizeAndPersists()
+{
+    ThumbnailService& service = ThumbnailService::instance();
+    const QString path = writeImage(QStringLiteral("photo.png"), QSize(1600, 1200));
+    QVERIFY(!path.isEmpty());
+
+    QSignalSpy spy(&service, &ThumbnailService::thumbnailReady);
+    QVERIFY(service.thumbnail(path, QSize(200, 150)).isNull());
+    QVERIFY(spy.wait(5000));
+    const QPixmap pm = service.thumbnail(path, QSize(200, 150));
+    QCOMPARE(pm.size(), QSize(200, 150));
+    QCOMPARE(diskCacheFileCount(), 1);
+
+    // 同一内容换个路径、清掉内存缓存后从磁盘缓存命中，不再重新解码
+    const QString copy = m_dir.filePath(QStringLiteral("photo-copy.png"));
+    QVERIFY(QFile::copy(path, copy));
+    QPixmapCache::clear();
+    Metrics::Counter* hits = Metrics::counter(QStringLiteral("thumbnail_disk_cache_total"),
+                                              {{QStringLiteral("result"), QStringLiteral("hit")}});
+    const quint64 hitsBefore = hits->value();
+    spy.clear();
+    QVERIFY(service.thumbnail(copy, QSize(200, 150)).isNull());
+    QVERIFY(spy.wait(5000));
+    QCOMPARE(service.thumbnail(copy, QSize(200, 150)).size(), QSize(200, 150));
+    QCOMPARE(hits->value(), hitsBefore + 1);
+    QCOMPARE(diskCacheFileCount(), 1);
+    // 磁盘缓存里带着原图尺寸，探测还没回来也能布局
+    QCOMPARE(service.probe(copy).originalSize, QSize(1600, 1200));
+}
+
+void TestThumbnailService::probe_missingFile()
+{
+    ThumbnailService& service = ThumbnailService::instance();
+    const QString path = m_dir.filePath(QStringLiteral("not-there.png"));
+
+    QSignalSpy spy(&service, &ThumbnailService::metadataReady);
+    QCOMPARE(service.probe(path).status, ThumbnailService::Status::Loading);
+    QVERIFY(spy.wait(5000));
+    QCOMPARE(service.probe(path).status, ThumbnailService::Status::Missing);
+    QVERIFY(service.thumbnail(path, QSize(64, 64)).isNull());
+    QVERIFY(service.waitForIdle(5000));
+}
+
+QTEST_MAIN(TestThumbnailService)
+#include "test_thumbnailservice.moc"
@@ -0,0 +1,114 @@
+#include <QtTest>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTemporaryDir>
+#include <QThread>
+#include "utils/tracing.h"
+
+class TestTracing : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+    void span_exportsChromeCompleteEvent();
+    void export_filtersByCorrelationAndMergesExtraEvents();
+    void ring_keepsNewestEventsUnderConcurrentWriters();
+    void writeChromeTrace_producesValidJson();
+};
+
+void TestTracing::init()
+{
+    Tracing::setEnabled(true);
+    Tracing::clear();
+}
+
+void TestTracing::span_exportsChromeCompleteEvent()
+{
+    const qint64 before = Tracing::nowUs();
+    qint64 elapsedMs = -1;
+    {
+        Tracing::Span span("router.incoming", "router", QStringLiteral("evt_abc"));
+        QThread::msleep(5);
+        elapsedMs = span.end();
+    }
+    QVERIFY(elapsedMs >= 4);
+
+    const QJsonArray events = Tracing::chromeTraceEvents();
+    QCOMPARE(events.size(), 2); // process_name 元数据 + 1 个 span
+    const QJsonObject event = events.at(1).toObject();
+    QCOMPARE(event.value(QStringLiteral("name")).toString(), QStringLiteral("router.incoming"));
+    QCOMPARE(event.value(QStringLiteral("cat")).toString(), QStringLiteral("router"));
+    QCOMPARE(event.value(QStringLiteral("ph")).toString(), QStringLiteral("X"));
+    QVERIFY(qint64(event.value(QStringLiteral("ts")).toDouble()) >= before);
+    QVERIFY(event.value(QStringLiteral("dur")).toDouble() >= 4000.0);
+    QCOMPARE(event.value(QStringLiteral("args")).toObject().value(QStringLiteral("correlation_id")).toString(),
+             QStringLiteral("evt_abc"));
+}
+
+void TestTracing::export_filtersByCorrelationAndMergesExtraEvents()
+{
+    {
+        Tracing::Span stage("router.send.create_pending", "router", QStringLiteral("cm-1"));
+        stage.restart("router.send.adapter");
+    }
+    Tracing::record("router.incoming", "router", Tracing::nowUs(), 10, QStringLiteral("cm-2"));
+
+    const QJsonArray filtered = Tracing::chromeTraceEvents(QStringLiteral("cm-1"));
+    QCOMPARE(filtered.size(), 3);
+    QCOMPARE(filtered.at(1).toObject().value(QStringLiteral("name")).toString(), QStringLiteral("router.send.create_pending"));
+    QCOMPARE(filtered.at(2).toObject().value(QStringLiteral("name")).toString(), QStringLiteral("router.send.adapter"));
+
+    QJsonArray python;
+    python.append(QJsonObject{{QStringLiteral("name"), QStringLiteral("rpa_event_store.append")},
+                              {QStringLiteral("ph"), QStringLiteral("X")}});
+    const QJsonObject merged = Tracing::exportChromeTrace(python);
+    QCOMPARE(merged.value(QStringLiteral("traceEvents")).toArray().size(), 1 + 3 + 1);
+}
+
+void TestTracing::ring_keepsNewestEventsUnderConcurrentWriters()
+{
+    constexpr int kThreads = 4;
+    constexpr int kPerThread = 10000;
+    QList<QThread*> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.append(QThread::create([]() {
+            for (int i = 0; i < kPerThread; ++i)
+                Tracing::record("bench.record", "test", Tracing::nowUs(), 1);
+        }));
+    }
+    for (QThread* thread : threads)
+        thread->start();
+    for (QThread* thread : threads) {
+        thread->wait();
+        delete thread;
+    }
+
+    const QVector<Tracing::Event> events = Tracing::snapshot();
+    QVERIFY(events.size() > 0);
+    QVERIFY(events.size() <= kThreads * kPerThread);
+    QVERIFY(events.size() <= 16384);
+    for (const Tracing::Event& event : events)
+        QCOMPARE(QByteArray(event.name), QByteArray("bench.record"));
+}
+
+void TestTracing::writeChromeTrace_producesValidJson()
+{
+    Tracing::record("qianniu.dispatch_send", "adapter", Tracing::nowUs(), 42, QStringLiteral("cm-3"));
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString path = dir.filePath(QStringLiteral("trace.json"));
+    QString error;
+    QVERIFY2(Tracing::writeChromeTrace(path, QJsonArray(), &error), qPrintable(error));
+
+    QFile file(path);
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    QJsonParseError parseError;
+    const QJsonDocument doc = QJsonDocument::fromJson(file.readAll(), &parseError);
+    QCOMPARE(parseError.error, QJsonParseError::NoError);
+    QCOMPARE(doc.object().value(QStringLiteral("traceEvents")).toArray().size(), 2);
+}
+
+QTEST_MAIN(TestTracing)
+#include "test_tracing.moc"
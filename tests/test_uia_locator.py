@@ -0,0 +1,250 @@
+import gc
+import itertools
+import sys
+import unittest
+import weakref
+from pathlib import Path
+
+
+REPO_ROOT = Path(__file__).resolve().parents[1]
+PYTHON_DIR = REPO_ROOT / "python"
+if str(PYTHON_DIR) not in sys.path:
+    sys.path.insert(0, str(PYTHON_DIR))
+
+from rpa.core.uia_locator import UiaLocatorCache, follow_path, index_path
+
+
+_RUNTIME_IDS = itertools.count(1)
+
+
+class Rect:
+    def __init__(self, left, top, right, bottom):
+        self.left, self.top, self.right, self.bottom = left, top, right, bottom
+
+
+class FakeControl:
+    """UIA 控件替身：统计 GetChildren 次数；alive=False 时属性读取抛异常，模拟失效的元素。"""
+
+    calls = {"children": 0}
+
+    def __init__(self, class_name="", automation_id="", name="", children=(), rect=(0, 0, 100, 100), hwnd=0):
+        self.alive = True
+        self.parent = None
+        self._class_name = class_name
+        self._automation_id = automation_id
+        self._name = name
+        self._rect = rect
+        self._children = []
+        self.runtime_id = (next(_RUNTIME_IDS),)
+        self.NativeWindowHandle = hwnd
+        for child in children:
+            self.add(child)
+
+    def add(self, child, index=None):
+        child.parent = self
+        if index is None:
+            self._children.append(child)
+        else:
+            self._children.insert(index, child)
+        return child
+
+    def _check(self):
+        if not self.alive:
+            raise RuntimeError("element not available")
+
+    @property
+    def ClassName(self):
+        self._check()
+        return self._class_name
+
+    @property
+    def AutomationId(self):
+        self._check()
+        return self._automation_id
+
+    @property
+    def ControlTypeName(self):
+        self._check()
+        return "PaneControl"
+
+    @property
+    def Name(self):
+        self._check()
+        return self._name
+
+    @property
+    def BoundingRectangle(self):
+        self._check()
+        return Rect(*self._rect)
+
+    def GetRuntimeId(self):
+        self._check()
+        return list(self.runtime_id)
+
+    def GetChildren(self):
+        self._check()
+        FakeControl.calls["children"] += 1
+        return list(self._children)
+
+    def GetParentControl(self):
+        self._check()
+        return self.parent
+
+
+def walk_search(predicate):
+    def search(root):
+        queue = [root]
+        while queue:
+            control = queue.pop(0)
+            if predicate(control):
+                return control
+            queue.extend(control.GetChildren())
+        return None
+
+    return search
+
+
+def build_window():
+    send = FakeControl("Button", "send_btn")
+    chat_input = FakeControl("Edit", "chat_input")
+    sessions = FakeControl("List", "session_list", children=[FakeControl("Cell", "session_item_张三", "张三")])
+    window = FakeControl(
+        "MainWindow",
+        hwnd=0x1234,
+        children=[
+            FakeControl("Nav"),
+            sessions,
+            FakeControl("ChatPane", children=[FakeControl("MessageList", "msg_list"), FakeControl("Bottom", children=[chat_input, send])]),
+        ],
+    )
+    return window, sessions, chat_input, send
+
+
+class UiaLocatorCacheTests(unittest.TestCase):
+    def setUp(self):
+        FakeControl.calls["children"] = 0
+        self.cache = UiaLocatorCache()
+        self.searches = 0
+
+    def counted(self, predicate):
+        search = walk_search(predicate)
+
+        def wrapper(root):
+            self.searches += 1
+            return search(root)
+
+        return wrapper
+
+    def test_index_path_round_trip(self):
+        window, _sessions, chat_input, send = build_window()
+        self.assertEqual(index_path(window, send), (2, 1, 1))
+        self.assertIs(follow_path(window, (2, 1, 0)), chat_input)
+        self.assertEqual(index_path(window, window), ())
+        self.assertIsNone(index_path(window, FakeControl("Orphan")))
+        self.assertIsNone(follow_path(window, (9,)))
+
+    def test_hit_re_resolves_along_index_path_without_search(self):
+        window, _sessions, _chat_input, send = build_window()
+        search = self.counted(lambda c: c.AutomationId == "send_btn")
+
+        self.assertIs(self.cache.resolve(window, "send_button", search), send)
+        FakeControl.calls["children"] = 0
+        for _ in range(5):
+            self.assertIs(self.cache.resolve(window, "send_button", search), send)
+
+        self.assertEqual(self.searches, 1)
+        # 每次命中只沿路径 (2, 1, 1) 取三层子节点
+        self.assertEqual(FakeControl.calls["children"], 5 * 3)
+        stats = self.cache.stats()
+        self.assertEqual((stats["hits"], stats["misses"], stats["relocated"]), (5, 1, 0))
+        self.assertEqual(stats["hit_rate"], round(5 / 6, 3))
+
+    def test_dead_reference_is_relocated_by_index_path(self):
+        window, _sessions, chat_input, _send = build_window()
+        search = self.counted(lambda c: c.AutomationId == "chat_input")
+        self.cache.resolve(window, "chat_input", search)
+
+        # 元素失效后同一位置出现一个同指纹的新元素
+        bottom = chat_input.parent
+        chat_input.alive = False
+        bottom._children[0] = replacement = FakeControl("Edit", "chat_input")
+        replacement.parent = bottom
+
+        FakeControl.calls["children"] = 0
+        self.assertIs(self.cache.resolve(window, "chat_input", search), replacement)
+        self.assertEqual(self.searches, 1)
+        self.assertEqual(FakeControl.calls["children"], 3)
+        self.assertEqual(self.cache.stats()["relocated"], 1)
+
+        # 重定位后的引用直接命中
+        self.assertIs(self.cache.resolve(window, "chat_input", search), replacement)
+        self.assertEqual(self.cache.stats()["hits"], 1)
+
+    def test_moved_control_falls_back_to_full_search(self):
+        window, sessions, chat_input, _send = build_window()
+        search = self.counted(lambda c: c.AutomationId == "chat_input")
+        self.cache.resolve(window, "chat_input", search)
+
+        chat_input.alive = False
+        moved = sessions.add(FakeControl("Edit", "chat_input"))
+        self.assertIs(self.cache.resolve(window, "chat_input", search), moved)
+        self.assertEqual(self.searches, 2)
+        stats = self.cache.stats()
+        self.assertEqual((stats["misses"], stats["stale"]), (2, 1))
+
+    def test_validate_rejects_recycled_cell(self):
+        window, sessions, _chat_input, _send = build_window()
+        cell = sessions._children[0]
+        search = self.counted(lambda c: c.Name == "张三")
+        validate = lambda c: c.Name == "张三"
+        self.assertIs(self.cache.resolve(sessions, "session:张三", search, validate=validate), cell)
+
+        # 列表滚动后单元格被复用成别的会话，指纹不变但名字变了
+        cell._name = "李四"
+        target = sessions.add(FakeControl("Cell", "session_item_张三", "张三"))
+        self.assertIs(self.cache.resolve(sessions, "session:张三", search, validate=validate), target)
+        self.assertEqual(self.searches, 2)
+
+    def test_entries_are_scoped_per_window_and_invalidate(self):
+        first, *_ = build_window()
+        second, *_ = build_window()
+        second.NativeWindowHandle = 0x5678
+        search = self.counted(lambda c: c.AutomationId == "msg_list")
+
+        a = self.cache.resolve(first, "message_list", search)
+        b = self.cache.resolve(second, "message_list", search)
+        self.assertIsNot(a, b)
+        self.assertEqual(self.cache.stats()["entries"], 2)
+
+        self.cache.invalidate(first)
+        self.assertEqual(self.cache.stats()["entries"], 1)
+        self.cache.resolve(first, "message_list", search)
+        self.assertEqual(self.searches, 3)
+
+    def test_entries_hold_no_control_references(self):
+        # UIA 元素是 COM 指针，跨 uia_guard 或线程持有都不安全：缓存里不能留引用
+        window, _sessions, _chat_input, send = build_window()
+        search = self.counted(lambda c: c.AutomationId == "send_btn")
+        self.cache.resolve(window, "send_button", search)
+        refs = [weakref.ref(window), weakref.ref(send)]
+
+        del window, send, _sessions, _chat_input
+        gc.collect()
+        self.assertEqual([ref() for ref in refs], [None, None])
+
+        # 换一个根（下一次 uia_guard 里重新取到的窗口）照样按路径解析
+        window, _sessions, _chat_input, send = build_window()
+        self.assertIs(self.cache.resolve(window, "send_button", search), send)
+        self.assertEqual(self.searches, 1)
+
+    def test_not_found_is_not_cached(self):
+        window, *_ = build_window()
+        search = self.counted(lambda c: c.AutomationId == "missing")
+        self.assertIsNone(self.cache.resolve(window, "missing", search))
+        self.assertIsNone(self.cache.resolve(window, "missing", search))
+        self.assertEqual(self.searches, 2)
+        self.assertEqual(self.cache.stats()["entries"], 0)
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -1,4 +1,6 @@
+import os
 import sys
+import tempfile
 import unittest
 from pathlib import Path
 from unittest.mock import patch
@@ -30,6 +32,12 @@ from rpa.platforms.wechat.screenshot import trim_media_evidence
 from rpa.platforms.wechat.uia import collect_chat_layout_samples
 
 
+def temporary_directory():
+    root = REPO_ROOT / "Testing" / "tmp"
+    root.mkdir(parents=True, exist_ok=True)
+    return tempfile.TemporaryDirectory(dir=root)
+
+
 class FakeRect:
     def __init__(self, left=0, top=0, right=0, bottom=0):
         self.left = left
@@ -345,21 +353,15 @@ class WechatRoleAndSendTests(unittest.TestCase):
         sample = FakeSample(10, 10, 100, 100)
         sample.window_hwnd = 123
         image = FakeImage()
-        writer = MediaEvidenceWriter(root_dir="python/rpa/_media/test")
-        with (
-            patch("rpa.platforms.wechat.media_evidence.capture_bubble", return_value=image) as capture,
-            patch("rpa.platforms.wechat.media_evidence.Path.exists", side_effect=[False, True]),
-            patch("rpa.platforms.wechat.media_evidence.Path.mkdir"),
-            patch(
-                "rpa.platforms.wechat.media_evidence.Path.resolve",
-                return_value=Path("D:/evidence/wechat_msg_1.png"),
-            ),
-        ):
-            saved = writer.capture("image", "wechat_msg_1", sample)
-            existing = writer.capture("image", "wechat_msg_1", sample)
-
-        self.assertEqual(saved.status, "saved")
-        self.assertEqual(saved.path, "D:\\evidence\\wechat_msg_1.png")
+        with temporary_directory() as tmp:
+            writer = MediaEvidenceWriter(root_dir=tmp)
+            with patch("rpa.platforms.wechat.media_evidence.capture_bubble", return_value=image) as capture:
+                saved = writer.capture("image", "wechat_msg_1", sample)
+                existing = writer.capture("image", "wechat_msg_1", sample)
+
+            self.assertEqual(saved.status, "saved")
+            self.assertEqual(saved.path, str((Path(tmp) / "image" / "wechat_msg_1.png").resolve()))
+            self.assertTrue(Path(saved.path).is_file())
         self.assertEqual(existing.status, "existing")
         self.assertEqual(existing.path, saved.path)
         self.assertEqual(len(image.saved), 1)
@@ -378,28 +380,33 @@ class WechatRoleAndSendTests(unittest.TestCase):
         self.assertEqual(trimmed.size, (144, 145))
 
     def test_copy_clipboard_files_to_artifacts_copies_sources(self):
-        source = Path("D:/source/order.pdf")
-        with (
-            patch("rpa.platforms.wechat.media_clipboard.Path.mkdir"),
-            patch("rpa.platforms.wechat.media_clipboard.Path.is_file", return_value=True),
-            patch("rpa.platforms.wechat.media_clipboard.Path.exists", return_value=False),
-            patch(
-                "rpa.platforms.wechat.media_clipboard.Path.resolve",
-                return_value=Path("D:/artifact/order.pdf"),
-            ),
-            patch("rpa.platforms.wechat.media_clipboard.shutil.copy2") as copy2,
-        ):
+        with temporary_directory() as tmp:
+            source = Path(tmp) / "source" / "order.pdf"
+            source.parent.mkdir()
+            source.write_bytes(b"%PDF order")
+            root_dir = Path(tmp) / "artifact"
+
             result = copy_clipboard_files_to_artifacts(
-                root_dir="D:/artifact",
+                root_dir=root_dir,
+                content_type="file",
+                platform_msg_id="wechat_msg_clipboard",
+                source_paths=[source],
+            )
+            repeated = copy_clipboard_files_to_artifacts(
+                root_dir=root_dir,
                 content_type="file",
                 platform_msg_id="wechat_msg_clipboard",
                 source_paths=[source],
             )
 
-        self.assertEqual(result.status, "copied")
-        self.assertEqual(result.source_paths, [str(source)])
-        self.assertEqual(result.artifact_paths, ["D:\\artifact\\order.pdf"])
-        copy2.assert_called_once()
+            target = (root_dir / "file" / "wechat_msg_clipboard" / "order.pdf").resolve()
+            self.assertEqual(result.status, "copied")
+            self.assertEqual(result.source_paths, [str(source)])
+            self.assertEqual(result.artifact_paths, [str(target)])
+            self.assertEqual(target.read_bytes(), b"%PDF order")
+            # 重复抓取同一文件复用已有产物，不再生成 order_2.pdf
+            self.assertEqual(repeated.artifact_paths, result.artifact_paths)
+            self.assertEqual(os.listdir(target.parent), ["order.pdf"])
 
     def test_copy_clipboard_files_to_artifacts_handles_empty_sources(self):
         result = copy_clipboard_files_to_artifacts(
@@ -426,44 +433,30 @@ class WechatRoleAndSendTests(unittest.TestCase):
         from PIL import Image
 
         image = Image.new("RGB", (1, 1), "white")
-        with (
-            patch("rpa.platforms.wechat.media_clipboard.Path.mkdir"),
-            patch("rpa.platforms.wechat.media_clipboard.Path.exists", return_value=False),
-            patch(
-                "rpa.platforms.wechat.media_clipboard.Path.resolve",
-                return_value=Path("D:/artifact/wechat_msg_bitmap.png"),
-            ),
-            patch.object(image, "save") as save,
-            patch("PIL.ImageGrab.grabclipboard", return_value=image),
-        ):
+        with temporary_directory() as tmp, patch("PIL.ImageGrab.grabclipboard", return_value=image):
             result = copy_clipboard_bitmap_to_artifact(
-                root_dir="D:/artifact",
+                root_dir=tmp,
                 content_type="image",
                 platform_msg_id="wechat_msg_bitmap",
             )
 
-        self.assertEqual(result.status, "copied")
-        self.assertEqual(result.method, "clipboard_bitmap")
-        self.assertEqual(result.artifact_paths, ["D:\\artifact\\wechat_msg_bitmap.png"])
-        save.assert_called_once()
+            target = (Path(tmp) / "image" / "wechat_msg_bitmap.png").resolve()
+            self.assertEqual(result.status, "copied")
+            self.assertEqual(result.method, "clipboard_bitmap")
+            self.assertEqual(result.artifact_paths, [str(target)])
+            self.assertEqual(Image.open(target).size, (1, 1))
 
     def test_copy_clipboard_files_to_artifacts_falls_back_to_bitmap_for_images(self):
         from PIL import Image
 
         image = Image.new("RGB", (1, 1), "white")
         with (
+            temporary_directory() as tmp,
             patch("rpa.platforms.wechat.media_clipboard.read_clipboard_file_paths", return_value=[]),
-            patch("rpa.platforms.wechat.media_clipboard.Path.mkdir"),
-            patch("rpa.platforms.wechat.media_clipboard.Path.exists", return_value=False),
-            patch(
-                "rpa.platforms.wechat.media_clipboard.Path.resolve",
-                return_value=Path("D:/artifact/wechat_msg_bitmap.png"),
-            ),
-            patch.object(image, "save"),
             patch("PIL.ImageGrab.grabclipboard", return_value=image),
         ):
             result = copy_clipboard_files_to_artifacts(
-                root_dir="D:/artifact",
+                root_dir=tmp,
                 content_type="image",
                 platform_msg_id="wechat_msg_bitmap",
             )
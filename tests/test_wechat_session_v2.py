@@ -33,10 +33,16 @@ class FakeControl:
         self.BoundingRectangle = rect or FakeRect()
         self._children = children or []
         self._selected = selected
+        self.parent = None
+        for child in self._children:
+            child.parent = self
 
     def GetChildren(self):
         return list(self._children)
 
+    def GetParentControl(self):
+        return self.parent
+
     def GetSelectionItemPattern(self):
         class Pattern:
             def __init__(self, selected):
@@ -75,6 +81,30 @@ class WechatSessionV2Tests(unittest.TestCase):
         self.assertEqual(len(result.sessions), 1)
         self.assertIs(result.sessions[0].control, unread)
 
+    def test_loose_session_lookup_reranks_instead_of_reusing_superstring_match(self):
+        longer = FakeControl(
+            name="张三丰",
+            automation_id="session_item_张三丰",
+            class_name="mmui::ChatSessionCell",
+            rect=FakeRect(0, 10, 200, 40),
+        )
+        session_list = FakeControl(class_name="mmui::XTableView", children=[longer])
+        detector = WechatDetector()
+
+        self.assertIs(detector.find_session_control_in_list(session_list, "张三"), longer)
+
+        # 列表刷新后真正的“张三”出现了：模糊匹配要按当前列表重新取最优，而不是沿用上次的张三丰
+        exact = FakeControl(
+            name="张三",
+            automation_id="session_item_张三",
+            class_name="mmui::ChatSessionCell",
+            rect=FakeRect(0, 50, 200, 80),
+        )
+        exact.parent = session_list
+        session_list._children.append(exact)
+        self.assertIs(detector.find_session_control_in_list(session_list, "张三"), exact)
+        self.assertIs(detector.find_session_control_in_list(session_list, "张三", exact=True), exact)
+
     def test_extract_session_title_uses_first_non_empty_line(self):
         self.assertEqual(extract_session_title("\n Alice \n2条新消息"), "Alice")
 
@@ -1,5 +1,7 @@
 import sys
+import tempfile
 import unittest
+from unittest import mock
 from dataclasses import dataclass
 from pathlib import Path
 from types import SimpleNamespace
@@ -10,6 +12,7 @@ PYTHON_DIR = REPO_ROOT / "python"
 if str(PYTHON_DIR) not in sys.path:
     sys.path.insert(0, str(PYTHON_DIR))
 
+import rpa.platforms.wechat.stability as stability_module
 from rpa.platforms.wechat.adapter import WechatSidecarAdapter
 from rpa.platforms.wechat.media_context_menu import ContextMenuFileResult
 from rpa.platforms.wechat.media_evidence import MediaEvidenceResult
@@ -631,6 +634,21 @@ class WechatSidecarAdapterTests(unittest.TestCase):
         self.assertEqual(meta["detail"], "boom")
         self.assertEqual(meta["failure_count"], 1)
 
+    def test_debug_snapshot_reuses_window_png_while_window_unchanged(self):
+        frames = [bytes(64 * 48 * 4)] * 2 + [bytes([255]) * (64 * 48 * 4)]
+        capture = mock.Mock(side_effect=[(frame, 64, 48) for frame in frames])
+        with tempfile.TemporaryDirectory() as tmp, mock.patch.object(stability_module, "capture_window_printwindow", capture):
+            writer = stability_module.DebugArtifactWriter(enabled=True, root_dir=tmp)
+            first = writer.save_snapshot("scan_unread", stage="scan_unread", hwnd=123)
+            second = writer.save_snapshot("send_message", stage="send_message", hwnd=123)
+            third = writer.save_snapshot("send_message", stage="send_message", hwnd=123)
+
+            self.assertTrue(first.window.exists())
+            self.assertEqual(second.window, first.window)
+            self.assertNotEqual(third.window, first.window)
+            self.assertTrue(third.window.exists())
+        self.assertEqual((writer.window_pngs_saved, writer.window_pngs_reused), (2, 1))
+
 
 if __name__ == "__main__":
     unittest.main()